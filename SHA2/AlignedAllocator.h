@@ -0,0 +1,110 @@
+// The GPL version 3 License (GPLv3)
+//
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+//
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _CEX_ALIGNEDALLOCATOR_H
+#define _CEX_ALIGNEDALLOCATOR_H
+
+#include "CexDomain.h"
+#include <cstdint>
+#include <limits>
+#include <new>
+
+NAMESPACE_UTILITY
+
+/// <summary>
+/// A standard allocator that returns storage aligned to a fixed boundary
+/// </summary>
+///
+/// <remarks>
+/// <para>Before C++17 neither std::allocator nor operator new honour an alignment above that of max_align_t,
+/// so a vector of cache line sized elements may start in the middle of a line. This allocator over-allocates by the alignment,
+/// rounds the address up, and keeps the original pointer in the word below the returned block.</para>
+/// </remarks>
+template <typename T, size_t Alignment>
+class AlignedAllocator
+{
+	static_assert(Alignment >= sizeof(void*) && (Alignment & (Alignment - 1)) == 0, "The alignment must be a power of two, and at least the size of a pointer!");
+
+public:
+
+	typedef T value_type;
+
+	template <typename U>
+	struct rebind
+	{
+		typedef AlignedAllocator<U, Alignment> other;
+	};
+
+	AlignedAllocator()
+	{
+	}
+
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Alignment> &)
+	{
+	}
+
+	/// <summary>
+	/// Allocate uninitialized storage for Count objects, aligned to the Alignment boundary
+	/// </summary>
+	///
+	/// <param name="Count">The number of objects</param>
+	///
+	/// <returns>The aligned storage</returns>
+	///
+	/// <exception cref="std::bad_alloc">Thrown if the size overflows, or the storage can not be allocated</exception>
+	T* allocate(size_t Count)
+	{
+		if (Count > (std::numeric_limits<size_t>::max() - Alignment) / sizeof(T))
+			throw std::bad_alloc();
+
+		void* block = ::operator new((Count * sizeof(T)) + Alignment);
+		// at least one pointer of room is left below the aligned address for the original block
+		const uintptr_t ALNADR = (reinterpret_cast<uintptr_t>(block) + Alignment) & ~static_cast<uintptr_t>(Alignment - 1);
+		void* aligned = reinterpret_cast<void*>(ALNADR);
+		reinterpret_cast<void**>(aligned)[-1] = block;
+
+		return static_cast<T*>(aligned);
+	}
+
+	/// <summary>
+	/// Release storage returned by allocate
+	/// </summary>
+	///
+	/// <param name="Block">The aligned storage</param>
+	void deallocate(T* Block, size_t)
+	{
+		if (Block != nullptr)
+			::operator delete(reinterpret_cast<void**>(Block)[-1]);
+	}
+};
+
+template <typename T, typename U, size_t Alignment>
+inline bool operator==(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &)
+{
+	return true;
+}
+
+template <typename T, typename U, size_t Alignment>
+inline bool operator!=(const AlignedAllocator<T, Alignment> &, const AlignedAllocator<U, Alignment> &)
+{
+	return false;
+}
+
+NAMESPACE_UTILITYEND
+#endif
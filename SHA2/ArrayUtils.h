@@ -127,8 +127,8 @@ public:
 	/*! \cond PRIVATE */
 	CEX_OPTIMIZE_IGNORE
 	/*! \endcond */
-	template <typename T>
-	static void ClearVector(std::vector<T> &Obj)
+	template <typename T, typename A>
+	static void ClearVector(std::vector<T, A> &Obj)
 	{
 		if (Obj.capacity() == 0)
 			return;
@@ -156,7 +156,7 @@ public:
 	template <typename T>
 	static bool Compare(const std::vector<T> &A, const std::vector<T> &B)
 	{
-		if (A, size() != B.size())
+		if (A.size() != B.size())
 			return false;
 
 		return Compare<T>(A, 0, B, 0, A.size());
@@ -270,7 +270,7 @@ public:
 	/// </summary>
 	/// 
 	/// <param name="Counter">The vector array of values</param>
-	static inline void ArrayUtils::IncrementLE8(std::vector<byte> &Counter)
+	static inline void IncrementLE8(std::vector<byte> &Counter)
 	{
 		int i = -1;
 		while (++i < static_cast<int>(Counter.size()) && ++Counter[i] == 0) {}
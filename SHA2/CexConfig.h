@@ -110,7 +110,7 @@ static const int CEX_VERSION_RELEASE = 1;
 #	elif defined(_M_IA64)
 #		define CEX_ARCH_IA64
 #	endif
-#elif defined(CEX_COMPILER_GCC)
+#elif defined(CEX_COMPILER_GCC) || defined(CEX_COMPILER_CLANG) || defined(CEX_COMPILER_MINGW)
 #	if defined(__amd64__) || defined(__amd64) || defined(__x86_64__) || defined(__x86_64)
 #		define CEX_ARCH_X64
 #		define CEX_ARCH_X86_X64
@@ -189,9 +189,9 @@ static const int CEX_VERSION_RELEASE = 1;
 typedef unsigned char byte;
 
 #if (defined(__GNUC__) && !defined(__alpha)) || defined(__MWERKS__)
-	typedef unsigned int ushort;
-	typedef unsigned long uint;
-	typedef unsigned long long ulong;
+	typedef uint16_t ushort;
+	typedef uint32_t uint;
+	typedef uint64_t ulong;
 #elif defined(_MSC_VER) || defined(__BCPLUSPLUS__)
 	typedef unsigned __int16 ushort;
 	typedef unsigned __int32 uint;
@@ -277,6 +277,27 @@ const unsigned int WORD_BITS = WORD_SIZE * 8;
 #	endif
 #endif
 
+// compiles a single function for an instruction set extension, so that runtime dispatched kernels can live beside baseline code;
+// msvc emits any intrinsic without an arch switch, gcc and clang need the target attribute
+#if !defined(CEX_TARGET_ISA)
+#	if (defined(__GNUC__) || defined(__clang__)) && defined(CEX_ARCH_X86_X64)
+#		define CEX_TARGET_ISA(x) __attribute__((target(x)))
+#	else
+#		define CEX_TARGET_ISA(x)
+#	endif
+#endif
+
+// relaxed constexpr functions (loops and local mutation, c++14); msvc supports them from vs2017,
+// without them the constexpr functions are compiled as inline, and are only evaluated at runtime
+#if !defined(CEX_CONSTEXPR14)
+#	if (defined(__cpp_constexpr) && (__cpp_constexpr >= 201304L)) || (defined(_MSC_VER) && (_MSC_VER >= 1910))
+#		define CEX_HAS_CONSTEXPR14
+#		define CEX_CONSTEXPR14 constexpr
+#	else
+#		define CEX_CONSTEXPR14 inline
+#	endif
+#endif
+
 #if !(CEX_SECTION_ALIGN16)
 #	if defined(__GNUC__) && !defined(__APPLE__)
 		// the alignment attribute doesn't seem to work without this section attribute when -fdata-sections is turned on
@@ -439,7 +460,7 @@ const unsigned int WORD_BITS = WORD_SIZE * 8;
 #if defined(CEX_COMPILER_MSC)
 #	define CEX_OPTIMIZE_IGNORE __pragma(optimize("", off))
 #elif defined(CEX_COMPILER_GCC) || defined(CEX_COMPILER_MINGW)
-#	define CEX_OPTIMIZE_IGNORE _Pragma(TOSTRING(GCC optimize("O0")))
+#	define CEX_OPTIMIZE_IGNORE _Pragma(TOSTRING(GCC push_options)) _Pragma(TOSTRING(GCC optimize("O0")))
 #elif defined(CEX_COMPILER_CLANG)
 #	define CEX_OPTIMIZE_IGNORE __attribute__((optnone))
 #elif defined(CEX_COMPILER_INTEL)
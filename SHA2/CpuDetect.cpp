@@ -32,6 +32,24 @@
 #	warning "No way of calling cpuid for this compiler"
 #endif
 
+#if defined(CEX_ARCH_X86_X64)
+#	if defined(CEX_COMPILER_MSC) || defined(CEX_COMPILER_INTEL)
+#		define X86_XGETBV(index) _xgetbv(index)
+#	else
+		// the _xgetbv intrinsic needs -mxsave on gcc and clang; the raw opcode does not
+		static inline ulong X86_XGETBV(uint Index)
+		{
+			uint eax;
+			uint edx;
+			__asm__ __volatile__(".byte 0x0f, 0x01, 0xd0" : "=a" (eax), "=d" (edx) : "c" (Index));
+			return (static_cast<ulong>(edx) << 32) | eax;
+		}
+#	endif
+#	if !defined(_XCR_XFEATURE_ENABLED_MASK)
+#		define _XCR_XFEATURE_ENABLED_MASK 0
+#	endif
+#endif
+
 NAMESPACE_COMMON
 
 //~~~ Constructor~~~//
@@ -67,7 +85,7 @@ bool CpuDetect::AvxEnabled()
 
 	// check if os saves the ymm registers
 	if ((cpuInfo[2] & (1 << 27)) && (cpuInfo[2] & (1 << 28)))
-		return (_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0x6) != 0;
+		return (X86_XGETBV(_XCR_XFEATURE_ENABLED_MASK) & 0x6) != 0;
 
 	return false;
 }
@@ -79,7 +97,7 @@ bool CpuDetect::Avx2Enabled()
 	X86_CPUID(1, cpuInfo);
 
 	if ((cpuInfo[2] & (1 << 27)) && (cpuInfo[2] & (1 << 28)))
-		return (_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & 0xe6) != 0;
+		return (X86_XGETBV(_XCR_XFEATURE_ENABLED_MASK) & 0xe6) != 0;
 
 	return false;
 }
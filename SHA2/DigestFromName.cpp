@@ -1,5 +1,6 @@
 #include "DigestFromName.h"
 #include "SHA256.h"
+#include "SHA256d.h"
 #include "SHA512.h"
 
 NAMESPACE_HELPER
@@ -12,8 +13,24 @@ IDigest* DigestFromName::GetInstance(Digests DigestType, bool Parallel)
 		{
 		case Digests::SHA256:
 			return new Digest::SHA256(Parallel);
+		case Digests::SHA256d:
+			// there is no tree hashing mode; the Parallel flag is ignored
+			return new Digest::SHA256d();
+		case Digests::SHA224:
+		{
+			// the truncated variants are selected by the output size, with the default tree fan-out when parallel
+			Digest::SHA2Params params(GetDigestSize(DigestType), static_cast<uint>(GetBlockSize(DigestType)), Parallel ? 8 : 0);
+			return new Digest::SHA256(params);
+		}
 		case Digests::SHA512:
 			return new Digest::SHA512(Parallel);
+		case Digests::SHA384:
+		case Digests::SHA512T224:
+		case Digests::SHA512T256:
+		{
+			Digest::SHA2Params params(GetDigestSize(DigestType), static_cast<uint>(GetBlockSize(DigestType)), Parallel ? 8 : 0);
+			return new Digest::SHA512(params);
+		}
 		default:
 			throw Exception::CryptoException("DigestFromName:GetInstance", "The digest is not recognized!");
 		}
@@ -24,6 +41,39 @@ IDigest* DigestFromName::GetInstance(Digests DigestType, bool Parallel)
 	}
 }
 
+IDigest* DigestFromName::GetInstance(Digests DigestType, SHA2Params &Params)
+{
+	try
+	{
+		// the type only selects the rounds, so a mismatched size would return another variant under this name
+		if (Params.OutputSize() != GetDigestSize(DigestType))
+			throw Exception::CryptoException("DigestFromName:GetInstance", "The parameters output size does not match the digest type!");
+
+		switch (DigestType)
+		{
+		case Digests::SHA224:
+		case Digests::SHA256:
+			return new Digest::SHA256(Params);
+		case Digests::SHA384:
+		case Digests::SHA512:
+		case Digests::SHA512T224:
+		case Digests::SHA512T256:
+			return new Digest::SHA512(Params);
+		default:
+			throw Exception::CryptoException("DigestFromName:GetInstance", "The digest does not take tree parameters!");
+		}
+	}
+	catch (const std::exception &ex)
+	{
+		throw Exception::CryptoException("DigestFromName:GetInstance", "The digest is unavailable!", std::string(ex.what()));
+	}
+}
+
+std::unique_ptr<IDigest> DigestFromName::GetUniqueInstance(Digests DigestType, bool Parallel)
+{
+	return std::unique_ptr<IDigest>(GetInstance(DigestType, Parallel));
+}
+
 size_t DigestFromName::GetBlockSize(Digests DigestType)
 {
 	try
@@ -33,11 +83,16 @@ size_t DigestFromName::GetBlockSize(Digests DigestType)
 		case Digests::Skein256:
 			return 32;
 		case Digests::Blake256:
+		case Digests::SHA224:
 		case Digests::SHA256:
+		case Digests::SHA256d:
 		case Digests::Skein512:
 			return 64;
 		case Digests::Blake512:
+		case Digests::SHA384:
 		case Digests::SHA512:
+		case Digests::SHA512T224:
+		case Digests::SHA512T256:
 		case Digests::Skein1024:
 			return 128;
 		case Digests::Keccak256:
@@ -66,8 +121,15 @@ size_t DigestFromName::GetDigestSize(Digests DigestType)
 		case Digests::Blake256:
 		case Digests::Keccak256:
 		case Digests::SHA256:
+		case Digests::SHA256d:
+		case Digests::SHA512T256:
 		case Digests::Skein256:
 			return 32;
+		case Digests::SHA224:
+		case Digests::SHA512T224:
+			return 28;
+		case Digests::SHA384:
+			return 48;
 		case Digests::Blake512:
 		case Digests::Keccak512:
 		case Digests::SHA512:
@@ -101,9 +163,14 @@ size_t DigestFromName::GetPaddingSize(Digests DigestType)
 		case Digests::Skein512:
 		case Digests::Skein1024:
 			return 0;
+		case Digests::SHA224:
 		case Digests::SHA256:
+		case Digests::SHA256d:
 			return 9;
+		case Digests::SHA384:
 		case Digests::SHA512:
+		case Digests::SHA512T224:
+		case Digests::SHA512T256:
 			return 17;
 		case Digests::None:
 			return 0;
@@ -4,11 +4,14 @@
 #include "CexDomain.h"
 #include "CryptoException.h"
 #include "IDigest.h"
+#include "SHA2Params.h"
+#include <memory>
 
 NAMESPACE_HELPER
 
 using Enumeration::Digests;
 using Digest::IDigest;
+using Digest::SHA2Params;
 
 /// <summary>
 /// Get a Message Digest instance from it's enumeration name.
@@ -28,6 +31,30 @@ public:
 	/// <exception cref="Exception::CryptoException">Thrown if the enumeration name is not supported</exception>
 	static IDigest* GetInstance(Digests DigestType, bool Parallel = false);
 
+	/// <summary>
+	/// Get a SHA-2 Digest instance by name, initialized with a SHA2Params structure
+	/// </summary>
+	/// 
+	/// <param name="DigestType">The message digests enumeration type name; selects the SHA-256 or SHA-512 rounds</param>
+	/// <param name="Params">The output size and tree hashing parameters; the output size must be the digest size of DigestType</param>
+	/// 
+	/// <returns>An initialized digest</returns>
+	/// 
+	/// <exception cref="Exception::CryptoException">Thrown if the enumeration name is not a SHA-2 digest with tree parameters, the output size does not match it, or the parameters are invalid</exception>
+	static IDigest* GetInstance(Digests DigestType, SHA2Params &Params);
+
+	/// <summary>
+	/// Get a Digest instance by name, owned by a unique_ptr
+	/// </summary>
+	/// 
+	/// <param name="DigestType">The message digests enumeration type name</param>
+	/// <param name="Parallel">Return the digest instance initialized in parallel mode; default is false</param>
+	/// 
+	/// <returns>An initialized digest, deleted with its owner</returns>
+	/// 
+	/// <exception cref="Exception::CryptoException">Thrown if the enumeration name is not supported</exception>
+	static std::unique_ptr<IDigest> GetUniqueInstance(Digests DigestType, bool Parallel = false);
+
 	/// <summary>
 	/// Get the input block size of a message digest
 	/// </summary>
@@ -0,0 +1,199 @@
+#include "DigestPool.h"
+#include "CryptoDigestException.h"
+#include "DigestFromName.h"
+#include "SHA256.h"
+#include "SHA512.h"
+
+NAMESPACE_DIGEST
+
+using Exception::CryptoDigestException;
+using Helper::DigestFromName;
+
+// the idle instances of each key; shared with the deleters of the leases, so a lease can outlive the pool
+struct DigestPool::PoolState
+{
+	struct Bucket
+	{
+		Digests DigestType;
+		bool IsParallel;
+		// the serialized SHA2Params, empty when leased by type
+		std::vector<byte> Params;
+		std::vector<IDigest*> Idle;
+	};
+
+	std::vector<Bucket> Buckets;
+	bool IsClosed;
+	size_t MaxIdle;
+	std::mutex Lock;
+
+	explicit PoolState(size_t Maximum)
+		:
+		Buckets(),
+		IsClosed(false),
+		MaxIdle(Maximum),
+		Lock()
+	{
+	}
+
+	~PoolState()
+	{
+		Clear();
+	}
+
+	void Clear()
+	{
+		for (size_t i = 0; i < Buckets.size(); ++i)
+		{
+			for (size_t j = 0; j < Buckets[i].Idle.size(); ++j)
+				delete Buckets[i].Idle[j];
+
+			Buckets[i].Idle.clear();
+		}
+	}
+};
+
+//~~~Releaser~~~//
+
+DigestPool::Releaser::Releaser()
+	:
+	m_bucket(0),
+	m_degree(0),
+	m_isParallel(false),
+	m_poolState()
+{
+}
+
+DigestPool::Releaser::Releaser(const std::shared_ptr<PoolState> &State, size_t Bucket, IDigest* Digest)
+	:
+	m_bucket(Bucket),
+	m_degree(Digest->ParallelProfile().ParallelMaxDegree()),
+	m_isParallel(Digest->IsParallel()),
+	m_poolState(State)
+{
+}
+
+void DigestPool::Releaser::operator()(IDigest* Digest) const
+{
+	if (Digest == nullptr)
+		return;
+
+	bool pooled = false;
+	SHA256* dgt256 = dynamic_cast<SHA256*>(Digest);
+	SHA512* dgt512 = dynamic_cast<SHA512*>(Digest);
+	// a reset would return a restored midstate, and the next lease would hash behind its prefix
+	const bool ISMIDSTATE = (dgt256 != nullptr && dgt256->IsMidstate()) || (dgt512 != nullptr && dgt512->IsMidstate());
+
+	// a digest whose tree shape was changed during the lease no longer matches its key
+	if (m_poolState != nullptr && !ISMIDSTATE && Digest->IsParallel() == m_isParallel && Digest->ParallelProfile().ParallelMaxDegree() == m_degree)
+	{
+		// the reset runs outside the lock; the pool never holds message data
+		Digest->Reset();
+
+		std::lock_guard<std::mutex> lock(m_poolState->Lock);
+		std::vector<IDigest*> &idle = m_poolState->Buckets[m_bucket].Idle;
+
+		if (!m_poolState->IsClosed && idle.size() < m_poolState->MaxIdle)
+		{
+			idle.push_back(Digest);
+			pooled = true;
+		}
+	}
+
+	if (!pooled)
+		delete Digest;
+}
+
+//~~~Constructor~~~//
+
+DigestPool::DigestPool(size_t MaxIdle)
+	:
+	m_maxIdle(MaxIdle),
+	m_poolState()
+{
+	if (MaxIdle == 0)
+		throw CryptoDigestException("DigestPool:Ctor", "The maximum idle count can not be zero!");
+
+	m_poolState = std::make_shared<PoolState>(MaxIdle);
+}
+
+DigestPool::~DigestPool()
+{
+	std::lock_guard<std::mutex> lock(m_poolState->Lock);
+
+	m_poolState->IsClosed = true;
+	m_poolState->Clear();
+}
+
+//~~~Public Functions~~~//
+
+DigestPool::Lease DigestPool::Acquire(Digests DigestType, bool Parallel)
+{
+	return Acquire(DigestType, Parallel, nullptr);
+}
+
+DigestPool::Lease DigestPool::Acquire(Digests DigestType, SHA2Params &Params)
+{
+	return Acquire(DigestType, Params.FanOut() > 1, &Params);
+}
+
+void DigestPool::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_poolState->Lock);
+
+	m_poolState->Clear();
+}
+
+size_t DigestPool::Idle()
+{
+	std::lock_guard<std::mutex> lock(m_poolState->Lock);
+	size_t count = 0;
+
+	for (size_t i = 0; i < m_poolState->Buckets.size(); ++i)
+		count += m_poolState->Buckets[i].Idle.size();
+
+	return count;
+}
+
+//~~~Private Functions~~~//
+
+DigestPool::Lease DigestPool::Acquire(Digests DigestType, bool Parallel, SHA2Params* Params)
+{
+	const std::vector<byte> PRMCODE = (Params != nullptr) ? Params->ToBytes() : std::vector<byte>(0);
+	IDigest* digest = nullptr;
+	size_t bucket;
+
+	{
+		std::lock_guard<std::mutex> lock(m_poolState->Lock);
+		std::vector<PoolState::Bucket> &buckets = m_poolState->Buckets;
+
+		// there are few distinct keys in practice; a linear scan is cheaper than hashing the parameters
+		for (bucket = 0; bucket < buckets.size(); ++bucket)
+		{
+			if (buckets[bucket].DigestType == DigestType && buckets[bucket].IsParallel == Parallel && buckets[bucket].Params == PRMCODE)
+				break;
+		}
+
+		if (bucket == buckets.size())
+		{
+			PoolState::Bucket entry;
+			entry.DigestType = DigestType;
+			entry.IsParallel = Parallel;
+			entry.Params = PRMCODE;
+			buckets.push_back(std::move(entry));
+		}
+
+		if (buckets[bucket].Idle.size() != 0)
+		{
+			digest = buckets[bucket].Idle.back();
+			buckets[bucket].Idle.pop_back();
+		}
+	}
+
+	// a miss is constructed outside the lock
+	if (digest == nullptr)
+		digest = (Params != nullptr) ? DigestFromName::GetInstance(DigestType, *Params) : DigestFromName::GetInstance(DigestType, Parallel);
+
+	return Lease(digest, Releaser(m_poolState, bucket, digest));
+}
+
+NAMESPACE_DIGESTEND
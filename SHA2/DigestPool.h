@@ -0,0 +1,181 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _CEX_DIGESTPOOL_H
+#define _CEX_DIGESTPOOL_H
+
+#include "CexDomain.h"
+#include "Digests.h"
+#include "IDigest.h"
+#include "SHA2Params.h"
+#include <memory>
+#include <mutex>
+
+NAMESPACE_DIGEST
+
+using Enumeration::Digests;
+
+/// <summary>
+/// A thread-safe pool of reset digest instances, keyed by digest type and parameters
+/// </summary>
+/// 
+/// <example>
+/// <description>Hashing a request with a pooled tree hashing digest:</description>
+/// <code>
+/// DigestPool pool;
+/// ...
+/// DigestPool::Lease dgt = pool.Acquire(Digests::SHA256, true);
+/// dgt-&gt;Compute(request, hash);
+/// // the digest is reset and returned to the pool when the lease goes out of scope
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>A digest is leased as a unique_ptr whose deleter resets the instance and returns it to the pool, instead of deleting it.
+/// The next Acquire with the same type, parallel flag or SHA2Params gets the instance back, with its message buffers, leaf states and processor profile already allocated;
+/// only a pool miss constructs a digest through DigestFromName.</para>
+/// <para>Each key keeps at most MaxIdle released instances, the surplus is deleted. An instance whose tree mode or parallel degree was changed during the lease, 
+/// or that was reset to a restored midstate, is deleted rather than pooled, so a lease always matches its key and starts from the initial value of its variant. Instances are reset when they are released, so pooled digests hold no message data.</para>
+/// <para>Acquire and release lock the pool briefly; the hashing itself runs outside the lock, and a lease can be used and released on any thread.
+/// Leases may outlive the pool; a digest released after the pool is destroyed is deleted.</para>
+/// </remarks>
+class DigestPool
+{
+private:
+
+	struct PoolState;
+
+public:
+
+	/// <summary>
+	/// The deleter of a leased digest; resets the digest and returns it to its pool
+	/// </summary>
+	class Releaser
+	{
+	private:
+
+		size_t m_bucket;
+		size_t m_degree;
+		bool m_isParallel;
+		std::shared_ptr<PoolState> m_poolState;
+
+	public:
+
+		/// <summary>
+		/// Initialize an empty deleter; a digest released with it is deleted
+		/// </summary>
+		Releaser();
+
+		/// <summary>
+		/// Initialize the deleter of a digest leased from a pool
+		/// </summary>
+		///
+		/// <param name="State">The pool state</param>
+		/// <param name="Bucket">The key index of the digest</param>
+		/// <param name="Digest">The leased digest; its tree mode and degree are recorded</param>
+		Releaser(const std::shared_ptr<PoolState> &State, size_t Bucket, IDigest* Digest);
+
+		/// <summary>
+		/// Reset the digest and return it to the pool; or delete it, if it no longer matches its key or the pool is full or gone
+		/// </summary>
+		///
+		/// <param name="Digest">The leased digest</param>
+		void operator()(IDigest* Digest) const;
+	};
+
+	/// <summary>
+	/// A leased digest; returned to the pool when the lease is destroyed or reset
+	/// </summary>
+	typedef std::unique_ptr<IDigest, Releaser> Lease;
+
+private:
+
+	size_t m_maxIdle;
+	std::shared_ptr<PoolState> m_poolState;
+
+public:
+
+	DigestPool(const DigestPool&) = delete;
+	DigestPool& operator=(const DigestPool&) = delete;
+
+	// *** Properties *** //
+
+	/// <summary>
+	/// Get: The number of released instances held by the pool, over all keys
+	/// </summary>
+	size_t Idle();
+
+	/// <summary>
+	/// Get: The maximum number of released instances held for each key
+	/// </summary>
+	size_t MaxIdle() { return m_maxIdle; }
+
+	//~~~Constructor~~~//
+
+	/// <summary>
+	/// Initialize the class
+	/// </summary>
+	///
+	/// <param name="MaxIdle">The maximum number of released instances held for each key</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the maximum is zero</exception>
+	explicit DigestPool(size_t MaxIdle = 16);
+
+	/// <summary>
+	/// Finalize objects; the idle instances are deleted, leases still out are deleted when they are released
+	/// </summary>
+	~DigestPool();
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Lease a reset digest instance by type
+	/// </summary>
+	///
+	/// <param name="DigestType">The digest type</param>
+	/// <param name="Parallel">Lease the digest in tree hashing mode; default is false</param>
+	///
+	/// <returns>The leased digest</returns>
+	///
+	/// <exception cref="CryptoException">Thrown if the digest type is not supported</exception>
+	Lease Acquire(Digests DigestType, bool Parallel = false);
+
+	/// <summary>
+	/// Lease a reset SHA-2 digest instance initialized with a SHA2Params structure; instances are shared by equal parameters
+	/// </summary>
+	///
+	/// <param name="DigestType">The SHA-2 digest type; selects the SHA-256 or SHA-512 rounds</param>
+	/// <param name="Params">The output size and tree hashing parameters; the output size must be the digest size of DigestType</param>
+	///
+	/// <returns>The leased digest</returns>
+	///
+	/// <exception cref="CryptoException">Thrown if the digest type does not take tree parameters, the output size does not match it, or the parameters are invalid</exception>
+	Lease Acquire(Digests DigestType, SHA2Params &Params);
+
+	/// <summary>
+	/// Delete the idle instances; leases still out are returned to the pool as usual
+	/// </summary>
+	void Clear();
+
+private:
+	Lease Acquire(Digests DigestType, bool Parallel, SHA2Params* Params);
+};
+
+NAMESPACE_DIGESTEND
+#endif
@@ -49,7 +49,27 @@ enum class Digests : byte
 	/// <summary>
 	/// The Skein digest with a 1024 bit return size
 	/// </summary>
-	Skein1024 = 9
+	Skein1024 = 9,
+	/// <summary>
+	/// The double SHA-2 digest, SHA256(SHA256(M)), with a 256 bit return size
+	/// </summary>
+	SHA256d = 10,
+	/// <summary>
+	/// The SHA-2 digest with a 224 bit return size; SHA-256 with a distinct initial value, truncated
+	/// </summary>
+	SHA224 = 11,
+	/// <summary>
+	/// The SHA-2 digest with a 384 bit return size; SHA-512 with a distinct initial value, truncated
+	/// </summary>
+	SHA384 = 12,
+	/// <summary>
+	/// The SHA-2 digest SHA-512/224; SHA-512 with a distinct initial value, truncated to 224 bits
+	/// </summary>
+	SHA512T224 = 13,
+	/// <summary>
+	/// The SHA-2 digest SHA-512/256; SHA-512 with a distinct initial value, truncated to 256 bits
+	/// </summary>
+	SHA512T256 = 14
 };
 
 NAMESPACE_ENUMERATIONEND
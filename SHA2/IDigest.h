@@ -79,6 +79,13 @@ public:
 
 	//~~~Public Functions~~~//
 
+	/// <summary>
+	/// Create a copy of the digest in its current state; the copy continues the message independently
+	/// </summary>
+	/// 
+	/// <returns>The copy; the caller owns and deletes it</returns>
+	virtual IDigest* Clone() = 0;
+
 	/// <summary>
 	/// Get the Hash value
 	/// </summary>
@@ -102,6 +109,15 @@ public:
 	/// <returns>Size of Hash value</returns>
 	virtual size_t Finalize(std::vector<byte> &Output, const size_t OutOffset) = 0;
 
+	/// <summary>
+	/// Do final processing and write the hash value to caller memory
+	/// </summary>
+	/// 
+	/// <param name="Output">Receives DigestSize() bytes of hash value</param>
+	/// 
+	/// <returns>Size of Hash value</returns>
+	virtual size_t Finalize(byte* Output) = 0;
+
 	/// <summary>
 	/// Set the number of threads allocated when using multi-threaded tree hashing processing.
 	/// <para>Thread count must be an even number, and not exceed the number of processor cores.
@@ -131,6 +147,14 @@ public:
 	/// <param name="InOffset">The starting offset within the Input array</param>
 	/// <param name="Length">Amount of data to process in bytes</param>
 	virtual void Update(const std::vector<byte> &Input, size_t InOffset, size_t Length) = 0;
+
+	/// <summary>
+	/// Update the buffer with input read in place; mapped files, network buffers and strings are hashed without copying them into a vector
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the input data; may be null if Length is zero</param>
+	/// <param name="Length">Amount of data to process in bytes</param>
+	virtual void Update(const byte* Input, size_t Length) = 0;
 };
 
 NAMESPACE_DIGESTEND
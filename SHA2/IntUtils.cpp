@@ -179,6 +179,22 @@ void IntUtils::BeUL256ToBlock(std::vector<uint> &Input, std::vector<byte> &Outpu
 #endif
 }
 
+void IntUtils::BeUL256ToBlock(const std::array<uint, 8> &Input, std::vector<byte> &Output, size_t OutOffset)
+{
+#if defined(IS_BIG_ENDIAN)
+	memcpy(&Output[OutOffset], Input.data(), 8 * sizeof(uint));
+#else
+	Be32ToBytes(Input[0], Output, OutOffset);
+	Be32ToBytes(Input[1], Output, OutOffset + 4);
+	Be32ToBytes(Input[2], Output, OutOffset + 8);
+	Be32ToBytes(Input[3], Output, OutOffset + 12);
+	Be32ToBytes(Input[4], Output, OutOffset + 16);
+	Be32ToBytes(Input[5], Output, OutOffset + 20);
+	Be32ToBytes(Input[6], Output, OutOffset + 24);
+	Be32ToBytes(Input[7], Output, OutOffset + 28);
+#endif
+}
+
 void IntUtils::BeULL512ToBlock(std::vector<ulong> &Input, std::vector<byte> &Output, size_t OutOffset)
 {
 #if defined(IS_BIG_ENDIAN)
@@ -195,6 +211,22 @@ void IntUtils::BeULL512ToBlock(std::vector<ulong> &Input, std::vector<byte> &Out
 #endif
 }
 
+void IntUtils::BeULL512ToBlock(const std::array<ulong, 8> &Input, std::vector<byte> &Output, size_t OutOffset)
+{
+#if defined(IS_BIG_ENDIAN)
+	memcpy(&Output[OutOffset], Input.data(), 8 * sizeof(ulong));
+#else
+	Be64ToBytes(Input[0], Output, OutOffset);
+	Be64ToBytes(Input[1], Output, OutOffset + 8);
+	Be64ToBytes(Input[2], Output, OutOffset + 16);
+	Be64ToBytes(Input[3], Output, OutOffset + 24);
+	Be64ToBytes(Input[4], Output, OutOffset + 32);
+	Be64ToBytes(Input[5], Output, OutOffset + 40);
+	Be64ToBytes(Input[6], Output, OutOffset + 48);
+	Be64ToBytes(Input[7], Output, OutOffset + 56);
+#endif
+}
+
 ushort IntUtils::BytesToBe16(const std::vector<byte> &Input, const size_t InOffset)
 {
 #if defined(IS_BIG_ENDIAN)
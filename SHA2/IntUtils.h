@@ -3,6 +3,8 @@
 
 #include "CexDomain.h"
 #include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <sstream>
 
 NAMESPACE_UTILITY
@@ -332,6 +334,15 @@ public:
 	/// <param name="OutOffset">OutOffset within the destination block</param>
 	static void BeUL256ToBlock(std::vector<uint> &Input, std::vector<byte> &Output, size_t OutOffset);
 
+	/// <summary>
+	/// Convert a Big Endian 8 * 32bit word fixed-size array to a byte array
+	/// </summary>
+	/// 
+	/// <param name="Input">The 32bit word array</param>
+	/// <param name="Output">The destination bytes</param>
+	/// <param name="OutOffset">OutOffset within the destination block</param>
+	static void BeUL256ToBlock(const std::array<uint, 8> &Input, std::vector<byte> &Output, size_t OutOffset);
+
 	/// <summary>
 	/// Convert a Big Endian 8 * 64bit word array to a byte array
 	/// </summary>
@@ -341,6 +352,15 @@ public:
 	/// <param name="OutOffset">OutOffset within the destination block</param>
 	static void BeULL512ToBlock(std::vector<ulong> &Input, std::vector<byte> &Output, size_t OutOffset);
 
+	/// <summary>
+	/// Convert a Big Endian 8 * 64bit word fixed-size array to a byte array
+	/// </summary>
+	/// 
+	/// <param name="Input">The 64bit word array</param>
+	/// <param name="Output">The destination bytes</param>
+	/// <param name="OutOffset">OutOffset within the destination block</param>
+	static void BeULL512ToBlock(const std::array<ulong, 8> &Input, std::vector<byte> &Output, size_t OutOffset);
+
 	/// <summary>
 	/// Convert a byte array to a Big Endian 16 bit word
 	/// </summary>
@@ -359,6 +379,92 @@ public:
 	/// <returns>A 32 bit word in Big Endian format</returns>
 	static uint BytesToBe32(const std::vector<byte> &Input, const size_t InOffset);
 
+	/// <summary>
+	/// Load a Big Endian 32 bit word from a byte pointer.
+	/// <para>The word is read unaligned and reversed with the compilers byte-swap intrinsic (bswap/movbe) where available.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first byte of the word</param>
+	/// <returns>A 32 bit word in Big Endian format</returns>
+	static inline uint BytesToBe32(const byte* Input)
+	{
+		uint value;
+		memcpy(&value, Input, sizeof(uint));
+#if defined(IS_BIG_ENDIAN)
+		return value;
+#elif defined(CEX_COMPILER_MSC)
+		return _byteswap_ulong(value);
+#elif defined(CEX_COMPILER_GCC) || defined(CEX_COMPILER_CLANG) || defined(CEX_COMPILER_MINGW)
+		return __builtin_bswap32(value);
+#else
+		return (value >> 24) | ((value >> 8) & 0x0000FF00UL) | ((value << 8) & 0x00FF0000UL) | (value << 24);
+#endif
+	}
+
+	/// <summary>
+	/// Load a Big Endian 64 bit word from a byte pointer.
+	/// <para>The word is read unaligned and reversed with the compilers byte-swap intrinsic (bswap/movbe) where available.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first byte of the word</param>
+	/// <returns>A 64 bit word in Big Endian format</returns>
+	static inline ulong BytesToBe64(const byte* Input)
+	{
+		ulong value;
+		memcpy(&value, Input, sizeof(ulong));
+#if defined(IS_BIG_ENDIAN)
+		return value;
+#elif defined(CEX_COMPILER_MSC)
+		return _byteswap_uint64(value);
+#elif defined(CEX_COMPILER_GCC) || defined(CEX_COMPILER_CLANG) || defined(CEX_COMPILER_MINGW)
+		return __builtin_bswap64(value);
+#else
+		return (static_cast<ulong>(BytesToBe32(Input)) << 32) | BytesToBe32(Input + 4);
+#endif
+	}
+
+	/// <summary>
+	/// Store a 32 bit word to a byte pointer in Big Endian format
+	/// </summary>
+	/// 
+	/// <param name="Value">The 32 bit word</param>
+	/// <param name="Output">Pointer to the destination bytes</param>
+	static inline void Be32ToBytes(const uint Value, byte* Output)
+	{
+#if defined(IS_BIG_ENDIAN)
+		const uint value = Value;
+#elif defined(CEX_COMPILER_MSC)
+		const uint value = _byteswap_ulong(Value);
+#elif defined(CEX_COMPILER_GCC) || defined(CEX_COMPILER_CLANG) || defined(CEX_COMPILER_MINGW)
+		const uint value = __builtin_bswap32(Value);
+#else
+		const uint value = (Value >> 24) | ((Value >> 8) & 0x0000FF00UL) | ((Value << 8) & 0x00FF0000UL) | (Value << 24);
+#endif
+		memcpy(Output, &value, sizeof(uint));
+	}
+
+	/// <summary>
+	/// Store a 64 bit word to a byte pointer in Big Endian format
+	/// </summary>
+	/// 
+	/// <param name="Value">The 64 bit word</param>
+	/// <param name="Output">Pointer to the destination bytes</param>
+	static inline void Be64ToBytes(const ulong Value, byte* Output)
+	{
+#if defined(IS_BIG_ENDIAN)
+		memcpy(Output, &Value, sizeof(ulong));
+#elif defined(CEX_COMPILER_MSC)
+		const ulong value = _byteswap_uint64(Value);
+		memcpy(Output, &value, sizeof(ulong));
+#elif defined(CEX_COMPILER_GCC) || defined(CEX_COMPILER_CLANG) || defined(CEX_COMPILER_MINGW)
+		const ulong value = __builtin_bswap64(Value);
+		memcpy(Output, &value, sizeof(ulong));
+#else
+		Be32ToBytes(static_cast<uint>(Value >> 32), Output);
+		Be32ToBytes(static_cast<uint>(Value), Output + 4);
+#endif
+	}
+
 	/// <summary>
 	/// Convert a byte array to a Big Endian 64 bit dword
 	/// </summary>
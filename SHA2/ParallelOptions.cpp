@@ -6,6 +6,20 @@ NAMESPACE_COMMON
 
 using Exception::CryptoProcessingException;
 
+//~~~ProcessorProfile~~~//
+
+ParallelOptions::ProcessorProfile::ProcessorProfile()
+{
+	Common::CpuDetect detect;
+
+	HasSHA2 = detect.SHA();
+	HasSimd128 = detect.AVX();
+	HasSimd256 = detect.AVX2();
+	L1DataCacheTotal = detect.L1DataCacheTotal();
+	PhysicalCores = detect.PhysicalCores();
+	VirtualCores = detect.VirtualCores();
+}
+
 //~~~Constructor~~~//
 
 ParallelOptions::ParallelOptions(size_t BlockSize, bool SimdMultiply, size_t ReservedCache, bool SplitChannel, size_t ParallelMaxDegree)
@@ -67,6 +81,34 @@ ParallelOptions::ParallelOptions(size_t BlockSize, bool Parallel, size_t Paralle
 	StoreDefaults();
 }
 
+ParallelOptions::ParallelOptions(size_t BlockSize)
+	:
+	m_autoInit(false),
+	m_blockSize(BlockSize),
+	m_hasSHA2(false),
+	m_hasSimd128(false),
+	m_hasSimd256(false),
+	m_isParallel(false),
+	m_l1DataCacheReserved(0),
+	m_l1DataCacheTotal(0),
+	m_overrideMaxDegree(false),
+	m_parallelBlockSize(0),
+	m_parallelMaxDegree(1),
+	m_parallelMinimumSize(BlockSize),
+	m_physicalCores(0),
+	m_processorCount(0),
+	m_simdDetected(SimdProfiles::None),
+	m_simdMultiply(false),
+	m_splitChannel(false),
+	m_virtualCores(0),
+	m_wideBlock(false)
+{
+	if (m_blockSize == 0 || m_blockSize % 2 != 0)
+		throw CryptoProcessingException("ParallelOptions:Ctor", "The BlockSize must be a positive even number!");
+
+	StoreDefaults();
+}
+
 ParallelOptions::~ParallelOptions()
 {
 	Reset();
@@ -142,14 +184,14 @@ void ParallelOptions::SetMaxDegree(size_t MaxDegree)
 
 void ParallelOptions::Detect()
 {
-	Common::CpuDetect detect;
+	const ProcessorProfile &profile = Profile();
 
-	m_hasSHA2 = detect.SHA();
-	m_hasSimd128 = detect.AVX();
-	m_hasSimd256 = detect.AVX2();
-	m_physicalCores = detect.PhysicalCores();
+	m_hasSHA2 = profile.HasSHA2;
+	m_hasSimd128 = profile.HasSimd128;
+	m_hasSimd256 = profile.HasSimd256;
+	m_physicalCores = profile.PhysicalCores;
 	m_simdDetected = (m_hasSimd256) ? SimdProfiles::Simd256 : (m_hasSimd128) ? SimdProfiles::Simd128 : SimdProfiles::None;
-	m_virtualCores = detect.VirtualCores();
+	m_virtualCores = profile.VirtualCores;
 	m_processorCount = (m_virtualCores > m_physicalCores) ? m_virtualCores : m_physicalCores;
 
 	if (m_processorCount > 1 && m_processorCount % 2 != 0)
@@ -158,7 +200,14 @@ void ParallelOptions::Detect()
 		m_parallelMaxDegree = m_processorCount;
 
 	m_isParallel = (m_processorCount > 1);
-	m_l1DataCacheTotal = detect.L1DataCacheTotal();
+	m_l1DataCacheTotal = profile.L1DataCacheTotal;
+}
+
+const ParallelOptions::ProcessorProfile &ParallelOptions::Profile()
+{
+	// initialized once and thread-safe; cpuid traps to the hypervisor on virtual machines, so it is not repeated per instance
+	static const ProcessorProfile profile;
+	return profile;
 }
 
 void ParallelOptions::Reset()
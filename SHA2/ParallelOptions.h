@@ -36,10 +36,23 @@ private:
 		size_t ParallelBlockSize;
 	};
 
+	// the processor capabilities; queried once per process and copied by every instance
+	struct ProcessorProfile
+	{
+		bool HasSHA2;
+		bool HasSimd128;
+		bool HasSimd256;
+		size_t L1DataCacheTotal;
+		size_t PhysicalCores;
+		size_t VirtualCores;
+
+		ProcessorProfile();
+	};
+
 	// 16kb min
-	const size_t DEF_DATACACHE = 16384;
+	static const size_t DEF_DATACACHE = 16384;
 	// 32mb, not enforced
-	const size_t MAX_PRLALLOC = DEF_DATACACHE * 2000;
+	static const size_t MAX_PRLALLOC = DEF_DATACACHE * 2000;
 
 	bool m_autoInit;
 	size_t m_blockSize;
@@ -165,7 +178,8 @@ public:
 	/// <summary>
 	/// Instantiate this class using automated calculation of recommended values based on the hardware profile.
 	/// <para>Initializes and calculates the default recommended values. 
-	/// Sizes are auto-calculated based on processor cache sizes, cpu core count, and SIMD availability, to favour a high-performance profile.</para>
+	/// Sizes are auto-calculated based on processor cache sizes, cpu core count, and SIMD availability, to favour a high-performance profile.
+	/// The processor is queried once per process, on first use; later instances copy that snapshot.</para>
 	/// </summary>
 	/// 
 	/// <param name="BlockSize">The calling algorithms base input block-size in bytes</param>
@@ -192,6 +206,15 @@ public:
 	/// <param name="SplitChannel">The calling algorithm uses two channels of equal size Input and Output when processing data</param>
 	explicit ParallelOptions(size_t BlockSize, bool Parallel, size_t ParallelBlockSize, size_t ParallelMaxDegree, bool SimdMultiply, size_t ReservedCache, bool SplitChannel);
 
+	/// <summary>
+	/// Instantiate a sequential profile without querying the processor.
+	/// <para>Used by instances that can never run in parallel, such as a digest restored from a midstate; 
+	/// the capability flags, core counts and cache size are reported as zero, and IsParallel is false.</para>
+	/// </summary>
+	/// 
+	/// <param name="BlockSize">The input block-size in bytes of the target algorithm</param>
+	explicit ParallelOptions(size_t BlockSize);
+
 	/// <summary>
 	/// Finalize this class and clear resources
 	/// </summary>
@@ -238,6 +261,7 @@ public:
 	//~~~Private Functions~~~//
 
 	void Detect();
+	static const ProcessorProfile &Profile();
 	void StoreDefaults();
 };
 
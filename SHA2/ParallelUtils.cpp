@@ -1,14 +1,417 @@
 #include "ParallelUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #if defined(_OPENMP)
 #	include <omp.h>
-#else
-#	include <future>
+#endif
+#if defined(CEX_ARCH_X86_X64)
+#	include <emmintrin.h>
 #endif
 
 NAMESPACE_UTILITY
 
+namespace
+{
+	// roughly 20 to 80 microseconds of pause instructions; long enough to span the gaps between the
+	// ParallelFor calls of one Update, short enough that an idle process stops burning its cores quickly
+	const size_t SPIN_COUNT = 2048;
+
+	// a spinning thread yields the core's pipeline to its sibling hyper-thread
+	inline void SpinPause()
+	{
+#if defined(CEX_ARCH_X86_X64)
+		_mm_pause();
+#else
+		std::this_thread::yield();
+#endif
+	}
+
+	// the work-stealing executor behind ParallelFor, started on first use and joined at exit
+	class Executor
+	{
+	private:
+
+		// deques lent to threads outside the pool for the length of a call; further callers run their loops inline
+		static const size_t GUEST_SLOTS = 16;
+
+		// a loop being run; it lives on the calling thread's stack until its last index has completed
+		struct Job
+		{
+			const std::function<void(size_t)>* Function;
+			std::atomic<size_t> Pending;
+			std::atomic<bool> Failed;
+			std::exception_ptr Error;
+
+			Job(const std::function<void(size_t)> &F, size_t Count)
+				:
+				Function(&F),
+				Pending(Count),
+				Failed(false),
+				Error()
+			{
+			}
+		};
+
+		// a range of a job's indexes; it is split in halves as it is run
+		struct Task
+		{
+			Job* Owner;
+			size_t From;
+			size_t To;
+		};
+
+		// the owner pushes and pops at the back, thieves take the oldest and largest ranges from the front
+		struct WorkDeque
+		{
+			std::atomic<size_t> Count;
+			std::mutex Lock;
+			std::deque<Task> Tasks;
+			std::atomic<bool> Used;
+
+			WorkDeque()
+				:
+				Count(0),
+				Lock(),
+				Tasks(),
+				Used(false)
+			{
+			}
+		};
+
+		size_t m_dequeCount;
+		std::unique_ptr<WorkDeque[]> m_deques;
+		std::condition_variable m_exitSignal;
+		std::mutex m_mutex;
+		std::atomic<size_t> m_queued;
+		std::atomic<size_t> m_sleeping;
+		bool m_stop;
+		std::atomic<size_t> m_waiting;
+		std::condition_variable m_wakeSignal;
+		std::vector<std::thread> m_workers;
+
+		static thread_local WorkDeque* t_localDeque;
+		static thread_local uint t_stealSeed;
+
+	public:
+
+		Executor(const Executor&) = delete;
+		Executor& operator=(const Executor&) = delete;
+
+		explicit Executor(size_t Workers)
+			:
+			m_dequeCount(Workers + GUEST_SLOTS),
+			m_deques(new WorkDeque[Workers + GUEST_SLOTS]),
+			m_exitSignal(),
+			m_mutex(),
+			m_queued(0),
+			m_sleeping(0),
+			m_stop(false),
+			m_waiting(0),
+			m_wakeSignal(),
+			m_workers()
+		{
+			m_workers.reserve(Workers);
+
+			for (size_t i = 0; i < Workers; ++i)
+				m_workers.emplace_back(&Executor::Work, this, i);
+		}
+
+		~Executor()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+
+			m_wakeSignal.notify_all();
+
+			for (size_t i = 0; i < m_workers.size(); ++i)
+				m_workers[i].join();
+		}
+
+		size_t Workers() const
+		{
+			return m_workers.size();
+		}
+
+		void Run(size_t From, size_t To, const std::function<void(size_t)> &F)
+		{
+			WorkDeque* local = t_localDeque;
+			const bool GUEST = (local == nullptr);
+
+			if (GUEST)
+			{
+				local = Borrow();
+
+				if (local == nullptr)
+				{
+					for (size_t i = From; i < To; ++i)
+						F(i);
+
+					return;
+				}
+
+				t_localDeque = local;
+			}
+
+			Job job(F, To - From);
+			Push(local, Task{ &job, From, To });
+			Wait(job, local);
+
+			if (GUEST)
+			{
+				t_localDeque = nullptr;
+				local->Used.store(false, std::memory_order_release);
+			}
+
+			if (job.Error)
+				std::rethrow_exception(job.Error);
+		}
+
+	private:
+
+		WorkDeque* Borrow()
+		{
+			for (size_t i = m_workers.size(); i < m_dequeCount; ++i)
+			{
+				if (!m_deques[i].Used.exchange(true, std::memory_order_acquire))
+					return &m_deques[i];
+			}
+
+			return nullptr;
+		}
+
+		void Complete(Job &Owner, size_t Count)
+		{
+			// the job may be released by its caller once the count reaches zero; only the executor is touched after it
+			if (Owner.Pending.fetch_sub(Count) == Count && m_waiting.load() != 0)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_exitSignal.notify_all();
+			}
+		}
+
+		void Execute(Task &Item, WorkDeque* Local)
+		{
+			Job &owner = *Item.Owner;
+
+			if (owner.Failed.load(std::memory_order_relaxed))
+			{
+				Complete(owner, Item.To - Item.From);
+				return;
+			}
+
+			// the upper halves are left for thieves, the lowest index is run here
+			while (Item.To - Item.From > 1)
+			{
+				const size_t MIDPOS = Item.From + ((Item.To - Item.From) / 2);
+				Push(Local, Task{ Item.Owner, MIDPOS, Item.To });
+				Item.To = MIDPOS;
+			}
+
+			try
+			{
+				(*owner.Function)(Item.From);
+			}
+			catch (...)
+			{
+				// the first exception is kept for the caller, and the indexes not yet started are skipped
+				if (!owner.Failed.exchange(true))
+					owner.Error = std::current_exception();
+			}
+
+			Complete(owner, 1);
+		}
+
+		bool Pop(WorkDeque* Local, Task &Item)
+		{
+			if (Local->Count.load(std::memory_order_relaxed) == 0)
+				return false;
+
+			std::lock_guard<std::mutex> lock(Local->Lock);
+
+			if (Local->Tasks.empty())
+				return false;
+
+			Item = Local->Tasks.back();
+			Local->Tasks.pop_back();
+			Local->Count.fetch_sub(1, std::memory_order_relaxed);
+			m_queued.fetch_sub(1);
+
+			return true;
+		}
+
+		void Push(WorkDeque* Local, const Task &Item)
+		{
+			{
+				std::lock_guard<std::mutex> lock(Local->Lock);
+				Local->Tasks.push_back(Item);
+				Local->Count.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			// a worker counts itself as sleeping before its last look at the queue, so one of the two sees the other
+			m_queued.fetch_add(1);
+
+			if (m_sleeping.load() != 0)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_wakeSignal.notify_one();
+			}
+		}
+
+		bool Steal(WorkDeque* Local, Task &Item)
+		{
+			if (m_queued.load(std::memory_order_relaxed) == 0)
+				return false;
+
+			// xorshift; each thief starts its sweep at a random victim, so thieves do not pile onto the same deque
+			t_stealSeed ^= t_stealSeed << 13;
+			t_stealSeed ^= t_stealSeed >> 17;
+			t_stealSeed ^= t_stealSeed << 5;
+
+			const size_t FIRST = t_stealSeed % m_dequeCount;
+
+			for (size_t i = 0; i < m_dequeCount; ++i)
+			{
+				WorkDeque* victim = &m_deques[(FIRST + i) % m_dequeCount];
+
+				if (victim == Local || victim->Count.load(std::memory_order_relaxed) == 0)
+					continue;
+
+				std::lock_guard<std::mutex> lock(victim->Lock);
+
+				if (victim->Tasks.empty())
+					continue;
+
+				Item = victim->Tasks.front();
+				victim->Tasks.pop_front();
+				victim->Count.fetch_sub(1, std::memory_order_relaxed);
+				m_queued.fetch_sub(1);
+
+				return true;
+			}
+
+			return false;
+		}
+
+		void Wait(Job &Owner, WorkDeque* Local)
+		{
+			size_t idle = 0;
+			Task item;
+
+			// the caller runs tasks until its job is done; its own deque first, then any other
+			while (Owner.Pending.load() != 0)
+			{
+				if (Pop(Local, item) || Steal(Local, item))
+				{
+					Execute(item, Local);
+					idle = 0;
+				}
+				else if (idle < SPIN_COUNT)
+				{
+					++idle;
+					SpinPause();
+				}
+				else
+				{
+					// the remaining indexes are being run by other threads; the caller's deque is empty
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_waiting.fetch_add(1);
+					m_exitSignal.wait(lock, [&Owner]() { return Owner.Pending.load() == 0; });
+					m_waiting.fetch_sub(1);
+				}
+			}
+		}
+
+		void Work(size_t Index)
+		{
+			WorkDeque* local = &m_deques[Index];
+			Task item;
+
+			t_localDeque = local;
+			t_stealSeed = static_cast<uint>(Index + 1) * 0x9E3779B9U;
+
+			for (;;)
+			{
+				if (Pop(local, item) || Steal(local, item))
+				{
+					Execute(item, local);
+					continue;
+				}
+
+				// spin first; a worker parked on the condition variable costs the next caller a system call to wake
+				for (size_t i = 0; i < SPIN_COUNT && m_queued.load(std::memory_order_relaxed) == 0; ++i)
+					SpinPause();
+
+				if (m_queued.load() != 0)
+					continue;
+
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_sleeping.fetch_add(1);
+
+				while (!m_stop && m_queued.load() == 0)
+					m_wakeSignal.wait(lock);
+
+				m_sleeping.fetch_sub(1);
+
+				if (m_stop)
+					return;
+			}
+		}
+	};
+
+	thread_local Executor::WorkDeque* Executor::t_localDeque = nullptr;
+	thread_local uint Executor::t_stealSeed = 0x2545F491U;
+
+	Executor &Pool()
+	{
+		// the calling thread runs a share of every loop, so one worker fewer than the processors
+		static Executor pool((std::max)(ParallelUtils::ProcessorCount(), static_cast<size_t>(1)) - 1);
+
+		return pool;
+	}
+
+	// the number of chain runners on this thread's stack; a nested runner must not wait on a chain held further up
+	thread_local size_t t_chainDepth = 0;
+
+	struct ChainScope
+	{
+		ChainScope() { ++t_chainDepth; }
+		~ChainScope() { --t_chainDepth; }
+	};
+
+	// the per-chain progress of a ParallelChains call
+	struct ChainState
+	{
+		std::vector<bool> Busy;
+		size_t Done;
+		bool Failed;
+		std::mutex Lock;
+		std::vector<size_t> Next;
+		size_t Waiting;
+
+		explicit ChainState(size_t Chains)
+			:
+			Busy(Chains, false),
+			Done(0),
+			Failed(false),
+			Lock(),
+			Next(Chains, 0),
+			Waiting(0)
+		{
+		}
+	};
+}
+
 size_t ParallelUtils::ProcessorCount()
 {
 #if defined(_OPENMP)
@@ -18,31 +421,150 @@ size_t ParallelUtils::ProcessorCount()
 #endif
 }
 
-void ParallelUtils::ParallelFor(size_t From, size_t To, const std::function<void(size_t)> &F)
+void ParallelUtils::ParallelChains(size_t Chains, size_t Links, const std::function<void(size_t, size_t)> &F)
 {
-#if defined(_OPENMP)
-#pragma omp parallel num_threads((int)To)
+	if (Chains == 0 || Links == 0)
+		return;
+
+	if (Links == 1)
+	{
+		ParallelFor(0, Chains, [&F](size_t i)
+		{
+			F(i, 0);
+		});
+
+		return;
+	}
+
+	const size_t RUNCNT = (std::min)(Chains, Pool().Workers() + 1);
+
+	if (RUNCNT == 1)
 	{
-		size_t i = (size_t)omp_get_thread_num();
-		F(i);
+		for (size_t i = 0; i < Chains; ++i)
+		{
+			for (size_t j = 0; j < Links; ++j)
+				F(i, j);
+		}
+
+		return;
 	}
-#else
-	std::vector<std::future<void>> futures;
 
-	for (size_t i = From; i < To; ++i)
+	ChainState state(Chains);
+
+	// each runner claims the free chain that is furthest behind, and runs its next link
+	ParallelFor(0, RUNCNT, [&F, &state, Chains, Links](size_t)
 	{
-		auto fut = std::async([i, F]()
+		const bool NESTED = (t_chainDepth != 0);
+		ChainScope scope;
+		size_t chain = Chains;
+		size_t idle = 0;
+
+		for (;;)
 		{
+			size_t link = 0;
+
+			{
+				std::lock_guard<std::mutex> lock(state.Lock);
+
+				if (chain != Chains)
+				{
+					state.Busy[chain] = false;
+					++state.Next[chain];
+
+					if (state.Next[chain] == Links)
+						++state.Done;
+				}
+
+				if (state.Failed || state.Done == Chains)
+					return;
+
+				const size_t PRVCHN = chain;
+				chain = Chains;
+
+				for (size_t i = 0; i < Chains; ++i)
+				{
+					if (!state.Busy[i] && state.Next[i] != Links && (chain == Chains || state.Next[i] < state.Next[chain]))
+						chain = i;
+				}
+
+				// a runner that is waiting takes the chain just released; the runner that released it may be on a slow core
+				if (chain != Chains && chain == PRVCHN && state.Waiting != 0)
+				{
+					bool other = false;
+
+					for (size_t i = 0; i < Chains && !other; ++i)
+						other = (i != chain && !state.Busy[i] && state.Next[i] != Links);
+
+					if (!other)
+						return;
+				}
+
+				if (chain != Chains)
+				{
+					state.Busy[chain] = true;
+					link = state.Next[chain];
+
+					if (idle != 0)
+					{
+						--state.Waiting;
+						idle = 0;
+					}
+				}
+				else if (NESTED)
+				{
+					return;
+				}
+				else if (idle == 0)
+				{
+					++state.Waiting;
+					idle = 1;
+				}
+			}
+
+			if (chain == Chains)
+			{
+				// every unfinished chain is being run; wait for one to be released
+				if (idle < SPIN_COUNT)
+				{
+					++idle;
+					SpinPause();
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+
+				continue;
+			}
+
+			try
+			{
+				F(chain, link);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(state.Lock);
+				state.Failed = true;
+				throw;
+			}
+		}
+	});
+}
+
+void ParallelUtils::ParallelFor(size_t From, size_t To, const std::function<void(size_t)> &F)
+{
+	if (To <= From)
+		return;
+
+	if (To - From == 1 || Pool().Workers() == 0)
+	{
+		for (size_t i = From; i < To; ++i)
 			F(i);
-		});
-		futures.push_back(std::move(fut));
-	}
 
-	for (size_t i = 0; i < futures.size(); ++i)
-		futures[i].wait();
+		return;
+	}
 
-	futures.clear();
-#endif
+	Pool().Run(From, To, F);
 }
 
-NAMESPACE_UTILITYEND
\ No newline at end of file
+NAMESPACE_UTILITYEND
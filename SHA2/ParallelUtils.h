@@ -18,10 +18,37 @@ public:
 	/// </summary>
 	static size_t ProcessorCount();
 
+	/// <summary>
+	/// Run a set of chains in parallel; the links of each chain run one at a time and in order
+	/// </summary>
+	/// 
+	/// <remarks>
+	/// <para>F(Chain, Link) is called once for every chain and link. Link j of a chain starts after link j - 1 has returned, and its writes are visible to it,
+	/// so a chain can carry a running hash state from one link to the next; different chains run concurrently.</para>
+	/// <para>Each runner takes the free chain that is furthest behind, so the chains advance together. Between two links a chain may move to another thread;
+	/// a runner left without a free chain takes over the next link of a chain released by a slower thread, so a slow core delays a single link rather than its whole chain.</para>
+	/// <para>The first exception thrown by F is rethrown to the caller, and the links not yet started are skipped.</para>
+	/// </remarks>
+	/// 
+	/// <param name="Chains">The number of chains</param> 
+	/// <param name="Links">The number of links in each chain</param>
+	/// <param name="F">The function delegate, called with the chain and link indexes</param>
+	static void ParallelChains(size_t Chains, size_t Links, const std::function<void(size_t, size_t)> &F);
+
 	/// <summary>
 	/// A Parallel For loop
 	/// </summary>
 	/// 
+	/// <remarks>
+	/// <para>The loop runs on a work-stealing executor of ProcessorCount() - 1 persistent worker threads, started by the first call and shared by every caller; the calling thread runs a share of the indexes.
+	/// Every thread owns a deque of index ranges; a range is split in halves as it is run, the owner keeping the lower half and leaving the upper half on its deque.
+	/// An idle thread steals the oldest, and so the largest, range from a randomly chosen deque, so a slow core or a long task is worked around rather than waited on.
+	/// Indexes run in no particular order; loops with uneven tasks, such as hashing a list of files, are balanced without any tuning.</para>
+	/// <para>Idle workers spin briefly before parking, so back to back loops are not delayed by a thread wakeup. Loops may be nested, or run from several threads at once;
+	/// a thread waiting on its loop runs other tasks meanwhile.</para>
+	/// <para>The call returns when every index has run; the first exception thrown by F is rethrown to the caller, and the indexes not yet started are skipped.</para>
+	/// </remarks>
+	/// 
 	/// <param name="From">The inclusive starting position</param> 
 	/// <param name="To">The exclusive ending position</param>
 	/// <param name="F">The function delegate</param>
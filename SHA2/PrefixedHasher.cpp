@@ -0,0 +1,149 @@
+#include "PrefixedHasher.h"
+#include "CryptoDigestException.h"
+#include "DigestFromName.h"
+#include "SHA256.h"
+#include "SHA2Dispatch.h"
+#include "SHA512.h"
+
+NAMESPACE_DIGEST
+
+using Exception::CryptoDigestException;
+using Helper::DigestFromName;
+
+//~~~Constructor~~~//
+
+PrefixedHasher::PrefixedHasher(Digests DigestType, size_t Capacity)
+	:
+	m_blockSize(0),
+	m_cacheList(),
+	m_cacheIndex(),
+	m_capacity(Capacity),
+	m_digestType(DigestType),
+	m_digestSize(0),
+	m_evictions(0),
+	m_hits(0),
+	m_lookupKey(),
+	m_misses(0),
+	m_shortDigest()
+{
+	switch (DigestType)
+	{
+		case Digests::SHA224:
+		case Digests::SHA256:
+		case Digests::SHA384:
+		case Digests::SHA512:
+		case Digests::SHA512T224:
+		case Digests::SHA512T256:
+			break;
+		default:
+			throw CryptoDigestException("PrefixedHasher:Ctor", "The digest type is not a SHA-2 variant!");
+	}
+
+	if (Capacity == 0)
+		throw CryptoDigestException("PrefixedHasher:Ctor", "The capacity can not be zero!");
+
+	m_blockSize = DigestFromName::GetBlockSize(DigestType);
+	m_digestSize = DigestFromName::GetDigestSize(DigestType);
+	m_shortDigest.reset(DigestFromName::GetInstance(DigestType, false));
+	m_cacheIndex.reserve(Capacity);
+}
+
+PrefixedHasher::~PrefixedHasher()
+{
+	Clear();
+}
+
+//~~~Public Functions~~~//
+
+void PrefixedHasher::Clear()
+{
+	m_cacheIndex.clear();
+	m_cacheList.clear();
+	std::fill(m_lookupKey.begin(), m_lookupKey.end(), static_cast<char>(0));
+	m_lookupKey.clear();
+	m_evictions = 0;
+	m_hits = 0;
+	m_misses = 0;
+}
+
+void PrefixedHasher::Compute(const std::vector<byte> &Prefix, const std::vector<byte> &Message, std::vector<byte> &Output)
+{
+	Output.resize(m_digestSize);
+
+	if (Prefix.size() < m_blockSize)
+	{
+		m_shortDigest->Update(Prefix, 0, Prefix.size());
+		m_shortDigest->Update(Message, 0, Message.size());
+		m_shortDigest->Finalize(Output, 0);
+
+		return;
+	}
+
+	CacheEntry &entry = Lookup(Prefix);
+
+	// the digest returns to the prefix midstate on finalize
+	entry.Digest->Update(entry.Tail, 0, entry.Tail.size());
+	entry.Digest->Update(Message, 0, Message.size());
+	entry.Digest->Finalize(Output, 0);
+}
+
+//~~~Private Functions~~~//
+
+IDigest* PrefixedHasher::CreateMidstate(const std::vector<byte> &Prefix, size_t Length)
+{
+	if (m_blockSize == 64)
+	{
+		SHA256::SHA256State state;
+		state.Reset(m_digestSize);
+		SHA2Dispatch::Compress256()(&Prefix[0], Length / m_blockSize, state.H);
+		state.T = static_cast<ulong>(Length);
+
+		return new SHA256(state, m_digestSize);
+	}
+	else
+	{
+		SHA512::SHA512State state;
+		state.Reset(m_digestSize);
+		SHA2Dispatch::Compress512()(&Prefix[0], Length / m_blockSize, state.H);
+		state.T[0] = static_cast<ulong>(Length);
+
+		return new SHA512(state, m_digestSize);
+	}
+}
+
+PrefixedHasher::CacheEntry &PrefixedHasher::Lookup(const std::vector<byte> &Prefix)
+{
+	// the lookup key reuses its capacity, so a hit does not allocate
+	m_lookupKey.assign(reinterpret_cast<const char*>(&Prefix[0]), Prefix.size());
+	std::unordered_map<std::string, std::list<CacheEntry>::iterator>::iterator pos = m_cacheIndex.find(m_lookupKey);
+
+	if (pos != m_cacheIndex.end())
+	{
+		++m_hits;
+		m_cacheList.splice(m_cacheList.begin(), m_cacheList, pos->second);
+
+		return m_cacheList.front();
+	}
+
+	++m_misses;
+
+	if (m_cacheList.size() == m_capacity)
+	{
+		m_cacheIndex.erase(m_cacheList.back().Key);
+		m_cacheList.pop_back();
+		++m_evictions;
+	}
+
+	const size_t ALNLEN = Prefix.size() - (Prefix.size() % m_blockSize);
+
+	m_cacheList.emplace_front();
+	CacheEntry &entry = m_cacheList.front();
+	entry.Key = m_lookupKey;
+	entry.Digest.reset(CreateMidstate(Prefix, ALNLEN));
+	entry.Tail.assign(Prefix.begin() + ALNLEN, Prefix.end());
+	m_cacheIndex.emplace(entry.Key, m_cacheList.begin());
+
+	return entry;
+}
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,161 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _CEX_PREFIXEDHASHER_H
+#define _CEX_PREFIXEDHASHER_H
+
+#include "CexDomain.h"
+#include "Digests.h"
+#include "IDigest.h"
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+NAMESPACE_DIGEST
+
+using Enumeration::Digests;
+
+/// <summary>
+/// Hashes Prefix || Message with a bounded least-recently-used cache of prefix midstates; repeated prefixes are not compressed again
+/// </summary>
+/// 
+/// <example>
+/// <description>Hashing records that share a domain prefix:</description>
+/// <code>
+/// PrefixedHasher hasher(Digests::SHA256, 32);
+/// std::vector&lt;byte&gt; hash;
+/// hasher.Compute(prefix, record, hash);
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>The cache is keyed by the prefix bytes. On a miss the block aligned part of the prefix is compressed once with the active SHA2Dispatch kernel, 
+/// and the entry keeps a sequential digest restored to that midstate, along with the trailing prefix bytes that do not fill a block.
+/// A hit only processes the trailing prefix bytes and the message; the output is identical to hashing Prefix || Message with the sequential digest.</para>
+/// <para>A prefix shorter than a block has no midstate to save, and is hashed directly without touching the cache or its counters.
+/// When the cache is full the least recently used entry is evicted; the Hits, Misses and Evictions counters can be used to size the capacity.</para>
+/// <para>Entries hold the prefix bytes; Clear erases them. An instance is not thread-safe, use one per thread.</para>
+/// <para>Supported digests are SHA224, SHA256, SHA384, SHA512, SHA512T224 and SHA512T256.</para>
+/// </remarks>
+class PrefixedHasher
+{
+private:
+
+	struct CacheEntry
+	{
+		std::string Key;
+		std::unique_ptr<IDigest> Digest;
+		std::vector<byte> Tail;
+	};
+
+	size_t m_blockSize;
+	std::list<CacheEntry> m_cacheList;
+	std::unordered_map<std::string, std::list<CacheEntry>::iterator> m_cacheIndex;
+	size_t m_capacity;
+	Digests m_digestType;
+	size_t m_digestSize;
+	ulong m_evictions;
+	ulong m_hits;
+	std::string m_lookupKey;
+	ulong m_misses;
+	std::unique_ptr<IDigest> m_shortDigest;
+
+public:
+
+	PrefixedHasher(const PrefixedHasher&) = delete;
+	PrefixedHasher& operator=(const PrefixedHasher&) = delete;
+
+	// *** Properties *** //
+
+	/// <summary>
+	/// Get: The maximum number of cached prefixes
+	/// </summary>
+	size_t Capacity() { return m_capacity; }
+
+	/// <summary>
+	/// Get: The digest type
+	/// </summary>
+	Digests DigestType() { return m_digestType; }
+
+	/// <summary>
+	/// Get: Size of returned digest in bytes
+	/// </summary>
+	size_t DigestSize() { return m_digestSize; }
+
+	/// <summary>
+	/// Get: The number of entries evicted to make room for a new prefix
+	/// </summary>
+	ulong Evictions() { return m_evictions; }
+
+	/// <summary>
+	/// Get: The number of lookups that found the prefix midstate in the cache
+	/// </summary>
+	ulong Hits() { return m_hits; }
+
+	/// <summary>
+	/// Get: The number of lookups that compressed the prefix and added it to the cache
+	/// </summary>
+	ulong Misses() { return m_misses; }
+
+	/// <summary>
+	/// Get: The number of cached prefixes
+	/// </summary>
+	size_t Size() { return m_cacheList.size(); }
+
+	//~~~Constructor~~~//
+
+	/// <summary>
+	/// Initialize the class
+	/// </summary>
+	///
+	/// <param name="DigestType">The SHA-2 digest type</param>
+	/// <param name="Capacity">The maximum number of cached prefixes</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the digest is not a SHA-2 variant, or the capacity is zero</exception>
+	explicit PrefixedHasher(Digests DigestType, size_t Capacity = 64);
+
+	/// <summary>
+	/// Finalize objects
+	/// </summary>
+	~PrefixedHasher();
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Erase the cached prefixes and reset the counters
+	/// </summary>
+	void Clear();
+
+	/// <summary>
+	/// Get the hash of Prefix || Message
+	/// </summary>
+	///
+	/// <param name="Prefix">The prefix bytes; the cache key</param>
+	/// <param name="Message">The message bytes following the prefix</param>
+	/// <param name="Output">Receives the hash, resized to DigestSize()</param>
+	void Compute(const std::vector<byte> &Prefix, const std::vector<byte> &Message, std::vector<byte> &Output);
+
+private:
+	CacheEntry &Lookup(const std::vector<byte> &Prefix);
+	IDigest* CreateMidstate(const std::vector<byte> &Prefix, size_t Length);
+};
+
+NAMESPACE_DIGESTEND
+#endif
@@ -1,12 +1,15 @@
 #include "SHA256.h"
 #include "ArrayUtils.h"
-#include "IntUtils.h"
+#include "ParallelOptions.h"
 #include "ParallelUtils.h"
+#include "SHA256Batch.h"
 #include "SHA256Compress.h"
+#include "SHA2Dispatch.h"
+#include <algorithm>
 
 NAMESPACE_DIGEST
 
-using Utility::IntUtils;
+using Common::ParallelOptions;
 using Utility::ParallelUtils;
 
 //~~~Constructor~~~//
@@ -14,11 +17,12 @@ using Utility::ParallelUtils;
 SHA256::SHA256(bool Parallel)
 	:
 	m_treeParams(DIGEST_SIZE, static_cast<uint>(BLOCK_SIZE), DEF_PRLDEGREE),
+	m_dgtState(Parallel ? DEF_PRLDEGREE : 0),
+	m_engine(DIGEST_SIZE),
 	m_isDestroyed(false),
-	m_msgBuffer(Parallel ? DEF_PRLDEGREE * BLOCK_SIZE : BLOCK_SIZE),
+	m_msgBuffer(Parallel ? DEF_PRLDEGREE * BLOCK_SIZE : 0),
 	m_msgLength(0),
-	m_parallelProfile(BLOCK_SIZE, false, STATE_PRECACHED, false, DEF_PRLDEGREE),
-	m_dgtState(Parallel ? DEF_PRLDEGREE : 1)
+	m_parallelProfile(BLOCK_SIZE, false, STATE_PRECACHED, false, DEF_PRLDEGREE)
 {
 	if (m_parallelProfile.IsParallel())
 		m_parallelProfile.IsParallel() = Parallel;
@@ -29,12 +33,18 @@ SHA256::SHA256(bool Parallel)
 SHA256::SHA256(SHA2Params &Params)
 	:
 	m_treeParams(Params),
-	m_dgtState(1),
+	m_dgtState(0),
+	m_engine(),
 	m_isDestroyed(false),
-	m_msgBuffer(BLOCK_SIZE),
+	m_msgBuffer(0),
 	m_msgLength(0),
 	m_parallelProfile(BLOCK_SIZE, false, STATE_PRECACHED, false, m_treeParams.FanOut())
 {
+	if (Params.OutputSize() != 28 && Params.OutputSize() != DIGEST_SIZE)
+		throw CryptoDigestException("SHA256:Ctor", "The output size must be 28 or 32 bytes!");
+
+	m_engine = Engine(Params.OutputSize());
+
 	if (m_treeParams.FanOut() > 1)
 	{
 		m_dgtState.resize(m_treeParams.FanOut());
@@ -48,6 +58,67 @@ SHA256::SHA256(SHA2Params &Params)
 	Reset();
 }
 
+SHA256::SHA256(const SHA256State &Midstate, size_t OutputSize)
+	:
+	m_treeParams(OutputSize, static_cast<uint>(BLOCK_SIZE), 0),
+	m_dgtState(0),
+	m_engine(),
+	m_isDestroyed(false),
+	m_msgBuffer(0),
+	m_msgLength(0),
+	m_parallelProfile(BLOCK_SIZE)
+{
+	if (OutputSize != 28 && OutputSize != DIGEST_SIZE)
+		throw CryptoDigestException("SHA256:Ctor", "The output size must be 28 or 32 bytes!");
+
+	m_engine = Engine(Midstate, OutputSize);
+}
+
+SHA256::SHA256(const SHA256 &Digest)
+	:
+	m_treeParams(Digest.m_treeParams),
+	m_dgtState(Digest.m_dgtState),
+	m_engine(Digest.m_engine),
+	m_isDestroyed(Digest.m_isDestroyed),
+	m_msgBuffer(Digest.m_msgBuffer),
+	m_msgLength(Digest.m_msgLength),
+	m_parallelProfile(Digest.m_parallelProfile)
+{
+}
+
+SHA256::SHA256(SHA256 &&Digest)
+	:
+	m_treeParams(Digest.m_treeParams),
+	m_dgtState(std::move(Digest.m_dgtState)),
+	m_engine(Digest.m_engine),
+	m_isDestroyed(Digest.m_isDestroyed),
+	m_msgBuffer(std::move(Digest.m_msgBuffer)),
+	m_msgLength(Digest.m_msgLength),
+	m_parallelProfile(Digest.m_parallelProfile)
+{
+	Digest.Release();
+}
+
+SHA256& SHA256::operator=(SHA256 &&Digest)
+{
+	if (this != &Digest)
+	{
+		Destroy();
+
+		m_treeParams = Digest.m_treeParams;
+		m_dgtState = std::move(Digest.m_dgtState);
+		m_engine = Digest.m_engine;
+		m_isDestroyed = Digest.m_isDestroyed;
+		m_msgBuffer = std::move(Digest.m_msgBuffer);
+		m_msgLength = Digest.m_msgLength;
+		m_parallelProfile = Digest.m_parallelProfile;
+
+		Digest.Release();
+	}
+
+	return *this;
+}
+
 SHA256::~SHA256()
 {
 	Destroy();
@@ -55,13 +126,67 @@ SHA256::~SHA256()
 
 //~~~Public Functions~~~//
 
+IDigest* SHA256::Clone()
+{
+	return new SHA256(*this);
+}
+
 void SHA256::Compute(const std::vector<byte> &Input, std::vector<byte> &Output)
 {
-	Output.resize(DIGEST_SIZE);
+	Output.resize(DigestSize());
 	Update(Input, 0, Input.size());
 	Finalize(Output, 0);
 }
 
+void SHA256::ComputeMany(const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	// a partition must hold enough blocks to amortize its dispatch and the batch setup
+	const size_t PRTMIN = 131072 / BLOCK_SIZE;
+	// several partitions per core; threads that finish early steal the partitions left to a slow core
+	const size_t PRTCORE = 4;
+
+	if (Count == 0)
+		return;
+
+	size_t total = 0;
+
+	// the padded block count of the batch
+	for (size_t i = 0; i < Count; ++i)
+		total += (Length[i] + 8) / BLOCK_SIZE + 1;
+
+	ParallelOptions profile(BLOCK_SIZE, false, STATE_PRECACHED, false);
+	const size_t PRTCNT = (std::min)(profile.IsParallel() ? profile.ProcessorCount() * PRTCORE : 1, (std::max)(total / PRTMIN, static_cast<size_t>(1)));
+
+	if (PRTCNT > 1)
+	{
+		std::vector<size_t> bounds(PRTCNT + 1, Count);
+		size_t sum = 0;
+		size_t part = 1;
+
+		// contiguous ranges in arrival order, cut at equal shares of the total block count
+		bounds[0] = 0;
+		for (size_t i = 0; i < Count && part < PRTCNT; ++i)
+		{
+			sum += (Length[i] + 8) / BLOCK_SIZE + 1;
+			if (sum >= (total / PRTCNT) * part)
+			{
+				bounds[part] = i + 1;
+				++part;
+			}
+		}
+
+		ParallelUtils::ParallelFor(0, PRTCNT, [Input, Length, Output, &bounds](size_t i)
+		{
+			if (bounds[i + 1] > bounds[i])
+				SHA256Batch::Compute(Input + bounds[i], Length + bounds[i], bounds[i + 1] - bounds[i], Output + (bounds[i] * DIGEST_SIZE));
+		});
+	}
+	else
+	{
+		SHA256Batch::Compute(Input, Length, Count, Output);
+	}
+}
+
 void SHA256::Destroy()
 {
 	if (!m_isDestroyed)
@@ -72,7 +197,10 @@ void SHA256::Destroy()
 		try
 		{
 			for (size_t i = 0; i < m_dgtState.size(); ++i)
-				m_dgtState[i].Reset();
+				m_dgtState[i].Reset(DIGEST_SIZE);
+
+			// a new engine clears the message buffer and the restored midstate
+			m_engine = Engine(DIGEST_SIZE);
 
 			Utility::ArrayUtils::ClearVector(m_msgBuffer);
 			Utility::ArrayUtils::ClearVector(m_dgtState);
@@ -86,66 +214,89 @@ void SHA256::Destroy()
 
 size_t SHA256::Finalize(std::vector<byte> &Output, const size_t OutOffset)
 {
-	CEXASSERT(Output.size() - OutOffset >= DIGEST_SIZE, "The Output buffer is too short!");
+	CEXASSERT(Output.size() - OutOffset >= DigestSize(), "The Output buffer is too short!");
 
+	return Finalize(&Output[OutOffset]);
+}
+
+size_t SHA256::Finalize(byte* Output)
+{
 	if (m_parallelProfile.IsParallel())
 	{
-		// pad buffer with zeros
-		if (m_msgLength < m_msgBuffer.size())
-			memset(&m_msgBuffer[m_msgLength], (byte)0, m_msgBuffer.size() - m_msgLength);
+		// the tree is finalized on stack copies of the leaves, then reset
+		Peek(Output);
+		Reset();
+	}
+	else
+	{
+		m_engine.Finalize(Output);
+	}
 
-		// process buffer
-		if (m_msgLength != 0)
-		{
-			size_t blkCtr = 0;
+	return DigestSize();
+}
 
-			while (m_msgLength != 0)
-			{
-				const size_t MSGRMD = (m_msgLength >= BLOCK_SIZE) ? BLOCK_SIZE : m_msgLength;
-				HashFinal(m_msgBuffer, blkCtr * BLOCK_SIZE, MSGRMD, m_dgtState[blkCtr]);
-				m_msgLength -= MSGRMD;
-				++blkCtr;
-			}
-		}
+void SHA256::Hash(const byte* Input, size_t Length, byte(&Output)[32])
+{
+	Engine::Hash(Input, Length, Output, 32);
+}
+
+void SHA256::Hash(const byte* Input, size_t Length, byte(&Output)[28])
+{
+	Engine::Hash(Input, Length, Output, 28);
+}
 
-		// initialize root state
+SHA256::SHA256State SHA256::Midstate()
+{
+	if (m_parallelProfile.IsParallel())
+		throw CryptoDigestException("SHA256:Midstate", "A midstate can not be exported in tree hashing mode!");
+
+	return m_engine.Midstate();
+}
+
+size_t SHA256::Peek(byte* Output)
+{
+	if (m_parallelProfile.IsParallel())
+	{
+		CEX_ALIGN_DATA(16) byte block[BLOCK_SIZE];
 		SHA256State rootState;
-		rootState.Reset();
+		size_t blkLen = 0;
 
-		// add state blocks as contiguous message input
+		rootState.Reset(DigestSize());
+
+		// each leaf is finalized on a copy, and its hash streamed into the root block by block
 		for (size_t i = 0; i < m_dgtState.size(); ++i)
 		{
-			IntUtils::BeUL256ToBlock(m_dgtState[i].H, m_msgBuffer, i * BLOCK_SIZE);
-			m_msgLength += DIGEST_SIZE;
-		}
+			SHA256State leafState = m_dgtState[i];
 
-		// compress full blocks
-		size_t blkOff = 0;
-		if (m_msgLength > BLOCK_SIZE)
-		{
-			const size_t BLKRMD = m_msgLength - (m_msgLength % BLOCK_SIZE);
+			if (i * BLOCK_SIZE < m_msgLength)
+				Engine::Final(&m_msgBuffer[i * BLOCK_SIZE], (std::min)(m_msgLength - (i * BLOCK_SIZE), static_cast<size_t>(BLOCK_SIZE)), leafState);
 
-			for (size_t i = 0; i < BLKRMD / BLOCK_SIZE; ++i)
-				Compress(m_msgBuffer, i * BLOCK_SIZE, rootState);
+			Engine::Store(leafState, block + blkLen, DIGEST_SIZE);
+			blkLen += DIGEST_SIZE;
 
-			m_msgLength -= BLKRMD;
-			blkOff = BLKRMD;
+			if (blkLen == BLOCK_SIZE)
+			{
+				Engine::Compress(block, 1, rootState);
+				blkLen = 0;
+			}
 		}
 
-		// finalize and store
-		HashFinal(m_msgBuffer, blkOff, m_msgLength, rootState);
-		IntUtils::BeUL256ToBlock(rootState.H, Output, OutOffset);
+		Engine::Final(block, blkLen, rootState);
+		Engine::Store(rootState, Output, DigestSize());
 	}
 	else
 	{
-		// finalize and store
-		HashFinal(m_msgBuffer, 0, m_msgLength, m_dgtState[0]);
-		IntUtils::BeUL256ToBlock(m_dgtState[0].H, Output, OutOffset);
+		m_engine.Peek(Output);
 	}
 
-	Reset();
+	return DigestSize();
+}
 
-	return DIGEST_SIZE;
+size_t SHA256::Peek(std::vector<byte> &Output, const size_t OutOffset)
+{
+	CEXASSERT(Output.size() - OutOffset >= DigestSize(), "The Output buffer is too short!");
+
+	return Peek(&Output[OutOffset]);
 }
 
 void SHA256::ParallelMaxDegree(size_t Degree)
@@ -168,31 +319,52 @@ void SHA256::ParallelMaxDegree(size_t Degree)
 
 void SHA256::Reset()
 {
-	m_msgLength = 0;
-	memset(&m_msgBuffer[0], 0, m_msgBuffer.size());
-
-	for (size_t i = 0; i < m_dgtState.size(); ++i)
+	if (m_parallelProfile.IsParallel())
 	{
-		m_dgtState[i].Reset();
+		m_msgLength = 0;
+		memset(&m_msgBuffer[0], 0, m_msgBuffer.size());
 
-		if (m_parallelProfile.IsParallel())
+		for (size_t i = 0; i < m_dgtState.size(); ++i)
 		{
+			m_dgtState[i].Reset(DigestSize());
 			m_treeParams.NodeOffset() = static_cast<uint>(i);
-			Compress(m_treeParams.ToBytes(), 0, m_dgtState[i]);
+			// the serialized parameters are sized to one block; truncated or zero-padded
+			std::vector<byte> config = m_treeParams.ToBytes();
+			config.resize(BLOCK_SIZE, 0);
+			Engine::Compress(&config[0], 1, m_dgtState[i]);
 		}
 	}
+	else
+	{
+		m_engine.Reset();
+	}
+}
+
+void SHA256::Reset(const SHA256State &Midstate)
+{
+	if (m_parallelProfile.IsParallel())
+		throw CryptoDigestException("SHA256:Reset", "A midstate can not be restored in tree hashing mode!");
+
+	m_engine.Reset(Midstate);
 }
 
 void SHA256::Update(byte Input)
 {
-	std::vector<byte> inp(1, Input);
-	Update(inp, 0, 1);
+	Update(&Input, 1);
 }
 
 void SHA256::Update(const std::vector<byte> &Input, size_t InOffset, size_t Length)
 {
 	CEXASSERT(Input.size() - InOffset >= Length, "The Output buffer is too short!");
 
+	if (Length == 0)
+		return;
+
+	Update(&Input[InOffset], Length);
+}
+
+void SHA256::Update(const byte* Input, size_t Length)
+{
 	if (Length == 0)
 		return;
 
@@ -203,17 +375,14 @@ void SHA256::Update(const std::vector<byte> &Input, size_t InOffset, size_t Leng
 			// fill buffer
 			const size_t BUFRMD = m_msgBuffer.size() - m_msgLength;
 			if (BUFRMD != 0)
-				memcpy(&m_msgBuffer[m_msgLength], &Input[InOffset], BUFRMD);
+				memcpy(&m_msgBuffer[m_msgLength], Input, BUFRMD);
 
 			// empty the message buffer
-			ParallelUtils::ParallelFor(0, m_parallelProfile.ParallelMaxDegree(), [this, &Input, InOffset](size_t i)
-			{
-				Compress(m_msgBuffer, i * BLOCK_SIZE, m_dgtState[i]);
-			});
+			ProcessLeaves(&m_msgBuffer[0], m_parallelProfile.ParallelMinimumSize());
 
 			m_msgLength = 0;
 			Length -= BUFRMD;
-			InOffset += BUFRMD;
+			Input += BUFRMD;
 		}
 
 		if (Length >= m_parallelProfile.ParallelBlockSize())
@@ -222,108 +391,123 @@ void SHA256::Update(const std::vector<byte> &Input, size_t InOffset, size_t Leng
 			const size_t PRCLEN = Length - (Length % m_parallelProfile.ParallelBlockSize());
 
 			// process large blocks
-			ParallelUtils::ParallelFor(0, m_parallelProfile.ParallelMaxDegree(), [this, &Input, InOffset, PRCLEN](size_t i)
-			{
-				ProcessLeaf(Input, InOffset + (i * BLOCK_SIZE), m_dgtState[i], PRCLEN);
-			});
+			ProcessLeaves(Input, PRCLEN);
 
 			Length -= PRCLEN;
-			InOffset += PRCLEN;
+			Input += PRCLEN;
 		}
 
 		if (Length >= m_parallelProfile.ParallelMinimumSize())
 		{
 			const size_t PRMLEN = Length - (Length % m_parallelProfile.ParallelMinimumSize());
-
-			Utility::ParallelUtils::ParallelFor(0, m_parallelProfile.ParallelMaxDegree(), [this, &Input, InOffset, PRMLEN](size_t i)
-			{
-				ProcessLeaf(Input, InOffset + (i * BLOCK_SIZE), m_dgtState[i], PRMLEN);
-			});
+			ProcessLeaves(Input, PRMLEN);
 
 			Length -= PRMLEN;
-			InOffset += PRMLEN;
+			Input += PRMLEN;
 		}
-	}
-	else
-	{
-		if (m_msgLength != 0 && (m_msgLength + Length >= BLOCK_SIZE))
-		{
-			size_t rmd = BLOCK_SIZE - m_msgLength;
-			if (rmd != 0)
-				memcpy(&m_msgBuffer[m_msgLength], &Input[InOffset], rmd);
 
-			Compress(m_msgBuffer, 0, m_dgtState[0]);
-			m_msgLength = 0;
-			InOffset += rmd;
-			Length -= rmd;
-		}
-
-		// sequential loop through blocks
-		while (Length > BLOCK_SIZE)
+		// store unaligned bytes
+		if (Length != 0)
 		{
-			Compress(Input, InOffset, m_dgtState[0]);
-			InOffset += BLOCK_SIZE;
-			Length -= BLOCK_SIZE;
+			memcpy(&m_msgBuffer[m_msgLength], Input, Length);
+			m_msgLength += Length;
 		}
 	}
-
-	// store unaligned bytes
-	if (Length != 0)
+	else
 	{
-		memcpy(&m_msgBuffer[m_msgLength], &Input[InOffset], Length);
-		m_msgLength += Length;
+		m_engine.Update(Input, Length);
 	}
 }
 
 //~~~Private Functions~~~//
 
-void SHA256::HashFinal(std::vector<byte> &Input, size_t InOffset, size_t Length, SHA256State &State)
+void SHA256::Release()
 {
-	State.T += Length;
-	ulong bitLen = (State.T << 3);
+	// the vectors have been moved out; a new engine clears the copied message buffer
+	m_engine = Engine(m_engine.DigestSize());
+	m_dgtState.clear();
+	m_msgBuffer.clear();
+	m_msgLength = 0;
+	m_isDestroyed = true;
+}
 
-	if (Length == BLOCK_SIZE)
+void SHA256::ProcessLeaf(const byte* Input, SHA256State &State, ulong Length)
+{
+	// leaf blocks are interleaved with the other leaves, so each is compressed individually
+	do
 	{
-		SHA256Compress::Compress64(Input, InOffset, State);
-		Length = 0;
-	}
+		Engine::Compress(Input, 1, State);
+		Input += m_parallelProfile.ParallelMinimumSize();
+		Length -= m_parallelProfile.ParallelMinimumSize();
+	} 
+	while (Length > 0);
+}
 
-	Input[InOffset + Length] = (byte)128;
-	++Length;
+void SHA256::ProcessLeafLanes(SHA2Dispatch::Compress256LanesFunc Compress, size_t Lanes, const byte* Input, size_t First, ulong Length)
+{
+	CEX_ALIGN_DATA(32) uint state[8 * 8];
+	const byte* blocks[8];
+	const size_t BLKCNT = static_cast<size_t>(Length / m_parallelProfile.ParallelMinimumSize());
 
-	// padding
-	if (Length < BLOCK_SIZE)
-		memset(&Input[InOffset + Length], 0, BLOCK_SIZE - Length);
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		blocks[i] = Input + ((First + i) * BLOCK_SIZE);
+
+		for (size_t j = 0; j < 8; ++j)
+			state[(j * Lanes) + i] = m_dgtState[First + i].H[j];
+	}
 
-	if (Length > 56)
+	for (size_t blk = 0; blk < BLKCNT; ++blk)
 	{
-		SHA256Compress::Compress64(Input, InOffset, State);
-		memset(&Input[InOffset], 0, BLOCK_SIZE);
+		Compress(blocks, 1, state);
+
+		for (size_t i = 0; i < Lanes; ++i)
+			blocks[i] += m_parallelProfile.ParallelMinimumSize();
 	}
 
-	// finalize state with counter and last compression
-	IntUtils::Be32ToBytes((uint)((ulong)bitLen >> 32), Input, InOffset + 56);
-	IntUtils::Be32ToBytes((uint)((ulong)bitLen), Input, InOffset + 60);
-	SHA256Compress::Compress64(Input, InOffset, State);
-}
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		for (size_t j = 0; j < 8; ++j)
+			m_dgtState[First + i].H[j] = state[(j * Lanes) + i];
 
-void SHA256::Compress(const std::vector<byte> &Input, size_t InOffset, SHA256State &State)
-{
-	if (m_parallelProfile.HasSHA2())
-		SHA256Compress::Compress64W(Input, InOffset, State);
-	else
-		SHA256Compress::Compress64(Input, InOffset, State);
+		m_dgtState[First + i].Increase(BLKCNT * BLOCK_SIZE);
+	}
 }
 
-void SHA256::ProcessLeaf(const std::vector<byte> &Input, size_t InOffset, SHA256State &State, ulong Length)
+void SHA256::ProcessLeaves(const byte* Input, ulong Length)
 {
-	do
+	const size_t PRLDGR = m_parallelProfile.ParallelMaxDegree();
+	// each leaf is hashed in links of 16 KB, so a leaf can move to an idle thread between links; the links of a leaf run in order
+	const ulong LNKLEN = static_cast<ulong>(m_parallelProfile.ParallelMinimumSize()) * 256;
+	const size_t LNKCNT = static_cast<size_t>((Length + LNKLEN - 1) / LNKLEN);
+	size_t lanes;
+	SHA2Dispatch::Compress256LanesFunc compress = SHA2Dispatch::CompressLanes256(lanes);
+
+	// the sse4.1 kernel covers a degree that is a multiple of four but not of eight
+	if (lanes == 8 && PRLDGR % 8 != 0 && PRLDGR % 4 == 0)
 	{
-		Compress(Input, InOffset, State);
-		InOffset += m_parallelProfile.ParallelMinimumSize();
-		Length -= m_parallelProfile.ParallelMinimumSize();
-	} 
-	while (Length > 0);
+		compress = &SHA256Compress::Compress64x4;
+		lanes = 4;
+	}
+
+	// with more leaves than cores the threads would share cores anyway, so adjacent leaves are packed into lanes instead;
+	// on sha-ni processors this compresses leaf pairs as two interleaved instruction streams
+	if (compress != nullptr && PRLDGR > m_parallelProfile.ProcessorCount() && PRLDGR % lanes == 0)
+	{
+		ParallelUtils::ParallelChains(PRLDGR / lanes, LNKCNT, [this, compress, lanes, Input, Length, LNKLEN](size_t i, size_t j)
+		{
+			const ulong LNKOFF = j * LNKLEN;
+			ProcessLeafLanes(compress, lanes, Input + LNKOFF, i * lanes, (std::min)(LNKLEN, Length - LNKOFF));
+		});
+	}
+	else
+	{
+		ParallelUtils::ParallelChains(PRLDGR, LNKCNT, [this, Input, Length, LNKLEN](size_t i, size_t j)
+		{
+			const ulong LNKOFF = j * LNKLEN;
+			ProcessLeaf(Input + LNKOFF + (i * BLOCK_SIZE), m_dgtState[i], (std::min)(LNKLEN, Length - LNKOFF));
+		});
+	}
 }
 
 NAMESPACE_DIGESTEND
\ No newline at end of file
@@ -30,8 +30,12 @@
 #ifndef _CEX_SHA256_H
 #define _CEX_SHA256_H
 
+#include "AlignedAllocator.h"
 #include "IDigest.h"
+#include "SHA2Dispatch.h"
+#include "SHA2Engine.h"
 #include "SHA2Params.h"
+#include <array>
 
 NAMESPACE_DIGEST
 
@@ -60,18 +64,24 @@ NAMESPACE_DIGEST
 /// The thread count must be an even number less or equal to the number of processing cores. \n
 /// For best performance in tree hashing mode, the message input block-size (Length parameter of an Update call), should be ParallelBlockSize in length. \n
 /// The ideal parallel block-size is calculated automatically based on the hardware profile and algorithm requirments. \n
-/// The parallel mode uses multi-threaded parallel processing, with each thread maintaining a single unique state. \n
-/// The hash finalizer processes each leaf state as contiguous message input for the root hash; i.e. R = H(S0 || S1 || S2 || ...Sn).</para>
+/// The parallel mode uses multi-threaded parallel processing, with each leaf maintaining a single unique state. \n
+/// Each leaf is compressed in links of 16 KB on the ParallelUtils work-stealing executor; the links of a leaf run in order, but a leaf may move to an idle thread between links. \n
+/// The hash finalizer processes each leaf state as contiguous message input for the root hash; i.e. R = H(S0 || S1 || S2 || ...Sn). \n
+/// Earlier versions wrote each leaf output at a 64 byte block stride while hashing only the output length, so the root omitted the upper half of the leaves;
+/// tree hashes produced by those versions do not match this implementation, sequential mode hashes are unchanged.</para>
 ///
 /// <description>Implementation Notes:</description>
 /// <list type="bullet">
 /// <item><description>State block size is 64 bytes, (512 bits), in parallel mode the ParallelBlockSize() is used to trigger multi-threaded processing.</description></item>
-/// <item><description>Digest output size is 32 bytes, (256 bits).</description></item>
+/// <item><description>Digest output size is 32 bytes, (256 bits); the SHA-224 variant is selected with a SHA2Params OutputSize of 28 bytes.</description></item>
 /// <item><description>The <see cref="Compute(byte[])"/> method wraps the <see cref="Update(byte[], size_t, size_t)"/> and Finalize methods; (suitable for small data).</description>/></item>
 /// <item><description>The <see cref="Update(byte)"/> and <see cref="Update(byte[], size_t, size_t)"/> methods process message input.</description></item>
 /// <item><description>The <see cref="Finalize(byte[], size_t)"/> method returns the hash or MAC code and resets the internal state.</description></item>
 /// <item><description>Setting Parallel to true in the constructor instantiates the multi-threaded variant.</description></item>
 /// <item><description>Multi-threaded and sequential versions produce a different output hash for a message, this is expected.</description></item>
+/// <item><description>The sequential mode, padding and output rules are those of the <see cref="SHA2Engine"/> template, which hot callers can use directly, without virtual calls.</description></item>
+/// <item><description>The compression kernel (SHA-NI, AVX2, AVX, BMI2 or portable) is selected once per process from the cpu features, and can be forced through SHA2Dispatch.</description></item>
+/// <item><description>When the tree has more leaves than the processor has cores, adjacent leaves are compressed together; as leaf pairs by the two stream SHA-NI kernel, otherwise by the multi-buffer (AVX2 or SSE4.1) kernel.</description></item>
 /// </list>
 /// 
 /// <description>Guiding Publications:</description>
@@ -97,34 +107,21 @@ private:
 	// size of reserved state buffer subtracted from parallel size calculations
 	static const size_t STATE_PRECACHED = 2048;
 
-	struct SHA256State
-	{
-		std::vector<uint> H;
-		ulong T;
-
-		SHA256State()
-			:
-			H(8),
-			T(0)
-		{
-		}
-
-		void Reset()
-		{
-			T = 0;
-			H[0] = 0x6a09e667;
-			H[1] = 0xbb67ae85;
-			H[2] = 0x3c6ef372;
-			H[3] = 0xa54ff53a;
-			H[4] = 0x510e527f;
-			H[5] = 0x9b05688c;
-			H[6] = 0x1f83d9ab;
-			H[7] = 0x5be0cd19;
-		}
-	};
+public:
+
+	/// <summary>
+	/// The chaining value and byte counter of a message; a midstate once a block aligned prefix has been compressed
+	/// </summary>
+	typedef SHA256Traits::State SHA256State;
+
+private:
+
+	typedef SHA2Engine<SHA256Traits> Engine;
 
 	SHA2Params m_treeParams;
-	std::vector<SHA256State> m_dgtState;
+	// leaf states start on a cache line, so each fills its own lines
+	std::vector<SHA256State, Utility::AlignedAllocator<SHA256State, 64>> m_dgtState;
+	Engine m_engine;
 	bool m_isDestroyed;
 	std::vector<byte> m_msgBuffer;
 	size_t m_msgLength = 0;
@@ -132,9 +129,15 @@ private:
 
 public:
 
-	SHA256(const SHA256&) = delete;
 	SHA256& operator=(const SHA256&) = delete;
-	SHA256& operator=(SHA256&&) = delete;
+
+	/// <summary>
+	/// Move the state of another instance into this one; the state of this instance is cleared first.
+	/// <para>The source is left empty, and may only be destroyed or assigned to.</para>
+	/// </summary>
+	///
+	/// <param name="Digest">The instance to move from</param>
+	SHA256& operator=(SHA256 &&Digest);
 
 	// *** Properties *** //
 
@@ -146,12 +149,17 @@ public:
 	/// <summary>
 	/// Get: Size of returned digest in bytes
 	/// </summary>
-	virtual size_t DigestSize() { return DIGEST_SIZE; }
+	virtual size_t DigestSize() { return static_cast<size_t>(m_treeParams.OutputSize()); }
 
 	/// <summary>
 	/// Get: The digests type name
 	/// </summary>
-	virtual const Digests Enumeral() { return Digests::SHA256; }
+	virtual const Digests Enumeral() { return (m_treeParams.OutputSize() == 28) ? Digests::SHA224 : Digests::SHA256; }
+
+	/// <summary>
+	/// Get: The instance was reset to a restored midstate; Reset and Finalize return to it instead of the initial value
+	/// </summary>
+	const bool IsMidstate() { return m_engine.IsMidstate(); }
 
 	/// <summary>
 	/// Get: Processor parallelization availability.
@@ -163,7 +171,7 @@ public:
 	/// <summary>
 	/// Get: The digests class name
 	/// </summary>
-	virtual const std::string Name() { return "SHA256"; }
+	virtual const std::string Name() { return (m_treeParams.OutputSize() == 28) ? "SHA224" : "SHA256"; }
 
 	/// <summary>
 	/// Get: Parallel block size; the byte-size of the input data array passed to the Update function that triggers parallel processing.
@@ -198,11 +206,31 @@ public:
 	/// The default thread count is 8, changing this value will produce a different output hash code.</para>
 	/// </summary>
 	/// 
-	/// <param name="Params">The SHA2Params structure, containing the tree configuration settings.</param>
+	/// <param name="Params">The SHA2Params structure, containing the tree configuration settings.
+	/// An OutputSize of 28 selects SHA-224, 32 selects SHA-256.</param>
 	///
-	/// <exception cref="CryptoDigestException">Thrown if the SHA2Params structure contains invalid values</exception>
+	/// <exception cref="CryptoDigestException">Thrown if the SHA2Params structure contains invalid values, or the OutputSize is not 28 or 32 bytes</exception>
 	explicit SHA256(SHA2Params &Params);
 
+	/// <summary>
+	/// Initialize a sequential instance from a midstate; the message continues after the prefix compressed into it.
+	/// <para>The processor is not queried for a parallel profile. Reset and Finalize return the instance to this midstate.</para>
+	/// </summary>
+	/// 
+	/// <param name="Midstate">The state exported by Midstate() after a block aligned prefix</param>
+	/// <param name="OutputSize">The output size of the variant the midstate was taken from; the default is the full digest size</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the midstate byte counter is not a multiple of the block size, or the output size has no variant</exception>
+	explicit SHA256(const SHA256State &Midstate, size_t OutputSize = DIGEST_SIZE);
+
+	/// <summary>
+	/// Move an instance; the leaf states and message buffers are taken over, not copied.
+	/// <para>The source is left empty, and may only be destroyed or assigned to.</para>
+	/// </summary>
+	///
+	/// <param name="Digest">The instance to move from</param>
+	SHA256(SHA256 &&Digest);
+
 	/// <summary>
 	/// Finalize objects
 	/// </summary>
@@ -210,6 +238,15 @@ public:
 
 	//~~~Public Functions~~~//
 
+	/// <summary>
+	/// Create a copy of the digest in its current state; the copy continues the message independently of this instance.
+	/// <para>The chaining values, message buffer and counters are copied, including every leaf state and the leaf buffers in tree hashing mode.
+	/// The processor profile is copied, not queried again; the cost is that of the copies.</para>
+	/// </summary>
+	/// 
+	/// <returns>The copy; the caller owns and deletes it</returns>
+	virtual IDigest* Clone();
+
 	/// <summary>
 	/// Get the hash code for a message input array
 	/// </summary>
@@ -218,6 +255,19 @@ public:
 	/// <param name="Output">The hash output code array</param>
 	virtual void Compute(const std::vector<byte> &Input, std::vector<byte> &Output);
 
+	/// <summary>
+	/// Compute the SHA-256 hashes of many independent messages, written contiguously.
+	/// <para>Messages are fed in arrival order to the SHA256Batch multi-buffer kernels, which refill a lane as soon as its message completes, so mixed lengths do not leave lanes idle.
+	/// A batch large enough to pay for the threads is split into contiguous partitions of equal padded block count, one per processor core.
+	/// No instance is constructed, and there is no reset, padding buffer or allocation per message.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">The message pointers; a pointer may be null if its length is zero</param>
+	/// <param name="Length">The length of each message in bytes</param>
+	/// <param name="Count">The number of messages</param>
+	/// <param name="Output">Receives Count * 32 bytes; the hash of message i is written at offset i * 32</param>
+	static void ComputeMany(const byte* const* Input, const size_t* Length, size_t Count, byte* Output);
+
 	/// <summary>
 	/// Release all resources associated with the object
 	/// </summary>
@@ -235,6 +285,71 @@ public:
 	/// <exception cref="CryptoDigestException">Thrown if the output array is too short</exception>
 	virtual size_t Finalize(std::vector<byte> &Output, const size_t OutOffset);
 
+	/// <summary>
+	/// Finalize processing and write the hash code to caller memory
+	/// </summary>
+	/// 
+	/// <param name="Output">Receives DigestSize() bytes of hash code</param>
+	/// 
+	/// <returns>The byte size of the hash code</returns>
+	virtual size_t Finalize(byte* Output);
+
+	/// <summary>
+	/// Get the SHA-256 hash of a message in one call, on stack state only.
+	/// <para>No instance is constructed; there is no parallel profile, message buffer allocation or reset, and the input is compressed in place.
+	/// The active SHA2Dispatch kernel is used; the processor is queried once per process, on the first SHA-2 call.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the message; may be null if Length is zero</param>
+	/// <param name="Length">The message length in bytes</param>
+	/// <param name="Output">Receives the 32 byte hash</param>
+	static void Hash(const byte* Input, size_t Length, byte(&Output)[32]);
+
+	/// <summary>
+	/// Get the SHA-224 hash of a message in one call, on stack state only.
+	/// <para>No instance is constructed; there is no parallel profile, message buffer allocation or reset, and the input is compressed in place.
+	/// The active SHA2Dispatch kernel is used; the processor is queried once per process, on the first SHA-2 call.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the message; may be null if Length is zero</param>
+	/// <param name="Length">The message length in bytes</param>
+	/// <param name="Output">Receives the 28 byte hash</param>
+	static void Hash(const byte* Input, size_t Length, byte(&Output)[28]);
+
+	/// <summary>
+	/// Export the state after a block aligned prefix, to restore it with the midstate constructor or Reset(const SHA256State &amp;).
+	/// <para>The prefix is compressed once, and every message hashed from the midstate skips those compressions.
+	/// A full block still held in the message buffer is compressed first; the state is otherwise unchanged.</para>
+	/// </summary>
+	/// 
+	/// <returns>The chaining value and byte counter</returns>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the instance is in tree hashing mode, or the input absorbed so far is not a multiple of the block size</exception>
+	SHA256State Midstate();
+
+	/// <summary>
+	/// Get the hash of the message absorbed so far, without finalizing the instance.
+	/// <para>The chaining value and the partial block are finalized on stack copies, in tree hashing mode one leaf at a time; nothing is allocated, 
+	/// and the instance continues the message as if Peek had not been called. The output equals Finalize at this point.</para>
+	/// </summary>
+	/// 
+	/// <param name="Output">Receives DigestSize() bytes of hash code</param>
+	/// 
+	/// <returns>The byte size of the hash code</returns>
+	size_t Peek(byte* Output);
+
+	/// <summary>
+	/// Get the hash of the message absorbed so far, without finalizing the instance
+	/// </summary>
+	/// 
+	/// <param name="Output">The hash output code array</param>
+	/// <param name="OutOffset">The starting offset within the output array</param>
+	/// 
+	/// <returns>The byte size of the hash code</returns>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the output array is too short</exception>
+	size_t Peek(std::vector<byte> &Output, const size_t OutOffset);
+
 	/// <summary>
 	/// Set the number of threads allocated when using multi-threaded tree hashing processing.
 	/// <para>Thread count must be an even number, and not exceed the number of processor cores.
@@ -251,6 +366,16 @@ public:
 	/// </summary>
 	virtual void Reset();
 
+	/// <summary>
+	/// Reset the state to a midstate; subsequent Reset and Finalize calls return to it.
+	/// <para>The output size of the instance is unchanged, so the midstate must come from the same variant.</para>
+	/// </summary>
+	/// 
+	/// <param name="Midstate">The state exported by Midstate() after a block aligned prefix</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the instance is in tree hashing mode, or the midstate byte counter is not a multiple of the block size</exception>
+	void Reset(const SHA256State &Midstate);
+
 	/// <summary>
 	/// Update the hash with a single byte
 	/// </summary>
@@ -267,11 +392,23 @@ public:
 	/// <param name="Length">The number of message bytes to process</param>
 	virtual void Update(const std::vector<byte> &Input, size_t InOffset, size_t Length);
 
+	/// <summary>
+	/// Update the hash with message bytes read in place from caller memory; full blocks are compressed directly from the input
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the message bytes; may be null if Length is zero</param>
+	/// <param name="Length">The number of message bytes to process</param>
+	virtual void Update(const byte* Input, size_t Length);
+
 private:
 
-	void Compress(const std::vector<byte> &Input, size_t InOffset, SHA256State &State);
-	void HashFinal(std::vector<byte> &Input, size_t InOffset, size_t Length, SHA256State &State);
-	void ProcessLeaf(const std::vector<byte> &Input, size_t InOffset, SHA256State &State, ulong Length);
+	// the copy made by Clone
+	SHA256(const SHA256 &Digest);
+
+	void ProcessLeaf(const byte* Input, SHA256State &State, ulong Length);
+	void ProcessLeafLanes(SHA2Dispatch::Compress256LanesFunc Compress, size_t Lanes, const byte* Input, size_t First, ulong Length);
+	void ProcessLeaves(const byte* Input, ulong Length);
+	void Release();
 };
 
 NAMESPACE_DIGESTEND
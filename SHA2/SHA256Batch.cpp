@@ -0,0 +1,230 @@
+#include "SHA256Batch.h"
+#include "IntUtils.h"
+#include "SHA2Constants.h"
+#include "SHA2Dispatch.h"
+#include <algorithm>
+#include <array>
+
+NAMESPACE_DIGEST
+
+using Utility::IntUtils;
+
+// a message in flight; full blocks are read in place, the padded final block(s) from the tail buffer
+struct BatchLane256
+{
+	byte Tail[2 * SHA256Batch::BLOCK_SIZE];
+	const byte* Message;
+	size_t Index;
+	size_t Full;
+	size_t Blocks;
+	size_t Position;
+	bool Active;
+
+	void Load(const byte* Input, size_t Length, size_t Offset)
+	{
+		const size_t BLKRMD = Length % SHA256Batch::BLOCK_SIZE;
+		const size_t TLBLKS = (BLKRMD < SHA256Batch::BLOCK_SIZE - 8) ? 1 : 2;
+
+		Message = Input;
+		Index = Offset;
+		Full = Length / SHA256Batch::BLOCK_SIZE;
+		Blocks = Full + TLBLKS;
+		Position = 0;
+		Active = true;
+
+		std::memset(Tail, 0, sizeof(Tail));
+		if (BLKRMD != 0)
+			std::memcpy(Tail, Input + (Full * SHA256Batch::BLOCK_SIZE), BLKRMD);
+		Tail[BLKRMD] = 0x80;
+		IntUtils::Be64ToBytes(static_cast<ulong>(Length) << 3, Tail + (TLBLKS * SHA256Batch::BLOCK_SIZE) - 8);
+	}
+
+	const byte* Current() const
+	{
+		return (Position < Full) ? Message + (Position * SHA256Batch::BLOCK_SIZE) : Tail + ((Position - Full) * SHA256Batch::BLOCK_SIZE);
+	}
+
+	// the number of blocks that can be read contiguously from the current position
+	size_t Run() const
+	{
+		return (Position < Full) ? Full - Position : Blocks - Position;
+	}
+};
+
+static void StoreDigest(const std::array<uint, 8> &State, byte* Output)
+{
+	for (size_t i = 0; i < 8; ++i)
+		IntUtils::Be32ToBytes(State[i], Output + (i * sizeof(uint)));
+}
+
+static void FinishLane(BatchLane256 &Lane, std::array<uint, 8> &State, byte* Output)
+{
+	SHA2Dispatch::Compress256Func compress = SHA2Dispatch::Compress256();
+
+	while (Lane.Position != Lane.Blocks)
+	{
+		const size_t BLKCNT = Lane.Run();
+		compress(Lane.Current(), BLKCNT, State);
+		Lane.Position += BLKCNT;
+	}
+
+	StoreDigest(State, Output + (Lane.Index * SHA256Batch::DIGEST_SIZE));
+}
+
+template <size_t Lanes>
+static void ComputeLanes(SHA2Dispatch::Compress256LanesFunc Compress, const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	CEX_ALIGN_DATA(32) uint state[8 * Lanes];
+	BatchLane256 lane[Lanes];
+	const byte* blocks[Lanes];
+	std::array<uint, 8> single;
+	size_t active = 0;
+	size_t next = 0;
+
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		lane[i].Active = false;
+
+		if (next < Count)
+		{
+			lane[i].Load(Input[next], Length[next], next);
+			++next;
+			++active;
+		}
+
+		for (size_t j = 0; j < 8; ++j)
+			state[(j * Lanes) + i] = SHA256_IV[j];
+	}
+
+	// below a quarter of the lanes the vector rounds cost more than finishing the stragglers one at a time
+	const size_t MINACT = (Lanes / 4 != 0) ? Lanes / 4 : 1;
+
+	while (active > MINACT || (active != 0 && next < Count))
+	{
+		const byte* spare = nullptr;
+		size_t run = ~static_cast<size_t>(0);
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			if (lane[i].Active)
+			{
+				blocks[i] = lane[i].Current();
+				spare = blocks[i];
+				run = (std::min)(run, lane[i].Run());
+			}
+		}
+
+		// idle lanes recompute an active lane's blocks; their state is discarded when the lane is reloaded
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			if (!lane[i].Active)
+				blocks[i] = spare;
+		}
+
+		Compress(blocks, run, state);
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			if (!lane[i].Active)
+				continue;
+
+			lane[i].Position += run;
+
+			if (lane[i].Position == lane[i].Blocks)
+			{
+				for (size_t j = 0; j < 8; ++j)
+				{
+					single[j] = state[(j * Lanes) + i];
+					state[(j * Lanes) + i] = SHA256_IV[j];
+				}
+
+				StoreDigest(single, Output + (lane[i].Index * SHA256Batch::DIGEST_SIZE));
+
+				if (next < Count)
+				{
+					lane[i].Load(Input[next], Length[next], next);
+					++next;
+				}
+				else
+				{
+					lane[i].Active = false;
+					--active;
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		if (lane[i].Active)
+		{
+			for (size_t j = 0; j < 8; ++j)
+				single[j] = state[(j * Lanes) + i];
+
+			FinishLane(lane[i], single, Output);
+		}
+	}
+}
+
+//~~~Public Functions~~~//
+
+size_t SHA256Batch::Lanes()
+{
+	size_t lanes;
+	SHA2Dispatch::CompressLanes256(lanes);
+
+	return lanes;
+}
+
+void SHA256Batch::Compute(const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	size_t lanes;
+	SHA2Dispatch::Compress256LanesFunc compress = SHA2Dispatch::CompressLanes256(lanes);
+
+	if (lanes == 8)
+	{
+		ComputeLanes<8>(compress, Input, Length, Count, Output);
+	}
+	else if (lanes == 4)
+	{
+		ComputeLanes<4>(compress, Input, Length, Count, Output);
+	}
+	else if (lanes == 2)
+	{
+		ComputeLanes<2>(compress, Input, Length, Count, Output);
+	}
+	else
+	{
+		BatchLane256 lane;
+		std::array<uint, 8> state;
+
+		for (size_t i = 0; i < Count; ++i)
+		{
+			lane.Load(Input[i], Length[i], i);
+			state = SHA256_IV;
+			FinishLane(lane, state, Output);
+		}
+	}
+}
+
+void SHA256Batch::Compute(const std::vector<std::vector<byte>> &Input, std::vector<std::vector<byte>> &Output)
+{
+	std::vector<const byte*> msgPtr(Input.size());
+	std::vector<size_t> msgLen(Input.size());
+	std::vector<byte> hashes(Input.size() * DIGEST_SIZE);
+
+	for (size_t i = 0; i < Input.size(); ++i)
+	{
+		msgPtr[i] = Input[i].size() != 0 ? &Input[i][0] : nullptr;
+		msgLen[i] = Input[i].size();
+	}
+
+	if (Input.size() != 0)
+		Compute(&msgPtr[0], &msgLen[0], Input.size(), &hashes[0]);
+
+	Output.resize(Input.size());
+	for (size_t i = 0; i < Input.size(); ++i)
+		Output[i].assign(hashes.begin() + (i * DIGEST_SIZE), hashes.begin() + ((i + 1) * DIGEST_SIZE));
+}
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,80 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _CEX_SHA256BATCH_H
+#define _CEX_SHA256BATCH_H
+
+#include "CexDomain.h"
+
+NAMESPACE_DIGEST
+
+/// <summary>
+/// Computes the SHA-256 hashes of many independent messages with the multi-buffer kernels
+/// </summary>
+/// 
+/// <example>
+/// <description>Hashing a set of records:</description>
+/// <code>
+/// std::vector&lt;std::vector&lt;byte&gt;&gt; hashes;
+/// SHA256Batch::Compute(records, hashes);
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>Each message occupies one 32 bit lane of an AVX2 (8 lanes) or SSE4.1 (4 lanes) register, and every lane carries its own length and padding.
+/// On processors with the SHA extensions two messages are compressed as interleaved SHA-NI instruction streams instead.
+/// A lane that finishes its message is refilled with the next one, so messages of different lengths keep the lanes busy.
+/// The last few messages of a batch are completed with the single stream kernel once too few lanes remain active to pay for the vector rounds.
+/// When the scalar kernel is forced through SHA2Dispatch, messages are hashed one at a time.</para>
+/// <para>The output is the standard SHA-256 hash of each message, identical to a sequential SHA256 instance.</para>
+/// </remarks>
+class SHA256Batch
+{
+public:
+
+	static const size_t BLOCK_SIZE = 64;
+	static const size_t DIGEST_SIZE = 32;
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Get: The number of messages compressed in parallel on this processor; 1, 2, 4 or 8
+	/// </summary>
+	static size_t Lanes();
+
+	/// <summary>
+	/// Compute the SHA-256 hashes of Count independent messages
+	/// </summary>
+	/// 
+	/// <param name="Input">The message pointers; a pointer may be null if its length is zero</param>
+	/// <param name="Length">The length of each message in bytes</param>
+	/// <param name="Count">The number of messages</param>
+	/// <param name="Output">Receives Count * 32 bytes; the hash of message i is written at offset i * 32</param>
+	static void Compute(const byte* const* Input, const size_t* Length, size_t Count, byte* Output);
+
+	/// <summary>
+	/// Compute the SHA-256 hashes of a set of independent messages
+	/// </summary>
+	/// 
+	/// <param name="Input">The messages</param>
+	/// <param name="Output">Receives one 32 byte hash per message</param>
+	static void Compute(const std::vector<std::vector<byte>> &Input, std::vector<std::vector<byte>> &Output);
+};
+
+NAMESPACE_DIGESTEND
+#endif
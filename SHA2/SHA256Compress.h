@@ -16,9 +16,13 @@
 // You should have received a copy of the GNU General Public License
 // along with this program. If not, see <http://www.gnu.org/licenses/>.
 
+#ifndef _CEX_SHA256COMPRESS_H
+#define _CEX_SHA256COMPRESS_H
+
 #include "CexDomain.h"
-#include "Intrinsics.h"
 #include "IntUtils.h"
+#include "SHA2Constants.h"
+#include <array>
 
 NAMESPACE_DIGEST
 
@@ -32,36 +36,45 @@ class SHA256Compress
 private:
 	static const size_t BLOCK_SIZE = 64;
 
-	static inline uint BigSigma0(uint W)
+	static constexpr uint BigSigma0(uint W)
 	{
 		return ((W >> 2) | (W << 30)) ^ ((W >> 13) | (W << 19)) ^ ((W >> 22) | (W << 10));
 	}
 
-	static inline uint BigSigma1(uint W)
+	static constexpr uint BigSigma1(uint W)
 	{
 		return ((W >> 6) | (W << 26)) ^ ((W >> 11) | (W << 21)) ^ ((W >> 25) | (W << 7));
 	}
 
-	static inline uint Ch(uint B, uint C, uint D)
+	static constexpr uint Ch(uint B, uint C, uint D)
 	{
 		return (B & C) ^ (~B & D);
 	}
 
-	static inline uint Maj(uint B, uint C, uint D)
+	static constexpr uint Maj(uint B, uint C, uint D)
 	{
 		return (B & C) ^ (B & D) ^ (C & D);
 	}
 
-	static inline uint Sigma0(uint W)
+	static constexpr uint Sigma0(uint W)
 	{
 		return ((W >> 7) | (W << 25)) ^ ((W >> 18) | (W << 14)) ^ (W >> 3);
 	}
 
-	static inline uint Sigma1(uint W)
+	static constexpr uint Sigma1(uint W)
 	{
 		return ((W >> 17) | (W << 15)) ^ ((W >> 19) | (W << 13)) ^ (W >> 10);
 	}
 
+	// the schedule word of round R; from round 16 the word is expanded in place of the one it replaces
+	static CEX_CONSTEXPR14 uint ScheduleConstexpr(uint* W, size_t R)
+	{
+		if (R >= 16)
+			W[R & 15] += Sigma1(W[(R - 2) & 15]) + W[(R - 7) & 15] + Sigma0(W[(R - 15) & 15]);
+
+		return W[R & 15];
+	}
+
 	#define SHA256ROUND(A, B, C, D, E, F, G, H, M, P)			\
 	do {														\
 		uint R0(H + BigSigma1(E) + Ch(E, F, G) + P + M);		\
@@ -73,351 +86,383 @@ private:
 
 public:
 
-	template <typename T>
-	static inline void Compress64W(const std::vector<byte> &Input, size_t InOffset, T &Output)
+	/// <summary>
+	/// Compress a contiguous run of 64 byte blocks with BMI2 rounds.
+	/// <para>Rotations compile to rorx and the choose function to andn; the message schedule is the portable one.
+	/// The caller must check that the processor supports BMI2.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static void Compress64BMI2(const byte* Input, size_t BlockCount, std::array<uint, 8> &State);
+
+	/// <summary>
+	/// Compress a contiguous run of 64 byte blocks with a vectorized message schedule and BMI2 rounds.
+	/// <para>The message words are byte-swapped, expanded and added to the round constants four at a time in 128 bit registers.
+	/// The caller must check that the processor supports AVX and BMI2.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static void Compress64AVX(const byte* Input, size_t BlockCount, std::array<uint, 8> &State);
+
+	/// <summary>
+	/// Compress a contiguous run of 64 byte blocks with a two block vectorized message schedule and BMI2 rounds.
+	/// <para>Each 256 bit register holds four schedule words of two consecutive blocks, one block per 128 bit half,
+	/// so one expansion serves two blocks of rounds. The caller must check that the processor supports AVX2 and BMI2.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static void Compress64AVX2(const byte* Input, size_t BlockCount, std::array<uint, 8> &State);
+
+	/// <summary>
+	/// Compress a contiguous run of 64 byte blocks using the SHA-NI instructions.
+	/// <para>The chaining value is shuffled into the ABEF/CDGH register layout once, and kept in registers for the whole run.
+	/// The caller must check that the processor supports the SHA extensions and SSE4.1.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static void Compress64SHANI(const byte* Input, size_t BlockCount, std::array<uint, 8> &State);
+
+	/// <summary>
+	/// Compress a run of blocks from two independent messages with interleaved SHA-NI instruction streams.
+	/// <para>The chaining values are interleaved by word; State[(Word * 2) + Lane].
+	/// The caller must check that the processor supports the SHA extensions and SSE4.1.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Two pointers, each to the first block of a lane message</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress in every lane</param>
+	/// <param name="State">The 16 word interleaved chaining values</param>
+	static void Compress64x2SHANI(const byte* const* Input, size_t BlockCount, uint* State);
+
+	/// <summary>
+	/// Compress a run of blocks from four independent messages in the 32 bit lanes of SSE registers.
+	/// <para>The chaining values are interleaved by word; State[(Word * 4) + Lane].
+	/// The caller must check that the processor supports SSE4.1.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Four pointers, each to the first block of a lane message</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress in every lane</param>
+	/// <param name="State">The 32 word interleaved chaining values</param>
+	static void Compress64x4(const byte* const* Input, size_t BlockCount, uint* State);
+
+	/// <summary>
+	/// Compress a run of blocks from eight independent messages in the 32 bit lanes of AVX2 registers.
+	/// <para>The chaining values are interleaved by word; State[(Word * 8) + Lane].
+	/// The caller must check that the processor supports AVX2.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Eight pointers, each to the first block of a lane message</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress in every lane</param>
+	/// <param name="State">The 64 word interleaved chaining values</param>
+	static void Compress64x8(const byte* const* Input, size_t BlockCount, uint* State);
+
+	/// <summary>
+	/// The portable form of the multi-buffer kernels; compresses each lane in turn with Compress64
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointers to the first block of each lane message</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress in every lane</param>
+	/// <param name="State">The interleaved chaining values; State[(Word * Lanes) + Lane]</param>
+	template <size_t Lanes>
+	static inline void Compress64xN(const byte* const* Input, size_t BlockCount, uint* State)
 	{
-#if defined(__AVX__)
-		__m128i S0, S1, T0, T1;
-		__m128i MSG, TMP, MASK;
-		__m128i M0, M1, M2, M3;
-
-		// Load initial values
-		TMP = _mm_loadu_si128(reinterpret_cast<__m128i*>(&Output.H));
-		S1 = _mm_loadu_si128(reinterpret_cast<__m128i*>(&Output.H[4]));
-		MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
-		TMP = _mm_shuffle_epi32(TMP, 0xB1);  // CDAB
-		S1 = _mm_shuffle_epi32(S1, 0x1B);    // EFGH
-		S0 = _mm_alignr_epi8(TMP, S1, 8);    // ABEF
-		S1 = _mm_blend_epi16(S1, TMP, 0xF0); // CDGH
-
-		// Save current state
-		T0 = S0;
-		T1 = S1;
-
-		// Rounds 0-3
-		MSG = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Input[InOffset]));
-		M0 = _mm_shuffle_epi8(MSG, MASK);
-		MSG = _mm_add_epi32(M0, _mm_set_epi64x(0xE9B5DBA5B5C0FBCFULL, 0x71374491428A2F98ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-
-		// Rounds 4-7
-		M1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Input[InOffset + 16]));
-		M1 = _mm_shuffle_epi8(M1, MASK);
-		MSG = _mm_add_epi32(M1, _mm_set_epi64x(0xAB1C5ED5923F82A4ULL, 0x59F111F13956C25BULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M0 = _mm_sha256msg1_epu32(M0, M1);
-
-		// Rounds 8-11
-		M2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Input[InOffset + 32]));
-		M2 = _mm_shuffle_epi8(M2, MASK);
-		MSG = _mm_add_epi32(M2, _mm_set_epi64x(0x550C7DC3243185BEULL, 0x12835B01D807AA98ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M1 = _mm_sha256msg1_epu32(M1, M2);
-
-		// Rounds 12-15
-		M3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&Input[InOffset + 48]));
-		M3 = _mm_shuffle_epi8(M3, MASK);
-		MSG = _mm_add_epi32(M3, _mm_set_epi64x(0xC19BF1749BDC06A7ULL, 0x80DEB1FE72BE5D74ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M3, M2, 4);
-		M0 = _mm_add_epi32(M0, TMP);
-		M0 = _mm_sha256msg2_epu32(M0, M3);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M2 = _mm_sha256msg1_epu32(M2, M3);
-
-		// Rounds 16-19
-		MSG = _mm_add_epi32(M0, _mm_set_epi64x(0x240CA1CC0FC19DC6ULL, 0xEFBE4786E49B69C1ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M0, M3, 4);
-		M1 = _mm_add_epi32(M1, TMP);
-		M1 = _mm_sha256msg2_epu32(M1, M0);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M3 = _mm_sha256msg1_epu32(M3, M0);
-
-		// Rounds 20-23
-		MSG = _mm_add_epi32(M1, _mm_set_epi64x(0x76F988DA5CB0A9DCULL, 0x4A7484AA2DE92C6FULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M1, M0, 4);
-		M2 = _mm_add_epi32(M2, TMP);
-		M2 = _mm_sha256msg2_epu32(M2, M1);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M0 = _mm_sha256msg1_epu32(M0, M1);
-
-		// Rounds 24-27
-		MSG = _mm_add_epi32(M2, _mm_set_epi64x(0xBF597FC7B00327C8ULL, 0xA831C66D983E5152ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M2, M1, 4);
-		M3 = _mm_add_epi32(M3, TMP);
-		M3 = _mm_sha256msg2_epu32(M3, M2);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M1 = _mm_sha256msg1_epu32(M1, M2);
-
-		// Rounds 28-31
-		MSG = _mm_add_epi32(M3, _mm_set_epi64x(0x1429296706CA6351ULL, 0xD5A79147C6E00BF3ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M3, M2, 4);
-		M0 = _mm_add_epi32(M0, TMP);
-		M0 = _mm_sha256msg2_epu32(M0, M3);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M2 = _mm_sha256msg1_epu32(M2, M3);
-
-		// Rounds 32-35
-		MSG = _mm_add_epi32(M0, _mm_set_epi64x(0x53380D134D2C6DFCULL, 0x2E1B213827B70A85ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M0, M3, 4);
-		M1 = _mm_add_epi32(M1, TMP);
-		M1 = _mm_sha256msg2_epu32(M1, M0);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M3 = _mm_sha256msg1_epu32(M3, M0);
-
-		// Rounds 36-39
-		MSG = _mm_add_epi32(M1, _mm_set_epi64x(0x92722C8581C2C92EULL, 0x766A0ABB650A7354ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M1, M0, 4);
-		M2 = _mm_add_epi32(M2, TMP);
-		M2 = _mm_sha256msg2_epu32(M2, M1);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M0 = _mm_sha256msg1_epu32(M0, M1);
-
-		// Rounds 40-43
-		MSG = _mm_add_epi32(M2, _mm_set_epi64x(0xC76C51A3C24B8B70ULL, 0xA81A664BA2BFE8A1ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M2, M1, 4);
-		M3 = _mm_add_epi32(M3, TMP);
-		M3 = _mm_sha256msg2_epu32(M3, M2);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M1 = _mm_sha256msg1_epu32(M1, M2);
-
-		// Rounds 44-47
-		MSG = _mm_add_epi32(M3, _mm_set_epi64x(0x106AA070F40E3585ULL, 0xD6990624D192E819ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M3, M2, 4);
-		M0 = _mm_add_epi32(M0, TMP);
-		M0 = _mm_sha256msg2_epu32(M0, M3);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M2 = _mm_sha256msg1_epu32(M2, M3);
-
-		// Rounds 48-51
-		MSG = _mm_add_epi32(M0, _mm_set_epi64x(0x34B0BCB52748774CULL, 0x1E376C0819A4C116ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M0, M3, 4);
-		M1 = _mm_add_epi32(M1, TMP);
-		M1 = _mm_sha256msg2_epu32(M1, M0);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-		M3 = _mm_sha256msg1_epu32(M3, M0);
-
-		// Rounds 52-55
-		MSG = _mm_add_epi32(M1, _mm_set_epi64x(0x682E6FF35B9CCA4FULL, 0x4ED8AA4A391C0CB3ULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M1, M0, 4);
-		M2 = _mm_add_epi32(M2, TMP);
-		M2 = _mm_sha256msg2_epu32(M2, M1);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-
-		// Rounds 56-59
-		MSG = _mm_add_epi32(M2, _mm_set_epi64x(0x8CC7020884C87814ULL, 0x78A5636F748F82EEULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		TMP = _mm_alignr_epi8(M2, M1, 4);
-		M3 = _mm_add_epi32(M3, TMP);
-		M3 = _mm_sha256msg2_epu32(M3, M2);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-
-		// Rounds 60-63
-		MSG = _mm_add_epi32(M3, _mm_set_epi64x(0xC67178F2BEF9A3F7ULL, 0xA4506CEB90BEFFFAULL));
-		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
-		MSG = _mm_shuffle_epi32(MSG, 0x0E);
-		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
-
-		// Combine state 
-		S0 = _mm_add_epi32(S0, T0);
-		S1 = _mm_add_epi32(S1, T1);
-		TMP = _mm_shuffle_epi32(S0, 0x1B);   // FEBA
-		S1 = _mm_shuffle_epi32(S1, 0xB1);    // DCHG
-		S0 = _mm_blend_epi16(TMP, S1, 0xF0); // DCBA
-		S1 = _mm_alignr_epi8(S1, TMP, 8);    // ABEF
-
-		// Save state
-		_mm_storeu_si128(reinterpret_cast<__m128i*>(&Output.H[0]), S0);
-		_mm_storeu_si128(reinterpret_cast<__m128i*>(&Output.H[4]), S1);
-#else
-		Compress64(Input, InOffset, Output);
-#endif
+		std::array<uint, 8> lane;
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			for (size_t j = 0; j < 8; ++j)
+				lane[j] = State[(j * Lanes) + i];
+
+			Compress64(Input[i], BlockCount, lane);
+
+			for (size_t j = 0; j < 8; ++j)
+				State[(j * Lanes) + i] = lane[j];
+		}
+	}
+
+	/// <summary>
+	/// Compress a contiguous run of 64 byte blocks using the portable implementation.
+	/// <para>The chaining value is held in locals for the whole run, and message words are loaded with a byte-swap.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 64 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static inline void Compress64(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+	{
+		uint S0 = State[0];
+		uint S1 = State[1];
+		uint S2 = State[2];
+		uint S3 = State[3];
+		uint S4 = State[4];
+		uint S5 = State[5];
+		uint S6 = State[6];
+		uint S7 = State[7];
+
+		while (BlockCount != 0)
+		{
+			uint A = S0;
+			uint B = S1;
+			uint C = S2;
+			uint D = S3;
+			uint E = S4;
+			uint F = S5;
+			uint G = S6;
+			uint H = S7;
+			uint W0, W1, W2, W3, W4, W5, W6, W7, W8, W9, W10, W11, W12, W13, W14, W15;
+
+			W0 = IntUtils::BytesToBe32(Input);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0x428a2f98);
+			W1 = IntUtils::BytesToBe32(Input + 4);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0x71374491);
+			W2 = IntUtils::BytesToBe32(Input + 8);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0xb5c0fbcf);
+			W3 = IntUtils::BytesToBe32(Input + 12);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0xe9b5dba5);
+			W4 = IntUtils::BytesToBe32(Input + 16);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x3956c25b);
+			W5 = IntUtils::BytesToBe32(Input + 20);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x59f111f1);
+			W6 = IntUtils::BytesToBe32(Input + 24);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x923f82a4);
+			W7 = IntUtils::BytesToBe32(Input + 28);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0xab1c5ed5);
+			W8 = IntUtils::BytesToBe32(Input + 32);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0xd807aa98);
+			W9 = IntUtils::BytesToBe32(Input + 36);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0x12835b01);
+			W10 = IntUtils::BytesToBe32(Input + 40);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0x243185be);
+			W11 = IntUtils::BytesToBe32(Input + 44);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0x550c7dc3);
+			W12 = IntUtils::BytesToBe32(Input + 48);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0x72be5d74);
+			W13 = IntUtils::BytesToBe32(Input + 52);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0x80deb1fe);
+			W14 = IntUtils::BytesToBe32(Input + 56);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0x9bdc06a7);
+			W15 = IntUtils::BytesToBe32(Input + 60);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0xc19bf174);
+
+			W0 += Sigma1(W14) + W9 + Sigma0(W1);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0xe49b69c1);
+			W1 += Sigma1(W15) + W10 + Sigma0(W2);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0xefbe4786);
+			W2 += Sigma1(W0) + W11 + Sigma0(W3);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0x0fc19dc6);
+			W3 += Sigma1(W1) + W12 + Sigma0(W4);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0x240ca1cc);
+			W4 += Sigma1(W2) + W13 + Sigma0(W5);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x2de92c6f);
+			W5 += Sigma1(W3) + W14 + Sigma0(W6);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x4a7484aa);
+			W6 += Sigma1(W4) + W15 + Sigma0(W7);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x5cb0a9dc);
+			W7 += Sigma1(W5) + W0 + Sigma0(W8);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0x76f988da);
+			W8 += Sigma1(W6) + W1 + Sigma0(W9);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0x983e5152);
+			W9 += Sigma1(W7) + W2 + Sigma0(W10);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0xa831c66d);
+			W10 += Sigma1(W8) + W3 + Sigma0(W11);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0xb00327c8);
+			W11 += Sigma1(W9) + W4 + Sigma0(W12);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0xbf597fc7);
+			W12 += Sigma1(W10) + W5 + Sigma0(W13);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0xc6e00bf3);
+			W13 += Sigma1(W11) + W6 + Sigma0(W14);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0xd5a79147);
+			W14 += Sigma1(W12) + W7 + Sigma0(W15);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0x06ca6351);
+			W15 += Sigma1(W13) + W8 + Sigma0(W0);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0x14292967);
+
+			W0 += Sigma1(W14) + W9 + Sigma0(W1);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0x27b70a85);
+			W1 += Sigma1(W15) + W10 + Sigma0(W2);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0x2e1b2138);
+			W2 += Sigma1(W0) + W11 + Sigma0(W3);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0x4d2c6dfc);
+			W3 += Sigma1(W1) + W12 + Sigma0(W4);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0x53380d13);
+			W4 += Sigma1(W2) + W13 + Sigma0(W5);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x650a7354);
+			W5 += Sigma1(W3) + W14 + Sigma0(W6);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x766a0abb);
+			W6 += Sigma1(W4) + W15 + Sigma0(W7);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x81c2c92e);
+			W7 += Sigma1(W5) + W0 + Sigma0(W8);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0x92722c85);
+			W8 += Sigma1(W6) + W1 + Sigma0(W9);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0xa2bfe8a1);
+			W9 += Sigma1(W7) + W2 + Sigma0(W10);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0xa81a664b);
+			W10 += Sigma1(W8) + W3 + Sigma0(W11);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0xc24b8b70);
+			W11 += Sigma1(W9) + W4 + Sigma0(W12);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0xc76c51a3);
+			W12 += Sigma1(W10) + W5 + Sigma0(W13);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0xd192e819);
+			W13 += Sigma1(W11) + W6 + Sigma0(W14);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0xd6990624);
+			W14 += Sigma1(W12) + W7 + Sigma0(W15);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0xf40e3585);
+			W15 += Sigma1(W13) + W8 + Sigma0(W0);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0x106aa070);
+
+			W0 += Sigma1(W14) + W9 + Sigma0(W1);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0x19a4c116);
+			W1 += Sigma1(W15) + W10 + Sigma0(W2);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0x1e376c08);
+			W2 += Sigma1(W0) + W11 + Sigma0(W3);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0x2748774c);
+			W3 += Sigma1(W1) + W12 + Sigma0(W4);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0x34b0bcb5);
+			W4 += Sigma1(W2) + W13 + Sigma0(W5);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x391c0cb3);
+			W5 += Sigma1(W3) + W14 + Sigma0(W6);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x4ed8aa4a);
+			W6 += Sigma1(W4) + W15 + Sigma0(W7);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x5b9cca4f);
+			W7 += Sigma1(W5) + W0 + Sigma0(W8);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0x682e6ff3);
+			W8 += Sigma1(W6) + W1 + Sigma0(W9);
+			SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0x748f82ee);
+			W9 += Sigma1(W7) + W2 + Sigma0(W10);
+			SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0x78a5636f);
+			W10 += Sigma1(W8) + W3 + Sigma0(W11);
+			SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0x84c87814);
+			W11 += Sigma1(W9) + W4 + Sigma0(W12);
+			SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0x8cc70208);
+			W12 += Sigma1(W10) + W5 + Sigma0(W13);
+			SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0x90befffa);
+			W13 += Sigma1(W11) + W6 + Sigma0(W14);
+			SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0xa4506ceb);
+			W14 += Sigma1(W12) + W7 + Sigma0(W15);
+			SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0xbef9a3f7);
+			W15 += Sigma1(W13) + W8 + Sigma0(W0);
+			SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0xc67178f2);
+
+			S0 += A;
+			S1 += B;
+			S2 += C;
+			S3 += D;
+			S4 += E;
+			S5 += F;
+			S6 += G;
+			S7 += H;
+
+			Input += BLOCK_SIZE;
+			--BlockCount;
+		}
+
+		State[0] = S0;
+		State[1] = S1;
+		State[2] = S2;
+		State[3] = S3;
+		State[4] = S4;
+		State[5] = S5;
+		State[6] = S6;
+		State[7] = S7;
 	}
 
-	template <typename T>
-	static inline void Compress64(const std::vector<byte> &Input, size_t InOffset, T &Output)
+	/// <summary>
+	/// Compress one 64 byte block in a constant expression.
+	/// <para>The reference rounds on a 16 word rolling schedule, using the shared round constant table; the SHA2Constexpr digests are built on it.
+	/// It is evaluated at compile time if the compiler supports relaxed constexpr functions (CEX_HAS_CONSTEXPR14), otherwise it is an ordinary inline function.</para>
+	/// </summary>
+	/// 
+	/// <param name="Block">The 64 byte message block</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static CEX_CONSTEXPR14 void CompressConstexpr(const byte* Block, uint* State)
 	{
-		uint A = Output.H[0];
-		uint B = Output.H[1];
-		uint C = Output.H[2];
-		uint D = Output.H[3];
-		uint E = Output.H[4];
-		uint F = Output.H[5];
-		uint G = Output.H[6];
-		uint H = Output.H[7];
-		uint W0, W1, W2, W3, W4, W5, W6, W7, W8, W9, W10, W11, W12, W13, W14, W15;
-
-		W0 = IntUtils::BytesToBe32(Input, InOffset);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0x428a2f98);
-		W1 = IntUtils::BytesToBe32(Input, InOffset + 4);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0x71374491);
-		W2 = IntUtils::BytesToBe32(Input, InOffset + 8);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0xb5c0fbcf);
-		W3 = IntUtils::BytesToBe32(Input, InOffset + 12);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0xe9b5dba5);
-		W4 = IntUtils::BytesToBe32(Input, InOffset + 16);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x3956c25b);
-		W5 = IntUtils::BytesToBe32(Input, InOffset + 20);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x59f111f1);
-		W6 = IntUtils::BytesToBe32(Input, InOffset + 24);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x923f82a4);
-		W7 = IntUtils::BytesToBe32(Input, InOffset + 28);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0xab1c5ed5);
-		W8 = IntUtils::BytesToBe32(Input, InOffset + 32);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0xd807aa98);
-		W9 = IntUtils::BytesToBe32(Input, InOffset + 36);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0x12835b01);
-		W10 = IntUtils::BytesToBe32(Input, InOffset + 40);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0x243185be);
-		W11 = IntUtils::BytesToBe32(Input, InOffset + 44);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0x550c7dc3);
-		W12 = IntUtils::BytesToBe32(Input, InOffset + 48);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0x72be5d74);
-		W13 = IntUtils::BytesToBe32(Input, InOffset + 52);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0x80deb1fe);
-		W14 = IntUtils::BytesToBe32(Input, InOffset + 56);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0x9bdc06a7);
-		W15 = IntUtils::BytesToBe32(Input, InOffset + 60);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0xc19bf174);
-
-		W0 += Sigma1(W14) + W9 + Sigma0(W1);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0xe49b69c1);
-		W1 += Sigma1(W15) + W10 + Sigma0(W2);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0xefbe4786);
-		W2 += Sigma1(W0) + W11 + Sigma0(W3);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0x0fc19dc6);
-		W3 += Sigma1(W1) + W12 + Sigma0(W4);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0x240ca1cc);
-		W4 += Sigma1(W2) + W13 + Sigma0(W5);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x2de92c6f);
-		W5 += Sigma1(W3) + W14 + Sigma0(W6);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x4a7484aa);
-		W6 += Sigma1(W4) + W15 + Sigma0(W7);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x5cb0a9dc);
-		W7 += Sigma1(W5) + W0 + Sigma0(W8);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0x76f988da);
-		W8 += Sigma1(W6) + W1 + Sigma0(W9);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0x983e5152);
-		W9 += Sigma1(W7) + W2 + Sigma0(W10);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0xa831c66d);
-		W10 += Sigma1(W8) + W3 + Sigma0(W11);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0xb00327c8);
-		W11 += Sigma1(W9) + W4 + Sigma0(W12);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0xbf597fc7);
-		W12 += Sigma1(W10) + W5 + Sigma0(W13);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0xc6e00bf3);
-		W13 += Sigma1(W11) + W6 + Sigma0(W14);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0xd5a79147);
-		W14 += Sigma1(W12) + W7 + Sigma0(W15);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0x06ca6351);
-		W15 += Sigma1(W13) + W8 + Sigma0(W0);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0x14292967);
-
-		W0 += Sigma1(W14) + W9 + Sigma0(W1);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0x27b70a85);
-		W1 += Sigma1(W15) + W10 + Sigma0(W2);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0x2e1b2138);
-		W2 += Sigma1(W0) + W11 + Sigma0(W3);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0x4d2c6dfc);
-		W3 += Sigma1(W1) + W12 + Sigma0(W4);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0x53380d13);
-		W4 += Sigma1(W2) + W13 + Sigma0(W5);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x650a7354);
-		W5 += Sigma1(W3) + W14 + Sigma0(W6);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x766a0abb);
-		W6 += Sigma1(W4) + W15 + Sigma0(W7);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x81c2c92e);
-		W7 += Sigma1(W5) + W0 + Sigma0(W8);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0x92722c85);
-		W8 += Sigma1(W6) + W1 + Sigma0(W9);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0xa2bfe8a1);
-		W9 += Sigma1(W7) + W2 + Sigma0(W10);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0xa81a664b);
-		W10 += Sigma1(W8) + W3 + Sigma0(W11);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0xc24b8b70);
-		W11 += Sigma1(W9) + W4 + Sigma0(W12);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0xc76c51a3);
-		W12 += Sigma1(W10) + W5 + Sigma0(W13);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0xd192e819);
-		W13 += Sigma1(W11) + W6 + Sigma0(W14);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0xd6990624);
-		W14 += Sigma1(W12) + W7 + Sigma0(W15);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0xf40e3585);
-		W15 += Sigma1(W13) + W8 + Sigma0(W0);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0x106aa070);
-
-		W0 += Sigma1(W14) + W9 + Sigma0(W1);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W0, 0x19a4c116);
-		W1 += Sigma1(W15) + W10 + Sigma0(W2);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W1, 0x1e376c08);
-		W2 += Sigma1(W0) + W11 + Sigma0(W3);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W2, 0x2748774c);
-		W3 += Sigma1(W1) + W12 + Sigma0(W4);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W3, 0x34b0bcb5);
-		W4 += Sigma1(W2) + W13 + Sigma0(W5);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W4, 0x391c0cb3);
-		W5 += Sigma1(W3) + W14 + Sigma0(W6);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W5, 0x4ed8aa4a);
-		W6 += Sigma1(W4) + W15 + Sigma0(W7);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W6, 0x5b9cca4f);
-		W7 += Sigma1(W5) + W0 + Sigma0(W8);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W7, 0x682e6ff3);
-		W8 += Sigma1(W6) + W1 + Sigma0(W9);
-		SHA256ROUND(A, B, C, D, E, F, G, H, W8, 0x748f82ee);
-		W9 += Sigma1(W7) + W2 + Sigma0(W10);
-		SHA256ROUND(H, A, B, C, D, E, F, G, W9, 0x78a5636f);
-		W10 += Sigma1(W8) + W3 + Sigma0(W11);
-		SHA256ROUND(G, H, A, B, C, D, E, F, W10, 0x84c87814);
-		W11 += Sigma1(W9) + W4 + Sigma0(W12);
-		SHA256ROUND(F, G, H, A, B, C, D, E, W11, 0x8cc70208);
-		W12 += Sigma1(W10) + W5 + Sigma0(W13);
-		SHA256ROUND(E, F, G, H, A, B, C, D, W12, 0x90befffa);
-		W13 += Sigma1(W11) + W6 + Sigma0(W14);
-		SHA256ROUND(D, E, F, G, H, A, B, C, W13, 0xa4506ceb);
-		W14 += Sigma1(W12) + W7 + Sigma0(W15);
-		SHA256ROUND(C, D, E, F, G, H, A, B, W14, 0xbef9a3f7);
-		W15 += Sigma1(W13) + W8 + Sigma0(W0);
-		SHA256ROUND(B, C, D, E, F, G, H, A, W15, 0xc67178f2);
-
-		Output.H[0] += A;
-		Output.H[1] += B;
-		Output.H[2] += C;
-		Output.H[3] += D;
-		Output.H[4] += E;
-		Output.H[5] += F;
-		Output.H[6] += G;
-		Output.H[7] += H;
-
-		Output.T += BLOCK_SIZE;
+		uint W[16] = {};
+		uint A = State[0];
+		uint B = State[1];
+		uint C = State[2];
+		uint D = State[3];
+		uint E = State[4];
+		uint F = State[5];
+		uint G = State[6];
+		uint H = State[7];
+
+		for (size_t i = 0; i < 16; ++i)
+		{
+			W[i] = (static_cast<uint>(Block[i * 4]) << 24) |
+				(static_cast<uint>(Block[(i * 4) + 1]) << 16) |
+				(static_cast<uint>(Block[(i * 4) + 2]) << 8) |
+				static_cast<uint>(Block[(i * 4) + 3]);
+		}
+
+		for (size_t i = 0; i < 64; i += 8)
+		{
+			SHA256ROUND(A, B, C, D, E, F, G, H, ScheduleConstexpr(W, i), SHA256_K[i]);
+			SHA256ROUND(H, A, B, C, D, E, F, G, ScheduleConstexpr(W, i + 1), SHA256_K[i + 1]);
+			SHA256ROUND(G, H, A, B, C, D, E, F, ScheduleConstexpr(W, i + 2), SHA256_K[i + 2]);
+			SHA256ROUND(F, G, H, A, B, C, D, E, ScheduleConstexpr(W, i + 3), SHA256_K[i + 3]);
+			SHA256ROUND(E, F, G, H, A, B, C, D, ScheduleConstexpr(W, i + 4), SHA256_K[i + 4]);
+			SHA256ROUND(D, E, F, G, H, A, B, C, ScheduleConstexpr(W, i + 5), SHA256_K[i + 5]);
+			SHA256ROUND(C, D, E, F, G, H, A, B, ScheduleConstexpr(W, i + 6), SHA256_K[i + 6]);
+			SHA256ROUND(B, C, D, E, F, G, H, A, ScheduleConstexpr(W, i + 7), SHA256_K[i + 7]);
+		}
+
+		State[0] += A;
+		State[1] += B;
+		State[2] += C;
+		State[3] += D;
+		State[4] += E;
+		State[5] += F;
+		State[6] += G;
+		State[7] += H;
+	}
+
+	/// <summary>
+	/// Compress one block whose message schedule was expanded in advance.
+	/// <para>Used for blocks with a constant schedule, such as the padding block of a fixed length message; only the 64 rounds are run.</para>
+	/// </summary>
+	/// 
+	/// <param name="Schedule">The 64 schedule words of the block, with the round constants already added</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static inline void Rounds64(const uint* Schedule, std::array<uint, 8> &State)
+	{
+		uint A = State[0];
+		uint B = State[1];
+		uint C = State[2];
+		uint D = State[3];
+		uint E = State[4];
+		uint F = State[5];
+		uint G = State[6];
+		uint H = State[7];
+
+		for (size_t i = 0; i < 64; i += 8)
+		{
+			SHA256ROUND(A, B, C, D, E, F, G, H, Schedule[i], 0);
+			SHA256ROUND(H, A, B, C, D, E, F, G, Schedule[i + 1], 0);
+			SHA256ROUND(G, H, A, B, C, D, E, F, Schedule[i + 2], 0);
+			SHA256ROUND(F, G, H, A, B, C, D, E, Schedule[i + 3], 0);
+			SHA256ROUND(E, F, G, H, A, B, C, D, Schedule[i + 4], 0);
+			SHA256ROUND(D, E, F, G, H, A, B, C, Schedule[i + 5], 0);
+			SHA256ROUND(C, D, E, F, G, H, A, B, Schedule[i + 6], 0);
+			SHA256ROUND(B, C, D, E, F, G, H, A, Schedule[i + 7], 0);
+		}
+
+		State[0] += A;
+		State[1] += B;
+		State[2] += C;
+		State[3] += D;
+		State[4] += E;
+		State[5] += F;
+		State[6] += G;
+		State[7] += H;
 	}
 };
 
-NAMESPACE_DIGESTEND
\ No newline at end of file
+NAMESPACE_DIGESTEND
+#endif
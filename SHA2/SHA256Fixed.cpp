@@ -0,0 +1,184 @@
+#include "SHA256Fixed.h"
+#include "IntUtils.h"
+#include "SHA256Compress.h"
+#include "SHA2Dispatch.h"
+#include <array>
+
+NAMESPACE_DIGEST
+
+using Utility::IntUtils;
+
+// the second half of the block of a 32 byte message; the 0x80 terminator, zeros, and the 256 bit length
+static const byte PAD32[32] =
+{
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00
+};
+
+// the padding block of a 64 byte message; the 0x80 terminator, zeros, and the 512 bit length
+CEX_ALIGN_DATA(16) static const byte PAD64[64] =
+{
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00
+};
+
+// the expanded schedule of PAD64 with the round constants added
+static const uint PAD64_SCHEDULE[64] =
+{
+	0xc28a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf374,
+	0x649b69c1, 0xf0fe4786, 0x0fe1edc6, 0x240cf254, 0x4fe9346f, 0x6cc984be, 0x61b9411e, 0x16f988fa,
+	0xf2c65152, 0xa88e5a6d, 0xb019fc65, 0xb9d99ec7, 0x9a1231c3, 0xe70eeaa0, 0xfdb1232b, 0xc7353eb0,
+	0x3069bad5, 0xcb976d5f, 0x5a0f118f, 0xdc1eeefd, 0x0a35b689, 0xde0b7a04, 0x58f4ca9d, 0xe15d5b16,
+	0x007f3e86, 0x37088980, 0xa507ea32, 0x6fab9537, 0x17406110, 0x0d8cd6f1, 0xcdaa3b6d, 0xc0bbbe37,
+	0x83613bda, 0xdb48a363, 0x0b02e931, 0x6fd15ca7, 0x521afaca, 0x31338431, 0x6ed41a95, 0x6d437890,
+	0xc39c91f2, 0x9eccabbd, 0xb5c9a0e6, 0x532fb63c, 0xd2c741c6, 0x07237ea3, 0xa4954b68, 0x4c191d76
+};
+
+static void StoreDigest(const std::array<uint, 8> &State, byte* Output)
+{
+	for (size_t i = 0; i < 8; ++i)
+		IntUtils::Be32ToBytes(State[i], Output + (i * sizeof(uint)));
+}
+
+template <size_t Length, size_t Lanes>
+static void ComputeLanes(SHA2Dispatch::Compress256LanesFunc Compress, const byte* const* Input, size_t Count, byte* Output)
+{
+	CEX_ALIGN_DATA(32) uint state[8 * Lanes];
+	byte block[Lanes][SHA256Fixed::BLOCK_SIZE];
+	const byte* blocks[Lanes];
+	const byte* padding[Lanes];
+	std::array<uint, 8> single;
+	size_t next = 0;
+
+	// the padded tails of the 32 byte messages are written once; only the message halves change
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		if (Length == 32)
+			std::memcpy(block[i] + 32, PAD32, sizeof(PAD32));
+
+		padding[i] = PAD64;
+	}
+
+	// below a quarter of the lanes the vector rounds cost more than hashing the remainder one at a time
+	const size_t MINACT = (Lanes / 4 != 0) ? Lanes / 4 : 1;
+
+	while (Count - next > MINACT)
+	{
+		const size_t LNCNT = (Count - next < Lanes) ? Count - next : Lanes;
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			// idle lanes of the last group recompute the first message of the group, and their output is discarded
+			const byte* msg = Input[next + ((i < LNCNT) ? i : 0)];
+
+			if (Length == 32)
+			{
+				std::memcpy(block[i], msg, 32);
+				blocks[i] = block[i];
+			}
+			else
+			{
+				blocks[i] = msg;
+			}
+
+			for (size_t j = 0; j < 8; ++j)
+				state[(j * Lanes) + i] = SHA256_IV[j];
+		}
+
+		Compress(blocks, 1, state);
+
+		if (Length == 64)
+			Compress(padding, 1, state);
+
+		for (size_t i = 0; i < LNCNT; ++i)
+		{
+			for (size_t j = 0; j < 8; ++j)
+				single[j] = state[(j * Lanes) + i];
+
+			StoreDigest(single, Output + ((next + i) * SHA256Fixed::DIGEST_SIZE));
+		}
+
+		next += LNCNT;
+	}
+
+	for (; next < Count; ++next)
+	{
+		if (Length == 32)
+			SHA256Fixed::Compute<32>(Input[next], Output + (next * SHA256Fixed::DIGEST_SIZE));
+		else
+			SHA256Fixed::Compute<64>(Input[next], Output + (next * SHA256Fixed::DIGEST_SIZE));
+	}
+}
+
+template <size_t Length>
+static void ComputeFrom(const byte* const* Input, size_t Count, byte* Output)
+{
+	size_t lanes;
+	SHA2Dispatch::Compress256LanesFunc compress = SHA2Dispatch::CompressLanes256(lanes);
+
+	if (lanes == 8)
+	{
+		ComputeLanes<Length, 8>(compress, Input, Count, Output);
+	}
+	else if (lanes == 4)
+	{
+		ComputeLanes<Length, 4>(compress, Input, Count, Output);
+	}
+	else if (lanes == 2)
+	{
+		ComputeLanes<Length, 2>(compress, Input, Count, Output);
+	}
+	else
+	{
+		for (size_t i = 0; i < Count; ++i)
+			SHA256Fixed::Compute<Length>(Input[i], Output + (i * SHA256Fixed::DIGEST_SIZE));
+	}
+}
+
+//~~~Public Functions~~~//
+
+void SHA256Fixed::CompressPadding64(std::array<uint, 8> &State)
+{
+	// sha-ni expands the schedule in hardware alongside the rounds; every other kernel spends a quarter of a block on it
+	if (SHA2Dispatch::Kernel256() == SHA2Kernels::SHANI)
+		SHA2Dispatch::Compress256()(PAD64, 1, State);
+	else
+		SHA256Compress::Rounds64(PAD64_SCHEDULE, State);
+}
+
+//~~~Private Functions~~~//
+
+void SHA256Fixed::Compute32(const byte* Input, byte* Output)
+{
+	CEX_ALIGN_DATA(16) byte block[BLOCK_SIZE];
+	std::array<uint, 8> state = SHA256_IV;
+
+	std::memcpy(block, Input, 32);
+	std::memcpy(block + 32, PAD32, sizeof(PAD32));
+	SHA2Dispatch::Compress256()(block, 1, state);
+	StoreDigest(state, Output);
+}
+
+void SHA256Fixed::Compute32(const byte* const* Input, size_t Count, byte* Output)
+{
+	ComputeFrom<32>(Input, Count, Output);
+}
+
+void SHA256Fixed::Compute64(const byte* Input, byte* Output)
+{
+	std::array<uint, 8> state = SHA256_IV;
+
+	SHA2Dispatch::Compress256()(Input, 1, state);
+	CompressPadding64(state);
+	StoreDigest(state, Output);
+}
+
+void SHA256Fixed::Compute64(const byte* const* Input, size_t Count, byte* Output)
+{
+	ComputeFrom<64>(Input, Count, Output);
+}
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,112 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _CEX_SHA256FIXED_H
+#define _CEX_SHA256FIXED_H
+
+#include "CexDomain.h"
+#include <array>
+
+NAMESPACE_DIGEST
+
+/// <summary>
+/// SHA-256 of fixed length messages; 32 bytes (a hash) or 64 bytes (a pair of hashes, or a block of key material)
+/// </summary>
+/// 
+/// <example>
+/// <description>Hashing a Merkle node from its two children:</description>
+/// <code>
+/// byte node[64]; // left child hash || right child hash
+/// byte parent[32];
+/// SHA256Fixed::Compute&lt;64&gt;(node, parent);
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>The message length is a template parameter, so the padding is a constant rather than being built per message,
+/// and no digest instance, message buffer or state reset is involved.
+/// The padding block of a 64 byte message does not depend on the message at all; its message schedule is a precomputed table,
+/// and only the rounds are run for it, except on the SHA-NI kernel, which expands the schedule in hardware alongside the rounds.
+/// A 32 byte message shares its only block with the padding, which is copied in from a constant.</para>
+/// <para>The multi-buffer form compresses the messages in the lanes of the active multi-buffer kernel (see SHA2Dispatch::CompressLanes256).
+/// The output is the standard SHA-256 hash of each message.</para>
+/// </remarks>
+class SHA256Fixed
+{
+public:
+
+	static const size_t BLOCK_SIZE = 64;
+	static const size_t DIGEST_SIZE = 32;
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Compress the padding block of a 64 byte message into a chaining value; used by the fused double hash in SHA256d
+	/// </summary>
+	/// 
+	/// <param name="State">The chaining value after the message block</param>
+	static void CompressPadding64(std::array<uint, 8> &State);
+
+	/// <summary>
+	/// Compute the SHA-256 hash of a message of Length bytes
+	/// </summary>
+	/// 
+	/// <param name="Input">The message; Length bytes are read</param>
+	/// <param name="Output">Receives the 32 byte hash</param>
+	///
+	/// <typeparam name="Length">The message length; 32 or 64 bytes</typeparam>
+	template <size_t Length>
+	static void Compute(const byte* Input, byte* Output)
+	{
+		static_assert(Length == 32 || Length == 64, "SHA256Fixed: the message length must be 32 or 64 bytes");
+
+		if (Length == 32)
+			Compute32(Input, Output);
+		else
+			Compute64(Input, Output);
+	}
+
+	/// <summary>
+	/// Compute the SHA-256 hashes of Count independent messages of Length bytes
+	/// </summary>
+	/// 
+	/// <param name="Input">The message pointers; Length bytes are read from each</param>
+	/// <param name="Count">The number of messages</param>
+	/// <param name="Output">Receives Count * 32 bytes; the hash of message i is written at offset i * 32</param>
+	///
+	/// <typeparam name="Length">The message length; 32 or 64 bytes</typeparam>
+	template <size_t Length>
+	static void Compute(const byte* const* Input, size_t Count, byte* Output)
+	{
+		static_assert(Length == 32 || Length == 64, "SHA256Fixed: the message length must be 32 or 64 bytes");
+
+		if (Length == 32)
+			Compute32(Input, Count, Output);
+		else
+			Compute64(Input, Count, Output);
+	}
+
+private:
+	static void Compute32(const byte* Input, byte* Output);
+	static void Compute32(const byte* const* Input, size_t Count, byte* Output);
+	static void Compute64(const byte* Input, byte* Output);
+	static void Compute64(const byte* const* Input, size_t Count, byte* Output);
+};
+
+NAMESPACE_DIGESTEND
+#endif
@@ -0,0 +1,344 @@
+#include "SHA256Multiplexer.h"
+#include "ArrayUtils.h"
+#include "CryptoDigestException.h"
+#include "IntUtils.h"
+#include "SHA256Batch.h"
+#include "SHA2Constants.h"
+#include "SHA2Dispatch.h"
+#include <algorithm>
+
+NAMESPACE_DIGEST
+
+using Exception::CryptoDigestException;
+using Utility::IntUtils;
+
+//~~~Constructor~~~//
+
+SHA256Multiplexer::SHA256Multiplexer(size_t Capacity)
+	:
+	m_freeSlots(),
+	m_lanes(SHA256Batch::Lanes() >= 4 ? SHA256Batch::Lanes() : 1),
+	m_readyStreams(),
+	m_streamState()
+{
+	m_freeSlots.reserve(Capacity);
+	m_readyStreams.reserve(Capacity);
+	m_streamState.reserve(Capacity);
+}
+
+SHA256Multiplexer::~SHA256Multiplexer()
+{
+	Utility::ArrayUtils::ClearVector(m_streamState);
+	m_streamState.clear();
+	m_freeSlots.clear();
+	m_readyStreams.clear();
+}
+
+//~~~Public Functions~~~//
+
+void SHA256Multiplexer::Close(size_t Stream)
+{
+	if (Stream >= m_streamState.size() || !m_streamState[Stream].Open)
+		throw CryptoDigestException("SHA256Multiplexer:Close", "The stream is not open!");
+
+	if (m_streamState[Stream].Ready)
+		m_readyStreams.erase(std::find(m_readyStreams.begin(), m_readyStreams.end(), Stream));
+
+	Release(Stream);
+}
+
+void SHA256Multiplexer::Finalize(const size_t* Streams, size_t Count, byte* Output)
+{
+	// mark every stream first, so an invalid or repeated handle leaves the set untouched
+	for (size_t i = 0; i < Count; ++i)
+	{
+		if (Streams[i] >= m_streamState.size() || !m_streamState[Streams[i]].Open || m_streamState[Streams[i]].Final)
+		{
+			for (size_t j = 0; j < i; ++j)
+				m_streamState[Streams[j]].Final = false;
+
+			throw CryptoDigestException("SHA256Multiplexer:Finalize", "The stream is not open, or is listed more than once!");
+		}
+
+		m_streamState[Streams[i]].Final = true;
+	}
+
+	for (size_t i = 0; i < Count; ++i)
+	{
+		StreamState &state = m_streamState[Streams[i]];
+		const ulong BITLEN = (state.T + state.Position) << 3;
+		const size_t BLKRMD = state.Position % BLOCK_SIZE;
+		const size_t PADLEN = (BLKRMD < BLOCK_SIZE - 8) ? BLOCK_SIZE - BLKRMD : (2 * BLOCK_SIZE) - BLKRMD;
+
+		std::memset(state.Buffer + state.Position, 0, PADLEN);
+		state.Buffer[state.Position] = 0x80;
+		state.Position += PADLEN;
+		IntUtils::Be64ToBytes(BITLEN, state.Buffer + state.Position - 8);
+
+		if (!state.Ready)
+		{
+			state.Ready = true;
+			m_readyStreams.push_back(Streams[i]);
+		}
+	}
+
+	Drain();
+
+	for (size_t i = 0; i < Count; ++i)
+	{
+		for (size_t j = 0; j < 8; ++j)
+			IntUtils::Be32ToBytes(m_streamState[Streams[i]].H[j], Output + (i * DIGEST_SIZE) + (j * sizeof(uint)));
+
+		Release(Streams[i]);
+	}
+}
+
+void SHA256Multiplexer::Finalize(size_t Stream, std::vector<byte> &Output)
+{
+	Output.resize(DIGEST_SIZE);
+	Finalize(&Stream, 1, &Output[0]);
+}
+
+size_t SHA256Multiplexer::Open()
+{
+	size_t stream;
+
+	if (m_freeSlots.size() != 0)
+	{
+		stream = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+	else
+	{
+		stream = m_streamState.size();
+		m_streamState.emplace_back();
+	}
+
+	StreamState &state = m_streamState[stream];
+	state.H = SHA256_IV;
+	state.T = 0;
+	state.Position = 0;
+	state.Final = false;
+	state.Open = true;
+	state.Ready = false;
+
+	return stream;
+}
+
+void SHA256Multiplexer::Update(size_t Stream, const byte* Input, size_t Length)
+{
+	if (Stream >= m_streamState.size() || !m_streamState[Stream].Open)
+		throw CryptoDigestException("SHA256Multiplexer:Update", "The stream is not open!");
+
+	StreamState &state = m_streamState[Stream];
+
+	// a write that would fill the buffer completes the partial block and drains it with the other ready streams,
+	// then the full blocks of the input are compressed in place; holding them back would only add a copy
+	if (state.Position + Length >= BUFFER_SIZE)
+	{
+		const size_t RMDLEN = (BLOCK_SIZE - (state.Position % BLOCK_SIZE)) % BLOCK_SIZE;
+
+		std::memcpy(state.Buffer + state.Position, Input, RMDLEN);
+		state.Position += RMDLEN;
+		Input += RMDLEN;
+		Length -= RMDLEN;
+
+		if (state.Position != 0)
+		{
+			if (!state.Ready)
+			{
+				state.Ready = true;
+				m_readyStreams.push_back(Stream);
+			}
+
+			Drain();
+		}
+
+		const size_t BLKCNT = Length / BLOCK_SIZE;
+
+		if (BLKCNT != 0)
+		{
+			SHA2Dispatch::Compress256()(Input, BLKCNT, state.H);
+			state.T += BLKCNT * BLOCK_SIZE;
+			Input += BLKCNT * BLOCK_SIZE;
+			Length -= BLKCNT * BLOCK_SIZE;
+		}
+	}
+
+	if (Length != 0)
+	{
+		std::memcpy(state.Buffer + state.Position, Input, Length);
+		state.Position += Length;
+
+		if (!state.Ready && state.Position >= BLOCK_SIZE)
+		{
+			state.Ready = true;
+			m_readyStreams.push_back(Stream);
+		}
+
+		// waiting for several streams per lane gives each drain enough work to amortize its setup
+		if (m_readyStreams.size() >= m_lanes * 16)
+			Drain();
+	}
+}
+
+void SHA256Multiplexer::Update(size_t Stream, const std::vector<byte> &Input, size_t InOffset, size_t Length)
+{
+	CEXASSERT(Input.size() - InOffset >= Length, "The input buffer is too short!");
+
+	if (Length != 0)
+		Update(Stream, &Input[InOffset], Length);
+}
+
+//~~~Private Functions~~~//
+
+void SHA256Multiplexer::Drain()
+{
+	SHA2Dispatch::Compress256Func single = SHA2Dispatch::Compress256();
+	size_t lanes;
+	SHA2Dispatch::Compress256LanesFunc compress = SHA2Dispatch::CompressLanes256(lanes);
+	size_t next = 0;
+
+	// the two stream SHA-NI kernel is slower than the single stream kernel on the short runs of a drain
+	if (compress != nullptr && lanes >= 4 && m_readyStreams.size() > 1)
+	{
+		CEX_ALIGN_DATA(32) uint state[8 * 8];
+		const byte* blocks[8];
+		size_t done[8];
+		size_t slot[8];
+		bool live[8];
+		size_t active = 0;
+
+		for (size_t i = 0; i < lanes; ++i)
+		{
+			live[i] = next < m_readyStreams.size();
+
+			if (live[i])
+			{
+				slot[i] = m_readyStreams[next];
+				done[i] = 0;
+				++next;
+				++active;
+
+				for (size_t j = 0; j < 8; ++j)
+					state[(j * lanes) + i] = m_streamState[slot[i]].H[j];
+			}
+		}
+
+		// below a quarter of the lanes the vector rounds cost more than finishing the stragglers one at a time
+		const size_t MINACT = (lanes / 4 != 0) ? lanes / 4 : 1;
+
+		while (active > MINACT || (active != 0 && next < m_readyStreams.size()))
+		{
+			const byte* spare = nullptr;
+			size_t run = ~static_cast<size_t>(0);
+
+			for (size_t i = 0; i < lanes; ++i)
+			{
+				if (live[i])
+				{
+					blocks[i] = m_streamState[slot[i]].Buffer + (done[i] * BLOCK_SIZE);
+					spare = blocks[i];
+					run = (std::min)(run, (m_streamState[slot[i]].Position / BLOCK_SIZE) - done[i]);
+				}
+			}
+
+			// idle lanes recompute an active lane's blocks; their state is overwritten when the lane is reloaded
+			for (size_t i = 0; i < lanes; ++i)
+			{
+				if (!live[i])
+					blocks[i] = spare;
+			}
+
+			compress(blocks, run, state);
+
+			for (size_t i = 0; i < lanes; ++i)
+			{
+				if (!live[i])
+					continue;
+
+				StreamState &stream = m_streamState[slot[i]];
+				done[i] += run;
+
+				if (done[i] == stream.Position / BLOCK_SIZE)
+				{
+					for (size_t j = 0; j < 8; ++j)
+						stream.H[j] = state[(j * lanes) + i];
+
+					Retire(stream, done[i]);
+
+					if (next < m_readyStreams.size())
+					{
+						slot[i] = m_readyStreams[next];
+						done[i] = 0;
+						++next;
+
+						for (size_t j = 0; j < 8; ++j)
+							state[(j * lanes) + i] = m_streamState[slot[i]].H[j];
+					}
+					else
+					{
+						live[i] = false;
+						--active;
+					}
+				}
+			}
+		}
+
+		for (size_t i = 0; i < lanes; ++i)
+		{
+			if (live[i])
+			{
+				StreamState &stream = m_streamState[slot[i]];
+				const size_t BLKCNT = stream.Position / BLOCK_SIZE;
+
+				for (size_t j = 0; j < 8; ++j)
+					stream.H[j] = state[(j * lanes) + i];
+
+				single(stream.Buffer + (done[i] * BLOCK_SIZE), BLKCNT - done[i], stream.H);
+				Retire(stream, BLKCNT);
+			}
+		}
+	}
+
+	// a lone stream, or without a vector lane kernel; compressed one stream at a time
+	for (; next < m_readyStreams.size(); ++next)
+	{
+		StreamState &stream = m_streamState[m_readyStreams[next]];
+		const size_t BLKCNT = stream.Position / BLOCK_SIZE;
+
+		single(stream.Buffer, BLKCNT, stream.H);
+		Retire(stream, BLKCNT);
+	}
+
+	m_readyStreams.clear();
+}
+
+void SHA256Multiplexer::Release(size_t Stream)
+{
+	StreamState &state = m_streamState[Stream];
+
+	std::memset(state.Buffer, 0, sizeof(state.Buffer));
+	state.H.fill(0);
+	state.T = 0;
+	state.Position = 0;
+	state.Final = false;
+	state.Open = false;
+	state.Ready = false;
+	m_freeSlots.push_back(Stream);
+}
+
+void SHA256Multiplexer::Retire(StreamState &State, size_t Blocks)
+{
+	const size_t PRCLEN = Blocks * BLOCK_SIZE;
+
+	State.T += PRCLEN;
+	State.Position -= PRCLEN;
+	State.Ready = false;
+
+	// the partial block moves to the front of the buffer
+	if (State.Position != 0)
+		std::memmove(State.Buffer, State.Buffer + PRCLEN, State.Position);
+}
+
+NAMESPACE_DIGESTEND
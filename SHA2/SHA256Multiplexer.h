@@ -0,0 +1,182 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _CEX_SHA256MULTIPLEXER_H
+#define _CEX_SHA256MULTIPLEXER_H
+
+#include "CexDomain.h"
+#include <array>
+
+NAMESPACE_DIGEST
+
+/// <summary>
+/// Owns many concurrent incremental SHA-256 streams, and compresses their pending blocks together in the multi-buffer kernels
+/// </summary>
+///
+/// <example>
+/// <description>Hashing uploads as their reads arrive:</description>
+/// <code>
+/// SHA256Multiplexer mux;
+/// size_t upload = mux.Open();
+/// mux.Update(upload, data, length);
+/// ...
+/// mux.Finalize(uploads, count, hashes);
+/// </code>
+/// </example>
+///
+/// <remarks>
+/// <para>Each stream is a slot holding its chaining value and a buffer of up to 4 blocks; a short Update only copies the input into the buffer.
+/// A stream with at least one full block buffered is queued as ready, and once 16 streams per lane are ready,
+/// the queued blocks of all ready streams are compressed together with the AVX2 (8 lanes) or SSE4.1 (4 lanes) multi-buffer kernels, a lane being refilled as soon as its stream is drained.
+/// A write that would fill a stream buffer drains the ready streams at once, and its remaining full blocks are compressed in place, so a long write never waits on the others.</para>
+/// <para>With the SHA extensions, or the Scalar kernel forced through SHA2Dispatch, ready streams are drained one at a time with the single stream kernel;
+/// the two stream SHA-NI kernel used by SHA256Batch is slower than the single stream kernel on runs of one or two blocks.</para>
+/// <para>Finalize pads every listed stream and drains them in one pass, writes the hashes contiguously, and closes the streams.
+/// The output of each stream is the standard SHA-256 hash of its input, identical to a sequential SHA256 instance.</para>
+/// <para>Stream handles are slot indexes; a closed slot is reused by the next Open. An instance is not thread-safe, use one per thread.</para>
+/// </remarks>
+class SHA256Multiplexer
+{
+public:
+
+	static const size_t BLOCK_SIZE = 64;
+	static const size_t DIGEST_SIZE = 32;
+
+private:
+
+	static const size_t BUFFER_BLOCKS = 4;
+	static const size_t BUFFER_SIZE = BUFFER_BLOCKS * BLOCK_SIZE;
+
+	struct StreamState
+	{
+		// the data area, followed by room for the two padding blocks appended on finalize
+		byte Buffer[BUFFER_SIZE + (2 * BLOCK_SIZE)];
+		std::array<uint, 8> H;
+		ulong T;
+		size_t Position;
+		bool Final;
+		bool Open;
+		bool Ready;
+	};
+
+	std::vector<size_t> m_freeSlots;
+	size_t m_lanes;
+	std::vector<size_t> m_readyStreams;
+	std::vector<StreamState> m_streamState;
+
+public:
+
+	SHA256Multiplexer(const SHA256Multiplexer&) = delete;
+	SHA256Multiplexer& operator=(const SHA256Multiplexer&) = delete;
+
+	// *** Properties *** //
+
+	/// <summary>
+	/// Get: The number of streams compressed in parallel on this processor; 1, 4 or 8
+	/// </summary>
+	size_t Lanes() { return m_lanes; }
+
+	/// <summary>
+	/// Get: The number of open streams
+	/// </summary>
+	size_t Streams() { return m_streamState.size() - m_freeSlots.size(); }
+
+	//~~~Constructor~~~//
+
+	/// <summary>
+	/// Initialize the class
+	/// </summary>
+	///
+	/// <param name="Capacity">The number of stream slots to reserve; more are added as needed</param>
+	explicit SHA256Multiplexer(size_t Capacity = 1024);
+
+	/// <summary>
+	/// Finalize objects
+	/// </summary>
+	~SHA256Multiplexer();
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Discard an open stream and free its slot
+	/// </summary>
+	///
+	/// <param name="Stream">The stream handle</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the stream is not open</exception>
+	void Close(size_t Stream);
+
+	/// <summary>
+	/// Finalize a set of streams in one pass, and close them
+	/// </summary>
+	///
+	/// <param name="Streams">The stream handles</param>
+	/// <param name="Count">The number of streams</param>
+	/// <param name="Output">Receives Count * 32 bytes; the hash of Streams[i] is written at offset i * 32</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if a stream is not open, or is listed more than once; no stream is changed</exception>
+	void Finalize(const size_t* Streams, size_t Count, byte* Output);
+
+	/// <summary>
+	/// Finalize a single stream, and close it
+	/// </summary>
+	///
+	/// <param name="Stream">The stream handle</param>
+	/// <param name="Output">Receives the hash, resized to 32 bytes</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the stream is not open</exception>
+	void Finalize(size_t Stream, std::vector<byte> &Output);
+
+	/// <summary>
+	/// Open a new stream
+	/// </summary>
+	///
+	/// <returns>The stream handle</returns>
+	size_t Open();
+
+	/// <summary>
+	/// Add data to a stream
+	/// </summary>
+	///
+	/// <param name="Stream">The stream handle</param>
+	/// <param name="Input">The input data</param>
+	/// <param name="Length">The number of bytes to process</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the stream is not open</exception>
+	void Update(size_t Stream, const byte* Input, size_t Length);
+
+	/// <summary>
+	/// Add data to a stream
+	/// </summary>
+	///
+	/// <param name="Stream">The stream handle</param>
+	/// <param name="Input">The input array</param>
+	/// <param name="InOffset">The starting offset within the input array</param>
+	/// <param name="Length">The number of bytes to process</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the stream is not open</exception>
+	void Update(size_t Stream, const std::vector<byte> &Input, size_t InOffset, size_t Length);
+
+private:
+	void Drain();
+	void Release(size_t Stream);
+	void Retire(StreamState &State, size_t Blocks);
+};
+
+NAMESPACE_DIGESTEND
+#endif
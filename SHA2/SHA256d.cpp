@@ -0,0 +1,495 @@
+#include "SHA256d.h"
+#include "ArrayUtils.h"
+#include "IntUtils.h"
+#include "SHA256Fixed.h"
+#include "SHA2Constants.h"
+#include "SHA2Dispatch.h"
+
+NAMESPACE_DIGEST
+
+using Utility::IntUtils;
+
+// the second half of the outer block; the 0x80 terminator, zeros, and the 256 bit length of the inner hash
+static const byte PAD32[32] =
+{
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00
+};
+
+// the padding block of a 64 byte message, read by the multi-buffer lanes of a Merkle level
+CEX_ALIGN_DATA(16) static const byte PAD64[64] =
+{
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00
+};
+
+// the second block of an 80 byte header after its 16 byte tail; the 0x80 terminator, zeros, and the 640 bit length
+static const byte PAD80[48] =
+{
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x80
+};
+
+static void StoreDigest(const std::array<uint, 8> &State, byte* Output)
+{
+	for (size_t i = 0; i < 8; ++i)
+		IntUtils::Be32ToBytes(State[i], Output + (i * sizeof(uint)));
+}
+
+// the second hash; the inner chaining value is the message, written straight into a block with the constant padding
+static void ComputeOuter(const std::array<uint, 8> &Inner, byte* Output)
+{
+	CEX_ALIGN_DATA(16) byte block[64];
+	std::array<uint, 8> state = SHA256_IV;
+
+	StoreDigest(Inner, block);
+	std::memcpy(block + 32, PAD32, sizeof(PAD32));
+	SHA2Dispatch::Compress256()(block, 1, state);
+	StoreDigest(state, Output);
+}
+
+// the outer hashes of the lanes; Block holds one outer block per lane with PAD32 already in its second half
+template <size_t Lanes>
+static void ComputeOuterLanes(SHA2Dispatch::Compress256LanesFunc Compress, uint* State, byte (*Block)[64], size_t Count, byte* Output)
+{
+	const byte* blocks[Lanes];
+	std::array<uint, 8> single;
+
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		for (size_t j = 0; j < 8; ++j)
+		{
+			IntUtils::Be32ToBytes(State[(j * Lanes) + i], Block[i] + (j * sizeof(uint)));
+			State[(j * Lanes) + i] = SHA256_IV[j];
+		}
+
+		blocks[i] = Block[i];
+	}
+
+	Compress(blocks, 1, State);
+
+	for (size_t i = 0; i < Count; ++i)
+	{
+		for (size_t j = 0; j < 8; ++j)
+			single[j] = State[(j * Lanes) + i];
+
+		StoreDigest(single, Output + (i * 32));
+	}
+}
+
+template <size_t Lanes>
+static void ComputeHeaderLanes(SHA2Dispatch::Compress256LanesFunc Compress, const std::array<uint, 8> &Midstate, const byte* const* Tail, size_t Count, byte* Output)
+{
+	CEX_ALIGN_DATA(32) uint state[8 * Lanes];
+	byte inner[Lanes][64];
+	byte outer[Lanes][64];
+	const byte* blocks[Lanes];
+	size_t next = 0;
+
+	// only the 16 byte tails change from one group to the next
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		std::memcpy(inner[i] + 16, PAD80, sizeof(PAD80));
+		std::memcpy(outer[i] + 32, PAD32, sizeof(PAD32));
+		blocks[i] = inner[i];
+	}
+
+	// below a quarter of the lanes the vector rounds cost more than hashing the remainder one at a time
+	const size_t MINACT = (Lanes / 4 != 0) ? Lanes / 4 : 1;
+
+	while (Count - next > MINACT)
+	{
+		const size_t LNCNT = (Count - next < Lanes) ? Count - next : Lanes;
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			// idle lanes of the last group recompute the first header of the group, and their output is discarded
+			std::memcpy(inner[i], Tail[next + ((i < LNCNT) ? i : 0)], 16);
+
+			for (size_t j = 0; j < 8; ++j)
+				state[(j * Lanes) + i] = Midstate[j];
+		}
+
+		Compress(blocks, 1, state);
+		ComputeOuterLanes<Lanes>(Compress, state, outer, LNCNT, Output + (next * 32));
+		next += LNCNT;
+	}
+
+	for (; next < Count; ++next)
+		SHA256d::ComputeHeader(Midstate, Tail[next], Output + (next * 32));
+}
+
+template <size_t Lanes>
+static void ComputeNodeLanes(SHA2Dispatch::Compress256LanesFunc Compress, const byte* Nodes, size_t Pairs, byte* Output)
+{
+	CEX_ALIGN_DATA(32) uint state[8 * Lanes];
+	byte outer[Lanes][64];
+	const byte* blocks[Lanes];
+	const byte* padding[Lanes];
+	size_t next = 0;
+
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		std::memcpy(outer[i] + 32, PAD32, sizeof(PAD32));
+		padding[i] = PAD64;
+	}
+
+	const size_t MINACT = (Lanes / 4 != 0) ? Lanes / 4 : 1;
+
+	// a pair of adjacent nodes is the inner message block, read in place; every read of a group precedes its writes, so the level can be reduced in place
+	while (Pairs - next > MINACT)
+	{
+		const size_t LNCNT = (Pairs - next < Lanes) ? Pairs - next : Lanes;
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			blocks[i] = Nodes + ((next + ((i < LNCNT) ? i : 0)) * 64);
+
+			for (size_t j = 0; j < 8; ++j)
+				state[(j * Lanes) + i] = SHA256_IV[j];
+		}
+
+		Compress(blocks, 1, state);
+		Compress(padding, 1, state);
+		ComputeOuterLanes<Lanes>(Compress, state, outer, LNCNT, Output + (next * 32));
+		next += LNCNT;
+	}
+
+	for (; next < Pairs; ++next)
+		SHA256d::ComputeNode(Nodes + (next * 64), Nodes + (next * 64) + 32, Output + (next * 32));
+}
+
+//~~~Constructor~~~//
+
+SHA256d::SHA256d()
+	:
+	m_dgtState(),
+	m_isDestroyed(false),
+	m_msgBuffer(BLOCK_SIZE),
+	m_msgCounter(0),
+	m_msgLength(0),
+	m_parallelProfile(BLOCK_SIZE, false, 0, false, 1)
+{
+	m_parallelProfile.IsParallel() = false;
+
+	Reset();
+}
+
+SHA256d::SHA256d(const SHA256d &Digest)
+	:
+	m_dgtState(Digest.m_dgtState),
+	m_isDestroyed(Digest.m_isDestroyed),
+	m_msgBuffer(Digest.m_msgBuffer),
+	m_msgCounter(Digest.m_msgCounter),
+	m_msgLength(Digest.m_msgLength),
+	m_parallelProfile(Digest.m_parallelProfile)
+{
+}
+
+SHA256d::SHA256d(SHA256d &&Digest)
+	:
+	m_dgtState(Digest.m_dgtState),
+	m_isDestroyed(Digest.m_isDestroyed),
+	m_msgBuffer(std::move(Digest.m_msgBuffer)),
+	m_msgCounter(Digest.m_msgCounter),
+	m_msgLength(Digest.m_msgLength),
+	m_parallelProfile(Digest.m_parallelProfile)
+{
+	Digest.m_dgtState.fill(0);
+	Digest.m_msgLength = 0;
+	Digest.m_isDestroyed = true;
+}
+
+SHA256d& SHA256d::operator=(SHA256d &&Digest)
+{
+	if (this != &Digest)
+	{
+		Destroy();
+
+		m_dgtState = Digest.m_dgtState;
+		m_isDestroyed = Digest.m_isDestroyed;
+		m_msgBuffer = std::move(Digest.m_msgBuffer);
+		m_msgCounter = Digest.m_msgCounter;
+		m_msgLength = Digest.m_msgLength;
+		m_parallelProfile = Digest.m_parallelProfile;
+
+		Digest.m_dgtState.fill(0);
+		Digest.m_msgLength = 0;
+		Digest.m_isDestroyed = true;
+	}
+
+	return *this;
+}
+
+SHA256d::~SHA256d()
+{
+	Destroy();
+}
+
+//~~~Public Functions~~~//
+
+IDigest* SHA256d::Clone()
+{
+	return new SHA256d(*this);
+}
+
+void SHA256d::Compute(const std::vector<byte> &Input, std::vector<byte> &Output)
+{
+	Output.resize(DIGEST_SIZE);
+	Update(Input, 0, Input.size());
+	Finalize(Output, 0);
+}
+
+void SHA256d::ComputeHeader(const byte* Header, byte* Output)
+{
+	std::array<uint, 8> midstate;
+
+	HeaderMidstate(Header, midstate);
+	ComputeHeader(midstate, Header + BLOCK_SIZE, Output);
+}
+
+void SHA256d::ComputeHeader(const std::array<uint, 8> &Midstate, const byte* Tail, byte* Output)
+{
+	CEX_ALIGN_DATA(16) byte block[BLOCK_SIZE];
+	std::array<uint, 8> state = Midstate;
+
+	std::memcpy(block, Tail, HEADER_SIZE - BLOCK_SIZE);
+	std::memcpy(block + (HEADER_SIZE - BLOCK_SIZE), PAD80, sizeof(PAD80));
+	SHA2Dispatch::Compress256()(block, 1, state);
+	ComputeOuter(state, Output);
+}
+
+void SHA256d::ComputeHeaders(const std::array<uint, 8> &Midstate, const byte* const* Tail, size_t Count, byte* Output)
+{
+	size_t lanes;
+	SHA2Dispatch::Compress256LanesFunc compress = SHA2Dispatch::CompressLanes256(lanes);
+
+	if (lanes == 8)
+	{
+		ComputeHeaderLanes<8>(compress, Midstate, Tail, Count, Output);
+	}
+	else if (lanes == 4)
+	{
+		ComputeHeaderLanes<4>(compress, Midstate, Tail, Count, Output);
+	}
+	else if (lanes == 2)
+	{
+		ComputeHeaderLanes<2>(compress, Midstate, Tail, Count, Output);
+	}
+	else
+	{
+		for (size_t i = 0; i < Count; ++i)
+			ComputeHeader(Midstate, Tail[i], Output + (i * DIGEST_SIZE));
+	}
+}
+
+void SHA256d::ComputeLevel(const byte* Nodes, size_t Count, byte* Output)
+{
+	const size_t PRCNT = Count / 2;
+	size_t lanes;
+	SHA2Dispatch::Compress256LanesFunc compress = SHA2Dispatch::CompressLanes256(lanes);
+
+	if (lanes == 8)
+	{
+		ComputeNodeLanes<8>(compress, Nodes, PRCNT, Output);
+	}
+	else if (lanes == 4)
+	{
+		ComputeNodeLanes<4>(compress, Nodes, PRCNT, Output);
+	}
+	else if (lanes == 2)
+	{
+		ComputeNodeLanes<2>(compress, Nodes, PRCNT, Output);
+	}
+	else
+	{
+		for (size_t i = 0; i < PRCNT; ++i)
+			ComputeNode(Nodes + (i * 2 * DIGEST_SIZE), Nodes + (i * 2 * DIGEST_SIZE) + DIGEST_SIZE, Output + (i * DIGEST_SIZE));
+	}
+
+	// the odd node is read after the pairs are written; it lies beyond the parents written so far
+	if (Count % 2 != 0)
+	{
+		const byte* last = Nodes + ((Count - 1) * DIGEST_SIZE);
+		ComputeNode(last, last, Output + (PRCNT * DIGEST_SIZE));
+	}
+}
+
+void SHA256d::ComputeNode(const byte* Left, const byte* Right, byte* Output)
+{
+	CEX_ALIGN_DATA(16) byte block[BLOCK_SIZE];
+	std::array<uint, 8> state = SHA256_IV;
+	const byte* msg = Left;
+
+	// adjacent children are read in place
+	if (Right != Left + DIGEST_SIZE)
+	{
+		std::memcpy(block, Left, DIGEST_SIZE);
+		std::memcpy(block + DIGEST_SIZE, Right, DIGEST_SIZE);
+		msg = block;
+	}
+
+	SHA2Dispatch::Compress256()(msg, 1, state);
+	SHA256Fixed::CompressPadding64(state);
+	ComputeOuter(state, Output);
+}
+
+void SHA256d::Destroy()
+{
+	if (!m_isDestroyed)
+	{
+		m_isDestroyed = true;
+		m_msgCounter = 0;
+		m_msgLength = 0;
+
+		try
+		{
+			m_dgtState.fill(0);
+			Utility::ArrayUtils::ClearVector(m_msgBuffer);
+		}
+		catch (std::exception& ex)
+		{
+			throw CryptoDigestException("SHA256d:Destroy", "Could not clear all variables!", std::string(ex.what()));
+		}
+	}
+}
+
+size_t SHA256d::Finalize(std::vector<byte> &Output, const size_t OutOffset)
+{
+	CEXASSERT(Output.size() - OutOffset >= DIGEST_SIZE, "The Output buffer is too short!");
+
+	return Finalize(&Output[OutOffset]);
+}
+
+size_t SHA256d::Finalize(byte* Output)
+{
+	const ulong BITLEN = (m_msgCounter + m_msgLength) << 3;
+
+	// the first hash is padded in the message buffer as in SHA256
+	if (m_msgLength == BLOCK_SIZE)
+	{
+		SHA2Dispatch::Compress256()(&m_msgBuffer[0], 1, m_dgtState);
+		m_msgLength = 0;
+	}
+
+	m_msgBuffer[m_msgLength] = (byte)128;
+	++m_msgLength;
+
+	if (m_msgLength < BLOCK_SIZE)
+		memset(&m_msgBuffer[m_msgLength], 0, BLOCK_SIZE - m_msgLength);
+
+	if (m_msgLength > 56)
+	{
+		SHA2Dispatch::Compress256()(&m_msgBuffer[0], 1, m_dgtState);
+		memset(&m_msgBuffer[0], 0, BLOCK_SIZE);
+	}
+
+	IntUtils::Be64ToBytes(BITLEN, &m_msgBuffer[56]);
+	SHA2Dispatch::Compress256()(&m_msgBuffer[0], 1, m_dgtState);
+
+	// the second hash is computed directly from the chaining value
+	ComputeOuter(m_dgtState, Output);
+
+	Reset();
+
+	return DIGEST_SIZE;
+}
+
+void SHA256d::HeaderMidstate(const byte* Header, std::array<uint, 8> &Midstate)
+{
+	Midstate = SHA256_IV;
+	SHA2Dispatch::Compress256()(Header, 1, Midstate);
+}
+
+void SHA256d::MerkleRoot(const byte* Leaves, size_t Count, byte* Output)
+{
+	if (Count == 0)
+		throw CryptoDigestException("SHA256d:MerkleRoot", "The tree must have at least one leaf!");
+
+	if (Count == 1)
+	{
+		std::memcpy(Output, Leaves, DIGEST_SIZE);
+		return;
+	}
+
+	// the first level is hashed out of the leaves, the rest are reduced in place
+	std::vector<byte> level(((Count + 1) / 2) * DIGEST_SIZE);
+	ComputeLevel(Leaves, Count, &level[0]);
+	Count = (Count + 1) / 2;
+
+	while (Count > 1)
+	{
+		ComputeLevel(&level[0], Count, &level[0]);
+		Count = (Count + 1) / 2;
+	}
+
+	std::memcpy(Output, &level[0], DIGEST_SIZE);
+}
+
+void SHA256d::ParallelMaxDegree(size_t)
+{
+	throw CryptoDigestException("SHA256d:ParallelMaxDegree", "SHA256d does not support tree hashing!");
+}
+
+void SHA256d::Reset()
+{
+	m_dgtState = SHA256_IV;
+	m_msgCounter = 0;
+	m_msgLength = 0;
+	memset(&m_msgBuffer[0], 0, m_msgBuffer.size());
+}
+
+void SHA256d::Update(byte Input)
+{
+	Update(&Input, 1);
+}
+
+void SHA256d::Update(const std::vector<byte> &Input, size_t InOffset, size_t Length)
+{
+	CEXASSERT(Input.size() - InOffset >= Length, "The Output buffer is too short!");
+
+	if (Length == 0)
+		return;
+
+	Update(&Input[InOffset], Length);
+}
+
+void SHA256d::Update(const byte* Input, size_t Length)
+{
+	if (Length == 0)
+		return;
+
+	if (m_msgLength != 0 && (m_msgLength + Length >= BLOCK_SIZE))
+	{
+		const size_t RMDLEN = BLOCK_SIZE - m_msgLength;
+		if (RMDLEN != 0)
+			memcpy(&m_msgBuffer[m_msgLength], Input, RMDLEN);
+
+		SHA2Dispatch::Compress256()(&m_msgBuffer[0], 1, m_dgtState);
+		m_msgCounter += BLOCK_SIZE;
+		m_msgLength = 0;
+		Input += RMDLEN;
+		Length -= RMDLEN;
+	}
+
+	// compress all but the last block as one contiguous run
+	if (Length > BLOCK_SIZE)
+	{
+		const size_t BLKCNT = (Length - 1) / BLOCK_SIZE;
+		SHA2Dispatch::Compress256()(Input, BLKCNT, m_dgtState);
+		m_msgCounter += BLKCNT * BLOCK_SIZE;
+		Input += BLKCNT * BLOCK_SIZE;
+		Length -= BLKCNT * BLOCK_SIZE;
+	}
+
+	if (Length != 0)
+	{
+		memcpy(&m_msgBuffer[m_msgLength], Input, Length);
+		m_msgLength += Length;
+	}
+}
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,295 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _CEX_SHA256D_H
+#define _CEX_SHA256D_H
+
+#include "IDigest.h"
+#include <array>
+
+NAMESPACE_DIGEST
+
+/// <summary>
+/// Double SHA-256; the SHA-256 hash of the SHA-256 hash of a message, SHA256(SHA256(M)), as used by Bitcoin for block headers, transaction ids and Merkle trees
+/// </summary> 
+/// 
+/// <example>
+/// <description>Hashing an 80 byte block header, and a Merkle root:</description>
+/// <code>
+/// byte id[32];
+/// SHA256d::ComputeHeader(header, id);
+/// 
+/// byte root[32];
+/// SHA256d::MerkleRoot(&amp;txids[0], txids.size() / 32, root);
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>The second hash is fused into the finalizer: the inner chaining value is written big endian into a block whose constant padding is copied in from a table, 
+/// and compressed once from the initial value; it is never returned to the caller, or copied through the message buffer.</para>
+/// <para>An 80 byte header spans two blocks, and only the second one (the time, target and nonce fields) changes while searching a nonce.
+/// The chaining value after the first block (the midstate) can be computed once with HeaderMidstate, and each header then costs one inner and one outer compression.
+/// ComputeHeaders hashes a batch of header tails from one midstate in the lanes of the multi-buffer kernel (see SHA2Dispatch::CompressLanes256).</para>
+/// <para>A Merkle node is the double hash of its two 32 byte children; the inner message is a single block with a constant padding block (see SHA256Fixed),
+/// and ComputeLevel hashes every pair of a tree level in the multi-buffer lanes.</para>
+/// <para>This digest has no tree hashing mode; the Parallel option of DigestFromName is ignored.</para>
+/// </remarks>
+class SHA256d : public IDigest
+{
+private:
+
+	static const size_t BLOCK_SIZE = 64;
+	static const size_t DIGEST_SIZE = 32;
+
+	std::array<uint, 8> m_dgtState;
+	bool m_isDestroyed;
+	std::vector<byte> m_msgBuffer;
+	ulong m_msgCounter;
+	size_t m_msgLength;
+	ParallelOptions m_parallelProfile;
+
+public:
+
+	/// <summary>
+	/// The byte size of a block header
+	/// </summary>
+	static const size_t HEADER_SIZE = 80;
+
+	SHA256d& operator=(const SHA256d&) = delete;
+
+	/// <summary>
+	/// Move the state of another instance into this one; the state of this instance is cleared first.
+	/// <para>The source is left empty, and may only be destroyed or assigned to.</para>
+	/// </summary>
+	///
+	/// <param name="Digest">The instance to move from</param>
+	SHA256d& operator=(SHA256d &&Digest);
+
+	// *** Properties *** //
+
+	/// <summary>
+	/// Get: The Digests internal blocksize in bytes
+	/// </summary>
+	virtual size_t BlockSize() { return BLOCK_SIZE; }
+
+	/// <summary>
+	/// Get: Size of returned digest in bytes
+	/// </summary>
+	virtual size_t DigestSize() { return DIGEST_SIZE; }
+
+	/// <summary>
+	/// Get: The digests type name
+	/// </summary>
+	virtual const Digests Enumeral() { return Digests::SHA256d; }
+
+	/// <summary>
+	/// Get: Processor parallelization availability; always false, this digest has no tree hashing mode
+	/// </summary>
+	virtual const bool IsParallel() { return false; }
+
+	/// <summary>
+	/// Get: The digests class name
+	/// </summary>
+	virtual const std::string Name() { return "SHA256d"; }
+
+	/// <summary>
+	/// Get: Parallel block size; always zero, this digest has no tree hashing mode
+	/// </summary>
+	virtual const size_t ParallelBlockSize() { return 0; }
+
+	/// <summary>
+	/// Get: The sequential ParallelOptions profile; present for the IDigest interface only
+	/// </summary>
+	virtual ParallelOptions &ParallelProfile() { return m_parallelProfile; }
+
+	//~~~Constructor~~~//
+
+	/// <summary>
+	/// Initialize the class
+	/// </summary>
+	SHA256d();
+
+	/// <summary>
+	/// Move an instance; the message buffer is taken over, not copied.
+	/// <para>The source is left empty, and may only be destroyed or assigned to.</para>
+	/// </summary>
+	///
+	/// <param name="Digest">The instance to move from</param>
+	SHA256d(SHA256d &&Digest);
+
+	/// <summary>
+	/// Finalize objects
+	/// </summary>
+	virtual ~SHA256d();
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Create a copy of the digest in its current state; the copy continues the message independently of this instance.
+	/// <para>The chaining value, message buffer and counters are copied; the cost is that of the copies.</para>
+	/// </summary>
+	/// 
+	/// <returns>The copy; the caller owns and deletes it</returns>
+	virtual IDigest* Clone();
+
+	/// <summary>
+	/// Get the hash code for a message input array
+	/// </summary>
+	/// 
+	/// <param name="Input">The input message array</param>
+	/// <param name="Output">The hash output code array</param>
+	virtual void Compute(const std::vector<byte> &Input, std::vector<byte> &Output);
+
+	/// <summary>
+	/// Compute the double hash of an 80 byte block header
+	/// </summary>
+	/// 
+	/// <param name="Header">The header; 80 bytes are read</param>
+	/// <param name="Output">Receives the 32 byte hash</param>
+	static void ComputeHeader(const byte* Header, byte* Output);
+
+	/// <summary>
+	/// Compute the double hash of an 80 byte block header from the midstate of its first 64 bytes
+	/// </summary>
+	/// 
+	/// <param name="Midstate">The chaining value after the first 64 bytes of the header; see HeaderMidstate</param>
+	/// <param name="Tail">The last 16 bytes of the header</param>
+	/// <param name="Output">Receives the 32 byte hash</param>
+	static void ComputeHeader(const std::array<uint, 8> &Midstate, const byte* Tail, byte* Output);
+
+	/// <summary>
+	/// Compute the double hashes of Count 80 byte headers sharing their first 64 bytes, in the multi-buffer lanes
+	/// </summary>
+	/// 
+	/// <param name="Midstate">The chaining value after the shared first 64 bytes; see HeaderMidstate</param>
+	/// <param name="Tail">The pointers to the last 16 bytes of each header</param>
+	/// <param name="Count">The number of headers</param>
+	/// <param name="Output">Receives Count * 32 bytes; the hash of header i is written at offset i * 32</param>
+	static void ComputeHeaders(const std::array<uint, 8> &Midstate, const byte* const* Tail, size_t Count, byte* Output);
+
+	/// <summary>
+	/// Hash one level of a Merkle tree; each pair of adjacent nodes is replaced by the double hash of the pair.
+	/// <para>If Count is odd the last node is paired with itself. The pairs are hashed in the multi-buffer lanes.</para>
+	/// </summary>
+	/// 
+	/// <param name="Nodes">The level; Count contiguous 32 byte nodes</param>
+	/// <param name="Count">The number of nodes</param>
+	/// <param name="Output">Receives (Count + 1) / 2 contiguous 32 byte parent nodes; can be the same buffer as Nodes</param>
+	static void ComputeLevel(const byte* Nodes, size_t Count, byte* Output);
+
+	/// <summary>
+	/// Compute the double hash of a Merkle node from its two children
+	/// </summary>
+	/// 
+	/// <param name="Left">The 32 byte left child</param>
+	/// <param name="Right">The 32 byte right child</param>
+	/// <param name="Output">Receives the 32 byte parent node</param>
+	static void ComputeNode(const byte* Left, const byte* Right, byte* Output);
+
+	/// <summary>
+	/// Release all resources associated with the object
+	/// </summary>
+	virtual void Destroy();
+
+	/// <summary>
+	/// Finalize processing and get the hash code
+	/// </summary>
+	/// 
+	/// <param name="Output">The hash output code array</param>
+	/// <param name="OutOffset">The starting offset within the output array</param>
+	/// 
+	/// <returns>The byte size of the hash code</returns>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the output array is too short</exception>
+	virtual size_t Finalize(std::vector<byte> &Output, const size_t OutOffset);
+
+	/// <summary>
+	/// Finalize processing and write the hash code to caller memory
+	/// </summary>
+	/// 
+	/// <param name="Output">Receives DigestSize() bytes of hash code</param>
+	/// 
+	/// <returns>The byte size of the hash code</returns>
+	virtual size_t Finalize(byte* Output);
+
+	/// <summary>
+	/// Compute the chaining value after the first 64 bytes of a block header
+	/// </summary>
+	/// 
+	/// <param name="Header">The header; the first 64 bytes are read</param>
+	/// <param name="Midstate">Receives the chaining value</param>
+	static void HeaderMidstate(const byte* Header, std::array<uint, 8> &Midstate);
+
+	/// <summary>
+	/// Compute the Merkle root of Count leaves; levels are reduced with ComputeLevel until a single node remains
+	/// </summary>
+	/// 
+	/// <param name="Leaves">Count contiguous 32 byte leaf hashes</param>
+	/// <param name="Count">The number of leaves</param>
+	/// <param name="Output">Receives the 32 byte root; a single leaf is its own root</param>
+	///
+	/// <exception cref="Exception::CryptoDigestException">Thrown if there are no leaves</exception>
+	static void MerkleRoot(const byte* Leaves, size_t Count, byte* Output);
+
+	/// <summary>
+	/// Not supported; this digest has no tree hashing mode
+	/// </summary>
+	///
+	/// <param name="Degree">The desired number of threads</param>
+	///
+	/// <exception cref="Exception::CryptoDigestException">Thrown always</exception>
+	virtual void ParallelMaxDegree(size_t Degree);
+
+	/// <summary>
+	/// Reset the internal state
+	/// </summary>
+	virtual void Reset();
+
+	/// <summary>
+	/// Update the hash with a single byte
+	/// </summary>
+	/// 
+	/// <param name="Input">Input message byte</param>
+	virtual void Update(byte Input);
+
+	/// <summary>
+	/// Update the buffer with a block of bytes
+	/// </summary>
+	/// 
+	/// <param name="Input">The input message array</param>
+	/// <param name="InOffset">The starting offset within the Input array</param>
+	/// <param name="Length">The number of message bytes to process</param>
+	virtual void Update(const std::vector<byte> &Input, size_t InOffset, size_t Length);
+
+	/// <summary>
+	/// Update the hash with message bytes read in place from caller memory; full blocks are compressed directly from the input
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the message bytes; may be null if Length is zero</param>
+	/// <param name="Length">The number of message bytes to process</param>
+	virtual void Update(const byte* Input, size_t Length);
+
+private:
+
+	// the copy made by Clone
+	SHA256d(const SHA256d &Digest);
+};
+
+NAMESPACE_DIGESTEND
+#endif
@@ -0,0 +1,160 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SHA256Compress.h"
+#include "Intrinsics.h"
+
+NAMESPACE_DIGEST
+
+#if defined(CEX_ARCH_X86_X64)
+
+#if defined(CEX_COMPILER_MSC)
+#	define AVX_ROTR32(X, N) _rorx_u32(X, N)
+#else
+#	define AVX_ROTR32(X, N) (((X) >> (N)) | ((X) << (32 - (N))))
+#endif
+
+// the round constant and message word arrive pre-added from the vector schedule
+#define AVX_ROUND256(A, B, C, D, E, F, G, H, WK)																\
+do {																											\
+	uint R0 = H + (AVX_ROTR32(E, 6) ^ AVX_ROTR32(E, 11) ^ AVX_ROTR32(E, 25)) + ((E & F) ^ (~E & G)) + WK;	\
+	D += R0;																									\
+	H = R0 + (AVX_ROTR32(A, 2) ^ AVX_ROTR32(A, 13) ^ AVX_ROTR32(A, 22)) + ((A & B) | (C & (A | B)));		\
+} while (0)
+
+CEX_TARGET_ISA("avx,bmi,bmi2")
+static inline __m128i RotR32x4(__m128i X, int N)
+{
+	return _mm_or_si128(_mm_srli_epi32(X, N), _mm_slli_epi32(X, 32 - N));
+}
+
+CEX_TARGET_ISA("avx,bmi,bmi2")
+static inline __m128i Sigma0x4(__m128i X)
+{
+	return _mm_xor_si128(_mm_xor_si128(RotR32x4(X, 7), RotR32x4(X, 18)), _mm_srli_epi32(X, 3));
+}
+
+CEX_TARGET_ISA("avx,bmi,bmi2")
+static inline __m128i Sigma1x4(__m128i X)
+{
+	return _mm_xor_si128(_mm_xor_si128(RotR32x4(X, 17), RotR32x4(X, 19)), _mm_srli_epi32(X, 10));
+}
+
+CEX_TARGET_ISA("avx,bmi,bmi2")
+static inline __m128i Schedule4(__m128i X0, __m128i X1, __m128i X2, __m128i X3)
+{
+	// W[t..t+3] from W[t-16..t-1] held in X0..X3
+	__m128i T = _mm_add_epi32(_mm_add_epi32(X0, Sigma0x4(_mm_alignr_epi8(X1, X0, 4))), _mm_alignr_epi8(X3, X2, 4));
+	// W[t] and W[t+1] depend on W[t-2] and W[t-1]; the upper lanes see sigma1(0), which is zero
+	T = _mm_add_epi32(T, Sigma1x4(_mm_srli_si128(X3, 8)));
+	// W[t+2] and W[t+3] depend on the two words just produced
+	return _mm_add_epi32(T, _mm_unpacklo_epi64(_mm_setzero_si128(), Sigma1x4(T)));
+}
+
+CEX_TARGET_ISA("avx,bmi,bmi2")
+void SHA256Compress::Compress64AVX(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+{
+	CEX_ALIGN_DATA(32) uint WK[64];
+	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	uint S0 = State[0];
+	uint S1 = State[1];
+	uint S2 = State[2];
+	uint S3 = State[3];
+	uint S4 = State[4];
+	uint S5 = State[5];
+	uint S6 = State[6];
+	uint S7 = State[7];
+
+	while (BlockCount != 0)
+	{
+		__m128i X0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Input)), MASK);
+		__m128i X1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 16)), MASK);
+		__m128i X2 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 32)), MASK);
+		__m128i X3 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 48)), MASK);
+
+		// expand the full schedule and add the round constants ahead of the rounds
+		for (size_t i = 0; i < 64; i += 16)
+		{
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i]), _mm_add_epi32(X0, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i]))));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i + 4]), _mm_add_epi32(X1, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i + 4]))));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i + 8]), _mm_add_epi32(X2, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i + 8]))));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i + 12]), _mm_add_epi32(X3, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i + 12]))));
+
+			if (i != 48)
+			{
+				X0 = Schedule4(X0, X1, X2, X3);
+				X1 = Schedule4(X1, X2, X3, X0);
+				X2 = Schedule4(X2, X3, X0, X1);
+				X3 = Schedule4(X3, X0, X1, X2);
+			}
+		}
+
+		uint A = S0;
+		uint B = S1;
+		uint C = S2;
+		uint D = S3;
+		uint E = S4;
+		uint F = S5;
+		uint G = S6;
+		uint H = S7;
+
+		for (size_t i = 0; i < 64; i += 8)
+		{
+			AVX_ROUND256(A, B, C, D, E, F, G, H, WK[i]);
+			AVX_ROUND256(H, A, B, C, D, E, F, G, WK[i + 1]);
+			AVX_ROUND256(G, H, A, B, C, D, E, F, WK[i + 2]);
+			AVX_ROUND256(F, G, H, A, B, C, D, E, WK[i + 3]);
+			AVX_ROUND256(E, F, G, H, A, B, C, D, WK[i + 4]);
+			AVX_ROUND256(D, E, F, G, H, A, B, C, WK[i + 5]);
+			AVX_ROUND256(C, D, E, F, G, H, A, B, WK[i + 6]);
+			AVX_ROUND256(B, C, D, E, F, G, H, A, WK[i + 7]);
+		}
+
+		S0 += A;
+		S1 += B;
+		S2 += C;
+		S3 += D;
+		S4 += E;
+		S5 += F;
+		S6 += G;
+		S7 += H;
+
+		Input += BLOCK_SIZE;
+		--BlockCount;
+	}
+
+	State[0] = S0;
+	State[1] = S1;
+	State[2] = S2;
+	State[3] = S3;
+	State[4] = S4;
+	State[5] = S5;
+	State[6] = S6;
+	State[7] = S7;
+}
+
+#else
+
+void SHA256Compress::Compress64AVX(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+{
+	Compress64(Input, BlockCount, State);
+}
+
+#endif
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,565 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SHA256Compress.h"
+#include "SHA512Compress.h"
+#include "Intrinsics.h"
+
+NAMESPACE_DIGEST
+
+#if defined(CEX_ARCH_X86_X64)
+
+#if defined(CEX_COMPILER_MSC)
+#	define AVX2_ROTR32(X, N) _rorx_u32(X, N)
+#	if defined(CEX_ARCH_X64)
+#		define AVX2_ROTR64(X, N) _rorx_u64(X, N)
+#	endif
+#endif
+#if !defined(AVX2_ROTR32)
+#	define AVX2_ROTR32(X, N) (((X) >> (N)) | ((X) << (32 - (N))))
+#endif
+#if !defined(AVX2_ROTR64)
+#	define AVX2_ROTR64(X, N) (((X) >> (N)) | ((X) << (64 - (N))))
+#endif
+
+// the round constant and message word arrive pre-added from the vector schedule
+#define AVX2_ROUND256(A, B, C, D, E, F, G, H, WK)																\
+do {																											\
+	uint R0 = H + (AVX2_ROTR32(E, 6) ^ AVX2_ROTR32(E, 11) ^ AVX2_ROTR32(E, 25)) + ((E & F) ^ (~E & G)) + WK;	\
+	D += R0;																									\
+	H = R0 + (AVX2_ROTR32(A, 2) ^ AVX2_ROTR32(A, 13) ^ AVX2_ROTR32(A, 22)) + ((A & B) | (C & (A | B)));		\
+} while (0)
+
+CEX_TARGET_ISA("avx2")
+static inline __m256i RotR32x8(__m256i X, int N)
+{
+	return _mm256_or_si256(_mm256_srli_epi32(X, N), _mm256_slli_epi32(X, 32 - N));
+}
+
+CEX_TARGET_ISA("avx2,bmi,bmi2")
+static inline __m256i Schedule4x2(__m256i X0, __m256i X1, __m256i X2, __m256i X3)
+{
+	// the schedule of Compress64AVX, on one block per 128 bit half; alignr, byte shifts and unpack all stay within a half
+	__m256i Y = _mm256_alignr_epi8(X1, X0, 4);
+	__m256i T = _mm256_add_epi32(_mm256_add_epi32(X0, _mm256_xor_si256(_mm256_xor_si256(RotR32x8(Y, 7), RotR32x8(Y, 18)), _mm256_srli_epi32(Y, 3))), _mm256_alignr_epi8(X3, X2, 4));
+	Y = _mm256_srli_si256(X3, 8);
+	T = _mm256_add_epi32(T, _mm256_xor_si256(_mm256_xor_si256(RotR32x8(Y, 17), RotR32x8(Y, 19)), _mm256_srli_epi32(Y, 10)));
+	Y = _mm256_xor_si256(_mm256_xor_si256(RotR32x8(T, 17), RotR32x8(T, 19)), _mm256_srli_epi32(T, 10));
+
+	return _mm256_add_epi32(T, _mm256_unpacklo_epi64(_mm256_setzero_si256(), Y));
+}
+
+CEX_TARGET_ISA("avx2,bmi,bmi2")
+static inline __m256i LoadBlockPair(const byte* Lower, const byte* Upper, __m256i Mask)
+{
+	__m256i X = _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Lower)));
+	X = _mm256_inserti128_si256(X, _mm_loadu_si128(reinterpret_cast<const __m128i*>(Upper)), 1);
+
+	return _mm256_shuffle_epi8(X, Mask);
+}
+
+CEX_TARGET_ISA("avx2,bmi,bmi2")
+void SHA256Compress::Compress64AVX2(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+{
+	// the schedules of two consecutive blocks; block n in WK[0..63], block n + 1 in WK[64..127]
+	CEX_ALIGN_DATA(32) uint WK[128];
+	const __m256i MASK = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	uint S0 = State[0];
+	uint S1 = State[1];
+	uint S2 = State[2];
+	uint S3 = State[3];
+	uint S4 = State[4];
+	uint S5 = State[5];
+	uint S6 = State[6];
+	uint S7 = State[7];
+
+	while (BlockCount != 0)
+	{
+		// an odd final block is expanded in both halves, and only the lower schedule is used
+		const size_t BLKCNT = (BlockCount >= 2) ? 2 : 1;
+		const byte* UPPER = Input + ((BLKCNT - 1) * BLOCK_SIZE);
+		__m256i X0 = LoadBlockPair(Input, UPPER, MASK);
+		__m256i X1 = LoadBlockPair(Input + 16, UPPER + 16, MASK);
+		__m256i X2 = LoadBlockPair(Input + 32, UPPER + 32, MASK);
+		__m256i X3 = LoadBlockPair(Input + 48, UPPER + 48, MASK);
+
+		for (size_t i = 0; i < 64; i += 16)
+		{
+			__m256i T0 = _mm256_add_epi32(X0, _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i]))));
+			__m256i T1 = _mm256_add_epi32(X1, _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i + 4]))));
+			__m256i T2 = _mm256_add_epi32(X2, _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i + 8]))));
+			__m256i T3 = _mm256_add_epi32(X3, _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[i + 12]))));
+
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i]), _mm256_castsi256_si128(T0));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i + 4]), _mm256_castsi256_si128(T1));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i + 8]), _mm256_castsi256_si128(T2));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[i + 12]), _mm256_castsi256_si128(T3));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[64 + i]), _mm256_extracti128_si256(T0, 1));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[64 + i + 4]), _mm256_extracti128_si256(T1, 1));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[64 + i + 8]), _mm256_extracti128_si256(T2, 1));
+			_mm_store_si128(reinterpret_cast<__m128i*>(&WK[64 + i + 12]), _mm256_extracti128_si256(T3, 1));
+
+			if (i != 48)
+			{
+				X0 = Schedule4x2(X0, X1, X2, X3);
+				X1 = Schedule4x2(X1, X2, X3, X0);
+				X2 = Schedule4x2(X2, X3, X0, X1);
+				X3 = Schedule4x2(X3, X0, X1, X2);
+			}
+		}
+
+		for (size_t blk = 0; blk < BLKCNT; ++blk)
+		{
+			const uint* PWK = &WK[blk * 64];
+			uint A = S0;
+			uint B = S1;
+			uint C = S2;
+			uint D = S3;
+			uint E = S4;
+			uint F = S5;
+			uint G = S6;
+			uint H = S7;
+
+			for (size_t i = 0; i < 64; i += 8)
+			{
+				AVX2_ROUND256(A, B, C, D, E, F, G, H, PWK[i]);
+				AVX2_ROUND256(H, A, B, C, D, E, F, G, PWK[i + 1]);
+				AVX2_ROUND256(G, H, A, B, C, D, E, F, PWK[i + 2]);
+				AVX2_ROUND256(F, G, H, A, B, C, D, E, PWK[i + 3]);
+				AVX2_ROUND256(E, F, G, H, A, B, C, D, PWK[i + 4]);
+				AVX2_ROUND256(D, E, F, G, H, A, B, C, PWK[i + 5]);
+				AVX2_ROUND256(C, D, E, F, G, H, A, B, PWK[i + 6]);
+				AVX2_ROUND256(B, C, D, E, F, G, H, A, PWK[i + 7]);
+			}
+
+			S0 += A;
+			S1 += B;
+			S2 += C;
+			S3 += D;
+			S4 += E;
+			S5 += F;
+			S6 += G;
+			S7 += H;
+		}
+
+		Input += BLKCNT * BLOCK_SIZE;
+		BlockCount -= BLKCNT;
+	}
+
+	State[0] = S0;
+	State[1] = S1;
+	State[2] = S2;
+	State[3] = S3;
+	State[4] = S4;
+	State[5] = S5;
+	State[6] = S6;
+	State[7] = S7;
+}
+
+// one round on eight independent states, one state per 32 bit lane
+#define AVX2_ROUND256X8(A, B, C, D, E, F, G, H, W, K)																	\
+do {																													\
+	__m256i R0 = _mm256_add_epi32(_mm256_add_epi32(H, _mm256_xor_si256(_mm256_xor_si256(RotR32x8(E, 6), RotR32x8(E, 11)), RotR32x8(E, 25))),	\
+		_mm256_add_epi32(_mm256_xor_si256(_mm256_and_si256(E, F), _mm256_andnot_si256(E, G)), _mm256_add_epi32(W, _mm256_set1_epi32(K))));		\
+	D = _mm256_add_epi32(D, R0);																						\
+	H = _mm256_add_epi32(R0, _mm256_add_epi32(_mm256_xor_si256(_mm256_xor_si256(RotR32x8(A, 2), RotR32x8(A, 13)), RotR32x8(A, 22)),			\
+		_mm256_or_si256(_mm256_and_si256(A, B), _mm256_and_si256(C, _mm256_or_si256(A, B)))));							\
+} while (0)
+
+CEX_TARGET_ISA("avx2")
+static inline void Transpose8x8(__m256i* R)
+{
+	__m256i T0 = _mm256_unpacklo_epi32(R[0], R[1]);
+	__m256i T1 = _mm256_unpackhi_epi32(R[0], R[1]);
+	__m256i T2 = _mm256_unpacklo_epi32(R[2], R[3]);
+	__m256i T3 = _mm256_unpackhi_epi32(R[2], R[3]);
+	__m256i T4 = _mm256_unpacklo_epi32(R[4], R[5]);
+	__m256i T5 = _mm256_unpackhi_epi32(R[4], R[5]);
+	__m256i T6 = _mm256_unpacklo_epi32(R[6], R[7]);
+	__m256i T7 = _mm256_unpackhi_epi32(R[6], R[7]);
+	__m256i U0 = _mm256_unpacklo_epi64(T0, T2);
+	__m256i U1 = _mm256_unpackhi_epi64(T0, T2);
+	__m256i U2 = _mm256_unpacklo_epi64(T1, T3);
+	__m256i U3 = _mm256_unpackhi_epi64(T1, T3);
+	__m256i U4 = _mm256_unpacklo_epi64(T4, T6);
+	__m256i U5 = _mm256_unpackhi_epi64(T4, T6);
+	__m256i U6 = _mm256_unpacklo_epi64(T5, T7);
+	__m256i U7 = _mm256_unpackhi_epi64(T5, T7);
+
+	R[0] = _mm256_permute2x128_si256(U0, U4, 0x20);
+	R[1] = _mm256_permute2x128_si256(U1, U5, 0x20);
+	R[2] = _mm256_permute2x128_si256(U2, U6, 0x20);
+	R[3] = _mm256_permute2x128_si256(U3, U7, 0x20);
+	R[4] = _mm256_permute2x128_si256(U0, U4, 0x31);
+	R[5] = _mm256_permute2x128_si256(U1, U5, 0x31);
+	R[6] = _mm256_permute2x128_si256(U2, U6, 0x31);
+	R[7] = _mm256_permute2x128_si256(U3, U7, 0x31);
+}
+
+CEX_TARGET_ISA("avx2")
+void SHA256Compress::Compress64x8(const byte* const* Input, size_t BlockCount, uint* State)
+{
+	const __m256i MASK = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL, 0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m256i S[8];
+	__m256i W[16];
+
+	for (size_t i = 0; i < 8; ++i)
+		S[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(State + (i * 8)));
+
+	for (size_t blk = 0; blk < BlockCount; ++blk)
+	{
+		const size_t OFT = blk * BLOCK_SIZE;
+
+		// each lane reads its own message; the transpose leaves word t of all eight messages in W[t]
+		for (size_t i = 0; i < 8; ++i)
+		{
+			W[i] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Input[i] + OFT)), MASK);
+			W[i + 8] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Input[i] + OFT + 32)), MASK);
+		}
+
+		Transpose8x8(&W[0]);
+		Transpose8x8(&W[8]);
+
+		__m256i A = S[0];
+		__m256i B = S[1];
+		__m256i C = S[2];
+		__m256i D = S[3];
+		__m256i E = S[4];
+		__m256i F = S[5];
+		__m256i G = S[6];
+		__m256i H = S[7];
+
+		for (size_t i = 0; i < 64; i += 16)
+		{
+			if (i != 0)
+			{
+				for (size_t j = 0; j < 16; ++j)
+				{
+					__m256i X = W[(j + 14) & 15];
+					__m256i Y = W[(j + 1) & 15];
+					X = _mm256_xor_si256(_mm256_xor_si256(RotR32x8(X, 17), RotR32x8(X, 19)), _mm256_srli_epi32(X, 10));
+					Y = _mm256_xor_si256(_mm256_xor_si256(RotR32x8(Y, 7), RotR32x8(Y, 18)), _mm256_srli_epi32(Y, 3));
+					W[j] = _mm256_add_epi32(_mm256_add_epi32(W[j], X), _mm256_add_epi32(W[(j + 9) & 15], Y));
+				}
+			}
+
+			AVX2_ROUND256X8(A, B, C, D, E, F, G, H, W[0], SHA256_K[i]);
+			AVX2_ROUND256X8(H, A, B, C, D, E, F, G, W[1], SHA256_K[i + 1]);
+			AVX2_ROUND256X8(G, H, A, B, C, D, E, F, W[2], SHA256_K[i + 2]);
+			AVX2_ROUND256X8(F, G, H, A, B, C, D, E, W[3], SHA256_K[i + 3]);
+			AVX2_ROUND256X8(E, F, G, H, A, B, C, D, W[4], SHA256_K[i + 4]);
+			AVX2_ROUND256X8(D, E, F, G, H, A, B, C, W[5], SHA256_K[i + 5]);
+			AVX2_ROUND256X8(C, D, E, F, G, H, A, B, W[6], SHA256_K[i + 6]);
+			AVX2_ROUND256X8(B, C, D, E, F, G, H, A, W[7], SHA256_K[i + 7]);
+			AVX2_ROUND256X8(A, B, C, D, E, F, G, H, W[8], SHA256_K[i + 8]);
+			AVX2_ROUND256X8(H, A, B, C, D, E, F, G, W[9], SHA256_K[i + 9]);
+			AVX2_ROUND256X8(G, H, A, B, C, D, E, F, W[10], SHA256_K[i + 10]);
+			AVX2_ROUND256X8(F, G, H, A, B, C, D, E, W[11], SHA256_K[i + 11]);
+			AVX2_ROUND256X8(E, F, G, H, A, B, C, D, W[12], SHA256_K[i + 12]);
+			AVX2_ROUND256X8(D, E, F, G, H, A, B, C, W[13], SHA256_K[i + 13]);
+			AVX2_ROUND256X8(C, D, E, F, G, H, A, B, W[14], SHA256_K[i + 14]);
+			AVX2_ROUND256X8(B, C, D, E, F, G, H, A, W[15], SHA256_K[i + 15]);
+		}
+
+		S[0] = _mm256_add_epi32(S[0], A);
+		S[1] = _mm256_add_epi32(S[1], B);
+		S[2] = _mm256_add_epi32(S[2], C);
+		S[3] = _mm256_add_epi32(S[3], D);
+		S[4] = _mm256_add_epi32(S[4], E);
+		S[5] = _mm256_add_epi32(S[5], F);
+		S[6] = _mm256_add_epi32(S[6], G);
+		S[7] = _mm256_add_epi32(S[7], H);
+	}
+
+	for (size_t i = 0; i < 8; ++i)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(State + (i * 8)), S[i]);
+}
+
+CEX_TARGET_ISA("avx2")
+static inline __m256i RotR64x4(__m256i X, int N)
+{
+	return _mm256_or_si256(_mm256_srli_epi64(X, N), _mm256_slli_epi64(X, 64 - N));
+}
+
+// the round constant and message word arrive pre-added from the vector schedule
+#define AVX2_ROUND512(A, B, C, D, E, F, G, H, WK)																\
+do {																											\
+	ulong R0 = H + (AVX2_ROTR64(E, 14) ^ AVX2_ROTR64(E, 18) ^ AVX2_ROTR64(E, 41)) + ((E & F) ^ (~E & G)) + WK;	\
+	D += R0;																									\
+	H = R0 + (AVX2_ROTR64(A, 28) ^ AVX2_ROTR64(A, 34) ^ AVX2_ROTR64(A, 39)) + ((A & B) | (C & (A | B)));		\
+} while (0)
+
+CEX_TARGET_ISA("avx2")
+static inline __m256i Sigma0x4(__m256i X)
+{
+	return _mm256_xor_si256(_mm256_xor_si256(RotR64x4(X, 1), RotR64x4(X, 8)), _mm256_srli_epi64(X, 7));
+}
+
+CEX_TARGET_ISA("avx2")
+static inline __m256i Sigma1x4(__m256i X)
+{
+	return _mm256_xor_si256(_mm256_xor_si256(RotR64x4(X, 19), RotR64x4(X, 61)), _mm256_srli_epi64(X, 6));
+}
+
+CEX_TARGET_ISA("avx2")
+static inline __m256i Schedule4x64(__m256i X0, __m256i X1, __m256i X2, __m256i X3)
+{
+	// words t - 15..t - 12 and t - 7..t - 4; alignr works within 128 bit halves, so the crossing pair comes from a permute
+	__m256i T = _mm256_alignr_epi8(_mm256_permute2x128_si256(X0, X1, 0x21), X0, 8);
+	__m256i Y = _mm256_alignr_epi8(_mm256_permute2x128_si256(X2, X3, 0x21), X2, 8);
+
+	T = _mm256_add_epi64(_mm256_add_epi64(X0, Sigma0x4(T)), Y);
+	// words t and t + 1 depend on t - 2 and t - 1, words t + 2 and t + 3 on the two just computed
+	T = _mm256_add_epi64(T, Sigma1x4(_mm256_permute2x128_si256(X3, X3, 0x81)));
+
+	return _mm256_add_epi64(T, Sigma1x4(_mm256_permute2x128_si256(T, T, 0x08)));
+}
+
+CEX_TARGET_ISA("avx2,bmi,bmi2")
+void SHA512Compress::Compress128AVX2(const byte* Input, size_t BlockCount, std::array<ulong, 8> &State)
+{
+	CEX_ALIGN_DATA(32) ulong WK[80];
+	const __m256i MASK = _mm256_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+	ulong S0 = State[0];
+	ulong S1 = State[1];
+	ulong S2 = State[2];
+	ulong S3 = State[3];
+	ulong S4 = State[4];
+	ulong S5 = State[5];
+	ulong S6 = State[6];
+	ulong S7 = State[7];
+
+	while (BlockCount != 0)
+	{
+		__m256i X0 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Input)), MASK);
+		__m256i X1 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Input + 32)), MASK);
+		__m256i X2 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Input + 64)), MASK);
+		__m256i X3 = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Input + 96)), MASK);
+
+		ulong A = S0;
+		ulong B = S1;
+		ulong C = S2;
+		ulong D = S3;
+		ulong E = S4;
+		ulong F = S5;
+		ulong G = S6;
+		ulong H = S7;
+
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[0]), _mm256_add_epi64(X0, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[0]))));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[4]), _mm256_add_epi64(X1, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[4]))));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[8]), _mm256_add_epi64(X2, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[8]))));
+		_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[12]), _mm256_add_epi64(X3, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[12]))));
+
+		// the schedule runs sixteen words ahead of the rounds; the vector steps fill the issue slots the dependent round chain leaves idle
+		for (size_t i = 0; i < 80; i += 16)
+		{
+			if (i != 64)
+			{
+				X0 = Schedule4x64(X0, X1, X2, X3);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[i + 16]), _mm256_add_epi64(X0, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[i + 16]))));
+			}
+
+			AVX2_ROUND512(A, B, C, D, E, F, G, H, WK[i]);
+			AVX2_ROUND512(H, A, B, C, D, E, F, G, WK[i + 1]);
+			AVX2_ROUND512(G, H, A, B, C, D, E, F, WK[i + 2]);
+			AVX2_ROUND512(F, G, H, A, B, C, D, E, WK[i + 3]);
+
+			if (i != 64)
+			{
+				X1 = Schedule4x64(X1, X2, X3, X0);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[i + 20]), _mm256_add_epi64(X1, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[i + 20]))));
+			}
+
+			AVX2_ROUND512(E, F, G, H, A, B, C, D, WK[i + 4]);
+			AVX2_ROUND512(D, E, F, G, H, A, B, C, WK[i + 5]);
+			AVX2_ROUND512(C, D, E, F, G, H, A, B, WK[i + 6]);
+			AVX2_ROUND512(B, C, D, E, F, G, H, A, WK[i + 7]);
+
+			if (i != 64)
+			{
+				X2 = Schedule4x64(X2, X3, X0, X1);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[i + 24]), _mm256_add_epi64(X2, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[i + 24]))));
+			}
+
+			AVX2_ROUND512(A, B, C, D, E, F, G, H, WK[i + 8]);
+			AVX2_ROUND512(H, A, B, C, D, E, F, G, WK[i + 9]);
+			AVX2_ROUND512(G, H, A, B, C, D, E, F, WK[i + 10]);
+			AVX2_ROUND512(F, G, H, A, B, C, D, E, WK[i + 11]);
+
+			if (i != 64)
+			{
+				X3 = Schedule4x64(X3, X0, X1, X2);
+				_mm256_store_si256(reinterpret_cast<__m256i*>(&WK[i + 28]), _mm256_add_epi64(X3, _mm256_load_si256(reinterpret_cast<const __m256i*>(&SHA512_K[i + 28]))));
+			}
+
+			AVX2_ROUND512(E, F, G, H, A, B, C, D, WK[i + 12]);
+			AVX2_ROUND512(D, E, F, G, H, A, B, C, WK[i + 13]);
+			AVX2_ROUND512(C, D, E, F, G, H, A, B, WK[i + 14]);
+			AVX2_ROUND512(B, C, D, E, F, G, H, A, WK[i + 15]);
+		}
+
+		S0 += A;
+		S1 += B;
+		S2 += C;
+		S3 += D;
+		S4 += E;
+		S5 += F;
+		S6 += G;
+		S7 += H;
+
+		Input += BLOCK_SIZE;
+		--BlockCount;
+	}
+
+	State[0] = S0;
+	State[1] = S1;
+	State[2] = S2;
+	State[3] = S3;
+	State[4] = S4;
+	State[5] = S5;
+	State[6] = S6;
+	State[7] = S7;
+}
+
+// one round on four independent states, one state per 64 bit lane
+#define AVX2_ROUND512X4(A, B, C, D, E, F, G, H, W, K)																	\
+do {																													\
+	__m256i R0 = _mm256_add_epi64(_mm256_add_epi64(H, _mm256_xor_si256(_mm256_xor_si256(RotR64x4(E, 14), RotR64x4(E, 18)), RotR64x4(E, 41))),	\
+		_mm256_add_epi64(_mm256_xor_si256(_mm256_and_si256(E, F), _mm256_andnot_si256(E, G)), _mm256_add_epi64(W, _mm256_set1_epi64x(static_cast<long long>(K)))));	\
+	D = _mm256_add_epi64(D, R0);																						\
+	H = _mm256_add_epi64(R0, _mm256_add_epi64(_mm256_xor_si256(_mm256_xor_si256(RotR64x4(A, 28), RotR64x4(A, 34)), RotR64x4(A, 39)),			\
+		_mm256_or_si256(_mm256_and_si256(A, B), _mm256_and_si256(C, _mm256_or_si256(A, B)))));							\
+} while (0)
+
+CEX_TARGET_ISA("avx2")
+static inline void Transpose4x4x64(__m256i* R)
+{
+	__m256i T0 = _mm256_unpacklo_epi64(R[0], R[1]);
+	__m256i T1 = _mm256_unpackhi_epi64(R[0], R[1]);
+	__m256i T2 = _mm256_unpacklo_epi64(R[2], R[3]);
+	__m256i T3 = _mm256_unpackhi_epi64(R[2], R[3]);
+
+	R[0] = _mm256_permute2x128_si256(T0, T2, 0x20);
+	R[1] = _mm256_permute2x128_si256(T1, T3, 0x20);
+	R[2] = _mm256_permute2x128_si256(T0, T2, 0x31);
+	R[3] = _mm256_permute2x128_si256(T1, T3, 0x31);
+}
+
+CEX_TARGET_ISA("avx2")
+void SHA512Compress::Compress128x4(const byte* const* Input, size_t BlockCount, ulong* State)
+{
+	const __m256i MASK = _mm256_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+	__m256i S[8];
+	__m256i W[16];
+
+	for (size_t i = 0; i < 8; ++i)
+		S[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(State + (i * 4)));
+
+	for (size_t blk = 0; blk < BlockCount; ++blk)
+	{
+		const size_t OFT = blk * BLOCK_SIZE;
+
+		// load four words of each lane per row, then transpose so that W[t] holds word t of all four messages
+		for (size_t i = 0; i < 4; ++i)
+		{
+			for (size_t j = 0; j < 4; ++j)
+				W[(i * 4) + j] = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Input[j] + OFT + (i * 32))), MASK);
+
+			Transpose4x4x64(&W[i * 4]);
+		}
+
+		__m256i A = S[0];
+		__m256i B = S[1];
+		__m256i C = S[2];
+		__m256i D = S[3];
+		__m256i E = S[4];
+		__m256i F = S[5];
+		__m256i G = S[6];
+		__m256i H = S[7];
+
+		for (size_t i = 0; i < 80; i += 16)
+		{
+			if (i != 0)
+			{
+				for (size_t j = 0; j < 16; ++j)
+				{
+					__m256i X = W[(j + 14) & 15];
+					__m256i Y = W[(j + 1) & 15];
+					X = _mm256_xor_si256(_mm256_xor_si256(RotR64x4(X, 19), RotR64x4(X, 61)), _mm256_srli_epi64(X, 6));
+					Y = _mm256_xor_si256(_mm256_xor_si256(RotR64x4(Y, 1), RotR64x4(Y, 8)), _mm256_srli_epi64(Y, 7));
+					W[j] = _mm256_add_epi64(_mm256_add_epi64(W[j], X), _mm256_add_epi64(W[(j + 9) & 15], Y));
+				}
+			}
+
+			AVX2_ROUND512X4(A, B, C, D, E, F, G, H, W[0], SHA512_K[i]);
+			AVX2_ROUND512X4(H, A, B, C, D, E, F, G, W[1], SHA512_K[i + 1]);
+			AVX2_ROUND512X4(G, H, A, B, C, D, E, F, W[2], SHA512_K[i + 2]);
+			AVX2_ROUND512X4(F, G, H, A, B, C, D, E, W[3], SHA512_K[i + 3]);
+			AVX2_ROUND512X4(E, F, G, H, A, B, C, D, W[4], SHA512_K[i + 4]);
+			AVX2_ROUND512X4(D, E, F, G, H, A, B, C, W[5], SHA512_K[i + 5]);
+			AVX2_ROUND512X4(C, D, E, F, G, H, A, B, W[6], SHA512_K[i + 6]);
+			AVX2_ROUND512X4(B, C, D, E, F, G, H, A, W[7], SHA512_K[i + 7]);
+			AVX2_ROUND512X4(A, B, C, D, E, F, G, H, W[8], SHA512_K[i + 8]);
+			AVX2_ROUND512X4(H, A, B, C, D, E, F, G, W[9], SHA512_K[i + 9]);
+			AVX2_ROUND512X4(G, H, A, B, C, D, E, F, W[10], SHA512_K[i + 10]);
+			AVX2_ROUND512X4(F, G, H, A, B, C, D, E, W[11], SHA512_K[i + 11]);
+			AVX2_ROUND512X4(E, F, G, H, A, B, C, D, W[12], SHA512_K[i + 12]);
+			AVX2_ROUND512X4(D, E, F, G, H, A, B, C, W[13], SHA512_K[i + 13]);
+			AVX2_ROUND512X4(C, D, E, F, G, H, A, B, W[14], SHA512_K[i + 14]);
+			AVX2_ROUND512X4(B, C, D, E, F, G, H, A, W[15], SHA512_K[i + 15]);
+		}
+
+		S[0] = _mm256_add_epi64(S[0], A);
+		S[1] = _mm256_add_epi64(S[1], B);
+		S[2] = _mm256_add_epi64(S[2], C);
+		S[3] = _mm256_add_epi64(S[3], D);
+		S[4] = _mm256_add_epi64(S[4], E);
+		S[5] = _mm256_add_epi64(S[5], F);
+		S[6] = _mm256_add_epi64(S[6], G);
+		S[7] = _mm256_add_epi64(S[7], H);
+	}
+
+	for (size_t i = 0; i < 8; ++i)
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(State + (i * 4)), S[i]);
+}
+
+#else
+
+void SHA256Compress::Compress64AVX2(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+{
+	Compress64(Input, BlockCount, State);
+}
+
+void SHA256Compress::Compress64x8(const byte* const* Input, size_t BlockCount, uint* State)
+{
+	Compress64xN<8>(Input, BlockCount, State);
+}
+
+void SHA512Compress::Compress128AVX2(const byte* Input, size_t BlockCount, std::array<ulong, 8> &State)
+{
+	Compress128(Input, BlockCount, State);
+}
+
+void SHA512Compress::Compress128x4(const byte* const* Input, size_t BlockCount, ulong* State)
+{
+	Compress128xN<4>(Input, BlockCount, State);
+}
+
+#endif
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,214 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SHA256Compress.h"
+#include "SHA512Compress.h"
+#include "Intrinsics.h"
+
+NAMESPACE_DIGEST
+
+// msvc needs the intrinsic to emit rorx, gcc and clang select it for a rotate idiom inside a bmi2 target function
+#if defined(CEX_COMPILER_MSC) && defined(CEX_ARCH_X86_X64)
+#	define BMI2_ROTR32(X, N) _rorx_u32(X, N)
+#	if defined(CEX_ARCH_X64)
+#		define BMI2_ROTR64(X, N) _rorx_u64(X, N)
+#	endif
+#endif
+#if !defined(BMI2_ROTR32)
+#	define BMI2_ROTR32(X, N) (((X) >> (N)) | ((X) << (32 - (N))))
+#endif
+#if !defined(BMI2_ROTR64)
+#	define BMI2_ROTR64(X, N) (((X) >> (N)) | ((X) << (64 - (N))))
+#endif
+
+#define BMI2_ROUND256(A, B, C, D, E, F, G, H, W, K)																\
+do {																											\
+	uint R0 = H + (BMI2_ROTR32(E, 6) ^ BMI2_ROTR32(E, 11) ^ BMI2_ROTR32(E, 25)) + ((E & F) ^ (~E & G)) + K + W;	\
+	D += R0;																									\
+	H = R0 + (BMI2_ROTR32(A, 2) ^ BMI2_ROTR32(A, 13) ^ BMI2_ROTR32(A, 22)) + ((A & B) | (C & (A | B)));		\
+} while (0)
+
+#define BMI2_ROUND512(A, B, C, D, E, F, G, H, W, K)																\
+do {																											\
+	ulong R0 = H + (BMI2_ROTR64(E, 14) ^ BMI2_ROTR64(E, 18) ^ BMI2_ROTR64(E, 41)) + ((E & F) ^ (~E & G)) + K + W;	\
+	D += R0;																									\
+	H = R0 + (BMI2_ROTR64(A, 28) ^ BMI2_ROTR64(A, 34) ^ BMI2_ROTR64(A, 39)) + ((A & B) | (C & (A | B)));		\
+} while (0)
+
+CEX_TARGET_ISA("bmi,bmi2")
+void SHA256Compress::Compress64BMI2(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+{
+	uint S0 = State[0];
+	uint S1 = State[1];
+	uint S2 = State[2];
+	uint S3 = State[3];
+	uint S4 = State[4];
+	uint S5 = State[5];
+	uint S6 = State[6];
+	uint S7 = State[7];
+	uint W[16];
+
+	while (BlockCount != 0)
+	{
+		uint A = S0;
+		uint B = S1;
+		uint C = S2;
+		uint D = S3;
+		uint E = S4;
+		uint F = S5;
+		uint G = S6;
+		uint H = S7;
+
+		for (size_t i = 0; i < 16; ++i)
+			W[i] = IntUtils::BytesToBe32(Input + (i * sizeof(uint)));
+
+		for (size_t i = 0; i < 64; i += 16)
+		{
+			// expand the next 16 schedule words in place
+			if (i != 0)
+			{
+				for (size_t j = 0; j < 16; ++j)
+				{
+					uint X = W[(j + 14) & 15];
+					uint Y = W[(j + 1) & 15];
+					W[j] += (BMI2_ROTR32(X, 17) ^ BMI2_ROTR32(X, 19) ^ (X >> 10)) + W[(j + 9) & 15] + (BMI2_ROTR32(Y, 7) ^ BMI2_ROTR32(Y, 18) ^ (Y >> 3));
+				}
+			}
+
+			BMI2_ROUND256(A, B, C, D, E, F, G, H, W[0], SHA256_K[i]);
+			BMI2_ROUND256(H, A, B, C, D, E, F, G, W[1], SHA256_K[i + 1]);
+			BMI2_ROUND256(G, H, A, B, C, D, E, F, W[2], SHA256_K[i + 2]);
+			BMI2_ROUND256(F, G, H, A, B, C, D, E, W[3], SHA256_K[i + 3]);
+			BMI2_ROUND256(E, F, G, H, A, B, C, D, W[4], SHA256_K[i + 4]);
+			BMI2_ROUND256(D, E, F, G, H, A, B, C, W[5], SHA256_K[i + 5]);
+			BMI2_ROUND256(C, D, E, F, G, H, A, B, W[6], SHA256_K[i + 6]);
+			BMI2_ROUND256(B, C, D, E, F, G, H, A, W[7], SHA256_K[i + 7]);
+			BMI2_ROUND256(A, B, C, D, E, F, G, H, W[8], SHA256_K[i + 8]);
+			BMI2_ROUND256(H, A, B, C, D, E, F, G, W[9], SHA256_K[i + 9]);
+			BMI2_ROUND256(G, H, A, B, C, D, E, F, W[10], SHA256_K[i + 10]);
+			BMI2_ROUND256(F, G, H, A, B, C, D, E, W[11], SHA256_K[i + 11]);
+			BMI2_ROUND256(E, F, G, H, A, B, C, D, W[12], SHA256_K[i + 12]);
+			BMI2_ROUND256(D, E, F, G, H, A, B, C, W[13], SHA256_K[i + 13]);
+			BMI2_ROUND256(C, D, E, F, G, H, A, B, W[14], SHA256_K[i + 14]);
+			BMI2_ROUND256(B, C, D, E, F, G, H, A, W[15], SHA256_K[i + 15]);
+		}
+
+		S0 += A;
+		S1 += B;
+		S2 += C;
+		S3 += D;
+		S4 += E;
+		S5 += F;
+		S6 += G;
+		S7 += H;
+
+		Input += BLOCK_SIZE;
+		--BlockCount;
+	}
+
+	State[0] = S0;
+	State[1] = S1;
+	State[2] = S2;
+	State[3] = S3;
+	State[4] = S4;
+	State[5] = S5;
+	State[6] = S6;
+	State[7] = S7;
+}
+
+CEX_TARGET_ISA("bmi,bmi2")
+void SHA512Compress::Compress128BMI2(const byte* Input, size_t BlockCount, std::array<ulong, 8> &State)
+{
+	ulong S0 = State[0];
+	ulong S1 = State[1];
+	ulong S2 = State[2];
+	ulong S3 = State[3];
+	ulong S4 = State[4];
+	ulong S5 = State[5];
+	ulong S6 = State[6];
+	ulong S7 = State[7];
+	ulong W[16];
+
+	while (BlockCount != 0)
+	{
+		ulong A = S0;
+		ulong B = S1;
+		ulong C = S2;
+		ulong D = S3;
+		ulong E = S4;
+		ulong F = S5;
+		ulong G = S6;
+		ulong H = S7;
+
+		for (size_t i = 0; i < 16; ++i)
+			W[i] = IntUtils::BytesToBe64(Input + (i * sizeof(ulong)));
+
+		for (size_t i = 0; i < 80; i += 16)
+		{
+			if (i != 0)
+			{
+				for (size_t j = 0; j < 16; ++j)
+				{
+					ulong X = W[(j + 14) & 15];
+					ulong Y = W[(j + 1) & 15];
+					W[j] += (BMI2_ROTR64(X, 19) ^ BMI2_ROTR64(X, 61) ^ (X >> 6)) + W[(j + 9) & 15] + (BMI2_ROTR64(Y, 1) ^ BMI2_ROTR64(Y, 8) ^ (Y >> 7));
+				}
+			}
+
+			BMI2_ROUND512(A, B, C, D, E, F, G, H, W[0], SHA512_K[i]);
+			BMI2_ROUND512(H, A, B, C, D, E, F, G, W[1], SHA512_K[i + 1]);
+			BMI2_ROUND512(G, H, A, B, C, D, E, F, W[2], SHA512_K[i + 2]);
+			BMI2_ROUND512(F, G, H, A, B, C, D, E, W[3], SHA512_K[i + 3]);
+			BMI2_ROUND512(E, F, G, H, A, B, C, D, W[4], SHA512_K[i + 4]);
+			BMI2_ROUND512(D, E, F, G, H, A, B, C, W[5], SHA512_K[i + 5]);
+			BMI2_ROUND512(C, D, E, F, G, H, A, B, W[6], SHA512_K[i + 6]);
+			BMI2_ROUND512(B, C, D, E, F, G, H, A, W[7], SHA512_K[i + 7]);
+			BMI2_ROUND512(A, B, C, D, E, F, G, H, W[8], SHA512_K[i + 8]);
+			BMI2_ROUND512(H, A, B, C, D, E, F, G, W[9], SHA512_K[i + 9]);
+			BMI2_ROUND512(G, H, A, B, C, D, E, F, W[10], SHA512_K[i + 10]);
+			BMI2_ROUND512(F, G, H, A, B, C, D, E, W[11], SHA512_K[i + 11]);
+			BMI2_ROUND512(E, F, G, H, A, B, C, D, W[12], SHA512_K[i + 12]);
+			BMI2_ROUND512(D, E, F, G, H, A, B, C, W[13], SHA512_K[i + 13]);
+			BMI2_ROUND512(C, D, E, F, G, H, A, B, W[14], SHA512_K[i + 14]);
+			BMI2_ROUND512(B, C, D, E, F, G, H, A, W[15], SHA512_K[i + 15]);
+		}
+
+		S0 += A;
+		S1 += B;
+		S2 += C;
+		S3 += D;
+		S4 += E;
+		S5 += F;
+		S6 += G;
+		S7 += H;
+
+		Input += BLOCK_SIZE;
+		--BlockCount;
+	}
+
+	State[0] = S0;
+	State[1] = S1;
+	State[2] = S2;
+	State[3] = S3;
+	State[4] = S4;
+	State[5] = S5;
+	State[6] = S6;
+	State[7] = S7;
+}
+
+NAMESPACE_DIGESTEND
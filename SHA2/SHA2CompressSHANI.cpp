@@ -0,0 +1,567 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SHA256Compress.h"
+#include "Intrinsics.h"
+
+NAMESPACE_DIGEST
+
+#if defined(CEX_ARCH_X86_X64)
+
+CEX_TARGET_ISA("sha,sse4.1,ssse3")
+void SHA256Compress::Compress64SHANI(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+{
+	__m128i S0, S1, T0, T1;
+	__m128i MSG, TMP, MASK;
+	__m128i M0, M1, M2, M3;
+
+	// Load initial values
+	TMP = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&State[0]));
+	S1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&State[4]));
+	MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	TMP = _mm_shuffle_epi32(TMP, 0xB1);  // CDAB
+	S1 = _mm_shuffle_epi32(S1, 0x1B);    // EFGH
+	S0 = _mm_alignr_epi8(TMP, S1, 8);    // ABEF
+	S1 = _mm_blend_epi16(S1, TMP, 0xF0); // CDGH
+
+	while (BlockCount != 0)
+	{
+		// Save current state
+		T0 = S0;
+		T1 = S1;
+
+		// Rounds 0-3
+		MSG = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input));
+		M0 = _mm_shuffle_epi8(MSG, MASK);
+		MSG = _mm_add_epi32(M0, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[0])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+
+		// Rounds 4-7
+		M1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 16));
+		M1 = _mm_shuffle_epi8(M1, MASK);
+		MSG = _mm_add_epi32(M1, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[4])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M0 = _mm_sha256msg1_epu32(M0, M1);
+
+		// Rounds 8-11
+		M2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 32));
+		M2 = _mm_shuffle_epi8(M2, MASK);
+		MSG = _mm_add_epi32(M2, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[8])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M1 = _mm_sha256msg1_epu32(M1, M2);
+
+		// Rounds 12-15
+		M3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input + 48));
+		M3 = _mm_shuffle_epi8(M3, MASK);
+		MSG = _mm_add_epi32(M3, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[12])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M3, M2, 4);
+		M0 = _mm_add_epi32(M0, TMP);
+		M0 = _mm_sha256msg2_epu32(M0, M3);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M2 = _mm_sha256msg1_epu32(M2, M3);
+
+		// Rounds 16-19
+		MSG = _mm_add_epi32(M0, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[16])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M0, M3, 4);
+		M1 = _mm_add_epi32(M1, TMP);
+		M1 = _mm_sha256msg2_epu32(M1, M0);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M3 = _mm_sha256msg1_epu32(M3, M0);
+
+		// Rounds 20-23
+		MSG = _mm_add_epi32(M1, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[20])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M1, M0, 4);
+		M2 = _mm_add_epi32(M2, TMP);
+		M2 = _mm_sha256msg2_epu32(M2, M1);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M0 = _mm_sha256msg1_epu32(M0, M1);
+
+		// Rounds 24-27
+		MSG = _mm_add_epi32(M2, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[24])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M2, M1, 4);
+		M3 = _mm_add_epi32(M3, TMP);
+		M3 = _mm_sha256msg2_epu32(M3, M2);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M1 = _mm_sha256msg1_epu32(M1, M2);
+
+		// Rounds 28-31
+		MSG = _mm_add_epi32(M3, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[28])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M3, M2, 4);
+		M0 = _mm_add_epi32(M0, TMP);
+		M0 = _mm_sha256msg2_epu32(M0, M3);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M2 = _mm_sha256msg1_epu32(M2, M3);
+
+		// Rounds 32-35
+		MSG = _mm_add_epi32(M0, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[32])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M0, M3, 4);
+		M1 = _mm_add_epi32(M1, TMP);
+		M1 = _mm_sha256msg2_epu32(M1, M0);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M3 = _mm_sha256msg1_epu32(M3, M0);
+
+		// Rounds 36-39
+		MSG = _mm_add_epi32(M1, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[36])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M1, M0, 4);
+		M2 = _mm_add_epi32(M2, TMP);
+		M2 = _mm_sha256msg2_epu32(M2, M1);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M0 = _mm_sha256msg1_epu32(M0, M1);
+
+		// Rounds 40-43
+		MSG = _mm_add_epi32(M2, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[40])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M2, M1, 4);
+		M3 = _mm_add_epi32(M3, TMP);
+		M3 = _mm_sha256msg2_epu32(M3, M2);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M1 = _mm_sha256msg1_epu32(M1, M2);
+
+		// Rounds 44-47
+		MSG = _mm_add_epi32(M3, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[44])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M3, M2, 4);
+		M0 = _mm_add_epi32(M0, TMP);
+		M0 = _mm_sha256msg2_epu32(M0, M3);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M2 = _mm_sha256msg1_epu32(M2, M3);
+
+		// Rounds 48-51
+		MSG = _mm_add_epi32(M0, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[48])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M0, M3, 4);
+		M1 = _mm_add_epi32(M1, TMP);
+		M1 = _mm_sha256msg2_epu32(M1, M0);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+		M3 = _mm_sha256msg1_epu32(M3, M0);
+
+		// Rounds 52-55
+		MSG = _mm_add_epi32(M1, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[52])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M1, M0, 4);
+		M2 = _mm_add_epi32(M2, TMP);
+		M2 = _mm_sha256msg2_epu32(M2, M1);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+
+		// Rounds 56-59
+		MSG = _mm_add_epi32(M2, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[56])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		TMP = _mm_alignr_epi8(M2, M1, 4);
+		M3 = _mm_add_epi32(M3, TMP);
+		M3 = _mm_sha256msg2_epu32(M3, M2);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+
+		// Rounds 60-63
+		MSG = _mm_add_epi32(M3, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[60])));
+		S1 = _mm_sha256rnds2_epu32(S1, S0, MSG);
+		MSG = _mm_shuffle_epi32(MSG, 0x0E);
+		S0 = _mm_sha256rnds2_epu32(S0, S1, MSG);
+
+		// Combine state 
+		S0 = _mm_add_epi32(S0, T0);
+		S1 = _mm_add_epi32(S1, T1);
+
+		Input += BLOCK_SIZE;
+		--BlockCount;
+	}
+
+	TMP = _mm_shuffle_epi32(S0, 0x1B);   // FEBA
+	S1 = _mm_shuffle_epi32(S1, 0xB1);    // DCHG
+	S0 = _mm_blend_epi16(TMP, S1, 0xF0); // DCBA
+	S1 = _mm_alignr_epi8(S1, TMP, 8);    // ABEF
+
+	// Save state
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&State[0]), S0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(&State[4]), S1);
+}
+
+CEX_TARGET_ISA("sha,sse4.1,ssse3")
+static inline void LoadLaneSHANI(const uint* State, size_t Lane, __m128i &S0, __m128i &S1)
+{
+	CEX_ALIGN_DATA(16) uint lane[8];
+
+	for (size_t i = 0; i < 8; ++i)
+		lane[i] = State[(i * 2) + Lane];
+
+	__m128i TMP = _mm_load_si128(reinterpret_cast<const __m128i*>(&lane[0]));
+	S1 = _mm_load_si128(reinterpret_cast<const __m128i*>(&lane[4]));
+	TMP = _mm_shuffle_epi32(TMP, 0xB1);  // CDAB
+	S1 = _mm_shuffle_epi32(S1, 0x1B);    // EFGH
+	S0 = _mm_alignr_epi8(TMP, S1, 8);    // ABEF
+	S1 = _mm_blend_epi16(S1, TMP, 0xF0); // CDGH
+}
+
+CEX_TARGET_ISA("sha,sse4.1,ssse3")
+static inline void StoreLaneSHANI(__m128i S0, __m128i S1, size_t Lane, uint* State)
+{
+	CEX_ALIGN_DATA(16) uint lane[8];
+
+	__m128i TMP = _mm_shuffle_epi32(S0, 0x1B); // FEBA
+	S1 = _mm_shuffle_epi32(S1, 0xB1);          // DCHG
+	S0 = _mm_blend_epi16(TMP, S1, 0xF0);       // DCBA
+	S1 = _mm_alignr_epi8(S1, TMP, 8);          // ABEF
+	_mm_store_si128(reinterpret_cast<__m128i*>(&lane[0]), S0);
+	_mm_store_si128(reinterpret_cast<__m128i*>(&lane[4]), S1);
+
+	for (size_t i = 0; i < 8; ++i)
+		State[(i * 2) + Lane] = lane[i];
+}
+
+CEX_TARGET_ISA("sha,sse4.1,ssse3")
+void SHA256Compress::Compress64x2SHANI(const byte* const* Input, size_t BlockCount, uint* State)
+{
+	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i S0A, S1A, T0A, T1A, MSGA, TMPA, M0A, M1A, M2A, M3A;
+	__m128i S0B, S1B, T0B, T1B, MSGB, TMPB, M0B, M1B, M2B, M3B;
+
+	LoadLaneSHANI(State, 0, S0A, S1A);
+	LoadLaneSHANI(State, 1, S0B, S1B);
+
+	for (size_t blk = 0; blk < BlockCount; ++blk)
+	{
+		const size_t OFT = blk * BLOCK_SIZE;
+
+		// the two streams are independent; each instruction of one stream is paired with its twin,
+		// so the second stream's rounds issue while the first waits on the latency of sha256rnds2
+		T0A = S0A;
+		T0B = S0B;
+		T1A = S1A;
+		T1B = S1B;
+
+		// Rounds 0-3
+		MSGA = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[0] + OFT));
+		MSGB = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[1] + OFT));
+		M0A = _mm_shuffle_epi8(MSGA, MASK);
+		M0B = _mm_shuffle_epi8(MSGB, MASK);
+		MSGA = _mm_add_epi32(M0A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[0])));
+		MSGB = _mm_add_epi32(M0B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[0])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+
+		// Rounds 4-7
+		M1A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[0] + OFT + 16));
+		M1B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[1] + OFT + 16));
+		M1A = _mm_shuffle_epi8(M1A, MASK);
+		M1B = _mm_shuffle_epi8(M1B, MASK);
+		MSGA = _mm_add_epi32(M1A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[4])));
+		MSGB = _mm_add_epi32(M1B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[4])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M0A = _mm_sha256msg1_epu32(M0A, M1A);
+		M0B = _mm_sha256msg1_epu32(M0B, M1B);
+
+		// Rounds 8-11
+		M2A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[0] + OFT + 32));
+		M2B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[1] + OFT + 32));
+		M2A = _mm_shuffle_epi8(M2A, MASK);
+		M2B = _mm_shuffle_epi8(M2B, MASK);
+		MSGA = _mm_add_epi32(M2A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[8])));
+		MSGB = _mm_add_epi32(M2B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[8])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M1A = _mm_sha256msg1_epu32(M1A, M2A);
+		M1B = _mm_sha256msg1_epu32(M1B, M2B);
+
+		// Rounds 12-15
+		M3A = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[0] + OFT + 48));
+		M3B = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[1] + OFT + 48));
+		M3A = _mm_shuffle_epi8(M3A, MASK);
+		M3B = _mm_shuffle_epi8(M3B, MASK);
+		MSGA = _mm_add_epi32(M3A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[12])));
+		MSGB = _mm_add_epi32(M3B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[12])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M3A, M2A, 4);
+		TMPB = _mm_alignr_epi8(M3B, M2B, 4);
+		M0A = _mm_add_epi32(M0A, TMPA);
+		M0B = _mm_add_epi32(M0B, TMPB);
+		M0A = _mm_sha256msg2_epu32(M0A, M3A);
+		M0B = _mm_sha256msg2_epu32(M0B, M3B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M2A = _mm_sha256msg1_epu32(M2A, M3A);
+		M2B = _mm_sha256msg1_epu32(M2B, M3B);
+
+		// Rounds 16-19
+		MSGA = _mm_add_epi32(M0A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[16])));
+		MSGB = _mm_add_epi32(M0B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[16])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M0A, M3A, 4);
+		TMPB = _mm_alignr_epi8(M0B, M3B, 4);
+		M1A = _mm_add_epi32(M1A, TMPA);
+		M1B = _mm_add_epi32(M1B, TMPB);
+		M1A = _mm_sha256msg2_epu32(M1A, M0A);
+		M1B = _mm_sha256msg2_epu32(M1B, M0B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M3A = _mm_sha256msg1_epu32(M3A, M0A);
+		M3B = _mm_sha256msg1_epu32(M3B, M0B);
+
+		// Rounds 20-23
+		MSGA = _mm_add_epi32(M1A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[20])));
+		MSGB = _mm_add_epi32(M1B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[20])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M1A, M0A, 4);
+		TMPB = _mm_alignr_epi8(M1B, M0B, 4);
+		M2A = _mm_add_epi32(M2A, TMPA);
+		M2B = _mm_add_epi32(M2B, TMPB);
+		M2A = _mm_sha256msg2_epu32(M2A, M1A);
+		M2B = _mm_sha256msg2_epu32(M2B, M1B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M0A = _mm_sha256msg1_epu32(M0A, M1A);
+		M0B = _mm_sha256msg1_epu32(M0B, M1B);
+
+		// Rounds 24-27
+		MSGA = _mm_add_epi32(M2A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[24])));
+		MSGB = _mm_add_epi32(M2B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[24])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M2A, M1A, 4);
+		TMPB = _mm_alignr_epi8(M2B, M1B, 4);
+		M3A = _mm_add_epi32(M3A, TMPA);
+		M3B = _mm_add_epi32(M3B, TMPB);
+		M3A = _mm_sha256msg2_epu32(M3A, M2A);
+		M3B = _mm_sha256msg2_epu32(M3B, M2B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M1A = _mm_sha256msg1_epu32(M1A, M2A);
+		M1B = _mm_sha256msg1_epu32(M1B, M2B);
+
+		// Rounds 28-31
+		MSGA = _mm_add_epi32(M3A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[28])));
+		MSGB = _mm_add_epi32(M3B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[28])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M3A, M2A, 4);
+		TMPB = _mm_alignr_epi8(M3B, M2B, 4);
+		M0A = _mm_add_epi32(M0A, TMPA);
+		M0B = _mm_add_epi32(M0B, TMPB);
+		M0A = _mm_sha256msg2_epu32(M0A, M3A);
+		M0B = _mm_sha256msg2_epu32(M0B, M3B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M2A = _mm_sha256msg1_epu32(M2A, M3A);
+		M2B = _mm_sha256msg1_epu32(M2B, M3B);
+
+		// Rounds 32-35
+		MSGA = _mm_add_epi32(M0A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[32])));
+		MSGB = _mm_add_epi32(M0B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[32])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M0A, M3A, 4);
+		TMPB = _mm_alignr_epi8(M0B, M3B, 4);
+		M1A = _mm_add_epi32(M1A, TMPA);
+		M1B = _mm_add_epi32(M1B, TMPB);
+		M1A = _mm_sha256msg2_epu32(M1A, M0A);
+		M1B = _mm_sha256msg2_epu32(M1B, M0B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M3A = _mm_sha256msg1_epu32(M3A, M0A);
+		M3B = _mm_sha256msg1_epu32(M3B, M0B);
+
+		// Rounds 36-39
+		MSGA = _mm_add_epi32(M1A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[36])));
+		MSGB = _mm_add_epi32(M1B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[36])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M1A, M0A, 4);
+		TMPB = _mm_alignr_epi8(M1B, M0B, 4);
+		M2A = _mm_add_epi32(M2A, TMPA);
+		M2B = _mm_add_epi32(M2B, TMPB);
+		M2A = _mm_sha256msg2_epu32(M2A, M1A);
+		M2B = _mm_sha256msg2_epu32(M2B, M1B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M0A = _mm_sha256msg1_epu32(M0A, M1A);
+		M0B = _mm_sha256msg1_epu32(M0B, M1B);
+
+		// Rounds 40-43
+		MSGA = _mm_add_epi32(M2A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[40])));
+		MSGB = _mm_add_epi32(M2B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[40])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M2A, M1A, 4);
+		TMPB = _mm_alignr_epi8(M2B, M1B, 4);
+		M3A = _mm_add_epi32(M3A, TMPA);
+		M3B = _mm_add_epi32(M3B, TMPB);
+		M3A = _mm_sha256msg2_epu32(M3A, M2A);
+		M3B = _mm_sha256msg2_epu32(M3B, M2B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M1A = _mm_sha256msg1_epu32(M1A, M2A);
+		M1B = _mm_sha256msg1_epu32(M1B, M2B);
+
+		// Rounds 44-47
+		MSGA = _mm_add_epi32(M3A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[44])));
+		MSGB = _mm_add_epi32(M3B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[44])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M3A, M2A, 4);
+		TMPB = _mm_alignr_epi8(M3B, M2B, 4);
+		M0A = _mm_add_epi32(M0A, TMPA);
+		M0B = _mm_add_epi32(M0B, TMPB);
+		M0A = _mm_sha256msg2_epu32(M0A, M3A);
+		M0B = _mm_sha256msg2_epu32(M0B, M3B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M2A = _mm_sha256msg1_epu32(M2A, M3A);
+		M2B = _mm_sha256msg1_epu32(M2B, M3B);
+
+		// Rounds 48-51
+		MSGA = _mm_add_epi32(M0A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[48])));
+		MSGB = _mm_add_epi32(M0B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[48])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M0A, M3A, 4);
+		TMPB = _mm_alignr_epi8(M0B, M3B, 4);
+		M1A = _mm_add_epi32(M1A, TMPA);
+		M1B = _mm_add_epi32(M1B, TMPB);
+		M1A = _mm_sha256msg2_epu32(M1A, M0A);
+		M1B = _mm_sha256msg2_epu32(M1B, M0B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+		M3A = _mm_sha256msg1_epu32(M3A, M0A);
+		M3B = _mm_sha256msg1_epu32(M3B, M0B);
+
+		// Rounds 52-55
+		MSGA = _mm_add_epi32(M1A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[52])));
+		MSGB = _mm_add_epi32(M1B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[52])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M1A, M0A, 4);
+		TMPB = _mm_alignr_epi8(M1B, M0B, 4);
+		M2A = _mm_add_epi32(M2A, TMPA);
+		M2B = _mm_add_epi32(M2B, TMPB);
+		M2A = _mm_sha256msg2_epu32(M2A, M1A);
+		M2B = _mm_sha256msg2_epu32(M2B, M1B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+
+		// Rounds 56-59
+		MSGA = _mm_add_epi32(M2A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[56])));
+		MSGB = _mm_add_epi32(M2B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[56])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		TMPA = _mm_alignr_epi8(M2A, M1A, 4);
+		TMPB = _mm_alignr_epi8(M2B, M1B, 4);
+		M3A = _mm_add_epi32(M3A, TMPA);
+		M3B = _mm_add_epi32(M3B, TMPB);
+		M3A = _mm_sha256msg2_epu32(M3A, M2A);
+		M3B = _mm_sha256msg2_epu32(M3B, M2B);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+
+		// Rounds 60-63
+		MSGA = _mm_add_epi32(M3A, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[60])));
+		MSGB = _mm_add_epi32(M3B, _mm_load_si128(reinterpret_cast<const __m128i*>(&SHA256_K[60])));
+		S1A = _mm_sha256rnds2_epu32(S1A, S0A, MSGA);
+		S1B = _mm_sha256rnds2_epu32(S1B, S0B, MSGB);
+		MSGA = _mm_shuffle_epi32(MSGA, 0x0E);
+		MSGB = _mm_shuffle_epi32(MSGB, 0x0E);
+		S0A = _mm_sha256rnds2_epu32(S0A, S1A, MSGA);
+		S0B = _mm_sha256rnds2_epu32(S0B, S1B, MSGB);
+
+		S0A = _mm_add_epi32(S0A, T0A);
+		S0B = _mm_add_epi32(S0B, T0B);
+		S1A = _mm_add_epi32(S1A, T1A);
+		S1B = _mm_add_epi32(S1B, T1B);
+	}
+
+	StoreLaneSHANI(S0A, S1A, 0, State);
+	StoreLaneSHANI(S0B, S1B, 1, State);
+}
+
+#else
+
+void SHA256Compress::Compress64SHANI(const byte* Input, size_t BlockCount, std::array<uint, 8> &State)
+{
+	Compress64(Input, BlockCount, State);
+}
+
+void SHA256Compress::Compress64x2SHANI(const byte* const* Input, size_t BlockCount, uint* State)
+{
+	Compress64xN<2>(Input, BlockCount, State);
+}
+
+#endif
+
+NAMESPACE_DIGESTEND
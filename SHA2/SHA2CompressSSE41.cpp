@@ -0,0 +1,243 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#include "SHA256Compress.h"
+#include "SHA512Compress.h"
+#include "Intrinsics.h"
+
+NAMESPACE_DIGEST
+
+#if defined(CEX_ARCH_X86_X64)
+
+CEX_TARGET_ISA("sse4.1")
+static inline __m128i RotR32x4(__m128i X, int N)
+{
+	return _mm_or_si128(_mm_srli_epi32(X, N), _mm_slli_epi32(X, 32 - N));
+}
+
+// one round on four independent states, one state per 32 bit lane
+#define SSE41_ROUND256X4(A, B, C, D, E, F, G, H, W, K)																\
+do {																												\
+	__m128i R0 = _mm_add_epi32(_mm_add_epi32(H, _mm_xor_si128(_mm_xor_si128(RotR32x4(E, 6), RotR32x4(E, 11)), RotR32x4(E, 25))),	\
+		_mm_add_epi32(_mm_xor_si128(_mm_and_si128(E, F), _mm_andnot_si128(E, G)), _mm_add_epi32(W, _mm_set1_epi32(K))));			\
+	D = _mm_add_epi32(D, R0);																						\
+	H = _mm_add_epi32(R0, _mm_add_epi32(_mm_xor_si128(_mm_xor_si128(RotR32x4(A, 2), RotR32x4(A, 13)), RotR32x4(A, 22)),			\
+		_mm_or_si128(_mm_and_si128(A, B), _mm_and_si128(C, _mm_or_si128(A, B)))));									\
+} while (0)
+
+CEX_TARGET_ISA("sse4.1")
+static inline void Transpose4x4(__m128i* R)
+{
+	__m128i T0 = _mm_unpacklo_epi32(R[0], R[1]);
+	__m128i T1 = _mm_unpackhi_epi32(R[0], R[1]);
+	__m128i T2 = _mm_unpacklo_epi32(R[2], R[3]);
+	__m128i T3 = _mm_unpackhi_epi32(R[2], R[3]);
+
+	R[0] = _mm_unpacklo_epi64(T0, T2);
+	R[1] = _mm_unpackhi_epi64(T0, T2);
+	R[2] = _mm_unpacklo_epi64(T1, T3);
+	R[3] = _mm_unpackhi_epi64(T1, T3);
+}
+
+CEX_TARGET_ISA("sse4.1")
+void SHA256Compress::Compress64x4(const byte* const* Input, size_t BlockCount, uint* State)
+{
+	const __m128i MASK = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+	__m128i S[8];
+	__m128i W[16];
+
+	for (size_t i = 0; i < 8; ++i)
+		S[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(State + (i * 4)));
+
+	for (size_t blk = 0; blk < BlockCount; ++blk)
+	{
+		const size_t OFT = blk * BLOCK_SIZE;
+
+		// load four words of each lane per row, then transpose so that W[t] holds word t of all four messages
+		for (size_t i = 0; i < 4; ++i)
+		{
+			for (size_t j = 0; j < 4; ++j)
+				W[(i * 4) + j] = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[j] + OFT + (i * 16))), MASK);
+
+			Transpose4x4(&W[i * 4]);
+		}
+
+		__m128i A = S[0];
+		__m128i B = S[1];
+		__m128i C = S[2];
+		__m128i D = S[3];
+		__m128i E = S[4];
+		__m128i F = S[5];
+		__m128i G = S[6];
+		__m128i H = S[7];
+
+		for (size_t i = 0; i < 64; i += 16)
+		{
+			if (i != 0)
+			{
+				for (size_t j = 0; j < 16; ++j)
+				{
+					__m128i X = W[(j + 14) & 15];
+					__m128i Y = W[(j + 1) & 15];
+					X = _mm_xor_si128(_mm_xor_si128(RotR32x4(X, 17), RotR32x4(X, 19)), _mm_srli_epi32(X, 10));
+					Y = _mm_xor_si128(_mm_xor_si128(RotR32x4(Y, 7), RotR32x4(Y, 18)), _mm_srli_epi32(Y, 3));
+					W[j] = _mm_add_epi32(_mm_add_epi32(W[j], X), _mm_add_epi32(W[(j + 9) & 15], Y));
+				}
+			}
+
+			SSE41_ROUND256X4(A, B, C, D, E, F, G, H, W[0], SHA256_K[i]);
+			SSE41_ROUND256X4(H, A, B, C, D, E, F, G, W[1], SHA256_K[i + 1]);
+			SSE41_ROUND256X4(G, H, A, B, C, D, E, F, W[2], SHA256_K[i + 2]);
+			SSE41_ROUND256X4(F, G, H, A, B, C, D, E, W[3], SHA256_K[i + 3]);
+			SSE41_ROUND256X4(E, F, G, H, A, B, C, D, W[4], SHA256_K[i + 4]);
+			SSE41_ROUND256X4(D, E, F, G, H, A, B, C, W[5], SHA256_K[i + 5]);
+			SSE41_ROUND256X4(C, D, E, F, G, H, A, B, W[6], SHA256_K[i + 6]);
+			SSE41_ROUND256X4(B, C, D, E, F, G, H, A, W[7], SHA256_K[i + 7]);
+			SSE41_ROUND256X4(A, B, C, D, E, F, G, H, W[8], SHA256_K[i + 8]);
+			SSE41_ROUND256X4(H, A, B, C, D, E, F, G, W[9], SHA256_K[i + 9]);
+			SSE41_ROUND256X4(G, H, A, B, C, D, E, F, W[10], SHA256_K[i + 10]);
+			SSE41_ROUND256X4(F, G, H, A, B, C, D, E, W[11], SHA256_K[i + 11]);
+			SSE41_ROUND256X4(E, F, G, H, A, B, C, D, W[12], SHA256_K[i + 12]);
+			SSE41_ROUND256X4(D, E, F, G, H, A, B, C, W[13], SHA256_K[i + 13]);
+			SSE41_ROUND256X4(C, D, E, F, G, H, A, B, W[14], SHA256_K[i + 14]);
+			SSE41_ROUND256X4(B, C, D, E, F, G, H, A, W[15], SHA256_K[i + 15]);
+		}
+
+		S[0] = _mm_add_epi32(S[0], A);
+		S[1] = _mm_add_epi32(S[1], B);
+		S[2] = _mm_add_epi32(S[2], C);
+		S[3] = _mm_add_epi32(S[3], D);
+		S[4] = _mm_add_epi32(S[4], E);
+		S[5] = _mm_add_epi32(S[5], F);
+		S[6] = _mm_add_epi32(S[6], G);
+		S[7] = _mm_add_epi32(S[7], H);
+	}
+
+	for (size_t i = 0; i < 8; ++i)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(State + (i * 4)), S[i]);
+}
+
+CEX_TARGET_ISA("sse4.1")
+static inline __m128i RotR64x2(__m128i X, int N)
+{
+	return _mm_or_si128(_mm_srli_epi64(X, N), _mm_slli_epi64(X, 64 - N));
+}
+
+// one round on two independent states, one state per 64 bit lane
+#define SSE41_ROUND512X2(A, B, C, D, E, F, G, H, W, K)																\
+do {																												\
+	__m128i R0 = _mm_add_epi64(_mm_add_epi64(H, _mm_xor_si128(_mm_xor_si128(RotR64x2(E, 14), RotR64x2(E, 18)), RotR64x2(E, 41))),	\
+		_mm_add_epi64(_mm_xor_si128(_mm_and_si128(E, F), _mm_andnot_si128(E, G)), _mm_add_epi64(W, _mm_set1_epi64x(static_cast<long long>(K)))));	\
+	D = _mm_add_epi64(D, R0);																						\
+	H = _mm_add_epi64(R0, _mm_add_epi64(_mm_xor_si128(_mm_xor_si128(RotR64x2(A, 28), RotR64x2(A, 34)), RotR64x2(A, 39)),			\
+		_mm_or_si128(_mm_and_si128(A, B), _mm_and_si128(C, _mm_or_si128(A, B)))));									\
+} while (0)
+
+CEX_TARGET_ISA("sse4.1")
+void SHA512Compress::Compress128x2(const byte* const* Input, size_t BlockCount, ulong* State)
+{
+	const __m128i MASK = _mm_set_epi64x(0x08090a0b0c0d0e0fULL, 0x0001020304050607ULL);
+	__m128i S[8];
+	__m128i W[16];
+
+	for (size_t i = 0; i < 8; ++i)
+		S[i] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(State + (i * 2)));
+
+	for (size_t blk = 0; blk < BlockCount; ++blk)
+	{
+		const size_t OFT = blk * BLOCK_SIZE;
+
+		// load two words of each lane per row, then interleave so that W[t] holds word t of both messages
+		for (size_t i = 0; i < 8; ++i)
+		{
+			__m128i X0 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[0] + OFT + (i * 16))), MASK);
+			__m128i X1 = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Input[1] + OFT + (i * 16))), MASK);
+			W[i * 2] = _mm_unpacklo_epi64(X0, X1);
+			W[(i * 2) + 1] = _mm_unpackhi_epi64(X0, X1);
+		}
+
+		__m128i A = S[0];
+		__m128i B = S[1];
+		__m128i C = S[2];
+		__m128i D = S[3];
+		__m128i E = S[4];
+		__m128i F = S[5];
+		__m128i G = S[6];
+		__m128i H = S[7];
+
+		for (size_t i = 0; i < 80; i += 16)
+		{
+			if (i != 0)
+			{
+				for (size_t j = 0; j < 16; ++j)
+				{
+					__m128i X = W[(j + 14) & 15];
+					__m128i Y = W[(j + 1) & 15];
+					X = _mm_xor_si128(_mm_xor_si128(RotR64x2(X, 19), RotR64x2(X, 61)), _mm_srli_epi64(X, 6));
+					Y = _mm_xor_si128(_mm_xor_si128(RotR64x2(Y, 1), RotR64x2(Y, 8)), _mm_srli_epi64(Y, 7));
+					W[j] = _mm_add_epi64(_mm_add_epi64(W[j], X), _mm_add_epi64(W[(j + 9) & 15], Y));
+				}
+			}
+
+			SSE41_ROUND512X2(A, B, C, D, E, F, G, H, W[0], SHA512_K[i]);
+			SSE41_ROUND512X2(H, A, B, C, D, E, F, G, W[1], SHA512_K[i + 1]);
+			SSE41_ROUND512X2(G, H, A, B, C, D, E, F, W[2], SHA512_K[i + 2]);
+			SSE41_ROUND512X2(F, G, H, A, B, C, D, E, W[3], SHA512_K[i + 3]);
+			SSE41_ROUND512X2(E, F, G, H, A, B, C, D, W[4], SHA512_K[i + 4]);
+			SSE41_ROUND512X2(D, E, F, G, H, A, B, C, W[5], SHA512_K[i + 5]);
+			SSE41_ROUND512X2(C, D, E, F, G, H, A, B, W[6], SHA512_K[i + 6]);
+			SSE41_ROUND512X2(B, C, D, E, F, G, H, A, W[7], SHA512_K[i + 7]);
+			SSE41_ROUND512X2(A, B, C, D, E, F, G, H, W[8], SHA512_K[i + 8]);
+			SSE41_ROUND512X2(H, A, B, C, D, E, F, G, W[9], SHA512_K[i + 9]);
+			SSE41_ROUND512X2(G, H, A, B, C, D, E, F, W[10], SHA512_K[i + 10]);
+			SSE41_ROUND512X2(F, G, H, A, B, C, D, E, W[11], SHA512_K[i + 11]);
+			SSE41_ROUND512X2(E, F, G, H, A, B, C, D, W[12], SHA512_K[i + 12]);
+			SSE41_ROUND512X2(D, E, F, G, H, A, B, C, W[13], SHA512_K[i + 13]);
+			SSE41_ROUND512X2(C, D, E, F, G, H, A, B, W[14], SHA512_K[i + 14]);
+			SSE41_ROUND512X2(B, C, D, E, F, G, H, A, W[15], SHA512_K[i + 15]);
+		}
+
+		S[0] = _mm_add_epi64(S[0], A);
+		S[1] = _mm_add_epi64(S[1], B);
+		S[2] = _mm_add_epi64(S[2], C);
+		S[3] = _mm_add_epi64(S[3], D);
+		S[4] = _mm_add_epi64(S[4], E);
+		S[5] = _mm_add_epi64(S[5], F);
+		S[6] = _mm_add_epi64(S[6], G);
+		S[7] = _mm_add_epi64(S[7], H);
+	}
+
+	for (size_t i = 0; i < 8; ++i)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(State + (i * 2)), S[i]);
+}
+
+#else
+
+void SHA256Compress::Compress64x4(const byte* const* Input, size_t BlockCount, uint* State)
+{
+	Compress64xN<4>(Input, BlockCount, State);
+}
+
+void SHA512Compress::Compress128x2(const byte* const* Input, size_t BlockCount, ulong* State)
+{
+	Compress128xN<2>(Input, BlockCount, State);
+}
+
+#endif
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,279 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _CEX_SHA2CONSTEXPR_H
+#define _CEX_SHA2CONSTEXPR_H
+
+#include "CexDomain.h"
+#include "SHA256Compress.h"
+#include "SHA512Compress.h"
+
+NAMESPACE_DIGEST
+
+/// <summary>
+/// A SHA-2 hash value that can be produced and compared in a constant expression
+/// </summary>
+///
+/// <typeparam name="Size">The hash size in bytes</typeparam>
+template <size_t Size>
+struct SHA2Hash
+{
+	/// <summary>
+	/// The hash bytes
+	/// </summary>
+	byte Bytes[Size];
+
+	/// <summary>
+	/// Get a byte of the hash
+	/// </summary>
+	constexpr byte operator[](size_t Index) const
+	{
+		return Bytes[Index];
+	}
+
+	/// <summary>
+	/// Compare two hashes
+	/// </summary>
+	CEX_CONSTEXPR14 bool operator==(const SHA2Hash &Other) const
+	{
+		for (size_t i = 0; i < Size; ++i)
+		{
+			if (Bytes[i] != Other.Bytes[i])
+				return false;
+		}
+
+		return true;
+	}
+
+	/// <summary>
+	/// Compare two hashes
+	/// </summary>
+	CEX_CONSTEXPR14 bool operator!=(const SHA2Hash &Other) const
+	{
+		return !(*this == Other);
+	}
+};
+
+/// <summary>
+/// Compile-time SHA-256 and SHA-512 digests of constant messages
+/// </summary>
+/// 
+/// <example>
+/// <description>Folding the digest of a domain separation label into the binary, and checking a hash at compile time:</description>
+/// <code>
+/// constexpr SHA2Hash&lt;32&gt; LABEL = SHA2Constexpr::Compute256("example.com/v1/signing");
+/// constexpr SHA2Hash&lt;32&gt; EMPTY = SHA2Constexpr::Compute256("");
+/// static_assert(EMPTY[0] == 0xE3 &amp;&amp; EMPTY[31] == 0x55, "unexpected hash");
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>The digests are built on SHA256Compress::CompressConstexpr and SHA512Compress::CompressConstexpr, which share the round functions and the 
+/// round constant tables (SHA2Constants.h) with the runtime kernels. The output is the standard SHA-256 or SHA-512 hash of the message.</para>
+/// <para>Evaluating a hash at compile time requires relaxed constexpr support (CEX_HAS_CONSTEXPR14; c++14, or vs2017 and later). 
+/// Otherwise the functions are compiled inline and evaluated at runtime, with the portable rounds; the SHA256 and SHA512 classes are faster for runtime input.</para>
+/// <para>String literal arguments are hashed without their terminating null.</para>
+/// </remarks>
+class SHA2Constexpr
+{
+public:
+
+	/// <summary>
+	/// Get the SHA-256 hash of a message
+	/// </summary>
+	///
+	/// <param name="Message">The message bytes</param>
+	/// <param name="Length">The message length in bytes</param>
+	///
+	/// <returns>The 32 byte hash</returns>
+	static CEX_CONSTEXPR14 SHA2Hash<32> Compute256(const byte* Message, size_t Length)
+	{
+		return Hash256(Message, Length);
+	}
+
+	/// <summary>
+	/// Get the SHA-256 hash of a character string
+	/// </summary>
+	///
+	/// <param name="Message">The message characters</param>
+	/// <param name="Length">The message length in characters</param>
+	///
+	/// <returns>The 32 byte hash</returns>
+	static CEX_CONSTEXPR14 SHA2Hash<32> Compute256(const char* Message, size_t Length)
+	{
+		return Hash256(Message, Length);
+	}
+
+	/// <summary>
+	/// Get the SHA-256 hash of a string literal, excluding its terminating null
+	/// </summary>
+	///
+	/// <param name="Message">The string literal</param>
+	///
+	/// <returns>The 32 byte hash</returns>
+	template <size_t Length>
+	static CEX_CONSTEXPR14 SHA2Hash<32> Compute256(const char(&Message)[Length])
+	{
+		return Hash256(Message, Length - 1);
+	}
+
+	/// <summary>
+	/// Get the SHA-512 hash of a message
+	/// </summary>
+	///
+	/// <param name="Message">The message bytes</param>
+	/// <param name="Length">The message length in bytes</param>
+	///
+	/// <returns>The 64 byte hash</returns>
+	static CEX_CONSTEXPR14 SHA2Hash<64> Compute512(const byte* Message, size_t Length)
+	{
+		return Hash512(Message, Length);
+	}
+
+	/// <summary>
+	/// Get the SHA-512 hash of a character string
+	/// </summary>
+	///
+	/// <param name="Message">The message characters</param>
+	/// <param name="Length">The message length in characters</param>
+	///
+	/// <returns>The 64 byte hash</returns>
+	static CEX_CONSTEXPR14 SHA2Hash<64> Compute512(const char* Message, size_t Length)
+	{
+		return Hash512(Message, Length);
+	}
+
+	/// <summary>
+	/// Get the SHA-512 hash of a string literal, excluding its terminating null
+	/// </summary>
+	///
+	/// <param name="Message">The string literal</param>
+	///
+	/// <returns>The 64 byte hash</returns>
+	template <size_t Length>
+	static CEX_CONSTEXPR14 SHA2Hash<64> Compute512(const char(&Message)[Length])
+	{
+		return Hash512(Message, Length - 1);
+	}
+
+private:
+
+	template <typename T>
+	static CEX_CONSTEXPR14 SHA2Hash<32> Hash256(const T* Message, size_t Length)
+	{
+		SHA2Hash<32> hash = {};
+		uint state[8] = {};
+		byte block[64] = {};
+		size_t pos = 0;
+
+		for (size_t i = 0; i < 8; ++i)
+			state[i] = SHA256_IV[i];
+
+		while (Length - pos >= 64)
+		{
+			for (size_t i = 0; i < 64; ++i)
+				block[i] = static_cast<byte>(Message[pos + i]);
+
+			SHA256Compress::CompressConstexpr(block, state);
+			pos += 64;
+		}
+
+		const size_t RMDLEN = Length - pos;
+		const ulong BITLEN = static_cast<ulong>(Length) << 3;
+
+		for (size_t i = 0; i < 64; ++i)
+			block[i] = (i < RMDLEN) ? static_cast<byte>(Message[pos + i]) : 0;
+
+		block[RMDLEN] = 0x80;
+
+		// no room for the length; it goes into an additional block
+		if (RMDLEN >= 56)
+		{
+			SHA256Compress::CompressConstexpr(block, state);
+
+			for (size_t i = 0; i < 64; ++i)
+				block[i] = 0;
+		}
+
+		for (size_t i = 0; i < 8; ++i)
+			block[56 + i] = static_cast<byte>(BITLEN >> (56 - (i * 8)));
+
+		SHA256Compress::CompressConstexpr(block, state);
+
+		for (size_t i = 0; i < 32; ++i)
+			hash.Bytes[i] = static_cast<byte>(state[i / 4] >> (24 - ((i % 4) * 8)));
+
+		return hash;
+	}
+
+	template <typename T>
+	static CEX_CONSTEXPR14 SHA2Hash<64> Hash512(const T* Message, size_t Length)
+	{
+		SHA2Hash<64> hash = {};
+		ulong state[8] = {};
+		byte block[128] = {};
+		size_t pos = 0;
+
+		for (size_t i = 0; i < 8; ++i)
+			state[i] = SHA512_IV[i];
+
+		while (Length - pos >= 128)
+		{
+			for (size_t i = 0; i < 128; ++i)
+				block[i] = static_cast<byte>(Message[pos + i]);
+
+			SHA512Compress::CompressConstexpr(block, state);
+			pos += 128;
+		}
+
+		const size_t RMDLEN = Length - pos;
+		const ulong BITLEN = static_cast<ulong>(Length) << 3;
+		const ulong BITHGH = static_cast<ulong>(Length) >> 61;
+
+		for (size_t i = 0; i < 128; ++i)
+			block[i] = (i < RMDLEN) ? static_cast<byte>(Message[pos + i]) : 0;
+
+		block[RMDLEN] = 0x80;
+
+		// no room for the 128 bit length; it goes into an additional block
+		if (RMDLEN >= 112)
+		{
+			SHA512Compress::CompressConstexpr(block, state);
+
+			for (size_t i = 0; i < 128; ++i)
+				block[i] = 0;
+		}
+
+		for (size_t i = 0; i < 8; ++i)
+		{
+			block[112 + i] = static_cast<byte>(BITHGH >> (56 - (i * 8)));
+			block[120 + i] = static_cast<byte>(BITLEN >> (56 - (i * 8)));
+		}
+
+		SHA512Compress::CompressConstexpr(block, state);
+
+		for (size_t i = 0; i < 64; ++i)
+			hash.Bytes[i] = static_cast<byte>(state[i / 8] >> (56 - ((i % 8) * 8)));
+
+		return hash;
+	}
+};
+
+NAMESPACE_DIGESTEND
+#endif
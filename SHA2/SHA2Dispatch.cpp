@@ -0,0 +1,362 @@
+#include "SHA2Dispatch.h"
+#include "CpuDetect.h"
+#include "CryptoDigestException.h"
+#include "SHA256Compress.h"
+#include "SHA512Compress.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+
+NAMESPACE_DIGEST
+
+using Common::CpuDetect;
+using Exception::CryptoDigestException;
+
+//~~~Registry~~~//
+
+struct SHA2Dispatch::Registry
+{
+	bool HasAVX;
+	bool HasAVX2;
+	bool HasBMI2;
+	bool HasSHANI;
+	bool HasSSE41;
+	std::atomic<Compress256Func> Active256;
+	std::atomic<Compress256LanesFunc> ActiveLanes256;
+	std::atomic<Compress512Func> Active512;
+	std::atomic<Compress512LanesFunc> ActiveLanes512;
+	std::atomic<SHA2Kernels> Kernel256;
+	std::atomic<SHA2Kernels> Kernel512;
+
+	Registry();
+	void Activate256(SHA2Kernels Kernel);
+	void Activate512(SHA2Kernels Kernel);
+	SHA2Kernels Best256() const;
+	SHA2Kernels Best512() const;
+	bool Supports256(SHA2Kernels Kernel) const;
+	bool Supports512(SHA2Kernels Kernel) const;
+};
+
+static SHA2Kernels KernelFromEnvironment(const char* Name)
+{
+	std::string value;
+
+#if defined(CEX_COMPILER_MSC)
+	char* env = nullptr;
+	size_t len = 0;
+	if (_dupenv_s(&env, &len, Name) == 0 && env != nullptr)
+	{
+		value = env;
+		free(env);
+	}
+#else
+	const char* env = std::getenv(Name);
+	if (env != nullptr)
+		value = env;
+#endif
+
+	std::transform(value.begin(), value.end(), value.begin(), [](char C) { return static_cast<char>(::tolower(C)); });
+
+	if (value == "scalar")
+		return SHA2Kernels::Scalar;
+	else if (value == "bmi2")
+		return SHA2Kernels::BMI2;
+	else if (value == "avx")
+		return SHA2Kernels::AVX;
+	else if (value == "avx2")
+		return SHA2Kernels::AVX2;
+	else if (value == "shani" || value == "sha-ni")
+		return SHA2Kernels::SHANI;
+
+	return SHA2Kernels::Auto;
+}
+
+SHA2Dispatch::Registry::Registry()
+	:
+	HasAVX(false),
+	HasAVX2(false),
+	HasBMI2(false),
+	HasSHANI(false),
+	HasSSE41(false),
+	Active256(&SHA256Compress::Compress64),
+	ActiveLanes256(nullptr),
+	Active512(&SHA512Compress::Compress128),
+	ActiveLanes512(nullptr),
+	Kernel256(SHA2Kernels::Scalar),
+	Kernel512(SHA2Kernels::Scalar)
+{
+#if defined(CEX_ARCH_X86_X64)
+	CpuDetect detect;
+	HasBMI2 = detect.BMT2();
+	HasAVX = detect.AVX() && HasBMI2;
+	HasAVX2 = HasAVX && detect.AVX2();
+	HasSHANI = detect.SHA() && detect.SSE41();
+	HasSSE41 = detect.SSE41();
+#endif
+
+	SHA2Kernels kernel = KernelFromEnvironment("CEX_SHA256_KERNEL");
+	Activate256(Supports256(kernel) ? kernel : SHA2Kernels::Auto);
+	kernel = KernelFromEnvironment("CEX_SHA512_KERNEL");
+	Activate512(Supports512(kernel) ? kernel : SHA2Kernels::Auto);
+}
+
+void SHA2Dispatch::Registry::Activate256(SHA2Kernels Kernel)
+{
+	// a forced scalar kernel disables the multi-buffer path as well, so that A/B runs compare the portable code
+	const bool FRCSCL = (Kernel == SHA2Kernels::Scalar);
+
+	if (Kernel == SHA2Kernels::Auto)
+		Kernel = Best256();
+
+	Compress256Func func;
+	Compress256LanesFunc lanesFunc = nullptr;
+
+	// sha-ni on two interleaved messages outruns eight simd lanes
+	if (Kernel == SHA2Kernels::SHANI)
+	{
+		lanesFunc = &SHA256Compress::Compress64x2SHANI;
+	}
+	else if (!FRCSCL)
+	{
+		if (HasAVX2)
+			lanesFunc = &SHA256Compress::Compress64x8;
+		else if (HasSSE41)
+			lanesFunc = &SHA256Compress::Compress64x4;
+	}
+
+	switch (Kernel)
+	{
+		case SHA2Kernels::SHANI:
+			func = &SHA256Compress::Compress64SHANI;
+			break;
+		case SHA2Kernels::AVX2:
+			func = &SHA256Compress::Compress64AVX2;
+			break;
+		case SHA2Kernels::AVX:
+			func = &SHA256Compress::Compress64AVX;
+			break;
+		case SHA2Kernels::BMI2:
+			func = &SHA256Compress::Compress64BMI2;
+			break;
+		default:
+			func = &SHA256Compress::Compress64;
+			break;
+	}
+
+	Active256.store(func);
+	ActiveLanes256.store(lanesFunc);
+	Kernel256.store(Kernel);
+}
+
+void SHA2Dispatch::Registry::Activate512(SHA2Kernels Kernel)
+{
+	const bool FRCSCL = (Kernel == SHA2Kernels::Scalar);
+
+	if (Kernel == SHA2Kernels::Auto)
+		Kernel = Best512();
+
+	Compress512Func func;
+	Compress512LanesFunc lanesFunc = nullptr;
+
+	if (!FRCSCL)
+	{
+		if (HasAVX2)
+			lanesFunc = &SHA512Compress::Compress128x4;
+		else if (HasSSE41)
+			lanesFunc = &SHA512Compress::Compress128x2;
+	}
+
+	switch (Kernel)
+	{
+		case SHA2Kernels::AVX2:
+			func = &SHA512Compress::Compress128AVX2;
+			break;
+		case SHA2Kernels::BMI2:
+			func = &SHA512Compress::Compress128BMI2;
+			break;
+		default:
+			func = &SHA512Compress::Compress128;
+			break;
+	}
+
+	Active512.store(func);
+	ActiveLanes512.store(lanesFunc);
+	Kernel512.store(Kernel);
+}
+
+SHA2Kernels SHA2Dispatch::Registry::Best256() const
+{
+	if (HasSHANI)
+		return SHA2Kernels::SHANI;
+	else if (HasAVX2)
+		return SHA2Kernels::AVX2;
+	else if (HasAVX)
+		return SHA2Kernels::AVX;
+	else if (HasBMI2)
+		return SHA2Kernels::BMI2;
+
+	return SHA2Kernels::Scalar;
+}
+
+SHA2Kernels SHA2Dispatch::Registry::Best512() const
+{
+	// the rorx rounds are only a gain with 64 bit registers
+#if defined(CEX_ARCH_X64)
+	if (HasAVX2)
+		return SHA2Kernels::AVX2;
+	else if (HasBMI2)
+		return SHA2Kernels::BMI2;
+#endif
+
+	return SHA2Kernels::Scalar;
+}
+
+bool SHA2Dispatch::Registry::Supports256(SHA2Kernels Kernel) const
+{
+	switch (Kernel)
+	{
+		case SHA2Kernels::Auto:
+		case SHA2Kernels::Scalar:
+			return true;
+		case SHA2Kernels::BMI2:
+			return HasBMI2;
+		case SHA2Kernels::AVX:
+			return HasAVX;
+		case SHA2Kernels::AVX2:
+			return HasAVX2;
+		case SHA2Kernels::SHANI:
+			return HasSHANI;
+		default:
+			return false;
+	}
+}
+
+bool SHA2Dispatch::Registry::Supports512(SHA2Kernels Kernel) const
+{
+	switch (Kernel)
+	{
+		case SHA2Kernels::Auto:
+		case SHA2Kernels::Scalar:
+			return true;
+		case SHA2Kernels::BMI2:
+			return HasBMI2;
+		case SHA2Kernels::AVX2:
+			return HasAVX2;
+		default:
+			return false;
+	}
+}
+
+//~~~Public Functions~~~//
+
+SHA2Dispatch::Compress256Func SHA2Dispatch::Compress256()
+{
+	return Instance().Active256.load(std::memory_order_relaxed);
+}
+
+SHA2Dispatch::Compress512Func SHA2Dispatch::Compress512()
+{
+	return Instance().Active512.load(std::memory_order_relaxed);
+}
+
+SHA2Dispatch::Compress256LanesFunc SHA2Dispatch::CompressLanes256(size_t &Lanes)
+{
+	// the lane count is derived from the pointer, so that a concurrent SetKernel256 can not pair a kernel with the wrong width
+	Compress256LanesFunc func = Instance().ActiveLanes256.load();
+
+	if (func == &SHA256Compress::Compress64x8)
+		Lanes = 8;
+	else if (func == &SHA256Compress::Compress64x4)
+		Lanes = 4;
+	else if (func == &SHA256Compress::Compress64x2SHANI)
+		Lanes = 2;
+	else
+		Lanes = 1;
+
+	return func;
+}
+
+SHA2Dispatch::Compress512LanesFunc SHA2Dispatch::CompressLanes512(size_t &Lanes)
+{
+	Compress512LanesFunc func = Instance().ActiveLanes512.load();
+
+	if (func == &SHA512Compress::Compress128x4)
+		Lanes = 4;
+	else if (func == &SHA512Compress::Compress128x2)
+		Lanes = 2;
+	else
+		Lanes = 1;
+
+	return func;
+}
+
+bool SHA2Dispatch::IsSupported256(SHA2Kernels Kernel)
+{
+	return Instance().Supports256(Kernel);
+}
+
+bool SHA2Dispatch::IsSupported512(SHA2Kernels Kernel)
+{
+	return Instance().Supports512(Kernel);
+}
+
+SHA2Kernels SHA2Dispatch::Kernel256()
+{
+	return Instance().Kernel256.load();
+}
+
+SHA2Kernels SHA2Dispatch::Kernel512()
+{
+	return Instance().Kernel512.load();
+}
+
+std::string SHA2Dispatch::KernelName(SHA2Kernels Kernel)
+{
+	switch (Kernel)
+	{
+		case SHA2Kernels::Scalar:
+			return "Scalar";
+		case SHA2Kernels::BMI2:
+			return "BMI2";
+		case SHA2Kernels::AVX:
+			return "AVX";
+		case SHA2Kernels::AVX2:
+			return "AVX2";
+		case SHA2Kernels::SHANI:
+			return "SHA-NI";
+		default:
+			return "Auto";
+	}
+}
+
+void SHA2Dispatch::SetKernel256(SHA2Kernels Kernel)
+{
+	Registry &registry = Instance();
+
+	if (!registry.Supports256(Kernel))
+		throw CryptoDigestException("SHA2Dispatch:SetKernel256", "The " + KernelName(Kernel) + " kernel is not supported by this processor!");
+
+	registry.Activate256(Kernel);
+}
+
+void SHA2Dispatch::SetKernel512(SHA2Kernels Kernel)
+{
+	Registry &registry = Instance();
+
+	if (!registry.Supports512(Kernel))
+		throw CryptoDigestException("SHA2Dispatch:SetKernel512", "The " + KernelName(Kernel) + " kernel is not supported by this processor!");
+
+	registry.Activate512(Kernel);
+}
+
+//~~~Private Functions~~~//
+
+SHA2Dispatch::Registry &SHA2Dispatch::Instance()
+{
+	// initialized once and thread-safe; the cpu is queried on first use
+	static Registry registry;
+	return registry;
+}
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,156 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _CEX_SHA2DISPATCH_H
+#define _CEX_SHA2DISPATCH_H
+
+#include "CexDomain.h"
+#include "SHA2Kernels.h"
+#include <array>
+
+NAMESPACE_DIGEST
+
+using Enumeration::SHA2Kernels;
+
+/// <summary>
+/// The runtime registry of SHA-2 compression kernels.
+/// <para>Every kernel lives in its own translation unit compiled for its instruction set, and is only selected after the processor has been checked for support.
+/// The processor is queried once per process; the fastest supported kernel is selected, unless it is overridden by SetKernel256/SetKernel512,
+/// or by the CEX_SHA256_KERNEL and CEX_SHA512_KERNEL environment variables (auto, scalar, bmi2, avx, avx2, shani) read at first use.
+/// An environment value naming an unsupported or unknown kernel is ignored.</para>
+/// </summary>
+///
+/// <example>
+/// <description>Forcing the portable kernel:</description>
+/// <code>
+/// SHA2Dispatch::SetKernel256(SHA2Kernels::Scalar);
+/// std::string name = SHA2Dispatch::KernelName(SHA2Dispatch::Kernel256());
+/// </code>
+/// </example>
+class SHA2Dispatch
+{
+public:
+
+	/// <summary>
+	/// A SHA-256 kernel; compresses BlockCount contiguous 64 byte blocks into the chaining value
+	/// </summary>
+	typedef void(*Compress256Func)(const byte* Input, size_t BlockCount, std::array<uint, 8> &State);
+
+	/// <summary>
+	/// A SHA-512 kernel; compresses BlockCount contiguous 128 byte blocks into the chaining value
+	/// </summary>
+	typedef void(*Compress512Func)(const byte* Input, size_t BlockCount, std::array<ulong, 8> &State);
+
+	/// <summary>
+	/// A multi-buffer SHA-256 kernel; compresses BlockCount blocks of one independent message per lane into word interleaved chaining values
+	/// </summary>
+	typedef void(*Compress256LanesFunc)(const byte* const* Input, size_t BlockCount, uint* State);
+
+	/// <summary>
+	/// A multi-buffer SHA-512 kernel; compresses BlockCount blocks of one independent message per lane into word interleaved chaining values
+	/// </summary>
+	typedef void(*Compress512LanesFunc)(const byte* const* Input, size_t BlockCount, ulong* State);
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Get the active SHA-256 compression kernel
+	/// </summary>
+	static Compress256Func Compress256();
+
+	/// <summary>
+	/// Get the active SHA-512 compression kernel
+	/// </summary>
+	static Compress512Func Compress512();
+
+	/// <summary>
+	/// Get the multi-buffer SHA-256 kernel used for batches of independent messages.
+	/// <para>Returns the 2 stream SHA-NI kernel if the SHA-NI kernel is active, otherwise the 8 lane AVX2 kernel, or the 4 lane SSE4.1 kernel, when the processor supports it.
+	/// Returns null and sets Lanes to 1 if the Scalar kernel was forced.</para>
+	/// </summary>
+	///
+	/// <param name="Lanes">Receives the number of messages compressed per call</param>
+	static Compress256LanesFunc CompressLanes256(size_t &Lanes);
+
+	/// <summary>
+	/// Get the multi-buffer SHA-512 kernel used for batches of independent messages, HMAC passes and tree leaves.
+	/// <para>Returns the 4 lane AVX2 kernel, or the 2 lane SSE4.1 kernel, when the processor supports it.
+	/// Returns null and sets Lanes to 1 if the Scalar kernel was forced.</para>
+	/// </summary>
+	///
+	/// <param name="Lanes">Receives the number of messages compressed per call</param>
+	static Compress512LanesFunc CompressLanes512(size_t &Lanes);
+
+	/// <summary>
+	/// Test if a SHA-256 kernel is supported by this processor; Auto and Scalar are always supported
+	/// </summary>
+	///
+	/// <param name="Kernel">The kernel to test</param>
+	static bool IsSupported256(SHA2Kernels Kernel);
+
+	/// <summary>
+	/// Test if a SHA-512 kernel is supported by this processor; Auto and Scalar are always supported
+	/// </summary>
+	///
+	/// <param name="Kernel">The kernel to test</param>
+	static bool IsSupported512(SHA2Kernels Kernel);
+
+	/// <summary>
+	/// Get the active SHA-256 kernel type
+	/// </summary>
+	static SHA2Kernels Kernel256();
+
+	/// <summary>
+	/// Get the active SHA-512 kernel type
+	/// </summary>
+	static SHA2Kernels Kernel512();
+
+	/// <summary>
+	/// Get the formal name of a kernel type
+	/// </summary>
+	///
+	/// <param name="Kernel">The kernel type</param>
+	static std::string KernelName(SHA2Kernels Kernel);
+
+	/// <summary>
+	/// Select the SHA-256 kernel used by all SHA256 instances; Auto restores the fastest supported kernel.
+	/// <para>Instances already processing a message continue with the new kernel; every kernel produces the same output.</para>
+	/// </summary>
+	///
+	/// <param name="Kernel">The kernel to activate</param>
+	///
+	/// <exception cref="Exception::CryptoDigestException">Thrown if the kernel is not supported by this processor</exception>
+	static void SetKernel256(SHA2Kernels Kernel);
+
+	/// <summary>
+	/// Select the SHA-512 kernel used by all SHA512 instances; Auto restores the fastest supported kernel
+	/// </summary>
+	///
+	/// <param name="Kernel">The kernel to activate</param>
+	///
+	/// <exception cref="Exception::CryptoDigestException">Thrown if the kernel is not supported by this processor</exception>
+	static void SetKernel512(SHA2Kernels Kernel);
+
+private:
+	struct Registry;
+
+	static Registry &Instance();
+};
+
+NAMESPACE_DIGESTEND
+#endif
@@ -0,0 +1,607 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef _CEX_SHA2ENGINE_H
+#define _CEX_SHA2ENGINE_H
+
+#include "CexDomain.h"
+#include "CryptoDigestException.h"
+#include "IntUtils.h"
+#include "SHA256Compress.h"
+#include "SHA2Dispatch.h"
+#include "SHA512Compress.h"
+#include <array>
+
+NAMESPACE_DIGEST
+
+using Exception::CryptoDigestException;
+
+/// <summary>
+/// The compile-time parameters of SHA-256 and SHA-224; the runtime selected compression kernel
+/// </summary>
+struct SHA256Traits
+{
+	typedef uint Word;
+
+	static const size_t BLOCK_SIZE = 64;
+	static const size_t DIGEST_SIZE = 32;
+	// the size of the big endian bit length that ends the padding
+	static const size_t LENGTH_SIZE = 8;
+
+	/// <summary>
+	/// The chaining value and byte counter of a message; a midstate once a block aligned prefix has been compressed.
+	/// <para>The state is padded to a cache line; in a 64 byte aligned array, such as the tree-mode leaf states, states written by different threads never share a line.
+	/// The type has no extended alignment, so objects holding it can be allocated with new before C++17.</para>
+	/// </summary>
+	struct State
+	{
+		std::array<uint, 8> H;
+		ulong T;
+		byte Padding[64 - (8 * sizeof(uint)) - sizeof(ulong)];
+
+		State()
+			:
+			H(),
+			T(0),
+			Padding()
+		{
+		}
+
+		void Increase(size_t Length)
+		{
+			T += Length;
+		}
+
+		// the initial value selects the variant; SHA-224 for a 28 byte output, otherwise SHA-256
+		void Reset(size_t OutputSize)
+		{
+			T = 0;
+
+			if (OutputSize == 28)
+			{
+				H[0] = 0xc1059ed8;
+				H[1] = 0x367cd507;
+				H[2] = 0x3070dd17;
+				H[3] = 0xf70e5939;
+				H[4] = 0xffc00b31;
+				H[5] = 0x68581511;
+				H[6] = 0x64f98fa7;
+				H[7] = 0xbefa4fa4;
+			}
+			else
+			{
+				H[0] = 0x6a09e667;
+				H[1] = 0xbb67ae85;
+				H[2] = 0x3c6ef372;
+				H[3] = 0xa54ff53a;
+				H[4] = 0x510e527f;
+				H[5] = 0x9b05688c;
+				H[6] = 0x1f83d9ab;
+				H[7] = 0x5be0cd19;
+			}
+		}
+	};
+
+	static inline void Compress(const byte* Input, size_t BlockCount, std::array<uint, 8> &H)
+	{
+		SHA2Dispatch::Compress256()(Input, BlockCount, H);
+	}
+
+	static inline bool IsOutputSize(size_t OutputSize)
+	{
+		return OutputSize == 28 || OutputSize == 32;
+	}
+
+	// the low word of the byte counter; a midstate must be block aligned
+	static inline ulong Processed(const State &Value)
+	{
+		return Value.T;
+	}
+
+	static inline void StoreLength(const State &Value, byte* Output)
+	{
+		Utility::IntUtils::Be64ToBytes(Value.T << 3, Output);
+	}
+
+	static inline void StoreWord(uint Value, byte* Output)
+	{
+		Utility::IntUtils::Be32ToBytes(Value, Output);
+	}
+};
+
+static_assert(sizeof(SHA256Traits::State) == 64, "The SHA256 state must fill a cache line!");
+
+/// <summary>
+/// The SHA-256 parameters with the portable compression rounds, compiled inline into the engine
+/// </summary>
+struct SHA256PortableTraits : public SHA256Traits
+{
+	static inline void Compress(const byte* Input, size_t BlockCount, std::array<uint, 8> &H)
+	{
+		SHA256Compress::Compress64(Input, BlockCount, H);
+	}
+};
+
+/// <summary>
+/// The compile-time parameters of SHA-512, SHA-384, SHA-512/256 and SHA-512/224; the runtime selected compression kernel
+/// </summary>
+struct SHA512Traits
+{
+	typedef ulong Word;
+
+	static const size_t BLOCK_SIZE = 128;
+	static const size_t DIGEST_SIZE = 64;
+	// the size of the big endian bit length that ends the padding
+	static const size_t LENGTH_SIZE = 16;
+
+	/// <summary>
+	/// The chaining value and byte counters of a message; a midstate once a block aligned prefix has been compressed.
+	/// <para>The state is padded to two cache lines; in a 64 byte aligned array, such as the tree-mode leaf states, states written by different threads never share a line.
+	/// The type has no extended alignment, so objects holding it can be allocated with new before C++17.</para>
+	/// </summary>
+	struct State
+	{
+		std::array<ulong, 8> H;
+		std::array<ulong, 2> T;
+		byte Padding[128 - (10 * sizeof(ulong))];
+
+		State()
+			:
+			H(),
+			T(),
+			Padding()
+		{
+		}
+
+		void Increase(size_t Length)
+		{
+			T[0] += Length;
+
+			if (T[0] > 0x1fffffffffffffffL)
+			{
+				T[1] += (int64_t)(T[0] >> 61);
+				T[0] &= 0x1fffffffffffffffL;
+			}
+		}
+
+		// the initial value selects the variant; SHA-512/224, SHA-512/256 and SHA-384 for 28, 32 and 48 byte outputs, otherwise SHA-512
+		void Reset(size_t OutputSize)
+		{
+			T[0] = 0;
+			T[1] = 0;
+
+			if (OutputSize == 28)
+			{
+				H[0] = 0x8c3d37c819544da2;
+				H[1] = 0x73e1996689dcd4d6;
+				H[2] = 0x1dfab7ae32ff9c82;
+				H[3] = 0x679dd514582f9fcf;
+				H[4] = 0x0f6d2b697bd44da8;
+				H[5] = 0x77e36f7304c48942;
+				H[6] = 0x3f9d85a86a1d36c8;
+				H[7] = 0x1112e6ad91d692a1;
+			}
+			else if (OutputSize == 32)
+			{
+				H[0] = 0x22312194fc2bf72c;
+				H[1] = 0x9f555fa3c84c64c2;
+				H[2] = 0x2393b86b6f53b151;
+				H[3] = 0x963877195940eabd;
+				H[4] = 0x96283ee2a88effe3;
+				H[5] = 0xbe5e1e2553863992;
+				H[6] = 0x2b0199fc2c85b8aa;
+				H[7] = 0x0eb72ddc81c52ca2;
+			}
+			else if (OutputSize == 48)
+			{
+				H[0] = 0xcbbb9d5dc1059ed8;
+				H[1] = 0x629a292a367cd507;
+				H[2] = 0x9159015a3070dd17;
+				H[3] = 0x152fecd8f70e5939;
+				H[4] = 0x67332667ffc00b31;
+				H[5] = 0x8eb44a8768581511;
+				H[6] = 0xdb0c2e0d64f98fa7;
+				H[7] = 0x47b5481dbefa4fa4;
+			}
+			else
+			{
+				H[0] = 0x6a09e667f3bcc908;
+				H[1] = 0xbb67ae8584caa73b;
+				H[2] = 0x3c6ef372fe94f82b;
+				H[3] = 0xa54ff53a5f1d36f1;
+				H[4] = 0x510e527fade682d1;
+				H[5] = 0x9b05688c2b3e6c1f;
+				H[6] = 0x1f83d9abfb41bd6b;
+				H[7] = 0x5be0cd19137e2179;
+			}
+		}
+	};
+
+	static inline void Compress(const byte* Input, size_t BlockCount, std::array<ulong, 8> &H)
+	{
+		SHA2Dispatch::Compress512()(Input, BlockCount, H);
+	}
+
+	static inline bool IsOutputSize(size_t OutputSize)
+	{
+		return OutputSize == 28 || OutputSize == 32 || OutputSize == 48 || OutputSize == 64;
+	}
+
+	// the low word of the byte counter; a midstate must be block aligned
+	static inline ulong Processed(const State &Value)
+	{
+		return Value.T[0];
+	}
+
+	// the high counter word holds the bits shifted out of the low word
+	static inline void StoreLength(const State &Value, byte* Output)
+	{
+		Utility::IntUtils::Be64ToBytes(Value.T[1], Output);
+		Utility::IntUtils::Be64ToBytes(Value.T[0] << 3, Output + sizeof(ulong));
+	}
+
+	static inline void StoreWord(ulong Value, byte* Output)
+	{
+		Utility::IntUtils::Be64ToBytes(Value, Output);
+	}
+};
+
+static_assert(sizeof(SHA512Traits::State) == 128, "The SHA512 state must fill two cache lines!");
+
+/// <summary>
+/// The SHA-512 parameters with the portable compression rounds, compiled inline into the engine
+/// </summary>
+struct SHA512PortableTraits : public SHA512Traits
+{
+	static inline void Compress(const byte* Input, size_t BlockCount, std::array<ulong, 8> &H)
+	{
+		SHA512Compress::Compress128(Input, BlockCount, H);
+	}
+};
+
+/// <summary>
+/// The sequential SHA-2 hash engine shared by SHA256 and SHA512; a concrete, non-virtual type that can be used directly
+/// </summary>
+///
+/// <typeparam name="Traits">The variant parameters; SHA256Traits or SHA512Traits, or their Portable variants</typeparam>
+///
+/// <example>
+/// <description>Hashing in a loop without virtual calls:</description>
+/// <code>
+/// SHA2Engine&lt;SHA256Traits&gt; eng;
+/// byte hash[32];
+/// eng.Update(Input, Length);
+/// eng.Finalize(hash);
+/// </code>
+/// </example>
+///
+/// <remarks>
+/// <para>The block size, word type, initial values, length encoding and compression kernel are fixed by the Traits parameter at compile time.
+/// SHA256 and SHA512 wrap an engine for their sequential mode, and use its static functions for the tree-mode leaves and root, so the padding and output rules live in one place.</para>
+/// <para>The SHA256Traits and SHA512Traits kernels are the SHA2Dispatch selection (SHA-NI, AVX2, AVX, BMI2 or portable); they are compiled in their own instruction set units, and are called through a pointer.
+/// The Portable traits compile the portable rounds inline into the engine; this removes the call, but is only faster where the dispatched kernel would be the portable one, or for very short messages.
+/// A caller can supply its own traits, deriving from SHA256Traits or SHA512Traits and replacing Compress with a fixed kernel.</para>
+/// <para>Engines with the same variant share a State type, so a midstate exported by one can be restored into the other, or into SHA256 and SHA512.
+/// The output is the standard SHA-2 hash of the message; an engine is copyable, and is not thread-safe.</para>
+/// </remarks>
+template <typename Traits>
+class SHA2Engine
+{
+public:
+
+	typedef typename Traits::State State;
+	typedef typename Traits::Word Word;
+
+	static const size_t BLOCK_SIZE = Traits::BLOCK_SIZE;
+	static const size_t DIGEST_SIZE = Traits::DIGEST_SIZE;
+
+private:
+
+	State m_initState;
+	bool m_isMidstate;
+	byte m_msgBuffer[BLOCK_SIZE];
+	size_t m_msgLength;
+	size_t m_outputSize;
+	State m_state;
+
+public:
+
+	// *** Properties *** //
+
+	/// <summary>
+	/// Get: The size of the hash output in bytes
+	/// </summary>
+	size_t DigestSize() const { return m_outputSize; }
+
+	/// <summary>
+	/// Get: The engine resets to a restored midstate instead of the initial value of the variant
+	/// </summary>
+	bool IsMidstate() const { return m_isMidstate; }
+
+	//~~~Constructor~~~//
+
+	/// <summary>
+	/// Initialize the engine
+	/// </summary>
+	///
+	/// <param name="OutputSize">The hash size in bytes; selects the variant</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the output size is not a size of the variant</exception>
+	explicit SHA2Engine(size_t OutputSize = DIGEST_SIZE)
+		:
+		m_initState(),
+		m_isMidstate(false),
+		m_msgBuffer(),
+		m_msgLength(0),
+		m_outputSize(OutputSize),
+		m_state()
+	{
+		if (!Traits::IsOutputSize(OutputSize))
+			throw CryptoDigestException("SHA2Engine:Ctor", "The output size is not supported by this variant!");
+
+		m_initState.Reset(OutputSize);
+		Reset();
+	}
+
+	/// <summary>
+	/// Initialize the engine from a midstate; the state of a block aligned message prefix
+	/// </summary>
+	///
+	/// <param name="Midstate">The midstate</param>
+	/// <param name="OutputSize">The hash size in bytes; must match the variant the midstate was produced with</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the output size is invalid, or the midstate is not block aligned</exception>
+	SHA2Engine(const State &Midstate, size_t OutputSize)
+		:
+		SHA2Engine(OutputSize)
+	{
+		Reset(Midstate);
+	}
+
+	/// <summary>
+	/// Finalize objects
+	/// </summary>
+	~SHA2Engine()
+	{
+		std::memset(m_msgBuffer, 0, BLOCK_SIZE);
+		m_initState.H.fill(0);
+		m_state.H.fill(0);
+		m_msgLength = 0;
+	}
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Compress a contiguous run of blocks, and advance the state counter
+	/// </summary>
+	///
+	/// <param name="Input">Pointer to the first block</param>
+	/// <param name="BlockCount">The number of blocks</param>
+	/// <param name="Value">The state</param>
+	static inline void Compress(const byte* Input, size_t BlockCount, State &Value)
+	{
+		Traits::Compress(Input, BlockCount, Value.H);
+		Value.Increase(BlockCount * BLOCK_SIZE);
+	}
+
+	/// <summary>
+	/// Pad the last bytes of a message into the state.
+	/// <para>The padding is written to a stack block; the input is not changed.</para>
+	/// </summary>
+	///
+	/// <param name="Input">The message tail</param>
+	/// <param name="Length">The tail length; at most one block</param>
+	/// <param name="Value">The state; the hash is the leading bytes of its big endian chaining value</param>
+	static inline void Final(const byte* Input, size_t Length, State &Value)
+	{
+		CEX_ALIGN_DATA(16) byte block[2 * BLOCK_SIZE];
+
+		CEXASSERT(Length <= BLOCK_SIZE, "The tail is longer than a block!");
+
+		if (Length == BLOCK_SIZE)
+		{
+			Compress(Input, 1, Value);
+			Length = 0;
+		}
+
+		const size_t PADBLK = (Length < BLOCK_SIZE - Traits::LENGTH_SIZE) ? 1 : 2;
+
+		Value.Increase(Length);
+		std::memset(block, 0, PADBLK * BLOCK_SIZE);
+		if (Length != 0)
+			std::memcpy(block, Input, Length);
+		block[Length] = 0x80;
+		Traits::StoreLength(Value, block + (PADBLK * BLOCK_SIZE) - Traits::LENGTH_SIZE);
+		Traits::Compress(block, PADBLK, Value.H);
+	}
+
+	/// <summary>
+	/// Process the message bytes and return the hash; the engine is reset
+	/// </summary>
+	///
+	/// <param name="Output">Receives DigestSize() bytes</param>
+	///
+	/// <returns>The size of the hash in bytes</returns>
+	size_t Finalize(byte* Output)
+	{
+		Final(m_msgBuffer, m_msgLength, m_state);
+		Store(m_state, Output, m_outputSize);
+		Reset();
+
+		return m_outputSize;
+	}
+
+	/// <summary>
+	/// Hash a message in one call, without an instance
+	/// </summary>
+	///
+	/// <param name="Input">The message</param>
+	/// <param name="Length">The message length in bytes</param>
+	/// <param name="Output">Receives OutputSize bytes</param>
+	/// <param name="OutputSize">The hash size in bytes; selects the variant</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the output size is not a size of the variant</exception>
+	static inline void Hash(const byte* Input, size_t Length, byte* Output, size_t OutputSize = DIGEST_SIZE)
+	{
+		const size_t BLKCNT = Length / BLOCK_SIZE;
+		State state;
+
+		// the size bounds the words Store reads from the state; checked in release builds too
+		if (!Traits::IsOutputSize(OutputSize))
+			throw CryptoDigestException("SHA2Engine:Hash", "The output size is not supported by this variant!");
+
+		state.Reset(OutputSize);
+
+		if (BLKCNT != 0)
+			Compress(Input, BLKCNT, state);
+
+		// only the message tail is copied; into one or two padding blocks
+		Final(Input + (BLKCNT * BLOCK_SIZE), Length - (BLKCNT * BLOCK_SIZE), state);
+		Store(state, Output, OutputSize);
+	}
+
+	/// <summary>
+	/// Export the state after a block aligned message prefix
+	/// </summary>
+	///
+	/// <returns>The midstate</returns>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the processed length is not a multiple of the block size</exception>
+	State Midstate()
+	{
+		// the last full block is held back by Update, in case it is the final block
+		if (m_msgLength == BLOCK_SIZE)
+		{
+			Compress(m_msgBuffer, 1, m_state);
+			m_msgLength = 0;
+		}
+
+		if (m_msgLength != 0)
+			throw CryptoDigestException("SHA2Engine:Midstate", "The prefix must be a multiple of the block size!");
+
+		return m_state;
+	}
+
+	/// <summary>
+	/// Get the hash of the message processed so far, without finalizing; further input may be added
+	/// </summary>
+	///
+	/// <param name="Output">Receives DigestSize() bytes</param>
+	///
+	/// <returns>The size of the hash in bytes</returns>
+	size_t Peek(byte* Output) const
+	{
+		State state = m_state;
+
+		Final(m_msgBuffer, m_msgLength, state);
+		Store(state, Output, m_outputSize);
+
+		return m_outputSize;
+	}
+
+	/// <summary>
+	/// Reset to the initial state, or to the restored midstate
+	/// </summary>
+	void Reset()
+	{
+		m_state = m_initState;
+		m_msgLength = 0;
+	}
+
+	/// <summary>
+	/// Restore a midstate; the engine resets to it until another is restored
+	/// </summary>
+	///
+	/// <param name="Midstate">The midstate</param>
+	///
+	/// <exception cref="CryptoDigestException">Thrown if the midstate counter is not a multiple of the block size</exception>
+	void Reset(const State &Midstate)
+	{
+		if (Traits::Processed(Midstate) % BLOCK_SIZE != 0)
+			throw CryptoDigestException("SHA2Engine:Reset", "The midstate counter must be a multiple of the block size!");
+
+		m_initState = Midstate;
+		m_isMidstate = true;
+		Reset();
+	}
+
+	/// <summary>
+	/// Write the leading bytes of the big endian chaining value
+	/// </summary>
+	///
+	/// <param name="Value">The finalized state</param>
+	/// <param name="Output">Receives OutputSize bytes</param>
+	/// <param name="OutputSize">The hash size in bytes</param>
+	static inline void Store(const State &Value, byte* Output, size_t OutputSize)
+	{
+		const size_t WRDCNT = OutputSize / sizeof(Word);
+		const size_t WRDRMD = OutputSize % sizeof(Word);
+
+		for (size_t i = 0; i < WRDCNT; ++i)
+			Traits::StoreWord(Value.H[i], Output + (i * sizeof(Word)));
+
+		// SHA-512/224 ends within a word
+		if (WRDRMD != 0)
+		{
+			byte tmp[sizeof(Word)];
+			Traits::StoreWord(Value.H[WRDCNT], tmp);
+			std::memcpy(Output + (WRDCNT * sizeof(Word)), tmp, WRDRMD);
+		}
+	}
+
+	/// <summary>
+	/// Add message bytes
+	/// </summary>
+	///
+	/// <param name="Input">The message bytes</param>
+	/// <param name="Length">The number of bytes to process</param>
+	void Update(const byte* Input, size_t Length)
+	{
+		if (m_msgLength != 0 && (m_msgLength + Length >= BLOCK_SIZE))
+		{
+			const size_t RMDLEN = BLOCK_SIZE - m_msgLength;
+			if (RMDLEN != 0)
+				std::memcpy(m_msgBuffer + m_msgLength, Input, RMDLEN);
+
+			Compress(m_msgBuffer, 1, m_state);
+			m_msgLength = 0;
+			Input += RMDLEN;
+			Length -= RMDLEN;
+		}
+
+		// compress all but the last block as one contiguous run
+		if (Length > BLOCK_SIZE)
+		{
+			const size_t BLKCNT = (Length - 1) / BLOCK_SIZE;
+			Compress(Input, BLKCNT, m_state);
+			Input += BLKCNT * BLOCK_SIZE;
+			Length -= BLKCNT * BLOCK_SIZE;
+		}
+
+		// store unaligned bytes
+		if (Length != 0)
+		{
+			std::memcpy(m_msgBuffer + m_msgLength, Input, Length);
+			m_msgLength += Length;
+		}
+	}
+};
+
+NAMESPACE_DIGESTEND
+#endif
@@ -0,0 +1,40 @@
+#ifndef _CEX_SHA2KERNELS_H
+#define _CEX_SHA2KERNELS_H
+
+#include "CexDomain.h"
+
+NAMESPACE_ENUMERATION
+
+/// <summary>
+/// SHA-2 compression kernel implementations selectable at runtime
+/// </summary>
+enum class SHA2Kernels : byte
+{
+	/// <summary>
+	/// Select the fastest kernel supported by the processor
+	/// </summary>
+	Auto = 0,
+	/// <summary>
+	/// The portable C++ implementation
+	/// </summary>
+	Scalar = 1,
+	/// <summary>
+	/// The portable rounds compiled with the BMI2 rorx and andn instructions
+	/// </summary>
+	BMI2 = 2,
+	/// <summary>
+	/// A vectorized message schedule with AVX2, and BMI2 rounds; two blocks at a time for SHA-256, one for SHA-512
+	/// </summary>
+	AVX2 = 3,
+	/// <summary>
+	/// The Intel SHA extensions; SHA-256 only
+	/// </summary>
+	SHANI = 4,
+	/// <summary>
+	/// A one block vectorized message schedule with AVX, and BMI2 rounds; SHA-256 only
+	/// </summary>
+	AVX = 5
+};
+
+NAMESPACE_ENUMERATIONEND
+#endif
@@ -25,6 +25,7 @@
 #define _CEXENGINE_SHA2PARAMS_H
 
 #include "CexDomain.h"
+#include "CryptoDigestException.h"
 #include "IntUtils.h"
 
 NAMESPACE_DIGEST
@@ -121,9 +122,11 @@ public:
 	/// Initialize with the default parameters.
 	/// <para>Default settings are configured for sequential mode.</para>
 	/// </summary>
-	/// <param name="OutputSize">Digest output byte length; set to 32 for Skein256, 64 for Skein512 or 128 for Skein1024</param>
+	/// <param name="OutputSize">Digest output byte length; must be 28, 32, 48 or 64, the size of one of the SHA-2 variants</param>
 	/// <param name="LeafSize">The outer leaf length in bytes; this must be the digests block size</param>
 	/// <param name="Fanout">The number of state leaf-nodes used by parallel processing (one state per processor core is recommended)</param>
+	///
+	/// <exception cref="Exception::CryptoDigestException">Thrown if the output size does not match a SHA-2 variant</exception>
 	SHA2Params(ulong OutputSize, uint LeafSize = 0, byte Fanout = 0)
 		:
 		m_nodeOffset(0),
@@ -135,6 +138,9 @@ public:
 		m_reserved(0),
 		m_dstCode(0)
 	{
+		if (OutputSize != 28 && OutputSize != 32 && OutputSize != 48 && OutputSize != 64)
+			throw Exception::CryptoDigestException("SHA2Params:Ctor", "The output size must be 28, 32, 48 or 64 bytes!");
+
 		m_dstCode.resize(DistributionCodeMax());
 	}
 
@@ -1,12 +1,15 @@
 #include "SHA512.h"
 #include "ArrayUtils.h"
-#include "IntUtils.h"
+#include "ParallelOptions.h"
 #include "ParallelUtils.h"
+#include "SHA512Batch.h"
+#include "SHA2Dispatch.h"
+#include <algorithm>
 #include "SHA512Compress.h"
 
 NAMESPACE_DIGEST
 
-using Utility::IntUtils;
+using Common::ParallelOptions;
 using Utility::ParallelUtils;
 
 //~~~Constructor~~~//
@@ -14,11 +17,12 @@ using Utility::ParallelUtils;
 SHA512::SHA512(bool Parallel)
 	:
 	m_treeParams(DIGEST_SIZE, static_cast<uint>(BLOCK_SIZE), DEF_PRLDEGREE),
+	m_dgtState(Parallel ? DEF_PRLDEGREE : 0),
+	m_engine(DIGEST_SIZE),
 	m_isDestroyed(false),
-	m_msgBuffer(Parallel ? DEF_PRLDEGREE * BLOCK_SIZE : BLOCK_SIZE),
+	m_msgBuffer(Parallel ? DEF_PRLDEGREE * BLOCK_SIZE : 0),
 	m_msgLength(0),
-	m_parallelProfile(BLOCK_SIZE, false, STATE_PRECACHED, false, DEF_PRLDEGREE),
-	m_dgtState(Parallel ? DEF_PRLDEGREE : 1)
+	m_parallelProfile(BLOCK_SIZE, false, STATE_PRECACHED, false, DEF_PRLDEGREE)
 {
 	if (m_parallelProfile.IsParallel())
 		m_parallelProfile.IsParallel() = Parallel;
@@ -29,12 +33,18 @@ SHA512::SHA512(bool Parallel)
 SHA512::SHA512(SHA2Params &Params)
 	:
 	m_treeParams(Params),
-	m_dgtState(1),
+	m_dgtState(0),
+	m_engine(),
 	m_isDestroyed(false),
-	m_msgBuffer(BLOCK_SIZE),
+	m_msgBuffer(0),
 	m_msgLength(0),
 	m_parallelProfile(BLOCK_SIZE, false, STATE_PRECACHED, false, m_treeParams.FanOut())
 {
+	if (Params.OutputSize() != 28 && Params.OutputSize() != 32 && Params.OutputSize() != 48 && Params.OutputSize() != DIGEST_SIZE)
+		throw CryptoDigestException("SHA512:Ctor", "The output size must be 28, 32, 48 or 64 bytes!");
+
+	m_engine = Engine(Params.OutputSize());
+
 	if (m_treeParams.FanOut() > 1)
 	{
 		m_dgtState.resize(m_treeParams.FanOut());
@@ -48,6 +58,67 @@ SHA512::SHA512(SHA2Params &Params)
 	Reset();
 }
 
+SHA512::SHA512(const SHA512State &Midstate, size_t OutputSize)
+	:
+	m_treeParams(OutputSize, static_cast<uint>(BLOCK_SIZE), 0),
+	m_dgtState(0),
+	m_engine(),
+	m_isDestroyed(false),
+	m_msgBuffer(0),
+	m_msgLength(0),
+	m_parallelProfile(BLOCK_SIZE)
+{
+	if (OutputSize != 28 && OutputSize != 32 && OutputSize != 48 && OutputSize != DIGEST_SIZE)
+		throw CryptoDigestException("SHA512:Ctor", "The output size must be 28, 32, 48 or 64 bytes!");
+
+	m_engine = Engine(Midstate, OutputSize);
+}
+
+SHA512::SHA512(const SHA512 &Digest)
+	:
+	m_treeParams(Digest.m_treeParams),
+	m_dgtState(Digest.m_dgtState),
+	m_engine(Digest.m_engine),
+	m_isDestroyed(Digest.m_isDestroyed),
+	m_msgBuffer(Digest.m_msgBuffer),
+	m_msgLength(Digest.m_msgLength),
+	m_parallelProfile(Digest.m_parallelProfile)
+{
+}
+
+SHA512::SHA512(SHA512 &&Digest)
+	:
+	m_treeParams(Digest.m_treeParams),
+	m_dgtState(std::move(Digest.m_dgtState)),
+	m_engine(Digest.m_engine),
+	m_isDestroyed(Digest.m_isDestroyed),
+	m_msgBuffer(std::move(Digest.m_msgBuffer)),
+	m_msgLength(Digest.m_msgLength),
+	m_parallelProfile(Digest.m_parallelProfile)
+{
+	Digest.Release();
+}
+
+SHA512& SHA512::operator=(SHA512 &&Digest)
+{
+	if (this != &Digest)
+	{
+		Destroy();
+
+		m_treeParams = Digest.m_treeParams;
+		m_dgtState = std::move(Digest.m_dgtState);
+		m_engine = Digest.m_engine;
+		m_isDestroyed = Digest.m_isDestroyed;
+		m_msgBuffer = std::move(Digest.m_msgBuffer);
+		m_msgLength = Digest.m_msgLength;
+		m_parallelProfile = Digest.m_parallelProfile;
+
+		Digest.Release();
+	}
+
+	return *this;
+}
+
 SHA512::~SHA512()
 {
 	Destroy();
@@ -55,13 +126,67 @@ SHA512::~SHA512()
 
 //~~~Public Functions~~~//
 
+IDigest* SHA512::Clone()
+{
+	return new SHA512(*this);
+}
+
 void SHA512::Compute(const std::vector<byte> &Input, std::vector<byte> &Output)
 {
-	Output.resize(DIGEST_SIZE);
+	Output.resize(DigestSize());
 	Update(Input, 0, Input.size());
 	Finalize(Output, 0);
 }
 
+void SHA512::ComputeMany(const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	// a partition must hold enough blocks to amortize its dispatch and the batch setup
+	const size_t PRTMIN = 131072 / BLOCK_SIZE;
+	// several partitions per core; threads that finish early steal the partitions left to a slow core
+	const size_t PRTCORE = 4;
+
+	if (Count == 0)
+		return;
+
+	size_t total = 0;
+
+	// the padded block count of the batch
+	for (size_t i = 0; i < Count; ++i)
+		total += (Length[i] + 16) / BLOCK_SIZE + 1;
+
+	ParallelOptions profile(BLOCK_SIZE, false, STATE_PRECACHED, false);
+	const size_t PRTCNT = (std::min)(profile.IsParallel() ? profile.ProcessorCount() * PRTCORE : 1, (std::max)(total / PRTMIN, static_cast<size_t>(1)));
+
+	if (PRTCNT > 1)
+	{
+		std::vector<size_t> bounds(PRTCNT + 1, Count);
+		size_t sum = 0;
+		size_t part = 1;
+
+		// contiguous ranges in arrival order, cut at equal shares of the total block count
+		bounds[0] = 0;
+		for (size_t i = 0; i < Count && part < PRTCNT; ++i)
+		{
+			sum += (Length[i] + 16) / BLOCK_SIZE + 1;
+			if (sum >= (total / PRTCNT) * part)
+			{
+				bounds[part] = i + 1;
+				++part;
+			}
+		}
+
+		ParallelUtils::ParallelFor(0, PRTCNT, [Input, Length, Output, &bounds](size_t i)
+		{
+			if (bounds[i + 1] > bounds[i])
+				SHA512Batch::Compute(Input + bounds[i], Length + bounds[i], bounds[i + 1] - bounds[i], Output + (bounds[i] * DIGEST_SIZE));
+		});
+	}
+	else
+	{
+		SHA512Batch::Compute(Input, Length, Count, Output);
+	}
+}
+
 void SHA512::Destroy()
 {
 	if (!m_isDestroyed)
@@ -72,7 +197,10 @@ void SHA512::Destroy()
 		try
 		{
 			for (size_t i = 0; i < m_dgtState.size(); ++i)
-				m_dgtState[i].Reset();
+				m_dgtState[i].Reset(DIGEST_SIZE);
+
+			// a new engine clears the message buffer and the restored midstate
+			m_engine = Engine(DIGEST_SIZE);
 
 			Utility::ArrayUtils::ClearVector(m_dgtState);
 			Utility::ArrayUtils::ClearVector(m_msgBuffer);
@@ -86,66 +214,99 @@ void SHA512::Destroy()
 
 size_t SHA512::Finalize(std::vector<byte> &Output, const size_t OutOffset)
 {
-	CEXASSERT(Output.size() - OutOffset >= DIGEST_SIZE, "The Output buffer is too short!");
+	CEXASSERT(Output.size() - OutOffset >= DigestSize(), "The Output buffer is too short!");
 
+	return Finalize(&Output[OutOffset]);
+}
+
+size_t SHA512::Finalize(byte* Output)
+{
 	if (m_parallelProfile.IsParallel())
 	{
-		// pad buffer with zeros
-		if (m_msgLength < m_msgBuffer.size())
-			memset(&m_msgBuffer[m_msgLength], (byte)0, m_msgBuffer.size() - m_msgLength);
+		// the tree is finalized on stack copies of the leaves, then reset
+		Peek(Output);
+		Reset();
+	}
+	else
+	{
+		m_engine.Finalize(Output);
+	}
 
-		// process buffer
-		if (m_msgLength != 0)
-		{
-			size_t blkCtr = 0;
+	return DigestSize();
+}
 
-			while (m_msgLength != 0)
-			{
-				const size_t MSGRMD = (m_msgLength >= BLOCK_SIZE) ? BLOCK_SIZE : m_msgLength;
-				HashFinal(m_msgBuffer, blkCtr * BLOCK_SIZE, MSGRMD, m_dgtState[blkCtr]);
-				m_msgLength -= MSGRMD;
-				++blkCtr;
-			}
-		}
+void SHA512::Hash(const byte* Input, size_t Length, byte(&Output)[64])
+{
+	Engine::Hash(Input, Length, Output, 64);
+}
+
+void SHA512::Hash(const byte* Input, size_t Length, byte(&Output)[48])
+{
+	Engine::Hash(Input, Length, Output, 48);
+}
+
+void SHA512::Hash(const byte* Input, size_t Length, byte(&Output)[32])
+{
+	Engine::Hash(Input, Length, Output, 32);
+}
+
+void SHA512::Hash(const byte* Input, size_t Length, byte(&Output)[28])
+{
+	Engine::Hash(Input, Length, Output, 28);
+}
+
+SHA512::SHA512State SHA512::Midstate()
+{
+	if (m_parallelProfile.IsParallel())
+		throw CryptoDigestException("SHA512:Midstate", "A midstate can not be exported in tree hashing mode!");
+
+	return m_engine.Midstate();
+}
 
-		// initialize root state
+size_t SHA512::Peek(byte* Output)
+{
+	if (m_parallelProfile.IsParallel())
+	{
+		CEX_ALIGN_DATA(16) byte block[BLOCK_SIZE];
 		SHA512State rootState;
-		rootState.Reset();
+		size_t blkLen = 0;
+
+		rootState.Reset(DigestSize());
 
-		// add state blocks as contiguous message input
+		// each leaf is finalized on a copy, and its hash streamed into the root block by block
 		for (size_t i = 0; i < m_dgtState.size(); ++i)
 		{
-			IntUtils::BeULL512ToBlock(m_dgtState[i].H, m_msgBuffer, i * BLOCK_SIZE);
-			m_msgLength += DIGEST_SIZE;
-		}
+			SHA512State leafState = m_dgtState[i];
 
-		// compress full blocks
-		size_t blkOff = 0;
-		if (m_msgLength > BLOCK_SIZE)
-		{
-			const size_t BLKRMD = m_msgLength - (m_msgLength % BLOCK_SIZE);
+			if (i * BLOCK_SIZE < m_msgLength)
+				Engine::Final(&m_msgBuffer[i * BLOCK_SIZE], (std::min)(m_msgLength - (i * BLOCK_SIZE), static_cast<size_t>(BLOCK_SIZE)), leafState);
 
-			for (size_t i = 0; i < BLKRMD / BLOCK_SIZE; ++i)
-				Compress(m_msgBuffer, i * BLOCK_SIZE, rootState);
+			Engine::Store(leafState, block + blkLen, DIGEST_SIZE);
+			blkLen += DIGEST_SIZE;
 
-			m_msgLength -= BLKRMD;
-			blkOff = BLKRMD;
+			if (blkLen == BLOCK_SIZE)
+			{
+				Engine::Compress(block, 1, rootState);
+				blkLen = 0;
+			}
 		}
 
-		// finalize and store
-		HashFinal(m_msgBuffer, blkOff, m_msgLength, rootState);
-		IntUtils::BeULL512ToBlock(rootState.H, Output, OutOffset);
+		Engine::Final(block, blkLen, rootState);
+		Engine::Store(rootState, Output, DigestSize());
 	}
 	else
 	{
-		// finalize and store
-		HashFinal(m_msgBuffer, 0, m_msgLength, m_dgtState[0]);
-		IntUtils::BeULL512ToBlock(m_dgtState[0].H, Output, OutOffset);
+		m_engine.Peek(Output);
 	}
 
-	Reset();
+	return DigestSize();
+}
+
+size_t SHA512::Peek(std::vector<byte> &Output, const size_t OutOffset)
+{
+	CEXASSERT(Output.size() - OutOffset >= DigestSize(), "The Output buffer is too short!");
 
-	return DIGEST_SIZE;
+	return Peek(&Output[OutOffset]);
 }
 
 void SHA512::ParallelMaxDegree(size_t Degree)
@@ -168,31 +329,52 @@ void SHA512::ParallelMaxDegree(size_t Degree)
 
 void SHA512::Reset()
 {
-	m_msgLength = 0;
-	memset(&m_msgBuffer[0], 0, m_msgBuffer.size());
-
-	for (size_t i = 0; i < m_dgtState.size(); ++i)
+	if (m_parallelProfile.IsParallel())
 	{
-		m_dgtState[i].Reset();
+		m_msgLength = 0;
+		memset(&m_msgBuffer[0], 0, m_msgBuffer.size());
 
-		if (m_parallelProfile.IsParallel())
+		for (size_t i = 0; i < m_dgtState.size(); ++i)
 		{
+			m_dgtState[i].Reset(DigestSize());
 			m_treeParams.NodeOffset() = static_cast<uint>(i);
-			Compress(m_treeParams.ToBytes(), 0, m_dgtState[i]);
+			// the serialized parameters are sized to one block; truncated or zero-padded
+			std::vector<byte> config = m_treeParams.ToBytes();
+			config.resize(BLOCK_SIZE, 0);
+			Engine::Compress(&config[0], 1, m_dgtState[i]);
 		}
 	}
+	else
+	{
+		m_engine.Reset();
+	}
+}
+
+void SHA512::Reset(const SHA512State &Midstate)
+{
+	if (m_parallelProfile.IsParallel())
+		throw CryptoDigestException("SHA512:Reset", "A midstate can not be restored in tree hashing mode!");
+
+	m_engine.Reset(Midstate);
 }
 
 void SHA512::Update(byte Input)
 {
-	std::vector<byte> inp(1, Input);
-	Update(inp, 0, 1);
+	Update(&Input, 1);
 }
 
 void SHA512::Update(const std::vector<byte> &Input, size_t InOffset, size_t Length)
 {
 	CEXASSERT(Input.size() - InOffset >= Length, "The Output buffer is too short!");
 
+	if (Length == 0)
+		return;
+
+	Update(&Input[InOffset], Length);
+}
+
+void SHA512::Update(const byte* Input, size_t Length)
+{
 	if (Length == 0)
 		return;
 
@@ -203,17 +385,14 @@ void SHA512::Update(const std::vector<byte> &Input, size_t InOffset, size_t Leng
 			// fill buffer
 			const size_t BUFRMD = m_msgBuffer.size() - m_msgLength;
 			if (BUFRMD != 0)
-				memcpy(&m_msgBuffer[m_msgLength], &Input[InOffset], BUFRMD);
+				memcpy(&m_msgBuffer[m_msgLength], Input, BUFRMD);
 
 			// empty the message buffer
-			ParallelUtils::ParallelFor(0, m_parallelProfile.ParallelMaxDegree(), [this, &Input, InOffset](size_t i)
-			{
-				Compress(m_msgBuffer, i * BLOCK_SIZE, m_dgtState[i]);
-			});
+			ProcessLeaves(&m_msgBuffer[0], m_parallelProfile.ParallelMinimumSize());
 
 			m_msgLength = 0;
 			Length -= BUFRMD;
-			InOffset += BUFRMD;
+			Input += BUFRMD;
 		}
 
 		if (Length >= m_parallelProfile.ParallelBlockSize())
@@ -222,104 +401,122 @@ void SHA512::Update(const std::vector<byte> &Input, size_t InOffset, size_t Leng
 			const size_t PRCLEN = Length - (Length % m_parallelProfile.ParallelBlockSize());
 
 			// process large blocks
-			ParallelUtils::ParallelFor(0, m_parallelProfile.ParallelMaxDegree(), [this, &Input, InOffset, PRCLEN](size_t i)
-			{
-				ProcessLeaf(Input, InOffset + (i * BLOCK_SIZE), m_dgtState[i], PRCLEN);
-			});
+			ProcessLeaves(Input, PRCLEN);
 
 			Length -= PRCLEN;
-			InOffset += PRCLEN;
+			Input += PRCLEN;
 		}
 
 		if (Length >= m_parallelProfile.ParallelMinimumSize())
 		{
 			const size_t PRMLEN = Length - (Length % m_parallelProfile.ParallelMinimumSize());
-			Utility::ParallelUtils::ParallelFor(0, m_parallelProfile.ParallelMaxDegree(), [this, &Input, InOffset, PRMLEN](size_t i)
-			{
-				ProcessLeaf(Input, InOffset + (i * BLOCK_SIZE), m_dgtState[i], PRMLEN);
-			});
+			ProcessLeaves(Input, PRMLEN);
 
 			Length -= PRMLEN;
-			InOffset += PRMLEN;
-		}
-	}
-	else
-	{
-		if (m_msgLength != 0 && (m_msgLength + Length >= BLOCK_SIZE))
-		{
-			size_t rmd = BLOCK_SIZE - m_msgLength;
-			if (rmd != 0)
-				memcpy(&m_msgBuffer[m_msgLength], &Input[InOffset], rmd);
-
-			Compress(m_msgBuffer, 0, m_dgtState[0]);
-			m_msgLength = 0;
-			InOffset += rmd;
-			Length -= rmd;
+			Input += PRMLEN;
 		}
 
-		// sequential loop through blocks
-		while (Length > BLOCK_SIZE)
+		// store unaligned bytes
+		if (Length != 0)
 		{
-			Compress(Input, InOffset, m_dgtState[0]);
-			InOffset += BLOCK_SIZE;
-			Length -= BLOCK_SIZE;
+			memcpy(&m_msgBuffer[m_msgLength], Input, Length);
+			m_msgLength += Length;
 		}
 	}
-
-	// store unaligned bytes
-	if (Length != 0)
+	else
 	{
-		memcpy(&m_msgBuffer[m_msgLength], &Input[InOffset], Length);
-		m_msgLength += Length;
+		m_engine.Update(Input, Length);
 	}
 }
 
 //~~~Private Functions~~~//
 
-void SHA512::Compress(const std::vector<byte> &Input, size_t InOffset, SHA512State &State)
+void SHA512::Release()
 {
-	SHA512Compress::Compress128(Input, InOffset, State);
+	// the vectors have been moved out; a new engine clears the copied message buffer
+	m_engine = Engine(m_engine.DigestSize());
+	m_dgtState.clear();
+	m_msgBuffer.clear();
+	m_msgLength = 0;
+	m_isDestroyed = true;
+}
+
+void SHA512::ProcessLeaf(const byte* Input, SHA512State &State, ulong Length)
+{
+	// leaf blocks are interleaved with the other leaves, so each is compressed individually
+	do
+	{
+		Engine::Compress(Input, 1, State);
+		Input += m_parallelProfile.ParallelMinimumSize();
+		Length -= m_parallelProfile.ParallelMinimumSize();
+	} 
+	while (Length > 0);
 }
 
-void SHA512::HashFinal(std::vector<byte> &Input, size_t InOffset, size_t Length, SHA512State &State)
+void SHA512::ProcessLeafLanes(SHA2Dispatch::Compress512LanesFunc Compress, size_t Lanes, const byte* Input, size_t First, ulong Length)
 {
-	State.Increase(Length);
-	ulong bitLen = (State.T[0] << 3);
+	CEX_ALIGN_DATA(32) ulong state[8 * 4];
+	const byte* blocks[4];
+	const size_t BLKCNT = static_cast<size_t>(Length / m_parallelProfile.ParallelMinimumSize());
 
-	if (Length == BLOCK_SIZE)
+	for (size_t i = 0; i < Lanes; ++i)
 	{
-		SHA512Compress::Compress128(Input, InOffset, State);
-		Length = 0;
+		blocks[i] = Input + ((First + i) * BLOCK_SIZE);
+
+		for (size_t j = 0; j < 8; ++j)
+			state[(j * Lanes) + i] = m_dgtState[First + i].H[j];
 	}
 
-	Input[InOffset + Length] = (byte)128;
-	++Length;
+	for (size_t blk = 0; blk < BLKCNT; ++blk)
+	{
+		Compress(blocks, 1, state);
 
-	// padding
-	if (Length < BLOCK_SIZE)
-		memset(&Input[InOffset + Length], 0, BLOCK_SIZE - Length);
+		for (size_t i = 0; i < Lanes; ++i)
+			blocks[i] += m_parallelProfile.ParallelMinimumSize();
+	}
 
-	if (Length > 112)
+	for (size_t i = 0; i < Lanes; ++i)
 	{
-		SHA512Compress::Compress128(Input, InOffset, State);
-		memset(&Input[InOffset], 0, BLOCK_SIZE);
-	}
+		for (size_t j = 0; j < 8; ++j)
+			m_dgtState[First + i].H[j] = state[(j * Lanes) + i];
 
-	// finalize state with counter and last compression
-	IntUtils::Be64ToBytes(State.T[1], Input, InOffset + 112);
-	IntUtils::Be64ToBytes(bitLen, Input, InOffset + 120);
-	SHA512Compress::Compress128(Input, InOffset, State);
+		m_dgtState[First + i].Increase(BLKCNT * BLOCK_SIZE);
+	}
 }
 
-void SHA512::ProcessLeaf(const std::vector<byte> &Input, size_t InOffset, SHA512State &State, ulong Length)
+void SHA512::ProcessLeaves(const byte* Input, ulong Length)
 {
-	do
+	const size_t PRLDGR = m_parallelProfile.ParallelMaxDegree();
+	// each leaf is hashed in links of 16 KB, so a leaf can move to an idle thread between links; the links of a leaf run in order
+	const ulong LNKLEN = static_cast<ulong>(m_parallelProfile.ParallelMinimumSize()) * 128;
+	const size_t LNKCNT = static_cast<size_t>((Length + LNKLEN - 1) / LNKLEN);
+	size_t lanes;
+	SHA2Dispatch::Compress512LanesFunc compress = SHA2Dispatch::CompressLanes512(lanes);
+
+	// with more leaves than cores the threads would share cores anyway, so adjacent leaves are packed into vector lanes instead
+	if (compress != nullptr && PRLDGR > m_parallelProfile.ProcessorCount())
 	{
-		Compress(Input, InOffset, State);
-		InOffset += m_parallelProfile.ParallelMinimumSize();
-		Length -= m_parallelProfile.ParallelMinimumSize();
-	} 
-	while (Length > 0);
+		// the degree is always even, so the two lane kernel covers a degree the four lane kernel does not divide
+		if (PRLDGR % lanes != 0)
+		{
+			compress = &SHA512Compress::Compress128x2;
+			lanes = 2;
+		}
+
+		ParallelUtils::ParallelChains(PRLDGR / lanes, LNKCNT, [this, compress, lanes, Input, Length, LNKLEN](size_t i, size_t j)
+		{
+			const ulong LNKOFF = j * LNKLEN;
+			ProcessLeafLanes(compress, lanes, Input + LNKOFF, i * lanes, (std::min)(LNKLEN, Length - LNKOFF));
+		});
+	}
+	else
+	{
+		ParallelUtils::ParallelChains(PRLDGR, LNKCNT, [this, Input, Length, LNKLEN](size_t i, size_t j)
+		{
+			const ulong LNKOFF = j * LNKLEN;
+			ProcessLeaf(Input + LNKOFF + (i * BLOCK_SIZE), m_dgtState[i], (std::min)(LNKLEN, Length - LNKOFF));
+		});
+	}
 }
 
 NAMESPACE_DIGESTEND
\ No newline at end of file
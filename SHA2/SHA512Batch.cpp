@@ -0,0 +1,294 @@
+#include "SHA512Batch.h"
+#include "ArrayUtils.h"
+#include "IntUtils.h"
+#include "SHA2Constants.h"
+#include "SHA2Dispatch.h"
+#include <algorithm>
+#include <array>
+
+NAMESPACE_DIGEST
+
+using Utility::ArrayUtils;
+using Utility::IntUtils;
+
+// a message in flight; full blocks are read in place, the padded final block(s) from the tail buffer
+struct BatchLane512
+{
+	byte Tail[2 * SHA512Batch::BLOCK_SIZE];
+	const byte* Message;
+	size_t Index;
+	size_t Full;
+	size_t Blocks;
+	size_t Position;
+	bool Active;
+
+	// Prefix is the number of bytes already compressed into the starting chaining value
+	void Load(const byte* Input, size_t Length, size_t Prefix, size_t Offset)
+	{
+		const size_t BLKRMD = Length % SHA512Batch::BLOCK_SIZE;
+		const size_t TLBLKS = (BLKRMD < SHA512Batch::BLOCK_SIZE - 16) ? 1 : 2;
+		const ulong MSGLEN = static_cast<ulong>(Prefix + Length);
+
+		Message = Input;
+		Index = Offset;
+		Full = Length / SHA512Batch::BLOCK_SIZE;
+		Blocks = Full + TLBLKS;
+		Position = 0;
+		Active = true;
+
+		std::memset(Tail, 0, sizeof(Tail));
+		if (BLKRMD != 0)
+			std::memcpy(Tail, Input + (Full * SHA512Batch::BLOCK_SIZE), BLKRMD);
+		Tail[BLKRMD] = 0x80;
+		IntUtils::Be64ToBytes(MSGLEN >> 61, Tail + (TLBLKS * SHA512Batch::BLOCK_SIZE) - 16);
+		IntUtils::Be64ToBytes(MSGLEN << 3, Tail + (TLBLKS * SHA512Batch::BLOCK_SIZE) - 8);
+	}
+
+	const byte* Current() const
+	{
+		return (Position < Full) ? Message + (Position * SHA512Batch::BLOCK_SIZE) : Tail + ((Position - Full) * SHA512Batch::BLOCK_SIZE);
+	}
+
+	// the number of blocks that can be read contiguously from the current position
+	size_t Run() const
+	{
+		return (Position < Full) ? Full - Position : Blocks - Position;
+	}
+};
+
+static void StoreDigest(const std::array<ulong, 8> &State, byte* Output)
+{
+	for (size_t i = 0; i < 8; ++i)
+		IntUtils::Be64ToBytes(State[i], Output + (i * sizeof(ulong)));
+}
+
+static void FinishLane(BatchLane512 &Lane, std::array<ulong, 8> &State, byte* Output)
+{
+	SHA2Dispatch::Compress512Func compress = SHA2Dispatch::Compress512();
+
+	while (Lane.Position != Lane.Blocks)
+	{
+		const size_t BLKCNT = Lane.Run();
+		compress(Lane.Current(), BLKCNT, State);
+		Lane.Position += BLKCNT;
+	}
+
+	StoreDigest(State, Output + (Lane.Index * SHA512Batch::DIGEST_SIZE));
+}
+
+template <size_t Lanes>
+static void ComputeLanes(SHA2Dispatch::Compress512LanesFunc Compress, const std::array<ulong, 8> &Initial, size_t Prefix, const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	CEX_ALIGN_DATA(32) ulong state[8 * Lanes];
+	BatchLane512 lane[Lanes];
+	const byte* blocks[Lanes];
+	std::array<ulong, 8> single;
+	size_t active = 0;
+	size_t next = 0;
+
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		lane[i].Active = false;
+
+		if (next < Count)
+		{
+			lane[i].Load(Input[next], Length[next], Prefix, next);
+			++next;
+			++active;
+		}
+
+		for (size_t j = 0; j < 8; ++j)
+			state[(j * Lanes) + i] = Initial[j];
+	}
+
+	// a single remaining message is faster on the one stream kernel than in a mostly idle vector
+	while (active > 1 || (active != 0 && next < Count))
+	{
+		const byte* spare = nullptr;
+		size_t run = ~static_cast<size_t>(0);
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			if (lane[i].Active)
+			{
+				blocks[i] = lane[i].Current();
+				spare = blocks[i];
+				run = (std::min)(run, lane[i].Run());
+			}
+		}
+
+		// idle lanes recompute an active lane's blocks; their state is discarded when the lane is reloaded
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			if (!lane[i].Active)
+				blocks[i] = spare;
+		}
+
+		Compress(blocks, run, state);
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			if (!lane[i].Active)
+				continue;
+
+			lane[i].Position += run;
+
+			if (lane[i].Position == lane[i].Blocks)
+			{
+				for (size_t j = 0; j < 8; ++j)
+				{
+					single[j] = state[(j * Lanes) + i];
+					state[(j * Lanes) + i] = Initial[j];
+				}
+
+				StoreDigest(single, Output + (lane[i].Index * SHA512Batch::DIGEST_SIZE));
+
+				if (next < Count)
+				{
+					lane[i].Load(Input[next], Length[next], Prefix, next);
+					++next;
+				}
+				else
+				{
+					lane[i].Active = false;
+					--active;
+				}
+			}
+		}
+	}
+
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		if (lane[i].Active)
+		{
+			for (size_t j = 0; j < 8; ++j)
+				single[j] = state[(j * Lanes) + i];
+
+			FinishLane(lane[i], single, Output);
+		}
+	}
+}
+
+static void ComputeFrom(const std::array<ulong, 8> &Initial, size_t Prefix, const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	size_t lanes;
+	SHA2Dispatch::Compress512LanesFunc compress = SHA2Dispatch::CompressLanes512(lanes);
+
+	if (lanes == 4)
+	{
+		ComputeLanes<4>(compress, Initial, Prefix, Input, Length, Count, Output);
+	}
+	else if (lanes == 2)
+	{
+		ComputeLanes<2>(compress, Initial, Prefix, Input, Length, Count, Output);
+	}
+	else
+	{
+		BatchLane512 lane;
+		std::array<ulong, 8> state;
+
+		for (size_t i = 0; i < Count; ++i)
+		{
+			lane.Load(Input[i], Length[i], Prefix, i);
+			state = Initial;
+			FinishLane(lane, state, Output);
+		}
+	}
+}
+
+//~~~Public Functions~~~//
+
+size_t SHA512Batch::Lanes()
+{
+	size_t lanes;
+	SHA2Dispatch::CompressLanes512(lanes);
+
+	return lanes;
+}
+
+void SHA512Batch::Compute(const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	ComputeFrom(SHA512_IV, 0, Input, Length, Count, Output);
+}
+
+void SHA512Batch::Compute(const std::vector<std::vector<byte>> &Input, std::vector<std::vector<byte>> &Output)
+{
+	std::vector<const byte*> msgPtr(Input.size());
+	std::vector<size_t> msgLen(Input.size());
+	std::vector<byte> hashes(Input.size() * DIGEST_SIZE);
+
+	for (size_t i = 0; i < Input.size(); ++i)
+	{
+		msgPtr[i] = Input[i].size() != 0 ? &Input[i][0] : nullptr;
+		msgLen[i] = Input[i].size();
+	}
+
+	if (Input.size() != 0)
+		Compute(&msgPtr[0], &msgLen[0], Input.size(), &hashes[0]);
+
+	Output.resize(Input.size());
+	for (size_t i = 0; i < Input.size(); ++i)
+		Output[i].assign(hashes.begin() + (i * DIGEST_SIZE), hashes.begin() + ((i + 1) * DIGEST_SIZE));
+}
+
+void SHA512Batch::Hmac(const byte* Key, size_t KeyLength, const byte* const* Input, const size_t* Length, size_t Count, byte* Output)
+{
+	if (Count == 0)
+		return;
+
+	std::vector<byte> ipad(BLOCK_SIZE, 0);
+	std::vector<byte> opad(BLOCK_SIZE, 0);
+	std::vector<byte> inner(Count * DIGEST_SIZE);
+	std::vector<const byte*> innerPtr(Count);
+	std::vector<size_t> innerLen(Count, static_cast<size_t>(DIGEST_SIZE));
+	std::array<ulong, 8> innerState = SHA512_IV;
+	std::array<ulong, 8> outerState = SHA512_IV;
+
+	if (KeyLength > BLOCK_SIZE)
+		Compute(&Key, &KeyLength, 1, &ipad[0]);
+	else if (KeyLength != 0)
+		std::memcpy(&ipad[0], Key, KeyLength);
+
+	for (size_t i = 0; i < BLOCK_SIZE; ++i)
+	{
+		opad[i] = ipad[i] ^ 0x5C;
+		ipad[i] ^= 0x36;
+	}
+
+	// the key blocks are compressed once, and every lane of both passes starts from these chaining values
+	SHA2Dispatch::Compress512()(&ipad[0], 1, innerState);
+	SHA2Dispatch::Compress512()(&opad[0], 1, outerState);
+
+	ComputeFrom(innerState, BLOCK_SIZE, Input, Length, Count, &inner[0]);
+
+	for (size_t i = 0; i < Count; ++i)
+		innerPtr[i] = &inner[i * DIGEST_SIZE];
+
+	ComputeFrom(outerState, BLOCK_SIZE, &innerPtr[0], &innerLen[0], Count, Output);
+
+	ArrayUtils::ClearVector(ipad);
+	ArrayUtils::ClearVector(opad);
+	ArrayUtils::ClearVector(inner);
+}
+
+void SHA512Batch::Hmac(const std::vector<byte> &Key, const std::vector<std::vector<byte>> &Input, std::vector<std::vector<byte>> &Output)
+{
+	std::vector<const byte*> msgPtr(Input.size());
+	std::vector<size_t> msgLen(Input.size());
+	std::vector<byte> codes(Input.size() * DIGEST_SIZE);
+
+	for (size_t i = 0; i < Input.size(); ++i)
+	{
+		msgPtr[i] = Input[i].size() != 0 ? &Input[i][0] : nullptr;
+		msgLen[i] = Input[i].size();
+	}
+
+	if (Input.size() != 0)
+		Hmac(Key.size() != 0 ? &Key[0] : nullptr, Key.size(), &msgPtr[0], &msgLen[0], Input.size(), &codes[0]);
+
+	Output.resize(Input.size());
+	for (size_t i = 0; i < Input.size(); ++i)
+		Output[i].assign(codes.begin() + (i * DIGEST_SIZE), codes.begin() + ((i + 1) * DIGEST_SIZE));
+}
+
+NAMESPACE_DIGESTEND
@@ -0,0 +1,101 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _CEX_SHA512BATCH_H
+#define _CEX_SHA512BATCH_H
+
+#include "CexDomain.h"
+
+NAMESPACE_DIGEST
+
+/// <summary>
+/// Computes the SHA-512 hashes and HMAC-SHA512 codes of many independent messages with the multi-buffer kernels
+/// </summary>
+/// 
+/// <example>
+/// <description>Authenticating a set of records with one key:</description>
+/// <code>
+/// std::vector&lt;std::vector&lt;byte&gt;&gt; codes;
+/// SHA512Batch::Hmac(key, records, codes);
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>Each message occupies one 64 bit lane of an AVX2 (4 lanes) or SSE4.1 (2 lanes) register, and every lane carries its own length and padding.
+/// A lane that finishes its message is refilled with the next one, and the last message of a batch is completed with the single stream kernel.
+/// When the scalar kernel is forced through SHA2Dispatch, messages are hashed one at a time.</para>
+/// <para>The HMAC inner pass starts every lane from the chaining value of the padded key block, so the key blocks are compressed once per batch rather than once per message;
+/// the outer pass then hashes the inner digests, which fit a single block per lane.</para>
+/// <para>The output is the standard SHA-512 hash or HMAC (RFC 2104) of each message, identical to a sequential implementation.</para>
+/// </remarks>
+class SHA512Batch
+{
+public:
+
+	static const size_t BLOCK_SIZE = 128;
+	static const size_t DIGEST_SIZE = 64;
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Get: The number of messages compressed in parallel on this processor; 1, 2 or 4
+	/// </summary>
+	static size_t Lanes();
+
+	/// <summary>
+	/// Compute the SHA-512 hashes of Count independent messages
+	/// </summary>
+	/// 
+	/// <param name="Input">The message pointers; a pointer may be null if its length is zero</param>
+	/// <param name="Length">The length of each message in bytes</param>
+	/// <param name="Count">The number of messages</param>
+	/// <param name="Output">Receives Count * 64 bytes; the hash of message i is written at offset i * 64</param>
+	static void Compute(const byte* const* Input, const size_t* Length, size_t Count, byte* Output);
+
+	/// <summary>
+	/// Compute the SHA-512 hashes of a set of independent messages
+	/// </summary>
+	/// 
+	/// <param name="Input">The messages</param>
+	/// <param name="Output">Receives one 64 byte hash per message</param>
+	static void Compute(const std::vector<std::vector<byte>> &Input, std::vector<std::vector<byte>> &Output);
+
+	/// <summary>
+	/// Compute the HMAC-SHA512 codes of Count independent messages under one key
+	/// </summary>
+	/// 
+	/// <param name="Key">The MAC key; keys longer than the block size are hashed first</param>
+	/// <param name="KeyLength">The length of the key in bytes</param>
+	/// <param name="Input">The message pointers; a pointer may be null if its length is zero</param>
+	/// <param name="Length">The length of each message in bytes</param>
+	/// <param name="Count">The number of messages</param>
+	/// <param name="Output">Receives Count * 64 bytes; the code of message i is written at offset i * 64</param>
+	static void Hmac(const byte* Key, size_t KeyLength, const byte* const* Input, const size_t* Length, size_t Count, byte* Output);
+
+	/// <summary>
+	/// Compute the HMAC-SHA512 codes of a set of independent messages under one key
+	/// </summary>
+	/// 
+	/// <param name="Key">The MAC key</param>
+	/// <param name="Input">The messages</param>
+	/// <param name="Output">Receives one 64 byte code per message</param>
+	static void Hmac(const std::vector<byte> &Key, const std::vector<std::vector<byte>> &Input, std::vector<std::vector<byte>> &Output);
+};
+
+NAMESPACE_DIGESTEND
+#endif
@@ -16,8 +16,13 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.If not, see <http://www.gnu.org/licenses/>.
 
+#ifndef _CEX_SHA512COMPRESS_H
+#define _CEX_SHA512COMPRESS_H
+
 #include "CexDomain.h"
 #include "IntUtils.h"
+#include "SHA2Constants.h"
+#include <array>
 
 NAMESPACE_DIGEST
 
@@ -31,36 +36,45 @@ class SHA512Compress
 private:
 	static const size_t BLOCK_SIZE = 128;
 
-	static inline ulong BigSigma0(ulong W)
+	static constexpr ulong BigSigma0(ulong W)
 	{
 		return ((W << 36) | (W >> 28)) ^ ((W << 30) | (W >> 34)) ^ ((W << 25) | (W >> 39));
 	}
 
-	static inline ulong BigSigma1(ulong W)
+	static constexpr ulong BigSigma1(ulong W)
 	{
 		return ((W << 50) | (W >> 14)) ^ ((W << 46) | (W >> 18)) ^ ((W << 23) | (W >> 41));
 	}
 
-	static inline ulong Ch(ulong B, ulong C, ulong D)
+	static constexpr ulong Ch(ulong B, ulong C, ulong D)
 	{
 		return (B & C) ^ (~B & D);
 	}
 
-	static inline ulong Maj(ulong B, ulong C, ulong D)
+	static constexpr ulong Maj(ulong B, ulong C, ulong D)
 	{
 		return (B & C) ^ (B & D) ^ (C & D);
 	}
 
-	static inline ulong Sigma0(ulong W)
+	static constexpr ulong Sigma0(ulong W)
 	{
 		return ((W << 63) | (W >> 1)) ^ ((W << 56) | (W >> 8)) ^ (W >> 7);
 	}
 
-	static inline ulong Sigma1(ulong W)
+	static constexpr ulong Sigma1(ulong W)
 	{
 		return ((W << 45) | (W >> 19)) ^ ((W << 3) | (W >> 61)) ^ (W >> 6);
 	}
 
+	// the schedule word of round R; from round 16 the word is expanded in place of the one it replaces
+	static CEX_CONSTEXPR14 ulong ScheduleConstexpr(ulong* W, size_t R)
+	{
+		if (R >= 16)
+			W[R & 15] += Sigma1(W[(R - 2) & 15]) + W[(R - 7) & 15] + Sigma0(W[(R - 15) & 15]);
+
+		return W[R & 15];
+	}
+
 	#define SHA512ROUND(A, B, C, D, E, F, G, H, M, P)			\
 	do {														\
 		ulong R0 = H + BigSigma1(E) + Ch(E, F, G) + P + M;		\
@@ -71,195 +85,387 @@ private:
 
 public:
 
-	template <typename T>
-	static inline void Compress128(const std::vector<byte> &Input, size_t InOffset, T &Output)
+	/// <summary>
+	/// Compress a contiguous run of 128 byte blocks with BMI2 rounds.
+	/// <para>Rotations compile to rorx and the choose function to andn on x64; the message schedule is the portable one.
+	/// The caller must check that the processor supports BMI2.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 128 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static void Compress128BMI2(const byte* Input, size_t BlockCount, std::array<ulong, 8> &State);
+
+	/// <summary>
+	/// Compress a contiguous run of 128 byte blocks with a vectorized message schedule.
+	/// <para>The schedule is expanded four words at a time in AVX2 registers and stored with the round constants added, sixteen words ahead of the rounds; the rounds use rorx.
+	/// The caller must check that the processor supports AVX2 and BMI2.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 128 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static void Compress128AVX2(const byte* Input, size_t BlockCount, std::array<ulong, 8> &State);
+
+	/// <summary>
+	/// Compress a run of blocks from two independent messages in the 64 bit lanes of SSE registers.
+	/// <para>The chaining values are interleaved by word; State[(Word * 2) + Lane].
+	/// The caller must check that the processor supports SSE4.1.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Two pointers, each to the first block of a lane message</param>
+	/// <param name="BlockCount">The number of contiguous 128 byte blocks to compress in every lane</param>
+	/// <param name="State">The 16 word interleaved chaining values</param>
+	static void Compress128x2(const byte* const* Input, size_t BlockCount, ulong* State);
+
+	/// <summary>
+	/// Compress a run of blocks from four independent messages in the 64 bit lanes of AVX2 registers.
+	/// <para>The chaining values are interleaved by word; State[(Word * 4) + Lane].
+	/// The caller must check that the processor supports AVX2.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Four pointers, each to the first block of a lane message</param>
+	/// <param name="BlockCount">The number of contiguous 128 byte blocks to compress in every lane</param>
+	/// <param name="State">The 32 word interleaved chaining values</param>
+	static void Compress128x4(const byte* const* Input, size_t BlockCount, ulong* State);
+
+	/// <summary>
+	/// The portable form of the multi-buffer kernels; compresses each lane in turn with Compress128
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointers to the first block of each lane message</param>
+	/// <param name="BlockCount">The number of contiguous 128 byte blocks to compress in every lane</param>
+	/// <param name="State">The interleaved chaining values; State[(Word * Lanes) + Lane]</param>
+	template <size_t Lanes>
+	static inline void Compress128xN(const byte* const* Input, size_t BlockCount, ulong* State)
 	{
-		ulong A = Output.H[0];
-		ulong B = Output.H[1];
-		ulong C = Output.H[2];
-		ulong D = Output.H[3];
-		ulong E = Output.H[4];
-		ulong F = Output.H[5];
-		ulong G = Output.H[6];
-		ulong H = Output.H[7];
-		ulong W0, W1, W2, W3, W4, W5, W6, W7, W8, W9, W10, W11, W12, W13, W14, W15;
-
-		W0 = IntUtils::BytesToBe64(Input, InOffset);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0x428a2f98d728ae22);
-		W1 = IntUtils::BytesToBe64(Input, InOffset + 8);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0x7137449123ef65cd);
-		W2 = IntUtils::BytesToBe64(Input, InOffset + 16);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0xb5c0fbcfec4d3b2f);
-		W3 = IntUtils::BytesToBe64(Input, InOffset + 24);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0xe9b5dba58189dbbc);
-		W4 = IntUtils::BytesToBe64(Input, InOffset + 32);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x3956c25bf348b538);
-		W5 = IntUtils::BytesToBe64(Input, InOffset + 40);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x59f111f1b605d019);
-		W6 = IntUtils::BytesToBe64(Input, InOffset + 48);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x923f82a4af194f9b);
-		W7 = IntUtils::BytesToBe64(Input, InOffset + 56);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0xab1c5ed5da6d8118);
-		W8 = IntUtils::BytesToBe64(Input, InOffset + 64);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0xd807aa98a3030242);
-		W9 = IntUtils::BytesToBe64(Input, InOffset + 72);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0x12835b0145706fbe);
-		W10 = IntUtils::BytesToBe64(Input, InOffset + 80);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0x243185be4ee4b28c);
-		W11 = IntUtils::BytesToBe64(Input, InOffset + 88);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0x550c7dc3d5ffb4e2);
-		W12 = IntUtils::BytesToBe64(Input, InOffset + 96);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0x72be5d74f27b896f);
-		W13 = IntUtils::BytesToBe64(Input, InOffset + 104);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0x80deb1fe3b1696b1);
-		W14 = IntUtils::BytesToBe64(Input, InOffset + 112);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0x9bdc06a725c71235);
-		W15 = IntUtils::BytesToBe64(Input, InOffset + 120);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0xc19bf174cf692694);
-
-		W0 += Sigma1(W14) + W9 + Sigma0(W1);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0xe49b69c19ef14ad2);
-		W1 += Sigma1(W15) + W10 + Sigma0(W2);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0xefbe4786384f25e3);
-		W2 += Sigma1(W0) + W11 + Sigma0(W3);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0x0fc19dc68b8cd5b5);
-		W3 += Sigma1(W1) + W12 + Sigma0(W4);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0x240ca1cc77ac9c65);
-		W4 += Sigma1(W2) + W13 + Sigma0(W5);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x2de92c6f592b0275);
-		W5 += Sigma1(W3) + W14 + Sigma0(W6);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x4a7484aa6ea6e483);
-		W6 += Sigma1(W4) + W15 + Sigma0(W7);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x5cb0a9dcbd41fbd4);
-		W7 += Sigma1(W5) + W0 + Sigma0(W8);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x76f988da831153b5);
-		W8 += Sigma1(W6) + W1 + Sigma0(W9);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0x983e5152ee66dfab);
-		W9 += Sigma1(W7) + W2 + Sigma0(W10);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0xa831c66d2db43210);
-		W10 += Sigma1(W8) + W3 + Sigma0(W11);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0xb00327c898fb213f);
-		W11 += Sigma1(W9) + W4 + Sigma0(W12);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0xbf597fc7beef0ee4);
-		W12 += Sigma1(W10) + W5 + Sigma0(W13);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0xc6e00bf33da88fc2);
-		W13 += Sigma1(W11) + W6 + Sigma0(W14);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0xd5a79147930aa725);
-		W14 += Sigma1(W12) + W7 + Sigma0(W15);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0x06ca6351e003826f);
-		W15 += Sigma1(W13) + W8 + Sigma0(W0);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0x142929670a0e6e70);
-
-		W0 += Sigma1(W14) + W9 + Sigma0(W1);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0x27b70a8546d22ffc);
-		W1 += Sigma1(W15) + W10 + Sigma0(W2);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0x2e1b21385c26c926);
-		W2 += Sigma1(W0) + W11 + Sigma0(W3);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0x4d2c6dfc5ac42aed);
-		W3 += Sigma1(W1) + W12 + Sigma0(W4);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0x53380d139d95b3df);
-		W4 += Sigma1(W2) + W13 + Sigma0(W5);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x650a73548baf63de);
-		W5 += Sigma1(W3) + W14 + Sigma0(W6);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x766a0abb3c77b2a8);
-		W6 += Sigma1(W4) + W15 + Sigma0(W7);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x81c2c92e47edaee6);
-		W7 += Sigma1(W5) + W0 + Sigma0(W8);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x92722c851482353b);
-		W8 += Sigma1(W6) + W1 + Sigma0(W9);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0xa2bfe8a14cf10364);
-		W9 += Sigma1(W7) + W2 + Sigma0(W10);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0xa81a664bbc423001);
-		W10 += Sigma1(W8) + W3 + Sigma0(W11);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0xc24b8b70d0f89791);
-		W11 += Sigma1(W9) + W4 + Sigma0(W12);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0xc76c51a30654be30);
-		W12 += Sigma1(W10) + W5 + Sigma0(W13);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0xd192e819d6ef5218);
-		W13 += Sigma1(W11) + W6 + Sigma0(W14);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0xd69906245565a910);
-		W14 += Sigma1(W12) + W7 + Sigma0(W15);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0xf40e35855771202a);
-		W15 += Sigma1(W13) + W8 + Sigma0(W0);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0x106aa07032bbd1b8);
-
-		W0 += Sigma1(W14) + W9 + Sigma0(W1);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0x19a4c116b8d2d0c8);
-		W1 += Sigma1(W15) + W10 + Sigma0(W2);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0x1e376c085141ab53);
-		W2 += Sigma1(W0) + W11 + Sigma0(W3);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0x2748774cdf8eeb99);
-		W3 += Sigma1(W1) + W12 + Sigma0(W4);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0x34b0bcb5e19b48a8);
-		W4 += Sigma1(W2) + W13 + Sigma0(W5);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x391c0cb3c5c95a63);
-		W5 += Sigma1(W3) + W14 + Sigma0(W6);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x4ed8aa4ae3418acb);
-		W6 += Sigma1(W4) + W15 + Sigma0(W7);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x5b9cca4f7763e373);
-		W7 += Sigma1(W5) + W0 + Sigma0(W8);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x682e6ff3d6b2b8a3);
-		W8 += Sigma1(W6) + W1 + Sigma0(W9);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0x748f82ee5defb2fc);
-		W9 += Sigma1(W7) + W2 + Sigma0(W10);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0x78a5636f43172f60);
-		W10 += Sigma1(W8) + W3 + Sigma0(W11);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0x84c87814a1f0ab72);
-		W11 += Sigma1(W9) + W4 + Sigma0(W12);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0x8cc702081a6439ec);
-		W12 += Sigma1(W10) + W5 + Sigma0(W13);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0x90befffa23631e28);
-		W13 += Sigma1(W11) + W6 + Sigma0(W14);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0xa4506cebde82bde9);
-		W14 += Sigma1(W12) + W7 + Sigma0(W15);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0xbef9a3f7b2c67915);
-		W15 += Sigma1(W13) + W8 + Sigma0(W0);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0xc67178f2e372532b);
-
-		W0 += Sigma1(W14) + W9 + Sigma0(W1);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0xca273eceea26619c);
-		W1 += Sigma1(W15) + W10 + Sigma0(W2);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0xd186b8c721c0c207);
-		W2 += Sigma1(W0) + W11 + Sigma0(W3);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0xeada7dd6cde0eb1e);
-		W3 += Sigma1(W1) + W12 + Sigma0(W4);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0xf57d4f7fee6ed178);
-		W4 += Sigma1(W2) + W13 + Sigma0(W5);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x06f067aa72176fba);
-		W5 += Sigma1(W3) + W14 + Sigma0(W6);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x0a637dc5a2c898a6);
-		W6 += Sigma1(W4) + W15 + Sigma0(W7);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x113f9804bef90dae);
-		W7 += Sigma1(W5) + W0 + Sigma0(W8);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x1b710b35131c471b);
-		W8 += Sigma1(W6) + W1 + Sigma0(W9);
-		SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0x28db77f523047d84);
-		W9 += Sigma1(W7) + W2 + Sigma0(W10);
-		SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0x32caab7b40c72493);
-		W10 += Sigma1(W8) + W3 + Sigma0(W11);
-		SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0x3c9ebe0a15c9bebc);
-		W11 += Sigma1(W9) + W4 + Sigma0(W12);
-		SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0x431d67c49c100d4c);
-		W12 += Sigma1(W10) + W5 + Sigma0(W13);
-		SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0x4cc5d4becb3e42b6);
-		W13 += Sigma1(W11) + W6 + Sigma0(W14);
-		SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0x597f299cfc657e2a);
-		W14 += Sigma1(W12) + W7 + Sigma0(W15);
-		SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0x5fcb6fab3ad6faec);
-		W15 += Sigma1(W13) + W8 + Sigma0(W0);
-		SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0x6c44198c4a475817);
-
-		Output.H[0] += A;
-		Output.H[1] += B;
-		Output.H[2] += C;
-		Output.H[3] += D;
-		Output.H[4] += E;
-		Output.H[5] += F;
-		Output.H[6] += G;
-		Output.H[7] += H;
-
-		Output.Increase(BLOCK_SIZE); 
+		std::array<ulong, 8> lane;
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			for (size_t j = 0; j < 8; ++j)
+				lane[j] = State[(j * Lanes) + i];
+
+			Compress128(Input[i], BlockCount, lane);
+
+			for (size_t j = 0; j < 8; ++j)
+				State[(j * Lanes) + i] = lane[j];
+		}
+	}
+
+	/// <summary>
+	/// Compress a contiguous run of 128 byte blocks using the portable implementation.
+	/// <para>The chaining value is held in locals for the whole run, and message words are loaded with a byte-swap.</para>
+	/// </summary>
+	/// 
+	/// <param name="Input">Pointer to the first message block</param>
+	/// <param name="BlockCount">The number of contiguous 128 byte blocks to compress</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static inline void Compress128(const byte* Input, size_t BlockCount, std::array<ulong, 8> &State)
+	{
+		ulong S0 = State[0];
+		ulong S1 = State[1];
+		ulong S2 = State[2];
+		ulong S3 = State[3];
+		ulong S4 = State[4];
+		ulong S5 = State[5];
+		ulong S6 = State[6];
+		ulong S7 = State[7];
+
+		while (BlockCount != 0)
+		{
+			ulong A = S0;
+			ulong B = S1;
+			ulong C = S2;
+			ulong D = S3;
+			ulong E = S4;
+			ulong F = S5;
+			ulong G = S6;
+			ulong H = S7;
+			ulong W0, W1, W2, W3, W4, W5, W6, W7, W8, W9, W10, W11, W12, W13, W14, W15;
+
+			W0 = IntUtils::BytesToBe64(Input);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0x428a2f98d728ae22);
+			W1 = IntUtils::BytesToBe64(Input + 8);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0x7137449123ef65cd);
+			W2 = IntUtils::BytesToBe64(Input + 16);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0xb5c0fbcfec4d3b2f);
+			W3 = IntUtils::BytesToBe64(Input + 24);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0xe9b5dba58189dbbc);
+			W4 = IntUtils::BytesToBe64(Input + 32);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x3956c25bf348b538);
+			W5 = IntUtils::BytesToBe64(Input + 40);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x59f111f1b605d019);
+			W6 = IntUtils::BytesToBe64(Input + 48);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x923f82a4af194f9b);
+			W7 = IntUtils::BytesToBe64(Input + 56);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0xab1c5ed5da6d8118);
+			W8 = IntUtils::BytesToBe64(Input + 64);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0xd807aa98a3030242);
+			W9 = IntUtils::BytesToBe64(Input + 72);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0x12835b0145706fbe);
+			W10 = IntUtils::BytesToBe64(Input + 80);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0x243185be4ee4b28c);
+			W11 = IntUtils::BytesToBe64(Input + 88);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0x550c7dc3d5ffb4e2);
+			W12 = IntUtils::BytesToBe64(Input + 96);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0x72be5d74f27b896f);
+			W13 = IntUtils::BytesToBe64(Input + 104);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0x80deb1fe3b1696b1);
+			W14 = IntUtils::BytesToBe64(Input + 112);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0x9bdc06a725c71235);
+			W15 = IntUtils::BytesToBe64(Input + 120);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0xc19bf174cf692694);
+
+			W0 += Sigma1(W14) + W9 + Sigma0(W1);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0xe49b69c19ef14ad2);
+			W1 += Sigma1(W15) + W10 + Sigma0(W2);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0xefbe4786384f25e3);
+			W2 += Sigma1(W0) + W11 + Sigma0(W3);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0x0fc19dc68b8cd5b5);
+			W3 += Sigma1(W1) + W12 + Sigma0(W4);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0x240ca1cc77ac9c65);
+			W4 += Sigma1(W2) + W13 + Sigma0(W5);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x2de92c6f592b0275);
+			W5 += Sigma1(W3) + W14 + Sigma0(W6);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x4a7484aa6ea6e483);
+			W6 += Sigma1(W4) + W15 + Sigma0(W7);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x5cb0a9dcbd41fbd4);
+			W7 += Sigma1(W5) + W0 + Sigma0(W8);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x76f988da831153b5);
+			W8 += Sigma1(W6) + W1 + Sigma0(W9);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0x983e5152ee66dfab);
+			W9 += Sigma1(W7) + W2 + Sigma0(W10);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0xa831c66d2db43210);
+			W10 += Sigma1(W8) + W3 + Sigma0(W11);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0xb00327c898fb213f);
+			W11 += Sigma1(W9) + W4 + Sigma0(W12);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0xbf597fc7beef0ee4);
+			W12 += Sigma1(W10) + W5 + Sigma0(W13);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0xc6e00bf33da88fc2);
+			W13 += Sigma1(W11) + W6 + Sigma0(W14);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0xd5a79147930aa725);
+			W14 += Sigma1(W12) + W7 + Sigma0(W15);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0x06ca6351e003826f);
+			W15 += Sigma1(W13) + W8 + Sigma0(W0);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0x142929670a0e6e70);
+
+			W0 += Sigma1(W14) + W9 + Sigma0(W1);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0x27b70a8546d22ffc);
+			W1 += Sigma1(W15) + W10 + Sigma0(W2);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0x2e1b21385c26c926);
+			W2 += Sigma1(W0) + W11 + Sigma0(W3);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0x4d2c6dfc5ac42aed);
+			W3 += Sigma1(W1) + W12 + Sigma0(W4);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0x53380d139d95b3df);
+			W4 += Sigma1(W2) + W13 + Sigma0(W5);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x650a73548baf63de);
+			W5 += Sigma1(W3) + W14 + Sigma0(W6);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x766a0abb3c77b2a8);
+			W6 += Sigma1(W4) + W15 + Sigma0(W7);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x81c2c92e47edaee6);
+			W7 += Sigma1(W5) + W0 + Sigma0(W8);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x92722c851482353b);
+			W8 += Sigma1(W6) + W1 + Sigma0(W9);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0xa2bfe8a14cf10364);
+			W9 += Sigma1(W7) + W2 + Sigma0(W10);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0xa81a664bbc423001);
+			W10 += Sigma1(W8) + W3 + Sigma0(W11);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0xc24b8b70d0f89791);
+			W11 += Sigma1(W9) + W4 + Sigma0(W12);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0xc76c51a30654be30);
+			W12 += Sigma1(W10) + W5 + Sigma0(W13);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0xd192e819d6ef5218);
+			W13 += Sigma1(W11) + W6 + Sigma0(W14);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0xd69906245565a910);
+			W14 += Sigma1(W12) + W7 + Sigma0(W15);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0xf40e35855771202a);
+			W15 += Sigma1(W13) + W8 + Sigma0(W0);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0x106aa07032bbd1b8);
+
+			W0 += Sigma1(W14) + W9 + Sigma0(W1);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0x19a4c116b8d2d0c8);
+			W1 += Sigma1(W15) + W10 + Sigma0(W2);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0x1e376c085141ab53);
+			W2 += Sigma1(W0) + W11 + Sigma0(W3);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0x2748774cdf8eeb99);
+			W3 += Sigma1(W1) + W12 + Sigma0(W4);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0x34b0bcb5e19b48a8);
+			W4 += Sigma1(W2) + W13 + Sigma0(W5);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x391c0cb3c5c95a63);
+			W5 += Sigma1(W3) + W14 + Sigma0(W6);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x4ed8aa4ae3418acb);
+			W6 += Sigma1(W4) + W15 + Sigma0(W7);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x5b9cca4f7763e373);
+			W7 += Sigma1(W5) + W0 + Sigma0(W8);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x682e6ff3d6b2b8a3);
+			W8 += Sigma1(W6) + W1 + Sigma0(W9);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0x748f82ee5defb2fc);
+			W9 += Sigma1(W7) + W2 + Sigma0(W10);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0x78a5636f43172f60);
+			W10 += Sigma1(W8) + W3 + Sigma0(W11);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0x84c87814a1f0ab72);
+			W11 += Sigma1(W9) + W4 + Sigma0(W12);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0x8cc702081a6439ec);
+			W12 += Sigma1(W10) + W5 + Sigma0(W13);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0x90befffa23631e28);
+			W13 += Sigma1(W11) + W6 + Sigma0(W14);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0xa4506cebde82bde9);
+			W14 += Sigma1(W12) + W7 + Sigma0(W15);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0xbef9a3f7b2c67915);
+			W15 += Sigma1(W13) + W8 + Sigma0(W0);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0xc67178f2e372532b);
+
+			W0 += Sigma1(W14) + W9 + Sigma0(W1);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W0, 0xca273eceea26619c);
+			W1 += Sigma1(W15) + W10 + Sigma0(W2);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W1, 0xd186b8c721c0c207);
+			W2 += Sigma1(W0) + W11 + Sigma0(W3);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W2, 0xeada7dd6cde0eb1e);
+			W3 += Sigma1(W1) + W12 + Sigma0(W4);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W3, 0xf57d4f7fee6ed178);
+			W4 += Sigma1(W2) + W13 + Sigma0(W5);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W4, 0x06f067aa72176fba);
+			W5 += Sigma1(W3) + W14 + Sigma0(W6);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W5, 0x0a637dc5a2c898a6);
+			W6 += Sigma1(W4) + W15 + Sigma0(W7);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W6, 0x113f9804bef90dae);
+			W7 += Sigma1(W5) + W0 + Sigma0(W8);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W7, 0x1b710b35131c471b);
+			W8 += Sigma1(W6) + W1 + Sigma0(W9);
+			SHA512ROUND(A, B, C, D, E, F, G, H, W8, 0x28db77f523047d84);
+			W9 += Sigma1(W7) + W2 + Sigma0(W10);
+			SHA512ROUND(H, A, B, C, D, E, F, G, W9, 0x32caab7b40c72493);
+			W10 += Sigma1(W8) + W3 + Sigma0(W11);
+			SHA512ROUND(G, H, A, B, C, D, E, F, W10, 0x3c9ebe0a15c9bebc);
+			W11 += Sigma1(W9) + W4 + Sigma0(W12);
+			SHA512ROUND(F, G, H, A, B, C, D, E, W11, 0x431d67c49c100d4c);
+			W12 += Sigma1(W10) + W5 + Sigma0(W13);
+			SHA512ROUND(E, F, G, H, A, B, C, D, W12, 0x4cc5d4becb3e42b6);
+			W13 += Sigma1(W11) + W6 + Sigma0(W14);
+			SHA512ROUND(D, E, F, G, H, A, B, C, W13, 0x597f299cfc657e2a);
+			W14 += Sigma1(W12) + W7 + Sigma0(W15);
+			SHA512ROUND(C, D, E, F, G, H, A, B, W14, 0x5fcb6fab3ad6faec);
+			W15 += Sigma1(W13) + W8 + Sigma0(W0);
+			SHA512ROUND(B, C, D, E, F, G, H, A, W15, 0x6c44198c4a475817);
+
+			S0 += A;
+			S1 += B;
+			S2 += C;
+			S3 += D;
+			S4 += E;
+			S5 += F;
+			S6 += G;
+			S7 += H;
+
+			Input += BLOCK_SIZE;
+			--BlockCount;
+		}
+
+		State[0] = S0;
+		State[1] = S1;
+		State[2] = S2;
+		State[3] = S3;
+		State[4] = S4;
+		State[5] = S5;
+		State[6] = S6;
+		State[7] = S7;
+	}
+
+	/// <summary>
+	/// Compress one 128 byte block in a constant expression.
+	/// <para>The reference rounds on a 16 word rolling schedule, using the shared round constant table; the SHA2Constexpr digests are built on it.
+	/// It is evaluated at compile time if the compiler supports relaxed constexpr functions (CEX_HAS_CONSTEXPR14), otherwise it is an ordinary inline function.</para>
+	/// </summary>
+	/// 
+	/// <param name="Block">The 128 byte message block</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static CEX_CONSTEXPR14 void CompressConstexpr(const byte* Block, ulong* State)
+	{
+		ulong W[16] = {};
+		ulong A = State[0];
+		ulong B = State[1];
+		ulong C = State[2];
+		ulong D = State[3];
+		ulong E = State[4];
+		ulong F = State[5];
+		ulong G = State[6];
+		ulong H = State[7];
+
+		for (size_t i = 0; i < 16; ++i)
+		{
+			W[i] = (static_cast<ulong>(Block[i * 8]) << 56) |
+				(static_cast<ulong>(Block[(i * 8) + 1]) << 48) |
+				(static_cast<ulong>(Block[(i * 8) + 2]) << 40) |
+				(static_cast<ulong>(Block[(i * 8) + 3]) << 32) |
+				(static_cast<ulong>(Block[(i * 8) + 4]) << 24) |
+				(static_cast<ulong>(Block[(i * 8) + 5]) << 16) |
+				(static_cast<ulong>(Block[(i * 8) + 6]) << 8) |
+				static_cast<ulong>(Block[(i * 8) + 7]);
+		}
+
+		for (size_t i = 0; i < 80; i += 8)
+		{
+			SHA512ROUND(A, B, C, D, E, F, G, H, ScheduleConstexpr(W, i), SHA512_K[i]);
+			SHA512ROUND(H, A, B, C, D, E, F, G, ScheduleConstexpr(W, i + 1), SHA512_K[i + 1]);
+			SHA512ROUND(G, H, A, B, C, D, E, F, ScheduleConstexpr(W, i + 2), SHA512_K[i + 2]);
+			SHA512ROUND(F, G, H, A, B, C, D, E, ScheduleConstexpr(W, i + 3), SHA512_K[i + 3]);
+			SHA512ROUND(E, F, G, H, A, B, C, D, ScheduleConstexpr(W, i + 4), SHA512_K[i + 4]);
+			SHA512ROUND(D, E, F, G, H, A, B, C, ScheduleConstexpr(W, i + 5), SHA512_K[i + 5]);
+			SHA512ROUND(C, D, E, F, G, H, A, B, ScheduleConstexpr(W, i + 6), SHA512_K[i + 6]);
+			SHA512ROUND(B, C, D, E, F, G, H, A, ScheduleConstexpr(W, i + 7), SHA512_K[i + 7]);
+		}
+
+		State[0] += A;
+		State[1] += B;
+		State[2] += C;
+		State[3] += D;
+		State[4] += E;
+		State[5] += F;
+		State[6] += G;
+		State[7] += H;
+	}
+
+	/// <summary>
+	/// Compress one block whose message schedule was expanded in advance.
+	/// <para>Used for blocks with a constant schedule, such as the padding block of a fixed length message; only the 80 rounds are run.</para>
+	/// </summary>
+	/// 
+	/// <param name="Schedule">The 80 schedule words of the block, with the round constants already added</param>
+	/// <param name="State">The 8 word chaining value</param>
+	static inline void Rounds128(const ulong* Schedule, std::array<ulong, 8> &State)
+	{
+		ulong A = State[0];
+		ulong B = State[1];
+		ulong C = State[2];
+		ulong D = State[3];
+		ulong E = State[4];
+		ulong F = State[5];
+		ulong G = State[6];
+		ulong H = State[7];
+
+		for (size_t i = 0; i < 80; i += 8)
+		{
+			SHA512ROUND(A, B, C, D, E, F, G, H, Schedule[i], 0);
+			SHA512ROUND(H, A, B, C, D, E, F, G, Schedule[i + 1], 0);
+			SHA512ROUND(G, H, A, B, C, D, E, F, Schedule[i + 2], 0);
+			SHA512ROUND(F, G, H, A, B, C, D, E, Schedule[i + 3], 0);
+			SHA512ROUND(E, F, G, H, A, B, C, D, Schedule[i + 4], 0);
+			SHA512ROUND(D, E, F, G, H, A, B, C, Schedule[i + 5], 0);
+			SHA512ROUND(C, D, E, F, G, H, A, B, Schedule[i + 6], 0);
+			SHA512ROUND(B, C, D, E, F, G, H, A, Schedule[i + 7], 0);
+		}
+
+		State[0] += A;
+		State[1] += B;
+		State[2] += C;
+		State[3] += D;
+		State[4] += E;
+		State[5] += F;
+		State[6] += G;
+		State[7] += H;
 	}
 };
 
-NAMESPACE_DIGESTEND
\ No newline at end of file
+NAMESPACE_DIGESTEND
+#endif
@@ -0,0 +1,188 @@
+#include "SHA512Fixed.h"
+#include "IntUtils.h"
+#include "SHA512Compress.h"
+#include "SHA2Dispatch.h"
+#include <array>
+
+NAMESPACE_DIGEST
+
+using Utility::IntUtils;
+
+// the second half of the block of a 64 byte message; the 0x80 terminator, zeros, and the 512 bit length
+static const byte PAD64[64] =
+{
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x00
+};
+
+// the padding block of a 128 byte message; the 0x80 terminator, zeros, and the 1024 bit length
+CEX_ALIGN_DATA(16) static const byte PAD128[128] =
+{
+	0x80, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00
+};
+
+// the expanded schedule of PAD128 with the round constants added
+static const ulong PAD128_SCHEDULE[80] =
+{
+	0xc28a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+	0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+	0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+	0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692a94ULL,
+	0x649b69c19ef14ad2ULL, 0xf03e4786384f45f3ULL, 0x11c1adc68b8cd5b9ULL, 0x240ca1dc77ad9c65ULL,
+	0x3df12c6f5b2b0295ULL, 0x6a74852aaeb0e883ULL, 0xdcb4cbddcd4a0114ULL, 0x36f988da845153c5ULL,
+	0x9b4761d2eea727cbULL, 0xad33ee6d37b932c2ULL, 0xc143c7fbb90f6167ULL, 0x577487c7d5ef1fd6ULL,
+	0xe9250da555d6c804ULL, 0x1652326c7c6f319cULL, 0x9c73c1308a6abe80ULL, 0xedcb859d96f4174fULL,
+	0x05992bbc5302ea46ULL, 0xc0515d8c72d32b21ULL, 0xe27760859b58b01cULL, 0xbd776eecd97e28bfULL,
+	0xfec461e497d05dfbULL, 0x8c65848a09b42f15ULL, 0x1d93677302646f8dULL, 0x71d7625be0029f9bULL,
+	0xed8c8b143b918647ULL, 0x5813345c6ddd5e95ULL, 0x44837edc639f1da6ULL, 0x65309e51db9245d4ULL,
+	0xa4de07e39af7c84cULL, 0xea208293cb3b3d17ULL, 0x33abda924feb6a30ULL, 0x8965f30d8a442337ULL,
+	0x90808dcdb29ea41bULL, 0xe2d6d8dad96f92caULL, 0xfd690c3258486648ULL, 0xddb95f897e662ce2ULL,
+	0x6b2b08dcc03f02bcULL, 0x261c68ddf66cc62cULL, 0xa4f0eddd57c1364dULL, 0xe35537ec1f29acd2ULL,
+	0x27e70659eef7b721ULL, 0xdabbb3bf5db9f4c8ULL, 0x34436c1241ad0e37ULL, 0x0302752801d6306bULL,
+	0xbf77d7d65bedd8cdULL, 0xa9871d46c85cd973ULL, 0x5fdbae1fae40e068ULL, 0x468af1bb676f47b0ULL,
+	0x809520bd379dac58ULL, 0x2766590af071ca9cULL, 0xff96fca3577ecadeULL, 0x1c490d6456b3b489ULL,
+	0xe85734c184192ce6ULL, 0x2ba01930bbb71001ULL, 0xabe1acaf661e43ebULL, 0x120f3b5f15bf003dULL,
+	0xfd7d4cd1515c8209ULL, 0x9cfa18c629a0c327ULL, 0x7e39ff2d2a3f2faeULL, 0x2ff0a5398e575356ULL,
+	0xc9117833006d097eULL, 0x09d40c7849733ff8ULL, 0x774d7c8f5f3aa6bdULL, 0xe04b4161aa09de75ULL
+};
+
+static void StoreDigest(const std::array<ulong, 8> &State, byte* Output)
+{
+	for (size_t i = 0; i < 8; ++i)
+		IntUtils::Be64ToBytes(State[i], Output + (i * sizeof(ulong)));
+}
+
+template <size_t Length, size_t Lanes>
+static void ComputeLanes(SHA2Dispatch::Compress512LanesFunc Compress, const byte* const* Input, size_t Count, byte* Output)
+{
+	CEX_ALIGN_DATA(32) ulong state[8 * Lanes];
+	byte block[Lanes][SHA512Fixed::BLOCK_SIZE];
+	const byte* blocks[Lanes];
+	const byte* padding[Lanes];
+	std::array<ulong, 8> single;
+	size_t next = 0;
+
+	// the padded tails of the 64 byte messages are written once; only the message halves change
+	for (size_t i = 0; i < Lanes; ++i)
+	{
+		if (Length == 64)
+			std::memcpy(block[i] + 64, PAD64, sizeof(PAD64));
+
+		padding[i] = PAD128;
+	}
+
+	// below a quarter of the lanes the vector rounds cost more than hashing the remainder one at a time
+	const size_t MINACT = (Lanes / 4 != 0) ? Lanes / 4 : 1;
+
+	while (Count - next > MINACT)
+	{
+		const size_t LNCNT = (Count - next < Lanes) ? Count - next : Lanes;
+
+		for (size_t i = 0; i < Lanes; ++i)
+		{
+			// idle lanes of the last group recompute the first message of the group, and their output is discarded
+			const byte* msg = Input[next + ((i < LNCNT) ? i : 0)];
+
+			if (Length == 64)
+			{
+				std::memcpy(block[i], msg, 64);
+				blocks[i] = block[i];
+			}
+			else
+			{
+				blocks[i] = msg;
+			}
+
+			for (size_t j = 0; j < 8; ++j)
+				state[(j * Lanes) + i] = SHA512_IV[j];
+		}
+
+		Compress(blocks, 1, state);
+
+		if (Length == 128)
+			Compress(padding, 1, state);
+
+		for (size_t i = 0; i < LNCNT; ++i)
+		{
+			for (size_t j = 0; j < 8; ++j)
+				single[j] = state[(j * Lanes) + i];
+
+			StoreDigest(single, Output + ((next + i) * SHA512Fixed::DIGEST_SIZE));
+		}
+
+		next += LNCNT;
+	}
+
+	for (; next < Count; ++next)
+	{
+		if (Length == 64)
+			SHA512Fixed::Compute<64>(Input[next], Output + (next * SHA512Fixed::DIGEST_SIZE));
+		else
+			SHA512Fixed::Compute<128>(Input[next], Output + (next * SHA512Fixed::DIGEST_SIZE));
+	}
+}
+
+template <size_t Length>
+static void ComputeFrom(const byte* const* Input, size_t Count, byte* Output)
+{
+	size_t lanes;
+	SHA2Dispatch::Compress512LanesFunc compress = SHA2Dispatch::CompressLanes512(lanes);
+
+	if (lanes == 4)
+	{
+		ComputeLanes<Length, 4>(compress, Input, Count, Output);
+	}
+	else if (lanes == 2)
+	{
+		ComputeLanes<Length, 2>(compress, Input, Count, Output);
+	}
+	else
+	{
+		for (size_t i = 0; i < Count; ++i)
+			SHA512Fixed::Compute<Length>(Input[i], Output + (i * SHA512Fixed::DIGEST_SIZE));
+	}
+}
+
+//~~~Private Functions~~~//
+
+void SHA512Fixed::Compute64(const byte* Input, byte* Output)
+{
+	CEX_ALIGN_DATA(16) byte block[BLOCK_SIZE];
+	std::array<ulong, 8> state = SHA512_IV;
+
+	std::memcpy(block, Input, 64);
+	std::memcpy(block + 64, PAD64, sizeof(PAD64));
+	SHA2Dispatch::Compress512()(block, 1, state);
+	StoreDigest(state, Output);
+}
+
+void SHA512Fixed::Compute64(const byte* const* Input, size_t Count, byte* Output)
+{
+	ComputeFrom<64>(Input, Count, Output);
+}
+
+void SHA512Fixed::Compute128(const byte* Input, byte* Output)
+{
+	std::array<ulong, 8> state = SHA512_IV;
+
+	SHA2Dispatch::Compress512()(Input, 1, state);
+	// the padding block has no message dependent schedule words, so only its rounds are run
+	SHA512Compress::Rounds128(PAD128_SCHEDULE, state);
+	StoreDigest(state, Output);
+}
+
+void SHA512Fixed::Compute128(const byte* const* Input, size_t Count, byte* Output)
+{
+	ComputeFrom<128>(Input, Count, Output);
+}
+
+NAMESPACE_DIGESTEND
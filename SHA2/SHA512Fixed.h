@@ -0,0 +1,104 @@
+// The GPL version 3 License (GPLv3)
+// 
+// Copyright (c) 2017 vtdev.com
+// This file is part of the CEX Cryptographic library.
+// 
+// This program is free software : you can redistribute it and / or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef _CEX_SHA512FIXED_H
+#define _CEX_SHA512FIXED_H
+
+#include "CexDomain.h"
+
+NAMESPACE_DIGEST
+
+/// <summary>
+/// SHA-512 of fixed length messages; 64 bytes (a hash) or 128 bytes (a pair of hashes, or a block of key material)
+/// </summary>
+/// 
+/// <example>
+/// <description>Hashing a Merkle node from its two children:</description>
+/// <code>
+/// byte node[128]; // left child hash || right child hash
+/// byte parent[64];
+/// SHA512Fixed::Compute&lt;128&gt;(node, parent);
+/// </code>
+/// </example>
+/// 
+/// <remarks>
+/// <para>The message length is a template parameter, so the padding is a constant rather than being built per message,
+/// and no digest instance, message buffer or state reset is involved.
+/// The padding block of a 128 byte message does not depend on the message at all; its message schedule is a precomputed table,
+/// and only the rounds are run for it.
+/// A 64 byte message shares its only block with the padding, which is copied in from a constant.</para>
+/// <para>The multi-buffer form compresses the messages in the lanes of the active multi-buffer kernel (see SHA2Dispatch::CompressLanes512).
+/// The output is the standard SHA-512 hash of each message.</para>
+/// </remarks>
+class SHA512Fixed
+{
+public:
+
+	static const size_t BLOCK_SIZE = 128;
+	static const size_t DIGEST_SIZE = 64;
+
+	//~~~Public Functions~~~//
+
+	/// <summary>
+	/// Compute the SHA-512 hash of a message of Length bytes
+	/// </summary>
+	/// 
+	/// <param name="Input">The message; Length bytes are read</param>
+	/// <param name="Output">Receives the 64 byte hash</param>
+	///
+	/// <typeparam name="Length">The message length; 64 or 128 bytes</typeparam>
+	template <size_t Length>
+	static void Compute(const byte* Input, byte* Output)
+	{
+		static_assert(Length == 64 || Length == 128, "SHA512Fixed: the message length must be 64 or 128 bytes");
+
+		if (Length == 64)
+			Compute64(Input, Output);
+		else
+			Compute128(Input, Output);
+	}
+
+	/// <summary>
+	/// Compute the SHA-512 hashes of Count independent messages of Length bytes
+	/// </summary>
+	/// 
+	/// <param name="Input">The message pointers; Length bytes are read from each</param>
+	/// <param name="Count">The number of messages</param>
+	/// <param name="Output">Receives Count * 64 bytes; the hash of message i is written at offset i * 64</param>
+	///
+	/// <typeparam name="Length">The message length; 64 or 128 bytes</typeparam>
+	template <size_t Length>
+	static void Compute(const byte* const* Input, size_t Count, byte* Output)
+	{
+		static_assert(Length == 64 || Length == 128, "SHA512Fixed: the message length must be 64 or 128 bytes");
+
+		if (Length == 64)
+			Compute64(Input, Count, Output);
+		else
+			Compute128(Input, Count, Output);
+	}
+
+private:
+	static void Compute64(const byte* Input, byte* Output);
+	static void Compute64(const byte* const* Input, size_t Count, byte* Output);
+	static void Compute128(const byte* Input, byte* Output);
+	static void Compute128(const byte* const* Input, size_t Count, byte* Output);
+};
+
+NAMESPACE_DIGESTEND
+#endif
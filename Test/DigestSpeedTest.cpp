@@ -1,13 +1,250 @@
 #include "DigestSpeedTest.h"
 #include "../SHA2/SHA256.h"
 #include "../SHA2/SHA512.h"
+#include "../SHA2/SHA256Batch.h"
+#include "../SHA2/SHA512Batch.h"
+#include "../SHA2/SHA256Fixed.h"
+#include "../SHA2/SHA256Multiplexer.h"
+#include "../SHA2/SHA512Fixed.h"
+#include "../SHA2/SHA512Compress.h"
+#include "../SHA2/CpuDetect.h"
 #include "../SHA2/DigestFromName.h"
+#include "../SHA2/DigestPool.h"
+#include "../SHA2/ParallelOptions.h"
+#include "../SHA2/ParallelUtils.h"
+#include "../SHA2/SHA2Dispatch.h"
+#include "../SHA2/SHA2Engine.h"
 #include "../SHA2/IntUtils.h"
+#include <atomic>
+#include <future>
 
 namespace Test
 {
+	using CEX::Common::CpuDetect;
+	using CEX::Common::ParallelOptions;
+	using CEX::Digest::DigestPool;
 	using CEX::Digest::IDigest;
+	using CEX::Digest::SHA256;
+	using CEX::Digest::SHA256Batch;
+	using CEX::Digest::SHA256Fixed;
+	using CEX::Digest::SHA256Multiplexer;
+	using CEX::Digest::SHA512;
+	using CEX::Digest::SHA512Batch;
+	using CEX::Digest::SHA512Compress;
+	using CEX::Digest::SHA512Fixed;
+	using CEX::Digest::SHA2Dispatch;
+	using CEX::Digest::SHA2Engine;
+	using CEX::Digest::SHA256PortableTraits;
+	using CEX::Digest::SHA256Traits;
+	using CEX::Digest::SHA512PortableTraits;
+	using CEX::Digest::SHA512Traits;
+	using CEX::Enumeration::SHA2Kernels;
 	using CEX::Utility::IntUtils;
+	using CEX::Utility::ParallelUtils;
+
+	// the time to hash Count messages with one reused engine; the calls are resolved at compile time
+	template <typename Traits>
+	uint64_t EngineTime(std::vector<byte> &Message, size_t Count)
+	{
+		SHA2Engine<Traits> engine;
+		byte hash[Traits::DIGEST_SIZE];
+
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &Message[0]);
+			engine.Update(&Message[0], Message.size());
+			engine.Finalize(hash);
+		}
+
+		return TestUtils::GetTimeMs64() - start;
+	}
+
+	void DigestSpeedTest::Batch512Loop(size_t MessageSize, size_t Count)
+	{
+		std::vector<byte> messages(MessageSize * Count, 0);
+		std::vector<const byte*> msgPtr(Count);
+		std::vector<size_t> msgLen(Count, MessageSize);
+		std::vector<byte> hashes(Count * SHA512Batch::DIGEST_SIZE);
+		std::vector<byte> key(SHA512Batch::DIGEST_SIZE, 0x0B);
+		std::array<ulong, 8> state = { 0 };
+
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &messages[i * MessageSize]);
+			msgPtr[i] = &messages[i * MessageSize];
+		}
+
+		// the portable kernel over the same blocks, one message at a time
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+			SHA512Compress::Compress128(msgPtr[i], MessageSize / SHA512Batch::BLOCK_SIZE, state);
+		uint64_t cmpDur = TestUtils::GetTimeMs64() - start;
+
+		start = TestUtils::GetTimeMs64();
+		SHA512Batch::Compute(&msgPtr[0], &msgLen[0], Count, &hashes[0]);
+		uint64_t btcDur = TestUtils::GetTimeMs64() - start;
+
+		start = TestUtils::GetTimeMs64();
+		SHA512Batch::Hmac(&key[0], key.size(), &msgPtr[0], &msgLen[0], Count, &hashes[0]);
+		uint64_t macDur = TestUtils::GetTimeMs64() - start;
+
+		// gigabytes per second
+		const double LEN = static_cast<double>(MessageSize * Count);
+		std::string cmp = IntUtils::ToString(LEN / ((cmpDur != 0 ? cmpDur : 1) * 1000000.0));
+		std::string btc = IntUtils::ToString(LEN / ((btcDur != 0 ? btcDur : 1) * 1000000.0));
+		std::string mac = IntUtils::ToString(LEN / ((macDur != 0 ? macDur : 1) * 1000000.0));
+		std::string lns = IntUtils::ToString(SHA512Batch::Lanes());
+		std::string resp = std::string(IntUtils::ToString(MessageSize) + " byte messages: Compress128 " + cmp + " GB/s, Batch (" + lns + " lanes) " + btc + " GB/s, HMAC batch " + mac + " GB/s");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+		OnProgress("");
+	}
+
+	void DigestSpeedTest::BatchMessageLoop(size_t MessageSize, size_t Count)
+	{
+		std::vector<byte> messages(MessageSize * Count, 0);
+		std::vector<const byte*> msgPtr(Count);
+		std::vector<size_t> msgLen(Count, MessageSize);
+		std::vector<byte> hashes(Count * SHA256Batch::DIGEST_SIZE);
+
+		for (size_t i = 0; i < Count; ++i)
+		{
+			// distinct messages, so that no lane can share work with another
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &messages[i * MessageSize]);
+			msgPtr[i] = &messages[i * MessageSize];
+		}
+
+		uint64_t start = TestUtils::GetTimeMs64();
+		SHA256Batch::Compute(&msgPtr[0], &msgLen[0], Count, &hashes[0]);
+		uint64_t btcDur = TestUtils::GetTimeMs64() - start;
+
+		SHA256 dgt;
+		std::vector<byte> hash(SHA256Batch::DIGEST_SIZE);
+
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			dgt.Update(messages, i * MessageSize, MessageSize);
+			dgt.Finalize(hash, 0);
+		}
+		uint64_t serDur = TestUtils::GetTimeMs64() - start;
+
+		// messages per second
+		std::string btc = IntUtils::ToString((Count * 1000) / (btcDur != 0 ? btcDur : 1));
+		std::string ser = IntUtils::ToString((Count * 1000) / (serDur != 0 ? serDur : 1));
+		std::string lns = IntUtils::ToString(SHA256Batch::Lanes());
+		std::string resp = std::string(IntUtils::ToString(MessageSize) + " byte messages: Batch (" + lns + " lanes) " + btc + " msg/s, One at a time " + ser + " msg/s");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+		OnProgress("");
+	}
+
+	void DigestSpeedTest::ComputeManyLoop(Digests DigestType, size_t MaxSize, size_t Count)
+	{
+		const size_t DGTLEN = (DigestType == Digests::SHA512) ? SHA512Batch::DIGEST_SIZE : SHA256Batch::DIGEST_SIZE;
+		std::vector<byte> messages(MaxSize * Count, 0);
+		std::vector<const byte*> msgPtr(Count);
+		std::vector<size_t> msgLen(Count);
+		std::vector<byte> hashes(Count * DGTLEN);
+		std::vector<byte> hash;
+		ulong seed = 0x9E3779B97F4A7C15ULL;
+
+		// object keys and log records; lengths spread evenly from 1 byte to MaxSize, in arrival order
+		for (size_t i = 0; i < Count; ++i)
+		{
+			seed = (seed * 6364136223846793005ULL) + 1442695040888963407ULL;
+			msgLen[i] = 1 + static_cast<size_t>((seed >> 33) % MaxSize);
+			msgPtr[i] = &messages[i * MaxSize];
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &messages[i * MaxSize]);
+		}
+
+		uint64_t start = TestUtils::GetTimeMs64();
+		if (DigestType == Digests::SHA512)
+			SHA512Batch::Compute(&msgPtr[0], &msgLen[0], Count, &hashes[0]);
+		else
+			SHA256Batch::Compute(&msgPtr[0], &msgLen[0], Count, &hashes[0]);
+		uint64_t btcDur = TestUtils::GetTimeMs64() - start;
+
+		start = TestUtils::GetTimeMs64();
+		if (DigestType == Digests::SHA512)
+			SHA512::ComputeMany(&msgPtr[0], &msgLen[0], Count, &hashes[0]);
+		else
+			SHA256::ComputeMany(&msgPtr[0], &msgLen[0], Count, &hashes[0]);
+		uint64_t mnyDur = TestUtils::GetTimeMs64() - start;
+
+		IDigest* dgt = CEX::Helper::DigestFromName::GetInstance(DigestType, false);
+
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			dgt->Update(msgPtr[i], msgLen[i]);
+			dgt->Finalize(&hashes[i * DGTLEN]);
+		}
+		uint64_t serDur = TestUtils::GetTimeMs64() - start;
+
+		delete dgt;
+
+		// messages per second
+		std::string mny = IntUtils::ToString((Count * 1000) / (mnyDur != 0 ? mnyDur : 1));
+		std::string btc = IntUtils::ToString((Count * 1000) / (btcDur != 0 ? btcDur : 1));
+		std::string ser = IntUtils::ToString((Count * 1000) / (serDur != 0 ? serDur : 1));
+		std::string resp = std::string(std::string(DigestType == Digests::SHA512 ? "SHA512" : "SHA256") + ", 1 to " + IntUtils::ToString(MaxSize) + " byte messages: ComputeMany " + mny + " msg/s, Batch " + btc + " msg/s, Compute loop " + ser + " msg/s");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::ConstructionLoop(Digests DigestType, size_t Loops)
+	{
+		const size_t BLKLEN = (DigestType == Digests::SHA512) ? 128 : 64;
+		size_t cores = 0;
+
+		// the processor query every instance paid before the profile was cached
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+		{
+			CpuDetect detect;
+			cores += detect.VirtualCores();
+		}
+		uint64_t cpuDur = TestUtils::GetTimeMs64() - start;
+
+		// the options copied from the cached profile
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+		{
+			ParallelOptions opt(BLKLEN, false, 0, false);
+			cores += opt.ProcessorCount();
+		}
+		uint64_t optDur = TestUtils::GetTimeMs64() - start;
+
+		// a complete sequential instance
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+		{
+			if (DigestType == Digests::SHA512)
+			{
+				SHA512 dgt;
+				cores += dgt.DigestSize();
+			}
+			else
+			{
+				SHA256 dgt;
+				cores += dgt.DigestSize();
+			}
+		}
+		uint64_t dgtDur = TestUtils::GetTimeMs64() - start;
+
+		if (cores == 0)
+			throw std::string("ConstructionLoop: the processor reported no cores!");
+
+		// nanoseconds per construction
+		std::string cpu = IntUtils::ToString((cpuDur * MB1) / Loops);
+		std::string opt = IntUtils::ToString((optDur * MB1) / Loops);
+		std::string dgs = IntUtils::ToString((dgtDur * MB1) / Loops);
+		std::string resp = std::string(std::string(DigestType == Digests::SHA512 ? "SHA512" : "SHA256") + ": Processor query " + cpu + " ns, ParallelOptions " + opt + " ns, Instance " + dgs + " ns");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
 
 	void DigestSpeedTest::DigestBlockLoop(Digests DigestType, size_t SampleSize, size_t Loops, bool Parallel)
 	{
@@ -49,6 +286,435 @@ namespace Test
 		OnProgress("");
 	}
 
+	void DigestSpeedTest::DigestStateLoop(Digests DigestType, size_t Loops, bool Parallel)
+	{
+		std::vector<byte> hash(CEX::Helper::DigestFromName::GetDigestSize(DigestType), 0);
+
+		// construction and destruction of the state
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+		{
+			IDigest* tmp = CEX::Helper::DigestFromName::GetInstance(DigestType, Parallel);
+			delete tmp;
+		}
+		uint64_t ctrDur = TestUtils::GetTimeMs64() - start;
+
+		IDigest* dgt = CEX::Helper::DigestFromName::GetInstance(DigestType, Parallel);
+
+		// state reset
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+			dgt->Reset();
+		uint64_t rstDur = TestUtils::GetTimeMs64() - start;
+
+		// finalize an empty message, includes the internal reset
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+			dgt->Finalize(hash, 0);
+		uint64_t finDur = TestUtils::GetTimeMs64() - start;
+
+		delete dgt;
+
+		// nanoseconds per call
+		std::string ctr = IntUtils::ToString((ctrDur * MB1) / Loops);
+		std::string rst = IntUtils::ToString((rstDur * MB1) / Loops);
+		std::string fin = IntUtils::ToString((finDur * MB1) / Loops);
+		std::string mode = Parallel ? "Parallel: " : "Sequential: ";
+		std::string resp = std::string(mode + "Construct " + ctr + " ns, Reset " + rst + " ns, Finalize " + fin + " ns");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+		OnProgress("");
+	}
+
+	void DigestSpeedTest::DispatchLoop(size_t Tasks, size_t Loops)
+	{
+		std::atomic<size_t> sink(0);
+		std::function<void(size_t)> task = [&sink](size_t i)
+		{
+			sink.fetch_add(i, std::memory_order_relaxed);
+		};
+
+		// the former dispatch, a thread started and joined for every index of every call
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+		{
+			std::vector<std::future<void>> futures;
+
+			for (size_t j = 0; j < Tasks; ++j)
+				futures.push_back(std::async(std::launch::async, task, j));
+
+			for (size_t j = 0; j < futures.size(); ++j)
+				futures[j].wait();
+		}
+		uint64_t asyDur = TestUtils::GetTimeMs64() - start;
+
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Loops; ++i)
+			ParallelUtils::ParallelFor(0, Tasks, task);
+		uint64_t poolDur = TestUtils::GetTimeMs64() - start;
+
+		// nanoseconds per call
+		std::string asy = IntUtils::ToString((asyDur * MB1) / Loops);
+		std::string pld = IntUtils::ToString((poolDur * MB1) / Loops);
+		std::string resp = std::string(IntUtils::ToString(Tasks) + " empty tasks: Thread per index " + asy + " ns, Worker pool " + pld + " ns");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::EngineLoop(Digests DigestType, size_t MessageSize, size_t Count)
+	{
+		std::vector<byte> message(MessageSize, 0);
+		IDigest* dgt = CEX::Helper::DigestFromName::GetInstance(DigestType, false);
+		std::vector<byte> hash(dgt->DigestSize());
+
+		// one reused instance, called through the IDigest interface
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &message[0]);
+			dgt->Update(message, 0, message.size());
+			dgt->Finalize(hash, 0);
+		}
+		uint64_t dgtDur = TestUtils::GetTimeMs64() - start;
+		delete dgt;
+
+		const uint64_t ENGDUR = (DigestType == Digests::SHA512) ? EngineTime<SHA512Traits>(message, Count) : EngineTime<SHA256Traits>(message, Count);
+		const uint64_t PRTDUR = (DigestType == Digests::SHA512) ? EngineTime<SHA512PortableTraits>(message, Count) : EngineTime<SHA256PortableTraits>(message, Count);
+
+		// nanoseconds per message
+		std::string dgs = IntUtils::ToString((dgtDur * MB1) / Count);
+		std::string eng = IntUtils::ToString((ENGDUR * MB1) / Count);
+		std::string prt = IntUtils::ToString((PRTDUR * MB1) / Count);
+		std::string resp = std::string(std::string(DigestType == Digests::SHA512 ? "SHA512" : "SHA256") + ", " + IntUtils::ToString(MessageSize) + " byte messages: IDigest " + dgs + " ns, Engine " + eng + " ns, Portable engine " + prt + " ns");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::FixedLengthLoop(Digests DigestType, size_t MessageSize, size_t Count)
+	{
+		const size_t DGTLEN = CEX::Helper::DigestFromName::GetDigestSize(DigestType);
+		std::vector<byte> messages(MessageSize * Count, 0);
+		std::vector<const byte*> msgPtr(Count);
+		std::vector<byte> hashes(Count * DGTLEN);
+		std::vector<byte> hash(DGTLEN);
+
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &messages[i * MessageSize]);
+			msgPtr[i] = &messages[i * MessageSize];
+		}
+
+		// the digest instance; Update copies into the message buffer, Finalize pads and resets
+		IDigest* dgt = CEX::Helper::DigestFromName::GetInstance(DigestType, false);
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			dgt->Update(messages, i * MessageSize, MessageSize);
+			dgt->Finalize(hash, 0);
+		}
+		uint64_t dgtDur = TestUtils::GetTimeMs64() - start;
+		delete dgt;
+
+		// the fixed length functions, one message at a time and in the multi-buffer lanes
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			if (DigestType == Digests::SHA512)
+			{
+				if (MessageSize == 64)
+					SHA512Fixed::Compute<64>(msgPtr[i], &hashes[i * DGTLEN]);
+				else
+					SHA512Fixed::Compute<128>(msgPtr[i], &hashes[i * DGTLEN]);
+			}
+			else
+			{
+				if (MessageSize == 32)
+					SHA256Fixed::Compute<32>(msgPtr[i], &hashes[i * DGTLEN]);
+				else
+					SHA256Fixed::Compute<64>(msgPtr[i], &hashes[i * DGTLEN]);
+			}
+		}
+		uint64_t sngDur = TestUtils::GetTimeMs64() - start;
+
+		start = TestUtils::GetTimeMs64();
+		if (DigestType == Digests::SHA512)
+		{
+			if (MessageSize == 64)
+				SHA512Fixed::Compute<64>(&msgPtr[0], Count, &hashes[0]);
+			else
+				SHA512Fixed::Compute<128>(&msgPtr[0], Count, &hashes[0]);
+		}
+		else
+		{
+			if (MessageSize == 32)
+				SHA256Fixed::Compute<32>(&msgPtr[0], Count, &hashes[0]);
+			else
+				SHA256Fixed::Compute<64>(&msgPtr[0], Count, &hashes[0]);
+		}
+		uint64_t mltDur = TestUtils::GetTimeMs64() - start;
+
+		// messages per second
+		std::string dgs = IntUtils::ToString((Count * 1000) / (dgtDur != 0 ? dgtDur : 1));
+		std::string sng = IntUtils::ToString((Count * 1000) / (sngDur != 0 ? sngDur : 1));
+		std::string mlt = IntUtils::ToString((Count * 1000) / (mltDur != 0 ? mltDur : 1));
+		std::string resp = std::string(IntUtils::ToString(MessageSize) + " byte messages: Digest " + dgs + " msg/s, Fixed " + sng + " msg/s, Fixed multi-buffer " + mlt + " msg/s");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::KernelCyclesLoop(Digests DigestType, size_t SampleSize, size_t Loops)
+	{
+		const SHA2Kernels kernels[] = { SHA2Kernels::Scalar, SHA2Kernels::BMI2, SHA2Kernels::AVX, SHA2Kernels::AVX2, SHA2Kernels::SHANI };
+		const bool IS512 = (DigestType == Digests::SHA512);
+		const SHA2Kernels active = IS512 ? SHA2Dispatch::Kernel512() : SHA2Dispatch::Kernel256();
+		std::vector<byte> buffer(SampleSize, 0);
+		std::vector<byte> hash(CEX::Helper::DigestFromName::GetDigestSize(DigestType), 0);
+		IDigest* dgt = CEX::Helper::DigestFromName::GetInstance(DigestType, false);
+
+		for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i)
+		{
+			if (IS512 ? !SHA2Dispatch::IsSupported512(kernels[i]) : !SHA2Dispatch::IsSupported256(kernels[i]))
+				continue;
+
+			if (IS512)
+				SHA2Dispatch::SetKernel512(kernels[i]);
+			else
+				SHA2Dispatch::SetKernel256(kernels[i]);
+
+			uint64_t best = ~0ULL;
+
+			// the fastest pass is the least disturbed by the rest of the system
+			for (size_t j = 0; j < Loops; ++j)
+			{
+				uint64_t start = TestUtils::GetCycles64();
+				dgt->Update(buffer, 0, buffer.size());
+				uint64_t dur = TestUtils::GetCycles64() - start;
+
+				if (dur < best)
+					best = dur;
+			}
+
+			dgt->Finalize(hash, 0);
+
+			std::string cpb = IntUtils::ToString(static_cast<double>(best) / SampleSize);
+			std::string resp = std::string(SHA2Dispatch::KernelName(kernels[i]) + ": " + cpb + " cycles per byte");
+			OnProgress(const_cast<char*>(resp.c_str()));
+		}
+
+		if (IS512)
+			SHA2Dispatch::SetKernel512(active);
+		else
+			SHA2Dispatch::SetKernel256(active);
+
+		delete dgt;
+		OnProgress("");
+	}
+
+	void DigestSpeedTest::MidstateLoop(size_t PrefixSize, size_t MessageSize, size_t Count)
+	{
+		std::vector<byte> prefix(PrefixSize, 0x5A);
+		std::vector<byte> message(MessageSize, 0);
+		std::vector<byte> hash(32);
+		SHA256 dgt;
+
+		// the prefix is compressed again for every message
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &message[0]);
+			dgt.Update(prefix, 0, prefix.size());
+			dgt.Update(message, 0, message.size());
+			dgt.Finalize(hash, 0);
+		}
+		uint64_t fulDur = TestUtils::GetTimeMs64() - start;
+
+		// the instance returns to the midstate after each Finalize
+		dgt.Update(prefix, 0, prefix.size());
+		SHA256::SHA256State midstate = dgt.Midstate();
+		dgt.Reset(midstate);
+
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &message[0]);
+			dgt.Update(message, 0, message.size());
+			dgt.Finalize(hash, 0);
+		}
+		uint64_t midDur = TestUtils::GetTimeMs64() - start;
+
+		// constructing an instance from the midstate skips the parallel profile
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count / 10; ++i)
+		{
+			SHA256 tmp(midstate);
+		}
+		uint64_t ctrDur = TestUtils::GetTimeMs64() - start;
+
+		std::string ful = IntUtils::ToString((Count * 1000) / (fulDur != 0 ? fulDur : 1));
+		std::string mid = IntUtils::ToString((Count * 1000) / (midDur != 0 ? midDur : 1));
+		std::string ctr = IntUtils::ToString((ctrDur * MB1) / (Count / 10));
+		std::string resp = std::string(IntUtils::ToString(PrefixSize) + " byte prefix, " + IntUtils::ToString(MessageSize) + " byte messages: Rehashed " + ful + " msg/s, Midstate " + mid + " msg/s, Construct from midstate " + ctr + " ns");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::MultiplexerLoop(size_t Streams, size_t ReadSize, size_t Reads)
+	{
+		std::vector<byte> read(ReadSize, 0);
+		std::vector<size_t> handles(Streams);
+		std::vector<byte> hashes(Streams * SHA256Multiplexer::DIGEST_SIZE);
+		std::vector<byte> hash(SHA256Multiplexer::DIGEST_SIZE);
+		SHA256Multiplexer mux(Streams);
+
+		// every stream receives one read per round, as uploads interleave on a server
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Streams; ++i)
+			handles[i] = mux.Open();
+		for (size_t r = 0; r < Reads; ++r)
+		{
+			for (size_t i = 0; i < Streams; ++i)
+				mux.Update(handles[i], &read[0], ReadSize);
+		}
+		mux.Finalize(&handles[0], Streams, &hashes[0]);
+		uint64_t muxDur = TestUtils::GetTimeMs64() - start;
+
+		std::vector<SHA256*> digests(Streams);
+
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Streams; ++i)
+			digests[i] = new SHA256();
+		for (size_t r = 0; r < Reads; ++r)
+		{
+			for (size_t i = 0; i < Streams; ++i)
+				digests[i]->Update(&read[0], ReadSize);
+		}
+		for (size_t i = 0; i < Streams; ++i)
+			digests[i]->Finalize(&hash[0]);
+		uint64_t serDur = TestUtils::GetTimeMs64() - start;
+
+		for (size_t i = 0; i < Streams; ++i)
+			delete digests[i];
+
+		const uint64_t DATLEN = static_cast<uint64_t>(Streams) * ReadSize * Reads;
+		std::string mxr = IntUtils::ToString(GetBytesPerSecond(muxDur != 0 ? muxDur : 1, DATLEN) / 1000000);
+		std::string ser = IntUtils::ToString(GetBytesPerSecond(serDur != 0 ? serDur : 1, DATLEN) / 1000000);
+		std::string resp = std::string(IntUtils::ToString(Streams) + " streams, " + IntUtils::ToString(ReadSize) + " byte reads: Multiplexer (" + IntUtils::ToString(mux.Lanes()) + " lanes) " + mxr + " MB/s, One SHA256 per stream " + ser + " MB/s");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::OneShotLoop(Digests DigestType, size_t MessageSize, size_t Count)
+	{
+		std::vector<byte> message(MessageSize, 0);
+		std::vector<byte> hash;
+		byte out32[32];
+		byte out64[64];
+
+		// a new instance per message; the options copy, buffers and the reset after Finalize are paid every time
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &message[0]);
+
+			if (DigestType == Digests::SHA512)
+			{
+				SHA512 dgt;
+				dgt.Compute(message, hash);
+			}
+			else
+			{
+				SHA256 dgt;
+				dgt.Compute(message, hash);
+			}
+		}
+		uint64_t dgtDur = TestUtils::GetTimeMs64() - start;
+
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &message[0]);
+
+			if (DigestType == Digests::SHA512)
+				SHA512::Hash(&message[0], message.size(), out64);
+			else
+				SHA256::Hash(&message[0], message.size(), out32);
+		}
+		uint64_t hshDur = TestUtils::GetTimeMs64() - start;
+
+		// nanoseconds per message
+		std::string dgs = IntUtils::ToString((dgtDur * MB1) / Count);
+		std::string hsh = IntUtils::ToString((hshDur * MB1) / Count);
+		std::string resp = std::string(std::string(DigestType == Digests::SHA512 ? "SHA512" : "SHA256") + ", " + IntUtils::ToString(MessageSize) + " byte messages: Instance " + dgs + " ns, Stateless " + hsh + " ns");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::PoolLoop(Digests DigestType, size_t MessageSize, size_t Count, bool Parallel)
+	{
+		std::vector<byte> message(MessageSize, 0);
+		std::vector<byte> hash;
+		DigestPool pool;
+
+		// a new instance per request; the buffers, leaf states and profile are allocated every time
+		uint64_t start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &message[0]);
+			std::unique_ptr<IDigest> dgt = CEX::Helper::DigestFromName::GetUniqueInstance(DigestType, Parallel);
+			dgt->Compute(message, hash);
+		}
+		uint64_t newDur = TestUtils::GetTimeMs64() - start;
+
+		start = TestUtils::GetTimeMs64();
+		for (size_t i = 0; i < Count; ++i)
+		{
+			IntUtils::Be64ToBytes(static_cast<ulong>(i), &message[0]);
+			DigestPool::Lease dgt = pool.Acquire(DigestType, Parallel);
+			dgt->Compute(message, hash);
+		}
+		uint64_t poolDur = TestUtils::GetTimeMs64() - start;
+
+		// nanoseconds per request
+		std::string dgs = IntUtils::ToString((newDur * MB1) / Count);
+		std::string pld = IntUtils::ToString((poolDur * MB1) / Count);
+		std::string resp = std::string(std::string(DigestType == Digests::SHA512 ? "SHA512" : "SHA256") + (Parallel ? " tree" : "") + ", " + IntUtils::ToString(MessageSize) + " byte messages: New instance " + dgs + " ns, Pooled " + pld + " ns");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
+	void DigestSpeedTest::TreeUpdateLoop(Digests DigestType, size_t UpdateSize, size_t SampleSize)
+	{
+		std::vector<byte> buffer(UpdateSize, 0);
+		std::vector<byte> hash;
+		uint64_t rates[2];
+
+		// the same updates in sequential and in tree mode; the tree leaves are hashed by the pool workers
+		for (size_t p = 0; p < 2; ++p)
+		{
+			IDigest* dgt = CEX::Helper::DigestFromName::GetInstance(DigestType, p != 0);
+			hash.resize(dgt->DigestSize());
+			size_t counter = 0;
+
+			uint64_t start = TestUtils::GetTimeMs64();
+			while (counter < SampleSize)
+			{
+				dgt->Update(buffer, 0, buffer.size());
+				counter += buffer.size();
+			}
+			dgt->Finalize(hash, 0);
+			uint64_t dur = TestUtils::GetTimeMs64() - start;
+			delete dgt;
+
+			rates[p] = GetBytesPerSecond(dur != 0 ? dur : 1, counter);
+		}
+
+		std::string seq = IntUtils::ToString(rates[0] / MB1);
+		std::string tre = IntUtils::ToString(rates[1] / MB1);
+		std::string resp = std::string(std::string(DigestType == Digests::SHA512 ? "SHA512" : "SHA256") + ", " + IntUtils::ToString(UpdateSize / 1024) + " KB updates: Sequential " + seq + " MB per Second, Tree " + tre + " MB per Second");
+
+		OnProgress(const_cast<char*>(resp.c_str()));
+	}
+
 	uint64_t DigestSpeedTest::GetBytesPerSecond(uint64_t DurationTicks, uint64_t DataSize)
 	{
 		double sec = (double)DurationTicks / 1000.0;
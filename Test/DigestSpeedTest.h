@@ -60,6 +60,63 @@ namespace Test
 				DigestBlockLoop(Digests::SHA512, MB100, 10, false);
 				OnProgress("***The parallel SHA2 512 digest***");
 				DigestBlockLoop(Digests::SHA512, MB100, 10, true);
+				OnProgress("***The sequential SHA2 512/256 digest, a 256 bit output from the 512 bit rounds***");
+				DigestBlockLoop(Digests::SHA512T256, MB100, 10, false);
+				OnProgress("***SHA2 256 digest construction, Reset and Finalize costs***");
+				DigestStateLoop(Digests::SHA256, 100000, false);
+				DigestStateLoop(Digests::SHA256, 100000, true);
+				OnProgress("***SHA2 512 digest construction, Reset and Finalize costs***");
+				DigestStateLoop(Digests::SHA512, 100000, false);
+				DigestStateLoop(Digests::SHA512, 100000, true);
+				OnProgress("***SHA2 256 short message batches, multi-buffer against one message at a time***");
+				BatchMessageLoop(32, 1000000);
+				BatchMessageLoop(64, 1000000);
+				BatchMessageLoop(256, 250000);
+				OnProgress("***SHA2 mixed length messages, ComputeMany against the batch and a Compute loop***");
+				ComputeManyLoop(Digests::SHA256, 512, 500000);
+				ComputeManyLoop(Digests::SHA512, 1024, 250000);
+				OnProgress("***SHA2 fixed length messages, against a digest instance***");
+				FixedLengthLoop(Digests::SHA256, 32, 1000000);
+				FixedLengthLoop(Digests::SHA256, 64, 1000000);
+				FixedLengthLoop(Digests::SHA512, 64, 1000000);
+				FixedLengthLoop(Digests::SHA512, 128, 1000000);
+				OnProgress("***SHA2 256 messages behind a shared prefix, restored from a midstate against rehashing the prefix***");
+				MidstateLoop(64, 64, 1000000);
+				MidstateLoop(128, 64, 1000000);
+				OnProgress("***SHA2 256 concurrent streams fed small reads, the stream multiplexer against one digest per stream***");
+				MultiplexerLoop(4096, 100, 1000);
+				MultiplexerLoop(4096, 1500, 100);
+				OnProgress("***SHA2 construction latency, the per-instance processor query against the cached profile***");
+				ConstructionLoop(Digests::SHA256, 100000);
+				ConstructionLoop(Digests::SHA512, 100000);
+				OnProgress("***SHA2 one-shot hashes of short messages, a constructed instance against the stateless Hash functions***");
+				OneShotLoop(Digests::SHA256, 100, 1000000);
+				OneShotLoop(Digests::SHA512, 100, 1000000);
+				OnProgress("***SHA2 short messages on a reused instance, the IDigest interface against the SHA2Engine template***");
+				EngineLoop(Digests::SHA256, 64, 1000000);
+				EngineLoop(Digests::SHA512, 128, 1000000);
+				OnProgress("***SHA2 per-request digests, constructed and deleted against leased from a DigestPool***");
+				PoolLoop(Digests::SHA256, 256, 200000, false);
+				PoolLoop(Digests::SHA256, 256, 200000, true);
+				PoolLoop(Digests::SHA512, 256, 200000, true);
+				OnProgress("***ParallelFor dispatch latency, a thread per index against the persistent worker pool***");
+				DispatchLoop(2, 20000);
+				DispatchLoop(8, 20000);
+				OnProgress("***SHA2 tree hash throughput by update size, on the persistent worker pool***");
+				TreeUpdateLoop(Digests::SHA256, 16 * 1024, MB100);
+				TreeUpdateLoop(Digests::SHA256, 64 * 1024, MB100);
+				TreeUpdateLoop(Digests::SHA256, 256 * 1024, MB100);
+				TreeUpdateLoop(Digests::SHA256, 1024 * 1024, MB100);
+				TreeUpdateLoop(Digests::SHA512, 16 * 1024, MB100);
+				TreeUpdateLoop(Digests::SHA512, 1024 * 1024, MB100);
+				OnProgress("");
+				OnProgress("***SHA2 256 single message cycles per byte, by compression kernel***");
+				KernelCyclesLoop(Digests::SHA256, MB1, 100);
+				OnProgress("***SHA2 512 single message cycles per byte, by compression kernel***");
+				KernelCyclesLoop(Digests::SHA512, MB1, 100);
+				OnProgress("***SHA2 512 multi-buffer batches and HMAC, against the portable Compress128 kernel***");
+				Batch512Loop(1024, 100000);
+				Batch512Loop(16384, 8000);
 
 				return MESSAGE;
 			}
@@ -75,7 +132,21 @@ namespace Test
 
 	private:
 
+		void Batch512Loop(size_t MessageSize, size_t Count);
+		void BatchMessageLoop(size_t MessageSize, size_t Count);
+		void ComputeManyLoop(Digests DigestType, size_t MaxSize, size_t Count);
+		void ConstructionLoop(Digests DigestType, size_t Loops);
 		void DigestSpeedTest::DigestBlockLoop(Digests DigestType, size_t SampleSize, size_t Loops, bool Parallel);
+		void DigestStateLoop(Digests DigestType, size_t Loops, bool Parallel);
+		void DispatchLoop(size_t Tasks, size_t Loops);
+		void EngineLoop(Digests DigestType, size_t MessageSize, size_t Count);
+		void FixedLengthLoop(Digests DigestType, size_t MessageSize, size_t Count);
+		void KernelCyclesLoop(Digests DigestType, size_t SampleSize, size_t Loops);
+		void MidstateLoop(size_t PrefixSize, size_t MessageSize, size_t Count);
+		void MultiplexerLoop(size_t Streams, size_t ReadSize, size_t Reads);
+		void OneShotLoop(Digests DigestType, size_t MessageSize, size_t Count);
+		void PoolLoop(Digests DigestType, size_t MessageSize, size_t Count, bool Parallel);
+		void TreeUpdateLoop(Digests DigestType, size_t UpdateSize, size_t SampleSize);
 		uint64_t GetBytesPerSecond(uint64_t DurationTicks, uint64_t DataSize);
 		void OnProgress(char* Data);
 	};
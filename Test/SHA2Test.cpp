@@ -1,9 +1,98 @@
 #include "SHA2Test.h"
+#include "../SHA2/DigestFromName.h"
+#include "../SHA2/DigestPool.h"
+#include "../SHA2/PrefixedHasher.h"
 #include "../SHA2/SHA256.h"
+#include "../SHA2/SHA256d.h"
+#include "../SHA2/SHA256Multiplexer.h"
 #include "../SHA2/SHA512.h"
+#include "../SHA2/SHA256Batch.h"
+#include "../SHA2/SHA512Batch.h"
+#include "../SHA2/SHA256Fixed.h"
+#include "../SHA2/SHA512Fixed.h"
+#include "../SHA2/SHA2Constexpr.h"
+#include "../SHA2/SHA2Dispatch.h"
+#include "../SHA2/SHA2Engine.h"
+#include "../SHA2/ParallelUtils.h"
+#include <atomic>
+#include <thread>
 
 namespace Test
 {
+#if defined(CEX_HAS_CONSTEXPR14)
+	// compares a constant hash with a hex string; the static_asserts below are evaluated by the compiler
+	template <size_t Size>
+	constexpr bool HashEquals(const SHA2Hash<Size> &Hash, const char* Expected)
+	{
+		for (size_t i = 0; i < Size; ++i)
+		{
+			const char HI = Expected[i * 2];
+			const char LO = Expected[(i * 2) + 1];
+			const int VAL = (((HI <= '9') ? HI - '0' : HI - 'a' + 10) << 4) | ((LO <= '9') ? LO - '0' : LO - 'a' + 10);
+
+			if (Hash[i] != VAL)
+				return false;
+		}
+
+		return true;
+	}
+
+	// the NIST vectors of SHA2Test::Initialize
+	static_assert(HashEquals(SHA2Constexpr::Compute256("abc"), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"), "SHA2: constexpr SHA256 vector 1 is not equal!");
+	static_assert(HashEquals(SHA2Constexpr::Compute256(""), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"), "SHA2: constexpr SHA256 vector 2 is not equal!");
+	static_assert(HashEquals(SHA2Constexpr::Compute256("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+		"248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"), "SHA2: constexpr SHA256 vector 3 is not equal!");
+	static_assert(HashEquals(SHA2Constexpr::Compute256("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"),
+		"cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"), "SHA2: constexpr SHA256 vector 4 is not equal!");
+	static_assert(HashEquals(SHA2Constexpr::Compute512("abc"),
+		"ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f"), "SHA2: constexpr SHA512 vector 1 is not equal!");
+	static_assert(HashEquals(SHA2Constexpr::Compute512(""),
+		"cf83e1357eefb8bdf1542850d66d8007d620e4050b5715dc83f4a921d36ce9ce47d0d13c5d85f2b0ff8318d2877eec2f63b931bd47417a81a538327af927da3e"), "SHA2: constexpr SHA512 vector 2 is not equal!");
+	static_assert(HashEquals(SHA2Constexpr::Compute512("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+		"204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c33596fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445"), "SHA2: constexpr SHA512 vector 3 is not equal!");
+	static_assert(HashEquals(SHA2Constexpr::Compute512("abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu"),
+		"8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909"), "SHA2: constexpr SHA512 vector 4 is not equal!");
+#endif
+
+	// hashes a message with an engine, one-shot and in chunks, and compares it with the digest class of the same output size
+	template <typename Traits, typename Digest>
+	void EngineCompare(const std::vector<byte> &Message, size_t OutputSize)
+	{
+		const size_t CHKLEN[4] = { 1, 13, Traits::BLOCK_SIZE, 700 };
+		SHA2Params params(OutputSize, static_cast<uint>(Traits::BLOCK_SIZE), 0);
+		Digest reference(params);
+		SHA2Engine<Traits> engine(OutputSize);
+		std::vector<byte> expected(OutputSize);
+		std::vector<byte> hash(OutputSize);
+
+		reference.Compute(Message, expected);
+
+		SHA2Engine<Traits>::Hash(Message.data(), Message.size(), &hash[0], OutputSize);
+		if (hash != expected)
+			throw TestException("SHA2: Engine one-shot hash is not equal!");
+
+		for (size_t c = 0; c < 4; ++c)
+		{
+			size_t pos = 0;
+
+			while (pos < Message.size())
+			{
+				const size_t LEN = (std::min)(Message.size() - pos, CHKLEN[c]);
+				engine.Update(&Message[pos], LEN);
+				pos += LEN;
+			}
+
+			engine.Peek(&hash[0]);
+			if (hash != expected)
+				throw TestException("SHA2: Engine peek hash is not equal!");
+
+			// finalize resets the engine for the next chunk size
+			engine.Finalize(&hash[0]);
+			if (hash != expected)
+				throw TestException("SHA2: Engine hash is not equal!");
+		}
+	}
+
 	const std::string SHA2Test::DESCRIPTION = "Tests SHA-2 256/512 with NIST KAT vectors.";
 	const std::string SHA2Test::FAILURE = "FAILURE! ";
 	const std::string SHA2Test::SUCCESS = "SUCCESS! All SHA-2 tests have executed succesfully.";
@@ -12,6 +101,9 @@ namespace Test
 		:
 		m_expected256(0),
 		m_expected512(0),
+		m_hmacExpected(0),
+		m_hmacKey(0),
+		m_hmacMessage(0),
 		m_message(0),
 		m_progressEvent()
 	{
@@ -29,6 +121,8 @@ namespace Test
 
 			TreeParamsTest();
 			OnProgress(std::string("Passed SHA2Params parameter serialization test.."));
+			TreeVectorTest();
+			OnProgress(std::string("Passed SHA-2 tree hashing known answer tests.."));
 
 			SHA256* sha256 = new SHA256();
 			CompareVector(sha256, m_message[0], m_expected256[0]);
@@ -46,6 +140,66 @@ namespace Test
 			delete sha512;
 			OnProgress(std::string("Sha2Test: Passed SHA-2 512 bit digest vector tests.."));
 
+			ConstexprTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 constexpr digest tests.."));
+
+			KernelTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 compression kernel tests.."));
+
+			MidstateTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 midstate export and restore tests.."));
+
+			BatchTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 256 multi-buffer batch tests.."));
+
+			Batch512Test();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 512 multi-buffer batch and HMAC tests.."));
+
+			FixedTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 fixed length message tests.."));
+
+			SHA256dTest();
+			OnProgress(std::string("Sha2Test: Passed double SHA-256 digest, header and Merkle tree tests.."));
+
+			TruncatedTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-224, SHA-384, SHA-512/224 and SHA-512/256 vector tests.."));
+
+			PrefixedTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 prefix midstate cache tests.."));
+
+			PointerTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 pointer update and finalize tests.."));
+
+			StatelessTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 stateless one-shot hash tests.."));
+
+			ComputeManyTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 many message tests.."));
+
+			MultiplexerTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-256 stream multiplexer tests.."));
+
+			CloneTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 digest clone tests.."));
+
+			PeekTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 intermediate digest tests.."));
+
+			EngineTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 static engine tests.."));
+
+			MoveTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 digest move tests.."));
+
+			PoolTest();
+			OnProgress(std::string("Sha2Test: Passed SHA-2 digest pool tests.."));
+
+			ParallelForTest();
+			OnProgress(std::string("Sha2Test: Passed parallel loop worker pool tests.."));
+
+			ParallelChainsTest();
+			OnProgress(std::string("Sha2Test: Passed work-stealing ordered chain tests.."));
+
 			return SUCCESS;
 		}
 		catch (std::exception const &ex)
@@ -58,6 +212,177 @@ namespace Test
 		}
 	}
 
+	void SHA2Test::BatchTest()
+	{
+		using CEX::Enumeration::SHA2Kernels;
+
+		std::vector<std::vector<byte>> messages;
+		std::vector<std::vector<byte>> hashes;
+		std::vector<byte> expected(32);
+		SHA256 dgt;
+
+		// the nist messages inside a batch
+		SHA256Batch::Compute(m_message, hashes);
+		for (size_t i = 0; i < m_message.size(); ++i)
+		{
+			if (hashes[i] != m_expected256[i])
+				throw TestException("SHA2: Batch hash is not equal!");
+		}
+
+		// every padding boundary, in uneven lengths so that lanes finish and are refilled at different blocks
+		for (size_t i = 0; i < 300; ++i)
+		{
+			std::vector<byte> msg((i * 7) % 263);
+			for (size_t j = 0; j < msg.size(); ++j)
+				msg[j] = static_cast<byte>(i + j);
+
+			messages.push_back(msg);
+		}
+
+		// the forced kernel decides between the multi-buffer and the one at a time paths
+		const SHA2Kernels kernels[] = { SHA2Kernels::Scalar, SHA2Kernels::BMI2, SHA2Kernels::AVX, SHA2Kernels::AVX2, SHA2Kernels::SHANI };
+		const SHA2Kernels active = SHA2Dispatch::Kernel256();
+
+		for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+		{
+			if (!SHA2Dispatch::IsSupported256(kernels[k]))
+				continue;
+
+			SHA2Dispatch::SetKernel256(kernels[k]);
+
+			for (size_t count = 1; count <= messages.size(); count += 37)
+			{
+				std::vector<std::vector<byte>> batch(messages.begin(), messages.begin() + count);
+				SHA256Batch::Compute(batch, hashes);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					dgt.Compute(batch[i], expected);
+					if (hashes[i] != expected)
+						throw TestException("SHA2: Batch hash is not equal!");
+				}
+			}
+		}
+
+		SHA2Dispatch::SetKernel256(active);
+	}
+
+	void SHA2Test::Batch512Test()
+	{
+		using CEX::Enumeration::SHA2Kernels;
+
+		std::vector<std::vector<byte>> messages;
+		std::vector<std::vector<byte>> hashes;
+		std::vector<byte> expected(64);
+		SHA512 dgt;
+
+		SHA512Batch::Compute(m_message, hashes);
+		for (size_t i = 0; i < m_message.size(); ++i)
+		{
+			if (hashes[i] != m_expected512[i])
+				throw TestException("SHA2: Batch hash is not equal!");
+		}
+
+		// lengths cross both the 112 byte padding boundary and whole blocks
+		for (size_t i = 0; i < 200; ++i)
+		{
+			std::vector<byte> msg((i * 11) % 521);
+			for (size_t j = 0; j < msg.size(); ++j)
+				msg[j] = static_cast<byte>(i + j);
+
+			messages.push_back(msg);
+		}
+
+		const SHA2Kernels active = SHA2Dispatch::Kernel512();
+		const SHA2Kernels kernels[] = { SHA2Kernels::Scalar, SHA2Kernels::BMI2, SHA2Kernels::AVX2 };
+
+		for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+		{
+			if (!SHA2Dispatch::IsSupported512(kernels[k]))
+				continue;
+
+			SHA2Dispatch::SetKernel512(kernels[k]);
+
+			for (size_t count = 1; count <= messages.size(); count += 33)
+			{
+				std::vector<std::vector<byte>> batch(messages.begin(), messages.begin() + count);
+				SHA512Batch::Compute(batch, hashes);
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					dgt.Compute(batch[i], expected);
+					if (hashes[i] != expected)
+						throw TestException("SHA2: Batch hash is not equal!");
+				}
+			}
+
+			// rfc 4231 cases 1, 2 and 6; each message is repeated so that the lanes and the single stream tail are both used
+			for (size_t i = 0; i < m_hmacKey.size(); ++i)
+			{
+				std::vector<std::vector<byte>> batch(5, m_hmacMessage[i]);
+				SHA512Batch::Hmac(m_hmacKey[i], batch, hashes);
+
+				for (size_t j = 0; j < batch.size(); ++j)
+				{
+					if (hashes[j] != m_hmacExpected[i])
+						throw TestException("SHA2: Batch HMAC code is not equal!");
+				}
+			}
+		}
+
+		SHA2Dispatch::SetKernel512(active);
+	}
+
+	void SHA2Test::CloneTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		std::vector<byte> message(3000);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 11);
+
+		const Digests DGTTYPE[4] = { Digests::SHA256, Digests::SHA512, Digests::SHA256d, Digests::SHA384 };
+		// fork points before, inside and across the leaf buffers of the tree hashing mode
+		const size_t FRKPOS[5] = { 0, 1, 700, 1537, 3000 };
+
+		for (size_t d = 0; d < 4; ++d)
+		{
+			for (size_t p = 0; p < 2; ++p)
+			{
+				IDigest* digest = DigestFromName::GetInstance(DGTTYPE[d], p != 0);
+				digest->Compute(message, expected);
+				hash.resize(digest->DigestSize());
+
+				for (size_t f = 0; f < 5; ++f)
+				{
+					digest->Update(message, 0, FRKPOS[f]);
+					IDigest* fork = digest->Clone();
+
+					// the fork finishes the message first, then diverges; the original must not see either
+					fork->Update(message, FRKPOS[f], message.size() - FRKPOS[f]);
+					fork->Finalize(&hash[0]);
+					if (hash != expected)
+						throw TestException("SHA2: Clone hash is not equal!");
+
+					fork->Update(message, 0, 100);
+					fork->Finalize(&hash[0]);
+					delete fork;
+
+					digest->Update(message, FRKPOS[f], message.size() - FRKPOS[f]);
+					digest->Finalize(&hash[0]);
+					if (hash != expected)
+						throw TestException("SHA2: Cloned digest hash is not equal!");
+				}
+
+				delete digest;
+			}
+		}
+	}
+
 	void SHA2Test::CompareVector(IDigest *Digest, std::vector<byte> &Input, std::vector<byte> &Expected)
 	{
 		std::vector<byte> hash(Digest->DigestSize(), 0);
@@ -73,6 +398,278 @@ namespace Test
 			throw TestException("SHA2: Expected hash is not equal!");
 	}
 
+	void SHA2Test::ComputeManyTest()
+	{
+		const size_t MSGCNT = 300;
+		std::vector<byte> message(1000);
+		std::vector<const byte*> msgPtr(MSGCNT);
+		std::vector<size_t> msgLen(MSGCNT);
+		std::vector<byte> hashes256(MSGCNT * 32);
+		std::vector<byte> hashes512(MSGCNT * 64);
+		std::vector<byte> expected;
+		SHA256 dgt256;
+		SHA512 dgt512;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 7);
+
+		// lengths scattered across many block counts in no order, with empty messages from null pointers
+		for (size_t i = 0; i < MSGCNT; ++i)
+		{
+			msgLen[i] = ((i * 389) + (i / 7)) % message.size();
+			if (i % 17 == 0)
+				msgLen[i] = 0;
+			msgPtr[i] = (msgLen[i] != 0) ? &message[i % 13] : nullptr;
+			if (msgLen[i] + (i % 13) > message.size())
+				msgLen[i] = message.size() - (i % 13);
+		}
+
+		for (size_t pass = 0; pass < 2; ++pass)
+		{
+			SHA256::ComputeMany(&msgPtr[0], &msgLen[0], MSGCNT, &hashes256[0]);
+			SHA512::ComputeMany(&msgPtr[0], &msgLen[0], MSGCNT, &hashes512[0]);
+
+			for (size_t i = 0; i < MSGCNT; ++i)
+			{
+				std::vector<byte> msg(msgLen[i]);
+				if (msgLen[i] != 0)
+					std::memcpy(&msg[0], msgPtr[i], msgLen[i]);
+
+				dgt256.Compute(msg, expected);
+				if (std::vector<byte>(hashes256.begin() + (i * 32), hashes256.begin() + ((i + 1) * 32)) != expected)
+					throw TestException("SHA2: SHA256 ComputeMany hash is not equal!");
+
+				dgt512.Compute(msg, expected);
+				if (std::vector<byte>(hashes512.begin() + (i * 64), hashes512.begin() + ((i + 1) * 64)) != expected)
+					throw TestException("SHA2: SHA512 ComputeMany hash is not equal!");
+			}
+
+			// the second pass with every message in the same block count
+			for (size_t i = 0; i < MSGCNT; ++i)
+			{
+				msgPtr[i] = &message[i];
+				msgLen[i] = 100 + (i % 12);
+			}
+		}
+
+		// an empty batch writes nothing
+		SHA256::ComputeMany(nullptr, nullptr, 0, nullptr);
+		SHA512::ComputeMany(nullptr, nullptr, 0, nullptr);
+	}
+
+	void SHA2Test::ConstexprTest()
+	{
+		std::vector<byte> message(300);
+		std::vector<byte> expected;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 13);
+
+		// the same functions at runtime; also covers compilers without relaxed constexpr
+		for (size_t i = 0; i < m_message.size(); ++i)
+		{
+			const byte* msg = m_message[i].size() != 0 ? &m_message[i][0] : nullptr;
+			SHA2Hash<32> hash256 = SHA2Constexpr::Compute256(msg, m_message[i].size());
+			SHA2Hash<64> hash512 = SHA2Constexpr::Compute512(msg, m_message[i].size());
+
+			if (std::vector<byte>(hash256.Bytes, hash256.Bytes + 32) != m_expected256[i])
+				throw TestException("SHA2: Constexpr SHA256 vector is not equal!");
+			if (std::vector<byte>(hash512.Bytes, hash512.Bytes + 64) != m_expected512[i])
+				throw TestException("SHA2: Constexpr SHA512 vector is not equal!");
+		}
+
+		// every padding case; lengths ending before, in and after the length field
+		SHA256 sha256;
+		SHA512 sha512;
+
+		for (size_t i = 0; i <= message.size(); ++i)
+		{
+			std::vector<byte> msg(message.begin(), message.begin() + i);
+			SHA2Hash<32> hash256 = SHA2Constexpr::Compute256(&message[0], i);
+			SHA2Hash<64> hash512 = SHA2Constexpr::Compute512(&message[0], i);
+
+			sha256.Compute(msg, expected);
+			if (std::vector<byte>(hash256.Bytes, hash256.Bytes + 32) != expected)
+				throw TestException("SHA2: Constexpr SHA256 hash is not equal!");
+
+			sha512.Compute(msg, expected);
+			if (std::vector<byte>(hash512.Bytes, hash512.Bytes + 64) != expected)
+				throw TestException("SHA2: Constexpr SHA512 hash is not equal!");
+		}
+	}
+
+	void SHA2Test::EngineTest()
+	{
+		// lengths at either side of the length field and the block boundary of both block sizes
+		const size_t MSGLEN[10] = { 0, 1, 55, 56, 64, 111, 112, 128, 129, 2500 };
+		std::vector<byte> message;
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < 10; ++i)
+		{
+			message.resize(MSGLEN[i]);
+			for (size_t j = 0; j < message.size(); ++j)
+				message[j] = static_cast<byte>((j * 7) + i);
+
+			EngineCompare<SHA256Traits, SHA256>(message, 32);
+			EngineCompare<SHA256Traits, SHA256>(message, 28);
+			EngineCompare<SHA256PortableTraits, SHA256>(message, 32);
+			EngineCompare<SHA256PortableTraits, SHA256>(message, 28);
+			EngineCompare<SHA512Traits, SHA512>(message, 64);
+			EngineCompare<SHA512Traits, SHA512>(message, 48);
+			EngineCompare<SHA512Traits, SHA512>(message, 28);
+			EngineCompare<SHA512PortableTraits, SHA512>(message, 64);
+			EngineCompare<SHA512PortableTraits, SHA512>(message, 32);
+		}
+
+		// a midstate exported by an engine is restored into the digest class, and the reverse
+		SHA2Engine<SHA256PortableTraits> engine256;
+		SHA256 digest256;
+		digest256.Compute(message, expected);
+		engine256.Update(&message[0], 128);
+		SHA256 resumed256(engine256.Midstate());
+		resumed256.Update(message, 128, message.size() - 128);
+		hash.resize(32);
+		resumed256.Finalize(hash, 0);
+		if (hash != expected)
+			throw TestException("SHA2: Engine midstate hash is not equal!");
+
+		SHA512 digest512;
+		digest512.Update(message, 0, 256);
+		SHA2Engine<SHA512Traits> resumed512(digest512.Midstate(), 64);
+		resumed512.Update(&message[256], message.size() - 256);
+		hash.resize(64);
+		resumed512.Finalize(&hash[0]);
+		digest512.Reset();
+		digest512.Compute(message, expected);
+		if (hash != expected)
+			throw TestException("SHA2: Engine midstate hash is not equal!");
+
+		try
+		{
+			SHA2Engine<SHA256Traits> invalid(48);
+			throw TestException("SHA2: Engine accepted an invalid output size!");
+		}
+		catch (CryptoDigestException const &)
+		{
+		}
+
+		// the one-call hash checks the size before storing the state words
+		try
+		{
+			hash.resize(64);
+			SHA2Engine<SHA256Traits>::Hash(&message[0], message.size(), &hash[0], 64);
+			throw TestException("SHA2: Engine hash accepted an invalid output size!");
+		}
+		catch (CryptoDigestException const &)
+		{
+		}
+
+		// states fill whole cache lines, and an aligned array of leaf states starts on one, before and after it grows
+		std::vector<SHA256::SHA256State, CEX::Utility::AlignedAllocator<SHA256::SHA256State, 64>> leaves256(8);
+		std::vector<SHA512::SHA512State, CEX::Utility::AlignedAllocator<SHA512::SHA512State, 64>> leaves512(8);
+
+		if (sizeof(SHA256::SHA256State) != 64 || sizeof(SHA512::SHA512State) != 128)
+			throw TestException("SHA2: A state does not fill whole cache lines!");
+		if (reinterpret_cast<uintptr_t>(leaves256.data()) % 64 != 0 || reinterpret_cast<uintptr_t>(leaves512.data()) % 64 != 0)
+			throw TestException("SHA2: Leaf states are not cache line aligned!");
+
+		leaves256.resize(1000);
+		leaves512.resize(1000);
+
+		if (reinterpret_cast<uintptr_t>(leaves256.data()) % 64 != 0 || reinterpret_cast<uintptr_t>(leaves512.data()) % 64 != 0)
+			throw TestException("SHA2: Leaf states are not cache line aligned!");
+	}
+
+	void SHA2Test::FixedTest()
+	{
+		using CEX::Enumeration::SHA2Kernels;
+
+		const size_t MSGCNT = 21;
+		const SHA2Kernels kernels[] = { SHA2Kernels::Scalar, SHA2Kernels::BMI2, SHA2Kernels::AVX, SHA2Kernels::AVX2, SHA2Kernels::SHANI };
+		const SHA2Kernels active256 = SHA2Dispatch::Kernel256();
+		const SHA2Kernels active512 = SHA2Dispatch::Kernel512();
+		std::vector<byte> messages(MSGCNT * 128);
+		std::vector<const byte*> msgPtr(MSGCNT);
+		std::vector<byte> hashes(MSGCNT * 64);
+		std::vector<byte> expected(64);
+		SHA256 sha256;
+		SHA512 sha512;
+
+		for (size_t i = 0; i < messages.size(); ++i)
+			messages[i] = static_cast<byte>((i * 7) + (i >> 7));
+		for (size_t i = 0; i < MSGCNT; ++i)
+			msgPtr[i] = &messages[i * 128];
+
+		for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+		{
+			if (SHA2Dispatch::IsSupported256(kernels[k]))
+			{
+				SHA2Dispatch::SetKernel256(kernels[k]);
+
+				// every count from a single message up to several full groups of lanes plus a remainder
+				for (size_t count = 1; count <= MSGCNT; ++count)
+				{
+					SHA256Fixed::Compute<32>(&msgPtr[0], count, &hashes[0]);
+					for (size_t i = 0; i < count; ++i)
+					{
+						std::vector<byte> msg(msgPtr[i], msgPtr[i] + 32);
+						sha256.Compute(msg, expected);
+						if (std::memcmp(&hashes[i * 32], &expected[0], 32) != 0)
+							throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " fixed length hash is not equal!");
+					}
+
+					SHA256Fixed::Compute<64>(&msgPtr[0], count, &hashes[0]);
+					for (size_t i = 0; i < count; ++i)
+					{
+						std::vector<byte> msg(msgPtr[i], msgPtr[i] + 64);
+						sha256.Compute(msg, expected);
+						if (std::memcmp(&hashes[i * 32], &expected[0], 32) != 0)
+							throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " fixed length hash is not equal!");
+
+						SHA256Fixed::Compute<64>(msgPtr[i], &hashes[i * 32]);
+						if (std::memcmp(&hashes[i * 32], &expected[0], 32) != 0)
+							throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " fixed length hash is not equal!");
+					}
+				}
+			}
+
+			if (SHA2Dispatch::IsSupported512(kernels[k]))
+			{
+				SHA2Dispatch::SetKernel512(kernels[k]);
+
+				for (size_t count = 1; count <= MSGCNT; ++count)
+				{
+					SHA512Fixed::Compute<64>(&msgPtr[0], count, &hashes[0]);
+					for (size_t i = 0; i < count; ++i)
+					{
+						std::vector<byte> msg(msgPtr[i], msgPtr[i] + 64);
+						sha512.Compute(msg, expected);
+						if (std::memcmp(&hashes[i * 64], &expected[0], 64) != 0)
+							throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " fixed length hash is not equal!");
+					}
+
+					SHA512Fixed::Compute<128>(&msgPtr[0], count, &hashes[0]);
+					for (size_t i = 0; i < count; ++i)
+					{
+						std::vector<byte> msg(msgPtr[i], msgPtr[i] + 128);
+						sha512.Compute(msg, expected);
+						if (std::memcmp(&hashes[i * 64], &expected[0], 64) != 0)
+							throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " fixed length hash is not equal!");
+
+						SHA512Fixed::Compute<128>(msgPtr[i], &hashes[i * 64]);
+						if (std::memcmp(&hashes[i * 64], &expected[0], 64) != 0)
+							throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " fixed length hash is not equal!");
+					}
+				}
+			}
+		}
+
+		SHA2Dispatch::SetKernel256(active256);
+		SHA2Dispatch::SetKernel512(active512);
+	}
+
 	void SHA2Test::Initialize()
 	{
 		const char* messageEncoded[4] =
@@ -101,6 +698,316 @@ namespace Test
 			("8e959b75dae313da8cf4f72814fc143f8f7779c6eb9f7fa17299aeadb6889018501d289e4900f7e4331b99dec4b5433ac7d329eeb6dd26545e96e55b874be909")
 		};
 		HexConverter::Decode(exp512Encoded, 4, m_expected512);
+
+		const char* hmacKeyEncoded[3] =
+		{
+			("0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b0b"),
+			("4a656665"),
+			("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa")
+		};
+		HexConverter::Decode(hmacKeyEncoded, 3, m_hmacKey);
+
+		const char* hmacMessageEncoded[3] =
+		{
+			("4869205468657265"),
+			("7768617420646f2079612077616e7420666f72206e6f7468696e673f"),
+			("54657374205573696e67204c6172676572205468616e20426c6f636b2d53697a65204b6579202d2048617368204b6579204669727374")
+		};
+		HexConverter::Decode(hmacMessageEncoded, 3, m_hmacMessage);
+
+		const char* hmacExpectedEncoded[3] =
+		{
+			("87aa7cdea5ef619d4ff0b4241a1d6cb02379f4e2ce4ec2787ad0b30545e17cdedaa833b7d6b8a702038b274eaea3f4e4be9d914eeb61f1702e696c203a126854"),
+			("164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737"),
+			("80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f3526b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598")
+		};
+		HexConverter::Decode(hmacExpectedEncoded, 3, m_hmacExpected);
+	}
+
+	void SHA2Test::KernelTest()
+	{
+		using CEX::Enumeration::SHA2Kernels;
+
+		const SHA2Kernels kernels[] = { SHA2Kernels::Scalar, SHA2Kernels::BMI2, SHA2Kernels::AVX, SHA2Kernels::AVX2, SHA2Kernels::SHANI };
+		const SHA2Kernels active256 = SHA2Dispatch::Kernel256();
+		const SHA2Kernels active512 = SHA2Dispatch::Kernel512();
+		// a multi-block message, compressed in runs by Update and one block at a time by the byte updates
+		std::vector<byte> message(1000);
+		std::vector<byte> expected256(32);
+		std::vector<byte> expected512(64);
+		std::vector<byte> hash256(32);
+		std::vector<byte> hash512(64);
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i);
+
+		SHA256 sha256;
+		SHA512 sha512;
+		SHA2Dispatch::SetKernel256(SHA2Kernels::Scalar);
+		SHA2Dispatch::SetKernel512(SHA2Kernels::Scalar);
+		sha256.Compute(message, expected256);
+		sha512.Compute(message, expected512);
+
+		for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); ++i)
+		{
+			if (SHA2Dispatch::IsSupported256(kernels[i]))
+			{
+				SHA2Dispatch::SetKernel256(kernels[i]);
+				if (SHA2Dispatch::Kernel256() != kernels[i])
+					throw TestException("SHA2: The requested kernel was not activated!");
+
+				for (size_t j = 0; j < m_message.size(); ++j)
+					CompareVector(&sha256, m_message[j], m_expected256[j]);
+
+				sha256.Compute(message, hash256);
+				if (hash256 != expected256)
+					throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[i]) + " kernel output is not equal!");
+
+				for (size_t j = 0; j < message.size(); ++j)
+					sha256.Update(message[j]);
+				sha256.Finalize(hash256, 0);
+				if (hash256 != expected256)
+					throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[i]) + " kernel output is not equal!");
+			}
+
+			if (SHA2Dispatch::IsSupported512(kernels[i]))
+			{
+				SHA2Dispatch::SetKernel512(kernels[i]);
+				if (SHA2Dispatch::Kernel512() != kernels[i])
+					throw TestException("SHA2: The requested kernel was not activated!");
+
+				for (size_t j = 0; j < m_message.size(); ++j)
+					CompareVector(&sha512, m_message[j], m_expected512[j]);
+
+				sha512.Compute(message, hash512);
+				if (hash512 != expected512)
+					throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[i]) + " kernel output is not equal!");
+
+				for (size_t j = 0; j < message.size(); ++j)
+					sha512.Update(message[j]);
+				sha512.Finalize(hash512, 0);
+				if (hash512 != expected512)
+					throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[i]) + " kernel output is not equal!");
+			}
+		}
+
+		SHA2Dispatch::SetKernel256(active256);
+		SHA2Dispatch::SetKernel512(active512);
+	}
+
+	void SHA2Test::MidstateTest()
+	{
+		std::vector<byte> prefix(256);
+		std::vector<byte> message(300);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < prefix.size(); ++i)
+			prefix[i] = static_cast<byte>(i * 3);
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i + 11);
+
+		// one and two block prefixes, with messages that end before, on and after a block boundary
+		const size_t PRELEN[2][2] = { { 64, 128 }, { 128, 256 } };
+		const size_t MSGLEN[6] = { 0, 1, 55, 64, 129, 300 };
+
+		for (size_t p = 0; p < 2; ++p)
+		{
+			SHA256 sha256;
+			sha256.Update(prefix, 0, PRELEN[0][p]);
+			SHA256::SHA256State state256 = sha256.Midstate();
+			SHA256 restored256(state256);
+			sha256.Reset();
+			SHA512 sha512;
+			sha512.Update(prefix, 0, PRELEN[1][p]);
+			SHA512::SHA512State state512 = sha512.Midstate();
+			SHA512 restored512(state512);
+			sha512.Reset();
+
+			// a truncated variant keeps its output size when reset to its own midstate
+			SHA2Params params(48, 128, 0);
+			SHA512 sha384(params);
+			sha384.Update(prefix, 0, PRELEN[1][p]);
+			SHA512::SHA512State state384 = sha384.Midstate();
+			sha384.Reset(state384);
+
+			for (size_t m = 0; m < 6; ++m)
+			{
+				std::vector<byte> msg(prefix.begin(), prefix.begin() + PRELEN[0][p]);
+				msg.insert(msg.end(), message.begin(), message.begin() + MSGLEN[m]);
+				sha256.Compute(msg, expected);
+				restored256.Compute(std::vector<byte>(message.begin(), message.begin() + MSGLEN[m]), hash);
+				if (hash != expected)
+					throw TestException("SHA2: SHA256 midstate hash is not equal!");
+
+				msg.assign(prefix.begin(), prefix.begin() + PRELEN[1][p]);
+				msg.insert(msg.end(), message.begin(), message.begin() + MSGLEN[m]);
+				sha512.Compute(msg, expected);
+				restored512.Compute(std::vector<byte>(message.begin(), message.begin() + MSGLEN[m]), hash);
+				if (hash != expected)
+					throw TestException("SHA2: SHA512 midstate hash is not equal!");
+
+				SHA512 ref384(params);
+				ref384.Compute(msg, expected);
+				sha384.Compute(std::vector<byte>(message.begin(), message.begin() + MSGLEN[m]), hash);
+				if (hash != expected)
+					throw TestException("SHA2: SHA384 midstate hash is not equal!");
+			}
+		}
+
+		// a prefix that does not end on a block boundary has no midstate
+		SHA256 partial;
+		partial.Update(prefix, 0, 65);
+		try
+		{
+			partial.Midstate();
+			throw TestException("SHA2: SHA256 exported the midstate of a partial block!");
+		}
+		catch (CryptoDigestException const &)
+		{
+		}
+	}
+
+	void SHA2Test::MoveTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		std::vector<byte> message(3000);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 13);
+
+		// a digest moved in the middle of a message finishes it in its new place
+		for (size_t p = 0; p < 2; ++p)
+		{
+			SHA256 source256(p != 0);
+			SHA256 target256(false);
+			source256.Compute(message, expected);
+			source256.Update(message, 0, 1537);
+			SHA256 moved256(std::move(source256));
+			target256.Update(message, 0, 100);
+			target256 = std::move(moved256);
+			target256.Update(message, 1537, message.size() - 1537);
+			hash.resize(target256.DigestSize());
+			target256.Finalize(hash, 0);
+			if (hash != expected)
+				throw TestException("SHA2: Moved SHA256 hash is not equal!");
+
+			SHA2Params params(48, 128, (p != 0) ? 8 : 0);
+			SHA512 source512(params);
+			SHA512 target512(true);
+			source512.Compute(message, expected);
+			source512.Update(message, 0, 700);
+			SHA512 moved512(std::move(source512));
+			target512.Update(message, 0, 100);
+			target512 = std::move(moved512);
+			target512.Update(message, 700, message.size() - 700);
+			hash.resize(target512.DigestSize());
+			target512.Finalize(hash, 0);
+			if (hash != expected)
+				throw TestException("SHA2: Moved SHA512 hash is not equal!");
+		}
+
+		SHA256d source;
+		SHA256d target;
+		source.Compute(message, expected);
+		source.Update(message, 0, 81);
+		target = std::move(source);
+		target.Update(message, 81, message.size() - 81);
+		hash.resize(target.DigestSize());
+		target.Finalize(hash, 0);
+		if (hash != expected)
+			throw TestException("SHA2: Moved SHA256d hash is not equal!");
+
+		std::unique_ptr<IDigest> owned = DigestFromName::GetUniqueInstance(Digests::SHA512T256, false);
+		SHA2Params params(32, 128, 0);
+		SHA512 reference(params);
+		reference.Compute(message, expected);
+		owned->Compute(message, hash);
+		if (hash != expected)
+			throw TestException("SHA2: Unique instance hash is not equal!");
+	}
+
+	void SHA2Test::MultiplexerTest()
+	{
+		using CEX::Enumeration::SHA2Kernels;
+
+		const size_t STMCNT = 100;
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+		std::vector<byte> hashes(STMCNT * 32);
+		SHA256 dgt;
+
+		// the forced kernel decides between the multi-buffer and the one at a time paths
+		const SHA2Kernels kernels[] = { SHA2Kernels::Scalar, SHA2Kernels::AVX2, SHA2Kernels::SHANI };
+		const SHA2Kernels active = SHA2Dispatch::Kernel256();
+
+		for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+		{
+			if (!SHA2Dispatch::IsSupported256(kernels[k]))
+				continue;
+
+			SHA2Dispatch::SetKernel256(kernels[k]);
+
+			SHA256Multiplexer mux(16);
+			std::vector<size_t> streams(STMCNT);
+			std::vector<std::vector<byte>> messages(STMCNT);
+
+			for (size_t i = 0; i < STMCNT; ++i)
+				streams[i] = mux.Open();
+
+			// uneven reads interleaved across the streams, some long enough to fill a stream buffer on their own
+			for (size_t r = 0; r < 12; ++r)
+			{
+				for (size_t i = 0; i < STMCNT; ++i)
+				{
+					std::vector<byte> read(((i * 31) + (r * 17)) % ((i % 10 == 0) ? 700 : 90));
+					for (size_t j = 0; j < read.size(); ++j)
+						read[j] = static_cast<byte>(i + r + j);
+
+					mux.Update(streams[i], read, 0, read.size());
+					messages[i].insert(messages[i].end(), read.begin(), read.end());
+				}
+			}
+
+			// a repeated handle is rejected without changing any stream
+			const size_t dupset[3] = { streams[0], streams[1], streams[0] };
+			try
+			{
+				mux.Finalize(dupset, 3, &hashes[0]);
+				throw TestException("SHA2: Multiplexer accepted a repeated stream!");
+			}
+			catch (CryptoDigestException const &)
+			{
+			}
+
+			// one stream is finalized alone, one is discarded and its slot reused, the rest in one call
+			mux.Finalize(streams[0], hash);
+			dgt.Compute(messages[0], expected);
+			if (hash != expected)
+				throw TestException("SHA2: Multiplexer hash is not equal!");
+
+			mux.Close(streams[1]);
+			streams[1] = mux.Open();
+			messages[1].assign(messages[2].begin(), messages[2].end());
+			mux.Update(streams[1], messages[1], 0, messages[1].size());
+
+			mux.Finalize(&streams[1], STMCNT - 1, &hashes[0]);
+			for (size_t i = 1; i < STMCNT; ++i)
+			{
+				dgt.Compute(messages[i], expected);
+				if (std::vector<byte>(hashes.begin() + ((i - 1) * 32), hashes.begin() + (i * 32)) != expected)
+					throw TestException("SHA2: Multiplexer hash is not equal!");
+			}
+
+			if (mux.Streams() != 0)
+				throw TestException("SHA2: Multiplexer streams were not closed!");
+		}
+
+		SHA2Dispatch::SetKernel256(active);
 	}
 
 	void SHA2Test::OnProgress(std::string Data)
@@ -108,6 +1015,812 @@ namespace Test
 		m_progressEvent(Data);
 	}
 
+	void SHA2Test::ParallelChainsTest()
+	{
+		using CEX::Utility::ParallelUtils;
+
+		// the links of a chain run in order and one at a time, whatever thread runs them
+		const size_t CHNCNT = 12;
+		const size_t LNKCNT = 40;
+		std::vector<std::vector<size_t>> order(CHNCNT);
+		std::vector<std::atomic<bool>> running(CHNCNT);
+		std::atomic<bool> overlap(false);
+
+		for (size_t i = 0; i < CHNCNT; ++i)
+			running[i] = false;
+
+		ParallelUtils::ParallelChains(CHNCNT, LNKCNT, [&order, &running, &overlap](size_t i, size_t j)
+		{
+			if (running[i].exchange(true))
+				overlap = true;
+
+			// uneven links, so the chains drift apart and change threads
+			volatile size_t sink = 0;
+			for (size_t k = 0; k < ((i * 7 + j * 13) % 17) * 1000; ++k)
+				sink = sink + k;
+
+			order[i].push_back(j);
+			running[i] = false;
+		});
+
+		if (overlap)
+			throw TestException("SHA2: Two links of a chain ran at once!");
+
+		for (size_t i = 0; i < CHNCNT; ++i)
+		{
+			for (size_t j = 0; j < LNKCNT; ++j)
+			{
+				if (order[i].size() != LNKCNT || order[i][j] != j)
+					throw TestException("SHA2: The links of a chain did not run in order!");
+			}
+		}
+
+		// chains nested in a loop, and an exception in a link
+		std::atomic<size_t> total(0);
+
+		ParallelUtils::ParallelFor(0, 4, [&total](size_t)
+		{
+			ParallelUtils::ParallelChains(3, 5, [&total](size_t i, size_t j)
+			{
+				total.fetch_add(i * 5 + j);
+			});
+		});
+
+		// each nested call sums 0 to 14
+		if (total != 4 * 105)
+			throw TestException("SHA2: A nested chain set is not complete!");
+
+		bool thrown = false;
+
+		try
+		{
+			ParallelUtils::ParallelChains(4, 10, [](size_t i, size_t j)
+			{
+				if (i == 2 && j == 3)
+					throw CryptoDigestException("SHA2Test:ParallelChainsTest", "Link failure");
+			});
+		}
+		catch (CryptoDigestException const &)
+		{
+			thrown = true;
+		}
+
+		if (!thrown)
+			throw TestException("SHA2: A chain exception was not rethrown!");
+
+		// a long update hashes each leaf in many links; the leaf hashes must match updates of one tree row at a time
+		std::vector<byte> message(3 * 1024 * 1024 + 4096);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>((i * 31) ^ (i >> 11));
+
+		for (size_t d = 0; d < 2; ++d)
+		{
+			IDigest* rowDgt = (d == 0) ? static_cast<IDigest*>(new SHA256(true)) : static_cast<IDigest*>(new SHA512(true));
+			IDigest* longDgt = (d == 0) ? static_cast<IDigest*>(new SHA256(true)) : static_cast<IDigest*>(new SHA512(true));
+			const size_t ROWLEN = rowDgt->ParallelProfile().ParallelMinimumSize();
+
+			for (size_t i = 0; i < message.size(); i += ROWLEN)
+				rowDgt->Update(message, i, (std::min)(ROWLEN, message.size() - i));
+
+			expected.resize(rowDgt->DigestSize());
+			rowDgt->Finalize(expected, 0);
+			longDgt->Update(message, 0, message.size());
+			hash.resize(longDgt->DigestSize());
+			longDgt->Finalize(hash, 0);
+			delete rowDgt;
+			delete longDgt;
+
+			if (hash != expected)
+				throw TestException("SHA2: Linked tree hash is not equal!");
+		}
+
+		// uneven messages hashed in many partitions
+		std::vector<std::vector<byte>> messages(64);
+		std::vector<const byte*> msgPtr(messages.size());
+		std::vector<size_t> msgLen(messages.size());
+		std::vector<byte> hashes(messages.size() * 32);
+
+		for (size_t i = 0; i < messages.size(); ++i)
+		{
+			messages[i].assign((i % 8 == 0) ? 400000 + i : 3000 * i, static_cast<byte>(i));
+			msgPtr[i] = messages[i].data();
+			msgLen[i] = messages[i].size();
+		}
+
+		SHA256::ComputeMany(msgPtr.data(), msgLen.data(), messages.size(), hashes.data());
+
+		for (size_t i = 0; i < messages.size(); ++i)
+		{
+			byte code[32];
+			SHA256::Hash(msgPtr[i], msgLen[i], code);
+
+			if (std::memcmp(&hashes[i * sizeof(code)], code, sizeof(code)) != 0)
+				throw TestException("SHA2: Partitioned batch hash is not equal!");
+		}
+	}
+
+	void SHA2Test::ParallelForTest()
+	{
+		using CEX::Utility::ParallelUtils;
+
+		// every index of the range runs exactly once, including ranges longer than the pool
+		const size_t RNGLEN[5] = { 1, 2, 7, 64, 1000 };
+
+		for (size_t r = 0; r < 5; ++r)
+		{
+			std::vector<std::atomic<size_t>> runs(RNGLEN[r] + 3);
+
+			for (size_t i = 0; i < runs.size(); ++i)
+				runs[i] = 0;
+
+			ParallelUtils::ParallelFor(3, RNGLEN[r] + 3, [&runs](size_t i)
+			{
+				runs[i].fetch_add(1);
+			});
+
+			for (size_t i = 0; i < runs.size(); ++i)
+			{
+				if (runs[i] != (i < 3 ? 0 : 1))
+					throw TestException("SHA2: A parallel loop index did not run once!");
+			}
+		}
+
+		// loops nested in a loop, and loops started from several threads at once
+		std::atomic<size_t> total(0);
+
+		ParallelUtils::ParallelFor(0, 8, [&total](size_t i)
+		{
+			for (size_t j = 0; j < 50; ++j)
+			{
+				ParallelUtils::ParallelFor(0, 8, [&total, i](size_t k)
+				{
+					total.fetch_add(i + k + 1);
+				});
+			}
+		});
+
+		// the sum over i and k of (i + k + 1) is 8 * 28 * 2 + 64 = 512 for each of the 50 inner loops
+		if (total != 50 * 512)
+			throw TestException("SHA2: A nested parallel loop is not complete!");
+
+		std::vector<std::thread> callers;
+		std::atomic<size_t> calls(0);
+
+		for (size_t t = 0; t < 4; ++t)
+		{
+			callers.emplace_back([&calls]()
+			{
+				for (size_t j = 0; j < 500; ++j)
+				{
+					ParallelUtils::ParallelFor(0, 4, [&calls](size_t)
+					{
+						calls.fetch_add(1);
+					});
+				}
+			});
+		}
+
+		for (size_t t = 0; t < callers.size(); ++t)
+			callers[t].join();
+
+		if (calls != 4 * 500 * 4)
+			throw TestException("SHA2: A concurrent parallel loop is not complete!");
+
+		// an exception in the loop reaches the caller, and the pool keeps working after it
+		bool thrown = false;
+
+		try
+		{
+			ParallelUtils::ParallelFor(0, 16, [](size_t i)
+			{
+				if (i == 5)
+					throw CryptoDigestException("SHA2Test:ParallelForTest", "Loop failure");
+			});
+		}
+		catch (CryptoDigestException const &)
+		{
+			thrown = true;
+		}
+
+		if (!thrown)
+			throw TestException("SHA2: A parallel loop exception was not rethrown!");
+
+		// tree hashes reuse the same workers from one instance to the next
+		std::vector<byte> message(100000);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 7);
+
+		SHA256 reference(true);
+		reference.Compute(message, expected);
+
+		for (size_t i = 0; i < 20; ++i)
+		{
+			SHA256 dgt(true);
+			dgt.Update(message, 0, 16384);
+			dgt.Update(message, 16384, message.size() - 16384);
+			hash.resize(dgt.DigestSize());
+			dgt.Finalize(hash, 0);
+			if (hash != expected)
+				throw TestException("SHA2: Pooled tree hash is not equal!");
+		}
+	}
+
+	void SHA2Test::PeekTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		std::vector<byte> message(2500);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 3);
+
+		const Digests DGTTYPE[4] = { Digests::SHA256, Digests::SHA224, Digests::SHA512, Digests::SHA384 };
+		// chunks that leave the partial block empty, full, and at either side of the length field
+		const size_t CHKLEN[4] = { 1, 55, 64, 301 };
+
+		for (size_t d = 0; d < 4; ++d)
+		{
+			for (size_t p = 0; p < 2; ++p)
+			{
+				IDigest* digest = DigestFromName::GetInstance(DGTTYPE[d], p != 0);
+				IDigest* reference = DigestFromName::GetInstance(DGTTYPE[d], p != 0);
+
+				// tree mode is exercised regardless of the host core count
+				if (p != 0)
+				{
+					TreeMode(digest, 8);
+					TreeMode(reference, 8);
+				}
+
+				SHA256* dgt256 = dynamic_cast<SHA256*>(digest);
+				SHA512* dgt512 = dynamic_cast<SHA512*>(digest);
+				hash.resize(digest->DigestSize());
+
+				for (size_t c = 0; c < 4; ++c)
+				{
+					size_t pos = 0;
+
+					while (pos < message.size())
+					{
+						const size_t LEN = (std::min)(message.size() - pos, CHKLEN[c] * ((pos % 7) + 1));
+						digest->Update(message, pos, LEN);
+						pos += LEN;
+
+						if (dgt256 != nullptr)
+							dgt256->Peek(hash, 0);
+						else
+							dgt512->Peek(hash, 0);
+
+						std::vector<byte> prefix(message.begin(), message.begin() + pos);
+						reference->Compute(prefix, expected);
+						if (hash != expected)
+							throw TestException("SHA2: Peek hash is not equal!");
+					}
+
+					// the stream was not disturbed by the intermediate hashes
+					digest->Finalize(hash, 0);
+					if (hash != expected)
+						throw TestException("SHA2: Finalize after Peek is not equal!");
+				}
+
+				delete reference;
+				delete digest;
+			}
+		}
+	}
+
+	void SHA2Test::PointerTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		std::string text(2000, 0);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < text.size(); ++i)
+			text[i] = static_cast<char>('a' + (i % 26));
+
+		const std::vector<byte> message(text.begin(), text.end());
+		const Digests DGTTYPE[4] = { Digests::SHA256, Digests::SHA512, Digests::SHA256d, Digests::SHA512T224 };
+		// chunks that straddle the block boundaries of both block sizes
+		const size_t CHKLEN[5] = { 1, 7, 63, 129, 700 };
+
+		for (size_t d = 0; d < 4; ++d)
+		{
+			for (size_t p = 0; p < 2; ++p)
+			{
+				// the tree hashing mode of each digest, where it has one
+				IDigest* digest = DigestFromName::GetInstance(DGTTYPE[d], p != 0);
+				digest->Compute(message, expected);
+				hash.resize(digest->DigestSize());
+
+				for (size_t c = 0; c < 5; ++c)
+				{
+					const byte* ptr = reinterpret_cast<const byte*>(text.data());
+					size_t rmd = text.size();
+
+					while (rmd != 0)
+					{
+						const size_t LEN = (std::min)(rmd, CHKLEN[c]);
+						if (LEN == 1)
+							digest->Update(*ptr);
+						else
+							digest->Update(ptr, LEN);
+
+						ptr += LEN;
+						rmd -= LEN;
+					}
+
+					digest->Update(nullptr, 0);
+					digest->Finalize(&hash[0]);
+
+					if (hash != expected)
+						throw TestException("SHA2: Pointer update hash is not equal!");
+				}
+
+				delete digest;
+			}
+		}
+	}
+
+	void SHA2Test::PoolTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+		using CEX::Utility::ParallelUtils;
+
+		std::vector<byte> message(3000);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 17);
+
+		DigestPool pool(2);
+		IDigest* first;
+
+		{
+			// a lease released in the middle of a message is reset, and handed out again
+			DigestPool::Lease dgt = pool.Acquire(Digests::SHA256, true);
+			dgt->Compute(message, expected);
+			dgt->Update(message, 0, 1000);
+			first = dgt.get();
+		}
+
+		if (pool.Idle() != 1)
+			throw TestException("SHA2: The released digest was not pooled!");
+
+		{
+			DigestPool::Lease dgt = pool.Acquire(Digests::SHA256, true);
+			DigestPool::Lease other = pool.Acquire(Digests::SHA256, false);
+			if (dgt.get() != first || other.get() == first)
+				throw TestException("SHA2: The pool returned the wrong instance!");
+
+			dgt->Compute(message, hash);
+			if (hash != expected)
+				throw TestException("SHA2: Pooled digest hash is not equal!");
+
+			// a changed tree shape no longer matches the key
+			dgt->ParallelMaxDegree(4);
+		}
+
+		if (pool.Idle() != 1)
+			throw TestException("SHA2: A changed digest was pooled!");
+
+		// instances are shared by equal parameters only
+		SHA2Params params384(48, 128, 0);
+		SHA2Params params512(64, 128, 0);
+		IDigest* reference = DigestFromName::GetInstance(Digests::SHA384, false);
+		reference->Compute(message, expected);
+		delete reference;
+
+		{
+			DigestPool::Lease dgt384 = pool.Acquire(Digests::SHA384, params384);
+			DigestPool::Lease dgt512 = pool.Acquire(Digests::SHA512, params512);
+			dgt384->Compute(message, hash);
+			if (hash != expected || dgt384->DigestSize() != 48 || dgt512->DigestSize() != 64)
+				throw TestException("SHA2: Pooled parameter digest is not equal!");
+		}
+
+		// the parameters must carry the output size of the requested type
+		try
+		{
+			SHA2Params params256(32, 64, 0);
+			DigestPool::Lease dgt224 = pool.Acquire(Digests::SHA224, params256);
+			throw TestException("SHA2: The pool leased a digest of another size!");
+		}
+		catch (CEX::Exception::CryptoException const &)
+		{
+		}
+
+		// an instance reset to a restored midstate is deleted, the next lease starts from the initial value
+		for (size_t d = 0; d < 2; ++d)
+		{
+			const Digests MIDTYPE = (d == 0) ? Digests::SHA256 : Digests::SHA512;
+			size_t idle;
+
+			reference = DigestFromName::GetInstance(MIDTYPE, false);
+			reference->Compute(message, expected);
+			delete reference;
+
+			{
+				DigestPool::Lease dgt = pool.Acquire(MIDTYPE, false);
+				idle = pool.Idle();
+				dgt->Update(message, 0, 256);
+
+				if (d == 0)
+				{
+					SHA256* dgt256 = dynamic_cast<SHA256*>(dgt.get());
+					dgt256->Reset(dgt256->Midstate());
+				}
+				else
+				{
+					SHA512* dgt512 = dynamic_cast<SHA512*>(dgt.get());
+					dgt512->Reset(dgt512->Midstate());
+				}
+			}
+
+			if (pool.Idle() != idle)
+				throw TestException("SHA2: A digest with a restored midstate was pooled!");
+
+			DigestPool::Lease dgt = pool.Acquire(MIDTYPE, false);
+			dgt->Compute(message, hash);
+			if (hash != expected)
+				throw TestException("SHA2: Pooled digest hash after a midstate lease is not equal!");
+		}
+
+		// leases taken and released concurrently; every thread must see a reset digest
+		const Digests DGTTYPE[4] = { Digests::SHA256, Digests::SHA512, Digests::SHA256d, Digests::SHA224 };
+		std::vector<std::vector<byte>> refHash(4);
+		std::atomic<bool> failed(false);
+
+		for (size_t d = 0; d < 4; ++d)
+		{
+			IDigest* dgt = DigestFromName::GetInstance(DGTTYPE[d], false);
+			dgt->Compute(message, refHash[d]);
+			delete dgt;
+		}
+
+		ParallelUtils::ParallelFor(0, 8, [&pool, &message, &refHash, &DGTTYPE, &failed](size_t i)
+		{
+			std::vector<byte> code;
+
+			for (size_t j = 0; j < 200; ++j)
+			{
+				const size_t TYPIDX = (i + j) % 4;
+				DigestPool::Lease dgt = pool.Acquire(DGTTYPE[TYPIDX], false);
+				dgt->Compute(message, code);
+
+				if (code != refHash[TYPIDX])
+					failed = true;
+
+				// leave a partial message behind for the next lease
+				dgt->Update(message, 0, j);
+			}
+		});
+
+		if (failed)
+			throw TestException("SHA2: Concurrent pooled digest hash is not equal!");
+		if (pool.Idle() > 2 * 7)
+			throw TestException("SHA2: The pool held more than its maximum!");
+
+		// a lease that outlives its pool is deleted on release
+		DigestPool::Lease orphan;
+		{
+			DigestPool scoped;
+			orphan = scoped.Acquire(Digests::SHA512, false);
+		}
+		orphan->Compute(message, hash);
+		orphan.reset();
+
+		pool.Clear();
+		if (pool.Idle() != 0)
+			throw TestException("SHA2: The pool was not cleared!");
+	}
+
+	void SHA2Test::PrefixedTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		std::vector<byte> message(200);
+		std::vector<byte> expected;
+		std::vector<byte> hash;
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 7);
+
+		// a short prefix bypasses the cache, the others end before, on and after a block boundary
+		const size_t PRELEN[4] = { 20, 128, 150, 300 };
+		const Digests DGTTYPE[3] = { Digests::SHA256, Digests::SHA224, Digests::SHA384 };
+
+		for (size_t d = 0; d < 3; ++d)
+		{
+			PrefixedHasher hasher(DGTTYPE[d], 2);
+			IDigest* reference = DigestFromName::GetInstance(DGTTYPE[d], false);
+
+			// the third distinct prefix evicts the first, which misses again on the second pass
+			for (size_t n = 0; n < 2; ++n)
+			{
+				for (size_t p = 0; p < 4; ++p)
+				{
+					std::vector<byte> prefix(PRELEN[p]);
+					for (size_t i = 0; i < prefix.size(); ++i)
+						prefix[i] = static_cast<byte>(i + p);
+
+					for (size_t m = 0; m < message.size(); m += 67)
+					{
+						std::vector<byte> msg(prefix);
+						std::vector<byte> tail(message.begin(), message.begin() + m);
+						msg.insert(msg.end(), tail.begin(), tail.end());
+						reference->Compute(msg, expected);
+						hasher.Compute(prefix, tail, hash);
+
+						if (hash != expected)
+							throw TestException("SHA2: Prefixed hash is not equal!");
+					}
+				}
+			}
+
+			// 3 prefixes, 3 messages each, 2 passes; every pass misses once per prefix as the capacity is 2
+			if (hasher.Misses() != 6 || hasher.Hits() != 12 || hasher.Evictions() != 4 || hasher.Size() != 2)
+				throw TestException("SHA2: Prefixed cache counters are not equal!");
+
+			hasher.Clear();
+			if (hasher.Size() != 0 || hasher.Hits() != 0)
+				throw TestException("SHA2: Prefixed cache was not cleared!");
+
+			delete reference;
+		}
+	}
+
+	void SHA2Test::SHA256dTest()
+	{
+		using CEX::Enumeration::SHA2Kernels;
+
+		const size_t MSGCNT = 21;
+		const SHA2Kernels kernels[] = { SHA2Kernels::Scalar, SHA2Kernels::BMI2, SHA2Kernels::AVX, SHA2Kernels::AVX2, SHA2Kernels::SHANI };
+		const SHA2Kernels active256 = SHA2Dispatch::Kernel256();
+		std::vector<std::vector<byte>> message;
+		std::vector<std::vector<byte>> expected;
+		std::vector<byte> hash(32);
+		SHA256d sha256d;
+		SHA256 sha256;
+
+		// "hello", the empty string, the bitcoin genesis block header, and the transaction ids of block 100000 with their merkle root (internal byte order)
+		const char* messageEncoded[4] =
+		{
+			("68656c6c6f"),
+			(""),
+			("0100000000000000000000000000000000000000000000000000000000000000000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a29ab5f49ffff001d1dac2b7c"),
+			("876dd0a3ef4a2816ffd1c12ab649825a958b0ff3bb3d6f3e1250f13ddbf0148cc40297f730dd7b5a99567eb8d27b78758f607507c52292d02d4031895b52f2ffc46e239ab7d28e2c019b6d66ad8fae98a56ef1f21aeecb94d1b1718186f059631d0cb83721529a062d9675b98d6e5c587e4a770fc84ed00abc5a5de04568a6e9")
+		};
+		HexConverter::Decode(messageEncoded, 4, message);
+
+		const char* expectedEncoded[4] =
+		{
+			("9595c9df90075148eb06860365df33584b75bff782a510c6cd4883a419833d50"),
+			("5df6e0e2761359d30a8275058e299fcc0381534545f55cf43e41983f5d4c9456"),
+			("6fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000"),
+			("6657a9252aacd5c0b2940996ecff952228c3067cc38d4885efb5a4ac4247e9f3")
+		};
+		HexConverter::Decode(expectedEncoded, 4, expected);
+
+		CompareVector(&sha256d, message[0], expected[0]);
+		CompareVector(&sha256d, message[1], expected[1]);
+		CompareVector(&sha256d, message[2], expected[2]);
+
+		SHA256d::ComputeHeader(&message[2][0], &hash[0]);
+		if (hash != expected[2])
+			throw TestException("SHA2: SHA256d header hash is not equal!");
+
+		SHA256d::MerkleRoot(&message[3][0], 4, &hash[0]);
+		if (hash != expected[3])
+			throw TestException("SHA2: SHA256d merkle root is not equal!");
+
+		// headers that share their first block, as in a nonce search, and a tree level of nodes
+		std::vector<byte> headers(MSGCNT * SHA256d::HEADER_SIZE);
+		std::vector<const byte*> tailPtr(MSGCNT);
+		std::vector<byte> nodes(MSGCNT * 32);
+		std::vector<byte> hashes(MSGCNT * 32);
+		std::vector<byte> inner(32);
+		std::array<uint, 8> midstate;
+
+		for (size_t i = 0; i < MSGCNT; ++i)
+		{
+			std::memcpy(&headers[i * SHA256d::HEADER_SIZE], &message[2][0], SHA256d::HEADER_SIZE);
+			headers[(i * SHA256d::HEADER_SIZE) + 76] = static_cast<byte>(i);
+			tailPtr[i] = &headers[(i * SHA256d::HEADER_SIZE) + 64];
+		}
+		for (size_t i = 0; i < nodes.size(); ++i)
+			nodes[i] = static_cast<byte>((i * 13) + (i >> 5));
+
+		for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); ++k)
+		{
+			if (!SHA2Dispatch::IsSupported256(kernels[k]))
+				continue;
+
+			SHA2Dispatch::SetKernel256(kernels[k]);
+			SHA256d::HeaderMidstate(&headers[0], midstate);
+
+			for (size_t count = 1; count <= MSGCNT; ++count)
+			{
+				SHA256d::ComputeHeaders(midstate, &tailPtr[0], count, &hashes[0]);
+				for (size_t i = 0; i < count; ++i)
+				{
+					std::vector<byte> msg(&headers[i * SHA256d::HEADER_SIZE], &headers[(i + 1) * SHA256d::HEADER_SIZE]);
+					sha256.Compute(msg, inner);
+					sha256.Compute(inner, hash);
+					if (std::memcmp(&hashes[i * 32], &hash[0], 32) != 0)
+						throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " SHA256d header hash is not equal!");
+				}
+
+				// the parents of each pair, the last node paired with itself on an odd count
+				SHA256d::ComputeLevel(&nodes[0], count, &hashes[0]);
+				for (size_t i = 0; i < (count + 1) / 2; ++i)
+				{
+					const size_t RGHOFF = (2 * i + 1 < count) ? (2 * i + 1) * 32 : (2 * i) * 32;
+					std::vector<byte> msg(&nodes[i * 64], &nodes[i * 64] + 32);
+					msg.resize(64);
+					std::memcpy(&msg[32], &nodes[RGHOFF], 32);
+					sha256.Compute(msg, inner);
+					sha256.Compute(inner, hash);
+					if (std::memcmp(&hashes[i * 32], &hash[0], 32) != 0)
+						throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " SHA256d merkle node is not equal!");
+				}
+
+				// the same level reduced in place
+				std::vector<byte> level(nodes.begin(), nodes.begin() + (count * 32));
+				SHA256d::ComputeLevel(&level[0], count, &level[0]);
+				if (std::memcmp(&level[0], &hashes[0], ((count + 1) / 2) * 32) != 0)
+					throw TestException("SHA2: " + SHA2Dispatch::KernelName(kernels[k]) + " SHA256d in place merkle level is not equal!");
+			}
+		}
+
+		SHA2Dispatch::SetKernel256(active256);
+	}
+
+	void SHA2Test::StatelessTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		std::vector<byte> message(400);
+		std::vector<byte> expected;
+		byte out28[28];
+		byte out32[32];
+		byte out48[48];
+		byte out64[64];
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i * 5);
+
+		const Digests DGTTYPE[6] = { Digests::SHA256, Digests::SHA224, Digests::SHA512, Digests::SHA384, Digests::SHA512T256, Digests::SHA512T224 };
+		IDigest* digest[6];
+
+		for (size_t d = 0; d < 6; ++d)
+			digest[d] = DigestFromName::GetInstance(DGTTYPE[d], false);
+
+		// every tail length of both block sizes, and the empty message from a null pointer
+		for (size_t i = 0; i <= message.size(); ++i)
+		{
+			std::vector<byte> msg(message.begin(), message.begin() + i);
+			const byte* ptr = (i != 0) ? &message[0] : nullptr;
+
+			digest[0]->Compute(msg, expected);
+			SHA256::Hash(ptr, i, out32);
+			if (std::vector<byte>(out32, out32 + 32) != expected)
+				throw TestException("SHA2: Stateless SHA256 hash is not equal!");
+
+			digest[1]->Compute(msg, expected);
+			SHA256::Hash(ptr, i, out28);
+			if (std::vector<byte>(out28, out28 + 28) != expected)
+				throw TestException("SHA2: Stateless SHA224 hash is not equal!");
+
+			digest[2]->Compute(msg, expected);
+			SHA512::Hash(ptr, i, out64);
+			if (std::vector<byte>(out64, out64 + 64) != expected)
+				throw TestException("SHA2: Stateless SHA512 hash is not equal!");
+
+			digest[3]->Compute(msg, expected);
+			SHA512::Hash(ptr, i, out48);
+			if (std::vector<byte>(out48, out48 + 48) != expected)
+				throw TestException("SHA2: Stateless SHA384 hash is not equal!");
+
+			digest[4]->Compute(msg, expected);
+			SHA512::Hash(ptr, i, out32);
+			if (std::vector<byte>(out32, out32 + 32) != expected)
+				throw TestException("SHA2: Stateless SHA512/256 hash is not equal!");
+
+			digest[5]->Compute(msg, expected);
+			SHA512::Hash(ptr, i, out28);
+			if (std::vector<byte>(out28, out28 + 28) != expected)
+				throw TestException("SHA2: Stateless SHA512/224 hash is not equal!");
+		}
+
+		for (size_t d = 0; d < 6; ++d)
+			delete digest[d];
+	}
+
+	void SHA2Test::TruncatedTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		const Digests types[4] = { Digests::SHA224, Digests::SHA384, Digests::SHA512T224, Digests::SHA512T256 };
+		const std::string names[4] = { "SHA224", "SHA384", "SHA512/224", "SHA512/256" };
+		std::vector<std::vector<byte>> expected;
+
+		// the abc, empty and 896 bit messages of the NIST examples, for each variant
+		const char* expectedEncoded[12] =
+		{
+			("23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7"),
+			("d14a028c2a3a2bc9476102bb288234c415a2b01f828ea62ac5b3e42f"),
+			("c97ca9a559850ce97a04a96def6d99a9e0e0e2ab14e6b8df265fc0b3"),
+			("cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7"),
+			("38b060a751ac96384cd9327eb1b1e36a21fdb71114be07434c0cc7bf63f6e1da274edebfe76f65fbd51ad2f14898b95b"),
+			("09330c33f71147e83d192fc782cd1b4753111b173b3b05d22fa08086e3b0f712fcc7c71a557e2db966c3e9fa91746039"),
+			("4634270f707b6a54daae7530460842e20e37ed265ceee9a43e8924aa"),
+			("6ed0dd02806fa89e25de060c19d3ac86cabb87d6a0ddd05c333b84f4"),
+			("23fec5bb94d60b23308192640b0c453335d664734fe40e7268674af9"),
+			("53048e2681941ef99b2e29b76b4c7dabe4c2d0c634fc6d46e0e2f13107e7af23"),
+			("c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a"),
+			("3928e184fb8690f840da3988121d31be65cb9d3ef83ee6146feac861e19b563a")
+		};
+		HexConverter::Decode(expectedEncoded, 12, expected);
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			IDigest* dgt = DigestFromName::GetInstance(types[i]);
+
+			if (dgt->Enumeral() != types[i] || dgt->Name() != names[i] || dgt->DigestSize() != expected[i * 3].size() || DigestFromName::GetDigestSize(types[i]) != expected[i * 3].size())
+				throw TestException("SHA2: " + names[i] + " reports the wrong type or size!");
+
+			CompareVector(dgt, m_message[0], expected[i * 3]);
+			CompareVector(dgt, m_message[1], expected[(i * 3) + 1]);
+			CompareVector(dgt, m_message[3], expected[(i * 3) + 2]);
+			delete dgt;
+		}
+
+		// an output size without a variant is rejected by the parameters
+		try
+		{
+			SHA2Params params(40, 64, 0);
+			throw TestException("SHA2: SHA2Params accepted an invalid output size!");
+		}
+		catch (CryptoDigestException const &)
+		{
+		}
+
+		// and a valid variant size for the other digest is rejected by the digest
+		try
+		{
+			SHA2Params params(48, 128, 0);
+			SHA256 dgt(params);
+			throw TestException("SHA2: SHA256 accepted an invalid output size!");
+		}
+		catch (CryptoDigestException const &)
+		{
+		}
+	}
+
+	void SHA2Test::TreeMode(IDigest* Digest, size_t Degree)
+	{
+		// the profile only enables threading on multi-core hosts; forcing it fixes the leaf count
+		Digest->ParallelProfile().IsParallel() = true;
+		Digest->ParallelMaxDegree(Degree);
+	}
+
 	void SHA2Test::TreeParamsTest()
 	{
 		std::vector<byte> code1(8, 7);
@@ -128,4 +1841,57 @@ namespace Test
 		if (!tree3.Equals(tree4))
 			throw std::string("SHA2Test: Tree parameters test failed!");
 	}
+
+	void SHA2Test::TreeVectorTest()
+	{
+		using CEX::Enumeration::Digests;
+		using CEX::Helper::DigestFromName;
+
+		const Digests DGTTYPE[2] = { Digests::SHA256, Digests::SHA512 };
+		const size_t MSGLEN[7] = { 0, 1, 511, 512, 513, 1024, 3000 };
+		std::vector<std::vector<byte>> expected;
+		std::vector<byte> hash;
+		std::vector<byte> message(3000);
+
+		// empty, partial, full and overflowing leaf rounds at a degree of 8; the root hashes the 8 leaf outputs contiguously
+		const char* expectedEncoded[14] =
+		{
+			("7a518cb03fe06ed6655eb02ddf2c807799df4dba72f46c20102daa83400d697e"),
+			("3479109453e7ba6c960198f3232b3a0826ef14cf7fccdc5aedb61c639e0fd82a"),
+			("351a5f19197c5d14426f16ecf726cbd580c056900bc36ea42ac832f009f187b4"),
+			("8fd94d1d330d0f6344db494f4a08649d7c7000c203df19456ee56e27dc8c3c2b"),
+			("26e21e1d7c385819def9395781376415859b679723e2b44ed4a00f6ca58354a4"),
+			("9cadda1659cf4f16ee2228f1de4af0315dcf6ac6d8d1b13d210f1cea5024a881"),
+			("f0dd69a64223caaafa5bbdb79cea3c5d2b397fdb8a3240a9b1d4a70af0df02cd"),
+			("48b2a22a9a0912a9ca28cb064c1509a0910aae4ee63a23e33cb9376f79c74fb8b1032f81d3fdac68d4ef5b867ad5de1d381bc5cf0f7e753596c47d4fe592bf99"),
+			("3874ecee006f713652a612ef025397b86589218886c0947a38b8aadc4800f5d291fa5553a52fff0281df9193f84470c8b7e9ec6dd128440c53f0ffaa980f1f65"),
+			("90abfdd0bf3a36be9110e9045b78e8bc5c742d8075f4f0f44c01a73b926bb134469972750b556671f5c744b6428190d382b1f0f5bfecac05653d5a4655b8c05e"),
+			("7fb33edc26664f212e3a7691ce57481627cb4f29001e6f502568db872f477fd8bdd45070163a5cc62251f40b4267df4f678cf6478e861edde1f6e7e8bbaf1911"),
+			("afa25ba776b1ce7614f556b1fd85142308e38eae0af0c2f27884ebb2e64ac6607fcf9fbb63c27c17c778a624191ec4382605cefe4bf8bc09e95c86c9b5b9f9b1"),
+			("dcd9a1fad4005d45c89c4a6b72d92c817bb8f3dd82c70ddc5cdda548604ba01d29891c2a5f0868a3e619a4fd9ccc6f89a0dab82cf4d623311fcd5841742b2a1f"),
+			("213320e015167cc035715c334c99871d80eca62ab991216543904846572cbe14db5ddb34e6769e971abc322aab1e582ee83466852113cb6ad3acca4b627aeab3")
+		};
+		HexConverter::Decode(expectedEncoded, 14, expected);
+
+		for (size_t i = 0; i < message.size(); ++i)
+			message[i] = static_cast<byte>(i);
+
+		for (size_t d = 0; d < 2; ++d)
+		{
+			IDigest* dgt = DigestFromName::GetInstance(DGTTYPE[d], true);
+			TreeMode(dgt, 8);
+			hash.resize(dgt->DigestSize());
+
+			for (size_t i = 0; i < 7; ++i)
+			{
+				dgt->Update(message, 0, MSGLEN[i]);
+				dgt->Finalize(hash, 0);
+
+				if (hash != expected[(d * 7) + i])
+					throw TestException("SHA2: Tree hash known answer test failed!");
+			}
+
+			delete dgt;
+		}
+	}
 }
\ No newline at end of file
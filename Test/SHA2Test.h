@@ -22,6 +22,9 @@ namespace Test
 
 		std::vector<std::vector<byte>> m_expected256;
 		std::vector<std::vector<byte>> m_expected512;
+		std::vector<std::vector<byte>> m_hmacExpected;
+		std::vector<std::vector<byte>> m_hmacKey;
+		std::vector<std::vector<byte>> m_hmacMessage;
 		std::vector<std::vector<byte>> m_message;
 		TestEventHandler m_progressEvent;
 
@@ -52,10 +55,32 @@ namespace Test
 		virtual std::string Run();
         
     private:
+		void Batch512Test();
+		void BatchTest();
+		void CloneTest();
 		void CompareVector(IDigest *Digest, std::vector<byte> &Input, std::vector<byte> &Expected);
+		void ComputeManyTest();
+		void ConstexprTest();
+		void EngineTest();
+		void FixedTest();
 		void Initialize();
+		void KernelTest();
+		void MidstateTest();
+		void MoveTest();
+		void MultiplexerTest();
 		void OnProgress(std::string Data);
+		void ParallelChainsTest();
+		void ParallelForTest();
+		void PeekTest();
+		void PointerTest();
+		void PoolTest();
+		void PrefixedTest();
+		void SHA256dTest();
+		void StatelessTest();
+		void TreeMode(IDigest* Digest, size_t Degree);
 		void TreeParamsTest();
+		void TreeVectorTest();
+		void TruncatedTest();
     };
 }
 
@@ -8,6 +8,13 @@
 #	include <sys/types.h>
 #	include <sys/time.h>
 #endif
+#if defined(CEX_ARCH_X86_X64)
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+#endif
 #include <algorithm>
 #include <fstream>
 #include <iostream>
@@ -38,6 +45,16 @@ namespace Test
 		return true;
 	}
 
+	uint64_t TestUtils::GetCycles64()
+	{
+#if defined(CEX_ARCH_X86_X64)
+		// the time stamp counter; constant rate on current processors, so cycles at the nominal frequency
+		return __rdtsc();
+#else
+		return 0;
+#endif
+	}
+
 	uint64_t TestUtils::GetTimeMs64()
 	{
 #if defined(_WIN32)
@@ -11,6 +11,7 @@ namespace Test
 
 		static void CopyVector(const std::vector<int> &SrcArray, size_t SrcIndex, std::vector<int> &DstArray, size_t DstIndex, size_t Length);
 		static bool IsEqual(std::vector<byte> &A, std::vector<byte> &B);
+		static uint64_t GetCycles64();
 		static uint64_t GetTimeMs64();
 		static void GetRandom(std::vector<byte> &Data);
 		static bool Read(const std::string &FilePath, std::string &Contents);